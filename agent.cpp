@@ -0,0 +1,314 @@
+#include "agent.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>        // For strtoul
+#include <cstring>        // For strerror
+#include "evaluate.h"
+#include "inventory.h"    // WideToUtf8
+#include "report.h"
+#include "snapshot.h"     // RecordSectionName
+#include "trace.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// --- Options ---
+AgentOptions DefaultAgentOptions() {
+    const unsigned minute = 60, hour = 60 * minute, day = 24 * hour;
+    AgentOptions options;
+    for (unsigned& seconds : options.RefreshSeconds) seconds = day; // Cpu, Ram, Firmware, DirectX, Graphics
+    options.RefreshSeconds[2] = minute;   // Disk: free space
+    options.RefreshSeconds[3] = hour;     // Os: updates change the build number
+    options.RefreshSeconds[5] = minute;   // Screen: docking / external displays
+    options.RefreshSeconds[7] = hour;     // Security: TPM and Secure Boot can be toggled in setup (reboot in between)
+    return options;
+}
+
+bool SetAgentRefresh(AgentOptions& options, const std::string& assignment, std::string& error) {
+    const size_t equals = assignment.find('=');
+    const std::string name = assignment.substr(0, equals);
+    char* end = NULL; const unsigned long seconds = equals == std::string::npos ? 0 : strtoul(assignment.c_str() + equals + 1, &end, 10);
+    for (int i = 0; i < RecordSectionCount; ++i) {
+        if (name != RecordSectionName(i)) continue;
+        if (equals == std::string::npos || end == assignment.c_str() + equals + 1 || *end) { error = "Expected Section=Seconds, got '" + assignment + "'."; return false; }
+        options.RefreshSeconds[i] = (unsigned)seconds; return true;
+    }
+    error = "Unknown section '" + name + "'. Available:";
+    for (int i = 0; i < RecordSectionCount; ++i) { error += ' '; error += RecordSectionName(i); }
+    return false;
+}
+
+// --- Published State (immutable once published; answers rendered up front) ---
+struct ReadinessAgent::State {
+    MachineRecord Record;
+    unsigned Probed = 0;                                // Sections with at least one successful probe
+    Clock::time_point ProbedAt[RecordSectionCount];     // Last successful probe
+    Clock::time_point NextDue[RecordSectionCount];      // Next scheduled probe (time_point::max() = never)
+    ProbeState LastState[RecordSectionCount];           // Outcome of the last attempt
+    double LastMs[RecordSectionCount];
+    std::string Check[BuiltinTargetCount];              // "check" response without the closing ageSeconds
+    std::string Report[BuiltinTargetCount];             // JSON report line
+    std::string Summary;                                // JSON summary line
+    unsigned long long Generation = 0;
+
+    State() { for (int i = 0; i < RecordSectionCount; ++i) { NextDue[i] = Clock::time_point::max(); LastState[i] = ProbePending; LastMs[i] = 0; } }
+};
+
+static void AppendCheckArray(std::string& out, unsigned mask) {
+    out += '[';
+    for (int id = 0, first = 1; id < CheckCount; ++id) {
+        if (!(mask & (1u << id))) continue;
+        if (!first) out += ',';
+        out += '"'; out += CheckIdName((CheckId)id); out += '"'; first = 0;
+    }
+    out += ']';
+}
+
+static int FindTargetKey(const std::string& key) { // Narrow-string FindBuiltinTarget (no conversion per request)
+    for (int i = 0; i < BuiltinTargetCount; ++i) {
+        const wchar_t* k = BUILTIN_TARGETS[i].Key; size_t n = 0;
+        while (k[n] && n < key.size() && (wchar_t)(unsigned char)key[n] == k[n]) ++n;
+        if (!k[n] && n == key.size()) return i;
+    }
+    return -1;
+}
+
+// --- Probing ---
+void ReadinessAgent::ProbeAndPublish(unsigned sections) {
+    std::lock_guard<std::mutex> probeLock(probeMutex);
+    TRACE_SPAN("Agent refresh", "agent");
+    std::shared_ptr<const State> previous = Current();
+    std::shared_ptr<State> next = std::make_shared<State>(previous ? *previous : State());
+    if (!previous) next->Record.MachineId = options.MachineId;
+
+    MachineRecord work = next->Record; work.TimedOutSections = 0;
+    ProbeScheduler scheduler(options.ProbeDeadlineMs);
+    probes(scheduler, sections);
+    std::vector<ProbeOutcome> outcomes;
+    scheduler.Run(work, outcomes);
+
+    const Clock::time_point now = Clock::now();
+    unsigned succeeded = 0, attempted = 0;
+    for (const ProbeOutcome& outcome : outcomes) {
+        attempted |= outcome.Section;
+        if (outcome.State == ProbeSucceeded) succeeded |= outcome.Section;
+        for (int i = 0; i < RecordSectionCount; ++i) { if (outcome.Section & (1u << i)) { next->LastState[i] = outcome.State; next->LastMs[i] = outcome.Milliseconds; } }
+    }
+    // A failed or timed-out re-probe keeps the last good value; a section never probed successfully takes the
+    // defaults (and the timed-out mark) so its checks report [WARN] as in a normal run
+    const unsigned take = succeeded | (attempted & ~next->Probed);
+    CopyRecordSections(take, work, next->Record);
+    next->Record.TimedOutSections = (next->Record.TimedOutSections & ~take) | (work.TimedOutSections & take);
+    next->Probed |= succeeded;
+    for (int i = 0; i < RecordSectionCount; ++i) {
+        if (succeeded & (1u << i)) next->ProbedAt[i] = now;
+        if (sections & (1u << i)) next->NextDue[i] = options.RefreshSeconds[i] ? now + std::chrono::seconds(options.RefreshSeconds[i]) : Clock::time_point::max();
+    }
+
+    // --- Render every answer once per state ---
+    {
+        TRACE_SPAN("Agent render", "agent");
+        std::unique_ptr<ReportRenderer> json = CreateReportRenderer(ReportJson);
+        const MachineFeatures features = ExtractFeatures(next->Record); RequirementsReport report;
+        for (int id = 0; id < BuiltinTargetCount; ++id) {
+            const WindowsRequirements& target = BUILTIN_TARGETS[id].Requirements;
+            const CheckMasks masks = EvaluateFeatures(target, features);
+            std::string& check = next->Check[id]; check.clear();
+            check += "{\"target\":"; AppendJsonString(check, WideToUtf8(BUILTIN_TARGETS[id].Key));
+            check += ",\"result\":\""; check += masks.Fail ? "FAIL" : (masks.Warn ? "WARN" : "PASS");
+            check += "\",\"failed\":"; AppendCheckArray(check, masks.Fail);
+            check += ",\"warned\":"; AppendCheckArray(check, masks.Warn);
+            report.Clear(); next->Report[id].clear();
+            BuildRequirementsReport(target, next->Record, MakeEvaluationResult(masks, features), report);
+            json->Render(report, next->Report[id]);
+        }
+        TargetSummaryReport summary; summary.MachineId = WideToUtf8(next->Record.MachineId);
+        summary.Targets = EvaluateAllBuiltinTargets(features);
+        next->Summary.clear(); json->Render(summary, next->Summary);
+    }
+
+    next->Generation = generation.load() + 1;
+    { std::lock_guard<std::mutex> lock(stateMutex); state = next; }
+    generation.store(next->Generation);
+}
+
+void ReadinessAgent::Start() {
+    ProbeAndPublish(SectionAll);
+    { std::lock_guard<std::mutex> lock(wakeMutex); stopping = false; }
+    refresher = std::thread([this]() { RefreshLoop(); });
+}
+
+void ReadinessAgent::Stop() {
+    { std::lock_guard<std::mutex> lock(wakeMutex); stopping = true; }
+    wake.notify_all();
+    if (refresher.joinable()) refresher.join();
+}
+
+void ReadinessAgent::Refresh(unsigned sections) { ProbeAndPublish(sections & SectionAll); }
+
+void ReadinessAgent::RefreshLoop() {
+    TRACE_THREAD_NAME("agent refresh");
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!stopping) {
+        std::shared_ptr<const State> current = Current();
+        const Clock::time_point now = Clock::now();
+        unsigned due = requested; Clock::time_point earliest = Clock::time_point::max();
+        for (int i = 0; i < RecordSectionCount; ++i) {
+            if (current->NextDue[i] <= now) due |= 1u << i;
+            else if (current->NextDue[i] < earliest) earliest = current->NextDue[i];
+        }
+        if (due) {
+            requested = 0; lock.unlock();
+            ProbeAndPublish(due); // Sections due within the same wakeup share one scheduler run
+            lock.lock(); continue;
+        }
+        if (earliest == Clock::time_point::max()) wake.wait(lock, [this]() { return stopping || requested; });
+        else wake.wait_until(lock, earliest, [this]() { return stopping || requested; });
+    }
+}
+
+// --- Requests ---
+void ReadinessAgent::HandleRequests(const std::vector<Request>& requests) {
+    std::shared_ptr<const State> current = Current();
+    const Clock::time_point now = Clock::now();
+    auto AgeSeconds = [&](int section) { return (long long)std::chrono::duration_cast<std::chrono::seconds>(now - current->ProbedAt[section]).count(); };
+    auto Error = [](std::string& out, const char* message, const std::string& detail) {
+        out += "{\"error\":"; AppendJsonString(out, message + detail); out += "}\n";
+    };
+    unsigned refresh = 0;
+    for (const Request& request : requests) {
+        std::string& out = *request.Reply;
+        std::string line = request.Line; if (!line.empty() && line.back() == '\r') line.pop_back();
+        const size_t space = line.find(' ');
+        const std::string command = line.substr(0, space), argument = space == std::string::npos ? std::string() : line.substr(space + 1);
+        if (!current) { Error(out, "Agent is starting", std::string()); continue; }
+
+        if (command == "check" || command == "report") {
+            const int id = FindTargetKey(argument);
+            if (id < 0) { Error(out, "Unknown target: ", argument); continue; }
+            if (command == "report") { out += current->Report[id]; continue; }
+            long long age = 0; // Oldest section the target's checks read
+            const unsigned needed = RequiredSections(BUILTIN_TARGETS[id].Requirements) & current->Probed;
+            for (int i = 0; i < RecordSectionCount; ++i) { if ((needed & (1u << i)) && AgeSeconds(i) > age) age = AgeSeconds(i); }
+            out += current->Check[id]; out += ",\"ageSeconds\":"; out += std::to_string(age); out += "}\n";
+        }
+        else if (command == "summary" && argument.empty()) { out += current->Summary; }
+        else if (command == "status" && argument.empty()) {
+            out += "{\"machineId\":"; AppendJsonString(out, WideToUtf8(current->Record.MachineId));
+            out += ",\"generation\":"; out += std::to_string(current->Generation); out += ",\"sections\":[";
+            for (int i = 0; i < RecordSectionCount; ++i) {
+                if (i) out += ',';
+                out += "{\"section\":\""; out += RecordSectionName(i); out += "\",\"ageSeconds\":";
+                out += (current->Probed & (1u << i)) ? std::to_string(AgeSeconds(i)) : std::string("null");
+                out += ",\"refreshSeconds\":"; out += std::to_string(options.RefreshSeconds[i]);
+                out += ",\"lastProbe\":\""; out += ProbeStateName(current->LastState[i]);
+                char ms[32]; snprintf(ms, sizeof(ms), "\",\"lastProbeMs\":%.1f}", current->LastMs[i]); out += ms;
+            }
+            out += "]}\n";
+        }
+        else if (command == "refresh") {
+            unsigned sections = argument.empty() ? (unsigned)SectionAll : 0;
+            for (int i = 0; i < RecordSectionCount; ++i) { if (argument == RecordSectionName(i)) sections = 1u << i; }
+            if (!sections) { Error(out, "Unknown section: ", argument); continue; }
+            refresh |= sections;
+            out += "{\"refreshQueued\":true,\"generation\":"; out += std::to_string(current->Generation); out += "}\n";
+        }
+        else { Error(out, "Unknown request: ", line); }
+    }
+    if (refresh) {
+        { std::lock_guard<std::mutex> lock(wakeMutex); requested |= refresh; }
+        wake.notify_all();
+    }
+}
+
+// --- Unix Domain Socket Server ---
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+struct AgentClient { int Fd; std::string In; std::string Out; bool Closing = false; };
+const size_t AGENT_MAX_REQUEST = 4096;   // A longer line without a newline drops the connection
+}
+
+bool RunAgentSocketServer(ReadinessAgent& agent, const std::string& path, const std::atomic<bool>& stop, std::string& error) {
+    sockaddr_un address = {}; address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) { error = "Socket path is empty or too long: " + path; return false; }
+    path.copy(address.sun_path, path.size());
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) { // Left over from an agent that was killed; never replace anything but a socket
+        if (!S_ISSOCK(existing.st_mode)) { error = path + " exists and is not a socket."; return false; }
+        unlink(path.c_str());
+    }
+    const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) { error = std::string("socket: ") + strerror(errno); return false; }
+    const mode_t mask = umask(0077); // Owner only, like the named pipe's default DACL
+    const bool bound = bind(listener, (sockaddr*)&address, sizeof(address)) == 0;
+    umask(mask);
+    if (!bound || listen(listener, 64) != 0) { error = "Cannot listen on " + path + ": " + strerror(errno); close(listener); return false; }
+    fcntl(listener, F_SETFL, O_NONBLOCK);
+
+    std::vector<AgentClient> clients; std::vector<pollfd> fds; std::vector<ReadinessAgent::Request> batch;
+    char buffer[16384];
+    while (!stop.load()) {
+        fds.clear(); fds.push_back(pollfd{ listener, POLLIN, 0 });
+        for (const AgentClient& client : clients) fds.push_back(pollfd{ client.Fd, (short)(client.Out.empty() ? POLLIN : POLLIN | POLLOUT), 0 });
+        if (poll(fds.data(), (nfds_t)fds.size(), 200) < 0 && errno != EINTR) { error = std::string("poll: ") + strerror(errno); break; }
+
+        // --- Read everything that arrived; collect the complete lines of every client into one batch ---
+        batch.clear();
+        for (size_t c = 0; c < clients.size(); ++c) {
+            AgentClient& client = clients[c]; const short events = fds[c + 1].revents;
+            if (events & (POLLIN | POLLHUP | POLLERR)) {
+                const ssize_t count = read(client.Fd, buffer, sizeof(buffer));
+                if (count > 0) client.In.append(buffer, (size_t)count);
+                else if (count == 0 || (errno != EAGAIN && errno != EINTR)) client.Closing = true;
+            }
+            size_t begin = 0, newline;
+            while ((newline = client.In.find('\n', begin)) != std::string::npos) {
+                batch.push_back(ReadinessAgent::Request{ client.In.substr(begin, newline - begin), &client.Out });
+                begin = newline + 1;
+            }
+            client.In.erase(0, begin);
+            if (client.In.size() > AGENT_MAX_REQUEST) { client.Closing = true; client.Out.clear(); }
+        }
+        if (!batch.empty()) { TRACE_SPAN("Agent batch", "agent"); agent.HandleRequests(batch); }
+
+        // --- Write replies (what does not fit the socket buffer waits for POLLOUT), drop finished clients ---
+        for (size_t c = 0; c < clients.size(); ) {
+            AgentClient& client = clients[c];
+            while (!client.Out.empty()) {
+                const ssize_t count = send(client.Fd, client.Out.data(), client.Out.size(), MSG_NOSIGNAL);
+                if (count > 0) client.Out.erase(0, (size_t)count);
+                else { if (count < 0 && errno != EAGAIN && errno != EINTR) { client.Closing = true; client.Out.clear(); } break; }
+            }
+            if (client.Closing && client.Out.empty()) { close(client.Fd); clients.erase(clients.begin() + c); }
+            else ++c;
+        }
+
+        // --- Accept new connections last, so fds still matches clients above ---
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listener, NULL, NULL)) >= 0) {
+                fcntl(fd, F_SETFL, O_NONBLOCK); fcntl(fd, F_SETFD, FD_CLOEXEC);
+                AgentClient client; client.Fd = fd; clients.push_back(client);
+            }
+        }
+    }
+    for (const AgentClient& client : clients) close(client.Fd);
+    close(listener); unlink(path.c_str());
+    return error.empty();
+}
+#else
+bool RunAgentSocketServer(ReadinessAgent& agent, const std::string& path, const std::atomic<bool>& stop, std::string& error) {
+    (void)agent; (void)path; (void)stop;
+    error = "Unix domain sockets are not available in this build; use the named pipe agent.";
+    return false;
+}
+#endif
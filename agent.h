@@ -0,0 +1,77 @@
+#ifndef AGENT_H_INCLUDED
+#define AGENT_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "probe.h"
+#include "requirements.h"
+
+// --- Readiness Agent (long-running; --agent) ---
+// Keeps the last detection results warm and answers readiness queries from memory. A background thread re-probes each
+// RecordSection when its refresh interval runs out (free disk space every minute, CPU once a day, ...) using the same
+// ProbeScheduler and probes as a normal run, so a hung probe only leaves that section stale. Every refresh publishes a
+// new immutable state with all answers (verdict and JSON report per built-in target, all-targets summary) rendered
+// up front; a query is a shared_ptr copy and a string append.
+//
+// Protocol: one request per line, one JSON object per line back, in order. Requests on one connection (or several
+// connections that became readable together) are answered against one state as a batch with a single write.
+//   check <target>    {"target":"11","result":"FAIL","failed":["Tpm"],"warned":[],"ageSeconds":12}
+//   report <target>   The JSON report (same object as --format json)
+//   summary           The all-targets summary (same object as --format json --target all)
+//   status            Per-section age, refresh interval and last probe state
+//   refresh [Section] Queues a re-probe (all sections, or e.g. "refresh Disk") and answers at once with the current
+//                     generation; "status" shows a higher one once the new state is published
+//   Anything else     {"error":"..."}
+struct AgentOptions {
+    unsigned RefreshSeconds[RecordSectionCount];    // Indexed like RecordSection bits; 0 = probe once at startup only
+    unsigned ProbeDeadlineMs = 15000;
+    std::wstring MachineId = L"local";              // Reported as machineId (the host name)
+};
+AgentOptions DefaultAgentOptions();                 // Disk/Screen 60 s, Security/Os 1 h, the rest 24 h
+bool SetAgentRefresh(AgentOptions& options, const std::string& assignment, std::string& error); // "Disk=30"
+
+// Adds probes for the given RecordSection bits (live WMI/API probes on Windows, /proc and /sys on Linux, mocks in tests)
+typedef std::function<void(ProbeScheduler& scheduler, unsigned sections)> AgentProbeSource;
+
+class ReadinessAgent {
+public:
+    ReadinessAgent(const AgentOptions& options, AgentProbeSource probes) : options(options), probes(probes) {}
+    ~ReadinessAgent() { Stop(); }
+    ReadinessAgent(const ReadinessAgent&) = delete; ReadinessAgent& operator=(const ReadinessAgent&) = delete;
+
+    void Start();                                   // Probes every section (blocking), then starts the refresh thread
+    void Stop();
+    void Refresh(unsigned sections);                // Re-probes now and waits until the result is published
+    // Answers a batch of requests (from one or several connections) against one state; appends each response line to
+    // its request's Reply
+    struct Request { std::string Line; std::string* Reply; };
+    void HandleRequests(const std::vector<Request>& requests);
+    unsigned long long Generation() const { return generation.load(); } // Number of states published so far
+
+private:
+    struct State;
+    std::shared_ptr<const State> Current() const { std::lock_guard<std::mutex> lock(stateMutex); return state; }
+    void ProbeAndPublish(unsigned sections);
+    void RefreshLoop();
+
+    AgentOptions options; AgentProbeSource probes;
+    mutable std::mutex stateMutex; std::shared_ptr<const State> state;
+    std::mutex probeMutex;                          // One probe round at a time (scheduler thread vs. "refresh" requests)
+    std::mutex wakeMutex; std::condition_variable wake; bool stopping = false; unsigned requested = 0; // "refresh" sections
+    std::thread refresher;
+    std::atomic<unsigned long long> generation{0};
+};
+
+// --- Transport ---
+// Unix domain socket server (Linux/macOS): poll()s the listening socket and every client, reads whatever arrived and
+// answers all complete lines of one wakeup with one HandleRequests call. Returns when stop becomes true (checked at
+// least every 200 ms) or on a setup error. The Windows build serves a named pipe from main.cpp.
+bool RunAgentSocketServer(ReadinessAgent& agent, const std::string& path, const std::atomic<bool>& stop, std::string& error);
+
+#endif // AGENT_H_INCLUDED
@@ -0,0 +1,292 @@
+#include "aggregate.h"
+
+#include <algorithm>
+#include <cstdio>         // For snprintf
+#include "report.h"       // AppendJsonString
+#include "varint.h"
+
+// --- Buckets ---
+// Bucket 0 is always "not detected" (value 0). Clock speed and width are linear, byte sizes are powers of two (so 7.9 GB
+// of visible RAM lands in "<= 8 GB"), small counts and versions are exact.
+enum BucketScale { ScaleExact, ScaleLinear, ScaleLog2 };
+struct FieldSpec { const char* Name; BucketScale Scale; ULONGLONG Step; const char* Unit; };
+static const FieldSpec FIELD_SPECS[AggregateFieldCount] = {
+    { "CpuSpeed", ScaleLinear, 100, "MHz" }, { "CpuCores", ScaleExact, 1, "cores" },
+    { "Ram", ScaleLog2, 1, "" }, { "DiskFree", ScaleLog2, 1, "" },
+    { "ScreenWidth", ScaleLinear, 128, "px" },
+    { "DirectX", ScaleExact, 1, "" }, { "Wddm", ScaleExact, 1, "" }, { "TpmVersion", ScaleExact, 1, "" },
+};
+
+int AggregateBucket(AggregateField field, ULONGLONG value) {
+    if (value == 0) return 0;
+    const FieldSpec& spec = FIELD_SPECS[field]; ULONGLONG bucket;
+    if (spec.Scale == ScaleLog2) { bucket = 1; while (bucket < 64 && (1ULL << bucket) < value) ++bucket; } // Smallest power of two >= value
+    else if (spec.Scale == ScaleLinear) bucket = 1 + (value - 1) / spec.Step;   // Bucket b covers ((b - 1) * Step, b * Step]
+    else bucket = value;
+    return bucket < (ULONGLONG)HISTOGRAM_BUCKETS ? (int)bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+static std::string ByteSize(ULONGLONG bytes) {
+    static const char* const units[] = { "B", "KB", "MB", "GB", "TB", "PB", "EB" };
+    int unit = 0; while (bytes >= 1024 && unit < 6) { bytes /= 1024; ++unit; }
+    return std::to_string(bytes) + " " + units[unit];
+}
+
+std::string AggregateBucketLabel(AggregateField field, int bucket) {
+    if (bucket == 0) return "not detected";
+    const FieldSpec& spec = FIELD_SPECS[field]; const bool last = (bucket == HISTOGRAM_BUCKETS - 1);
+    std::string label;
+    if (spec.Scale == ScaleLog2) { label = "<= " + ByteSize(1ULL << bucket); if (last) label = "> " + ByteSize(1ULL << (bucket - 1)); return label; }
+    if (spec.Scale == ScaleLinear) {
+        const ULONGLONG low = (ULONGLONG)(bucket - 1) * spec.Step + 1, high = (ULONGLONG)bucket * spec.Step;
+        label = std::to_string(low) + (last ? "+" : "-" + std::to_string(high));
+    } else { label = std::to_string(bucket) + (last ? "+" : ""); }
+    if (*spec.Unit) { label += ' '; label += spec.Unit; }
+    return label;
+}
+
+const char* AggregateFieldName(AggregateField field) { return FIELD_SPECS[field].Name; }
+
+// --- Accumulation ---
+FleetAggregate::FleetAggregate() : failCombos((size_t)1 << CheckCount, 0), histograms((size_t)AggregateFieldCount * HISTOGRAM_ROWS * HISTOGRAM_BUCKETS, 0) {}
+
+void FleetAggregate::Add(const MachineFeatures& f, unsigned fail, unsigned warn, const char* cpuName, size_t cpuLength, const char* gpuName, size_t gpuLength) {
+    ++machines; ++failCombos[fail];
+    for (int c = 0; c < CheckCount; ++c) { checkFails[c] += (fail >> c) & 1; checkWarns[c] += (warn >> c) & 1; }
+
+    const ULONGLONG values[AggregateFieldCount] = { f.CpuSpeedMHz, f.CpuCores, f.RamBytes, f.DiskFreeBytes, f.ScreenWidth, f.DXLevel, f.WDDMLevel, f.TpmVersionMajor };
+    for (int field = 0; field < AggregateFieldCount; ++field) {
+        unsigned long long* rows = &histograms[(size_t)field * HISTOGRAM_ROWS * HISTOGRAM_BUCKETS];
+        const int bucket = AggregateBucket((AggregateField)field, values[field]);
+        ++rows[bucket];
+        for (unsigned bits = fail; bits; bits &= bits - 1) { // Only the failing checks' rows
+            int c = 0; while (!((bits >> c) & 1)) ++c;
+            ++rows[(1 + c) * HISTOGRAM_BUCKETS + bucket];
+        }
+    }
+
+    auto Count = [&](NameTable& table, const char* name, size_t length) {
+        key.assign(name, length);
+        NameTable::iterator it = table.find(key);
+        if (it == table.end()) it = table.emplace(key, NameCounts()).first;
+        ++it->second.Machines;
+        for (int c = 0; c < CheckCount; ++c) it->second.Failing[c] += (fail >> c) & 1;
+    };
+    Count(cpuNames, cpuName, cpuLength); Count(gpuNames, gpuName, gpuLength);
+}
+
+void FleetAggregate::Merge(const FleetAggregate& other) {
+    machines += other.machines;
+    for (int c = 0; c < CheckCount; ++c) { checkFails[c] += other.checkFails[c]; checkWarns[c] += other.checkWarns[c]; }
+    for (size_t i = 0; i < failCombos.size(); ++i) failCombos[i] += other.failCombos[i];
+    for (size_t i = 0; i < histograms.size(); ++i) histograms[i] += other.histograms[i];
+    auto MergeNames = [](NameTable& into, const NameTable& from) {
+        for (const NameTable::value_type& entry : from) {
+            NameCounts& counts = into[entry.first]; counts.Machines += entry.second.Machines;
+            for (int c = 0; c < CheckCount; ++c) counts.Failing[c] += entry.second.Failing[c];
+        }
+    };
+    MergeNames(cpuNames, other.cpuNames); MergeNames(gpuNames, other.gpuNames);
+}
+
+// --- Serialization ---
+
+void FleetAggregate::Serialize(std::string& out) const {
+    PutVarint(out, machines);
+    for (int c = 0; c < CheckCount; ++c) { PutVarint(out, checkFails[c]); PutVarint(out, checkWarns[c]); }
+    for (unsigned long long count : failCombos) PutVarint(out, count);
+    for (unsigned long long count : histograms) PutVarint(out, count);
+    std::vector<const NameTable::value_type*> sorted; // Hash order depends on how the table grew, so names go out sorted
+    auto PutNames = [&](const NameTable& table) {
+        sorted.clear(); for (const NameTable::value_type& entry : table) sorted.push_back(&entry);
+        std::sort(sorted.begin(), sorted.end(), [](const NameTable::value_type* a, const NameTable::value_type* b) { return a->first < b->first; });
+        PutVarint(out, table.size());
+        for (const NameTable::value_type* entry : sorted) {
+            PutVarint(out, entry->first.size()); out += entry->first; PutVarint(out, entry->second.Machines);
+            for (int c = 0; c < CheckCount; ++c) PutVarint(out, entry->second.Failing[c]);
+        }
+    };
+    PutNames(cpuNames); PutNames(gpuNames);
+}
+
+bool FleetAggregate::Deserialize(const char*& p, const char* end) {
+    *this = FleetAggregate();
+    bool ok = GetVarint(p, end, machines);
+    for (int c = 0; c < CheckCount; ++c) ok = ok && GetVarint(p, end, checkFails[c]) && GetVarint(p, end, checkWarns[c]);
+    for (unsigned long long& count : failCombos) ok = ok && GetVarint(p, end, count);
+    for (unsigned long long& count : histograms) ok = ok && GetVarint(p, end, count);
+    auto GetNames = [&](NameTable& table) {
+        ULONGLONG size = 0, length = 0;
+        if (!GetVarint(p, end, size)) return false;
+        for (ULONGLONG i = 0; i < size; ++i) {
+            if (!GetVarint(p, end, length) || length > (ULONGLONG)(end - p)) return false;
+            std::pair<NameTable::iterator, bool> slot = table.emplace(std::string(p, (size_t)length), NameCounts()); p += length;
+            if (!slot.second || !GetVarint(p, end, slot.first->second.Machines)) return false;
+            for (int c = 0; c < CheckCount; ++c) { if (!GetVarint(p, end, slot.first->second.Failing[c])) return false; }
+        }
+        return true;
+    };
+    if (!ok || !GetNames(cpuNames) || !GetNames(gpuNames)) return false;
+
+    unsigned long long combos = 0, fromCombos[CheckCount] = {};
+    for (unsigned mask = 0; mask < failCombos.size(); ++mask) {
+        combos += failCombos[mask];
+        for (int c = 0; c < CheckCount; ++c) fromCombos[c] += ((mask >> c) & 1) ? failCombos[mask] : 0;
+    }
+    if (combos != machines) return false;
+    for (int c = 0; c < CheckCount; ++c) { if (fromCombos[c] != checkFails[c]) return false; }
+    for (int field = 0; field < AggregateFieldCount; ++field) {
+        for (int row = 0; row < HISTOGRAM_ROWS; ++row) {
+            const unsigned long long* buckets = Histogram((AggregateField)field, row); unsigned long long total = 0;
+            for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) total += buckets[b];
+            if (total != (row ? checkFails[row - 1] : machines)) return false;
+        }
+    }
+    for (const NameTable* table : { &cpuNames, &gpuNames }) {
+        unsigned long long total = 0, failing[CheckCount] = {};
+        for (const NameTable::value_type& entry : *table) {
+            total += entry.second.Machines;
+            for (int c = 0; c < CheckCount; ++c) failing[c] += entry.second.Failing[c];
+        }
+        if (total != machines) return false;
+        for (int c = 0; c < CheckCount; ++c) { if (failing[c] != checkFails[c]) return false; }
+    }
+    return true;
+}
+
+// --- Summary Helpers ---
+namespace {
+struct RankedName { const std::string* Name; unsigned long long Machines; };
+
+// check < 0 ranks by all machines; ties break by name so the output does not depend on hash order
+void TopNames(const FleetAggregate::NameTable& table, int check, size_t topK, std::vector<RankedName>& out) {
+    out.clear();
+    for (const FleetAggregate::NameTable::value_type& entry : table) {
+        const unsigned long long n = check < 0 ? entry.second.Machines : entry.second.Failing[check];
+        if (n) { RankedName ranked = { &entry.first, n }; out.push_back(ranked); }
+    }
+    auto Before = [](const RankedName& a, const RankedName& b) { return a.Machines != b.Machines ? a.Machines > b.Machines : *a.Name < *b.Name; };
+    const size_t keep = std::min(topK, out.size());
+    std::partial_sort(out.begin(), out.begin() + keep, out.end(), Before); out.resize(keep);
+}
+
+void SortedCombinations(const FleetAggregate& aggregate, std::vector<unsigned>& masks) { // Failing combinations, most machines first
+    const std::vector<unsigned long long>& combos = aggregate.FailCombinations();
+    masks.clear();
+    for (unsigned mask = 1; mask < combos.size(); ++mask) { if (combos[mask]) masks.push_back(mask); }
+    std::sort(masks.begin(), masks.end(), [&](unsigned a, unsigned b) { return combos[a] != combos[b] ? combos[a] > combos[b] : a < b; });
+}
+
+std::string CheckList(unsigned mask, const char* separator) {
+    std::string list;
+    for (int c = 0; c < CheckCount; ++c) { if (mask & (1u << c)) { if (!list.empty()) list += separator; list += CheckIdName((CheckId)c); } }
+    return list;
+}
+
+// Name lists shown per failing check: CPU names behind the CPU checks, GPU names behind the graphics checks
+bool CpuNamesExplain(int check) { return (CHECK_SECTIONS[check] & SectionCpu) != 0; }
+bool GpuNamesExplain(int check) { return (CHECK_SECTIONS[check] & SectionGraphics) != 0; }
+
+std::string Percent(unsigned long long part, unsigned long long whole) {
+    char text[32]; snprintf(text, sizeof(text), "%.1f%%", whole ? 100.0 * (double)part / (double)whole : 0.0); return text;
+}
+}
+
+// --- Text Summary ---
+void FormatAggregateText(const FleetAggregate& a, const std::string& targetName, size_t topK, std::string& out) {
+    const unsigned long long total = a.Machines();
+    out += "=== Fleet Summary: " + targetName + " ===\n";
+    out += "Machines: " + std::to_string(total) + ", no [FAIL]: " + std::to_string(a.Passed()) + " (" + Percent(a.Passed(), total) + ")\n";
+
+    out += "\n--- Checks ---\n";
+    char line[256];
+    for (int c = 0; c < CheckCount; ++c) {
+        if (!a.CheckFailures(c) && !a.CheckWarnings(c)) continue;
+        snprintf(line, sizeof(line), "  %-16s %10llu fail (%s)  %10llu warn\n", CheckIdName((CheckId)c), a.CheckFailures(c), Percent(a.CheckFailures(c), total).c_str(), a.CheckWarnings(c));
+        out += line;
+    }
+
+    out += "\n--- Failure Combinations (machines failing exactly these checks) ---\n";
+    std::vector<unsigned> masks; SortedCombinations(a, masks);
+    for (unsigned mask : masks) {
+        snprintf(line, sizeof(line), "  %10llu  %-7s ", a.FailCombinations()[mask], Percent(a.FailCombinations()[mask], total).c_str());
+        out += line; out += CheckList(mask, " + "); out += '\n';
+    }
+
+    auto AppendHistogram = [&](const unsigned long long* buckets, AggregateField field) {
+        out += "    "; out += AggregateFieldName(field); out += ':';
+        for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) { if (buckets[b]) { out += "  "; out += AggregateBucketLabel(field, b); out += ": "; out += std::to_string(buckets[b]); } }
+        out += '\n';
+    };
+    std::vector<RankedName> names;
+    auto AppendNames = [&](const char* title, const FleetAggregate::NameTable& table, int check) {
+        TopNames(table, check, topK, names); if (names.empty()) return;
+        out += "    "; out += title; out += ":\n";
+        for (const RankedName& ranked : names) { snprintf(line, sizeof(line), "      %10llu  ", ranked.Machines); out += line; out += *ranked.Name; out += '\n'; }
+    };
+
+    out += "\n--- All Machines ---\n";
+    for (int field = 0; field < AggregateFieldCount; ++field) AppendHistogram(a.Histogram((AggregateField)field, 0), (AggregateField)field);
+    AppendNames("Top CPU names", a.CpuNames(), -1); AppendNames("Top GPU names", a.GpuNames(), -1);
+
+    for (int c = 0; c < CheckCount; ++c) {
+        if (!a.CheckFailures(c)) continue;
+        out += "\n--- Machines Failing "; out += CheckIdName((CheckId)c); out += " (" + std::to_string(a.CheckFailures(c)) + ") ---\n";
+        for (int field = 0; field < AggregateFieldCount; ++field) AppendHistogram(a.Histogram((AggregateField)field, 1 + c), (AggregateField)field);
+        if (CpuNamesExplain(c)) AppendNames("Top CPU names", a.CpuNames(), c);
+        if (GpuNamesExplain(c)) AppendNames("Top GPU names", a.GpuNames(), c);
+    }
+}
+
+// --- JSON Summary ---
+void FormatAggregateJson(const FleetAggregate& a, const std::string& targetName, size_t topK, std::string& out) {
+    out += "{\"target\":"; AppendJsonString(out, targetName);
+    out += ",\"machines\":" + std::to_string(a.Machines()) + ",\"passed\":" + std::to_string(a.Passed());
+
+    out += ",\"checks\":[";
+    for (int c = 0; c < CheckCount; ++c) {
+        if (c) out += ',';
+        out += "{\"check\":\""; out += CheckIdName((CheckId)c); out += "\",\"fail\":" + std::to_string(a.CheckFailures(c)) + ",\"warn\":" + std::to_string(a.CheckWarnings(c)) + "}";
+    }
+    out += "],\"failCombinations\":[";
+    std::vector<unsigned> masks; SortedCombinations(a, masks);
+    for (size_t i = 0; i < masks.size(); ++i) {
+        if (i) out += ',';
+        out += "{\"checks\":[\""; out += CheckList(masks[i], "\",\""); out += "\"],\"machines\":" + std::to_string(a.FailCombinations()[masks[i]]) + "}";
+    }
+
+    auto AppendHistograms = [&](int row) {
+        out += '{';
+        for (int field = 0; field < AggregateFieldCount; ++field) {
+            if (field) out += ',';
+            out += '"'; out += AggregateFieldName((AggregateField)field); out += "\":[";
+            const unsigned long long* buckets = a.Histogram((AggregateField)field, row); bool first = true;
+            for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                if (!buckets[b]) continue;
+                if (!first) out += ',';
+                out += "{\"bucket\":"; AppendJsonString(out, AggregateBucketLabel((AggregateField)field, b)); out += ",\"machines\":" + std::to_string(buckets[b]) + "}"; first = false;
+            }
+            out += ']';
+        }
+        out += '}';
+    };
+    std::vector<RankedName> names;
+    auto AppendNames = [&](const FleetAggregate::NameTable& table, int check) {
+        TopNames(table, check, topK, names); out += '[';
+        for (size_t i = 0; i < names.size(); ++i) { if (i) out += ','; out += "{\"name\":"; AppendJsonString(out, *names[i].Name); out += ",\"machines\":" + std::to_string(names[i].Machines) + "}"; }
+        out += ']';
+    };
+
+    out += "],\"all\":{\"histograms\":"; AppendHistograms(0);
+    out += ",\"topCpu\":"; AppendNames(a.CpuNames(), -1); out += ",\"topGpu\":"; AppendNames(a.GpuNames(), -1);
+    out += "},\"failing\":{"; bool first = true;
+    for (int c = 0; c < CheckCount; ++c) {
+        if (!a.CheckFailures(c)) continue;
+        if (!first) out += ',';
+        out += '"'; out += CheckIdName((CheckId)c); out += "\":{\"machines\":" + std::to_string(a.CheckFailures(c)) + ",\"histograms\":"; AppendHistograms(1 + c);
+        if (CpuNamesExplain(c)) { out += ",\"topCpu\":"; AppendNames(a.CpuNames(), c); }
+        if (GpuNamesExplain(c)) { out += ",\"topGpu\":"; AppendNames(a.GpuNames(), c); }
+        out += '}'; first = false;
+    }
+    out += "}}\n";
+}
@@ -0,0 +1,63 @@
+#ifndef AGGREGATE_H_INCLUDED
+#define AGGREGATE_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "evaluate.h"
+
+// --- Fleet Aggregation (--batch ... --aggregate <summary.txt|summary.json>) ---
+// Built from the per-check Fail/Warn masks of a batch run: how many machines fail on exactly which combination of
+// checks ("Tpm only"), histograms of the numeric fields over all machines and over the machines failing each check
+// ("RAM of machines failing Disk"), and CPU/GPU name counts for top-K lists ("GPUs behind the Wddm failures").
+// Each batch worker fills its own FleetAggregate with no locking; the partials are merged once at the end, and merging
+// is order-independent, so the summary is identical for any thread count. Serialize writes the names sorted, so the
+// serialized bytes do not depend on merge order or hash table history either.
+enum AggregateField { FieldCpuSpeed, FieldCpuCores, FieldRam, FieldDiskFree, FieldScreenWidth, FieldDirectX, FieldWddm, FieldTpmVersion, AggregateFieldCount };
+
+const int HISTOGRAM_BUCKETS = 64;   // Last bucket also counts everything above it
+const int HISTOGRAM_ROWS = 1 + CheckCount; // Row 0: every machine; row 1 + c: machines failing CheckId c
+
+class FleetAggregate {
+public:
+    FleetAggregate();
+    // cpuName/gpuName are UTF-8 and need not be terminated (fleet files hand out string table slices)
+    void Add(const MachineFeatures& features, unsigned fail, unsigned warn, const char* cpuName, size_t cpuLength, const char* gpuName, size_t gpuLength);
+    void Merge(const FleetAggregate& other);
+    void Serialize(std::string& out) const;             // Varints; for handing partials between processes (shard.h)
+    // Replaces the contents; false if the data is cut short, names a CPU/GPU twice, or its totals disagree (every
+    // machine is counted once per failure combination, histogram and name table)
+    bool Deserialize(const char*& p, const char* end);
+
+    struct NameCounts { unsigned long long Machines = 0; unsigned long long Failing[CheckCount] = {}; };
+    typedef std::unordered_map<std::string, NameCounts> NameTable;
+
+    unsigned long long Machines() const { return machines; }
+    unsigned long long Passed() const { return failCombos[0]; }
+    unsigned long long CheckFailures(int check) const { return checkFails[check]; }
+    unsigned long long CheckWarnings(int check) const { return checkWarns[check]; }
+    const std::vector<unsigned long long>& FailCombinations() const { return failCombos; } // Index = Fail mask
+    const unsigned long long* Histogram(AggregateField field, int row) const { return &histograms[((size_t)field * HISTOGRAM_ROWS + row) * HISTOGRAM_BUCKETS]; }
+    const NameTable& CpuNames() const { return cpuNames; }
+    const NameTable& GpuNames() const { return gpuNames; }
+private:
+    unsigned long long machines = 0;
+    unsigned long long checkFails[CheckCount] = {}; unsigned long long checkWarns[CheckCount] = {};
+    std::vector<unsigned long long> failCombos;   // 1 << CheckCount entries
+    std::vector<unsigned long long> histograms;   // [field][row][bucket]
+    NameTable cpuNames, gpuNames;
+    std::string key;                              // Reused lookup key, so known names cost no allocation
+};
+
+// --- Histogram Buckets ---
+int AggregateBucket(AggregateField field, ULONGLONG value);
+std::string AggregateBucketLabel(AggregateField field, int bucket); // e.g. "<= 8 GB", "2400-2599 MHz", "4 cores"
+const char* AggregateFieldName(AggregateField field);            // Stable key, e.g. "Ram"
+
+// --- Summary Output ---
+// Text: failure combinations by count, histograms (all machines, then per failing check), top-K CPU names for the CPU
+// checks and top-K GPU names for the graphics checks. JSON: the same data as one object (only non-empty buckets).
+void FormatAggregateText(const FleetAggregate& aggregate, const std::string& targetName, size_t topK, std::string& out);
+void FormatAggregateJson(const FleetAggregate& aggregate, const std::string& targetName, size_t topK, std::string& out);
+
+#endif // AGGREGATE_H_INCLUDED
@@ -0,0 +1,44 @@
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --- Bump Arena for Short-lived Text ---
+// Hands out NUL-terminated copies carved from large blocks. Reset() rewinds to the first block and frees nothing, so an
+// owner that resets once per machine stops allocating after the first few machines: every later one reuses the blocks.
+// Blocks never move, so pointers stay valid until the next Reset() (or the arena's destruction).
+class TextArena {
+public:
+    explicit TextArena(size_t blockSize = 4096) : blockSize(blockSize ? blockSize : 1) {}
+    TextArena(const TextArena&) = delete; TextArena& operator=(const TextArena&) = delete;
+    TextArena(TextArena&&) = default; TextArena& operator=(TextArena&&) = default;
+
+    void Reset() { current = 0; used = 0; }
+    const char* Store(const char* text, size_t length) {
+        char* copy = Allocate(length + 1);
+        memcpy(copy, text, length); copy[length] = '\0';
+        return copy;
+    }
+    const char* Store(const std::string& text) { return Store(text.data(), text.size()); }
+    size_t BytesReserved() const { size_t total = 0; for (const Block& block : blocks) total += block.Size; return total; }
+
+private:
+    struct Block { std::unique_ptr<char[]> Data; size_t Size; };
+    char* Allocate(size_t size) {
+        while (current < blocks.size() && blocks[current].Size - used < size) { ++current; used = 0; }
+        if (current == blocks.size()) { // Only while warming up (or for a string larger than anything seen so far)
+            Block block; block.Size = size > blockSize ? size : blockSize; block.Data.reset(new char[block.Size]);
+            blocks.push_back(std::move(block)); used = 0;
+        }
+        char* p = blocks[current].Data.get() + used; used += size;
+        return p;
+    }
+    size_t blockSize; std::vector<Block> blocks;
+    size_t current = 0, used = 0;   // Block being filled and bytes used in it
+};
+
+#endif // ARENA_H_INCLUDED
@@ -0,0 +1,567 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "aggregate.h"
+#include "bounded_queue.h"
+#include "trace.h"
+#include "columnar.h"
+#include "evaluate.h"
+#include "fleet_file.h"
+#include "inventory.h"
+#include "mapped_inventory.h"
+#include "profile_index.h"
+#include "report.h"
+#include "requirements.h"
+#include "result_cache.h"
+#include "result_store.h"
+#include "shard.h"
+#include "sketch.h"
+#include "upgrade_plan.h"
+#include "work_stealing.h"
+
+// --- Pipeline Types ---
+struct CacheUpdate { std::string MachineId; CachedResult Result; const CachedResult* Previous; }; // Previous: NULL for a new machine
+struct StoredRow { std::string MachineId, CpuName, GpuName; MachineFeatures Features; unsigned short Fail, Warn; }; // Result store input
+
+struct BatchChunk {
+    size_t Source = 0; size_t Index = 0; bool Last = false; // Output order: by source, then chunk; Last ends its source
+    std::vector<MachineRecord> Records;       // Standard input, full reports, sharded fleet files
+    MappedInventory::ParsedRows Parsed;       // Every other mapped chunk: features, drive size and names only (a chunk fills one of the two)
+    size_t FleetBegin = 0; size_t FleetCount = 0;  // Fleet file input: a range of mapped records instead of Records
+    size_t TextBegin = 0, TextEnd = 0, FirstLine = 0; // Mapped inventory: a range of whole lines, parsed by the evaluator
+    std::vector<std::string> Warnings;        // Malformed rows of that range, printed by the writer in input order
+    std::string Output;                       // Formatted verdict lines for this chunk
+    size_t Passed = 0; size_t Failed = 0; size_t WithWarnings = 0;
+    // --- Result cache (incremental runs) ---
+    std::vector<const CachedResult*> CacheHits; std::vector<CacheUpdate> CacheUpdates;
+    std::string Delta; size_t Changes = 0; size_t Reused = 0; size_t Unparsed = 0;
+    std::vector<ULONGLONG> RowHashes;         // Mapped input: per record, RowHash() of its line
+    std::vector<const CachedResult*> RowHits; // Mapped input: per record, the entry whose line was identical (record not parsed, only MachineId set)
+    double PlanCost = 0; size_t Unfixable = 0;
+    std::vector<StoredRow> Stored;            // With a result store: appended by the writer, so the store keeps input order
+    std::unique_ptr<FleetSketch> Sketch;      // With a sketch: this chunk's machines, merged by the writer in input order
+    // --- Sharded runs (shard.h) ---
+    bool Sharded = false;
+    std::vector<ULONGLONG> Ordinals;          // Per machine of this shard: source << 40 | line number (text) or record index (fleet file)
+    std::vector<size_t> Starts;               // Offset in Output where each machine's output begins
+};
+
+// --- Inventory Sources ---
+// One per input. Sources are cut into chunks on demand: the worker that runs a source's task cuts one chunk off and
+// pushes a task for the rest, so a 2M-machine site spreads over every idle worker while a 10-machine one is one task.
+struct BatchSource {
+    enum Kind { KindFleet, KindMapped, KindStream };
+    Kind SourceKind = KindStream; std::string Path;
+    FleetFile Fleet; MappedInventory Mapped;  // Fleet file / inventory file, mapped
+    std::unique_ptr<InventoryReader> Stream;  // Standard input, read in order (only one task per source exists at a time)
+    ULONGLONG RowSeed = 0;                    // Mapped input with a result cache: RowSeed() of the profile and this file's header
+};
+
+struct BatchTask {                            // The not yet cut rest of one source
+    size_t Source = 0; size_t Chunk = 0;      // Source index, and the index the next chunk cut from it gets
+    size_t Begin = 0; size_t Line = 0;        // Fleet: next record; mapped: byte offset of the next line, and its number
+    bool operator<(const BatchTask& other) const { return Source != other.Source ? Source < other.Source : Chunk < other.Chunk; }
+};
+
+static bool OpenSource(BatchSource& source, std::string& error) {
+    if (source.Path == "-") {
+        source.SourceKind = BatchSource::KindStream; source.Stream.reset(new InventoryReader(std::cin));
+        if (!source.Stream->ReadHeader()) { error = source.Stream->LastError(); return false; }
+        return true;
+    }
+    if (IsFleetFile(source.Path)) { source.SourceKind = BatchSource::KindFleet; return source.Fleet.Open(source.Path, error); }
+    source.SourceKind = BatchSource::KindMapped;
+    return source.Mapped.Open(source.Path, error);
+}
+
+// Cuts the next chunk off the source of task; returns true (with rest) if anything is left after it
+static bool CutChunk(BatchSource& source, const BatchTask& task, size_t chunkSize, BatchChunk& chunk, BatchTask& rest) {
+    chunk.Source = task.Source; chunk.Index = task.Chunk;
+    rest = task; ++rest.Chunk;
+    if (source.SourceKind == BatchSource::KindFleet) {
+        chunk.FleetBegin = task.Begin; chunk.FleetCount = std::min(chunkSize, source.Fleet.Size() - task.Begin);
+        rest.Begin = chunk.FleetBegin + chunk.FleetCount; chunk.Last = rest.Begin >= source.Fleet.Size();
+    } else if (source.SourceKind == BatchSource::KindMapped) {
+        size_t lines = 0;
+        chunk.TextBegin = task.Begin; chunk.TextEnd = source.Mapped.NextRange(task.Begin, chunkSize, lines); chunk.FirstLine = task.Line;
+        rest.Begin = chunk.TextEnd; rest.Line = task.Line + lines; chunk.Last = rest.Begin >= source.Mapped.Size();
+    } else {
+        MachineRecord record; chunk.Records.reserve(std::min(chunkSize, (size_t)4096));
+        while (chunk.Records.size() < chunkSize) {
+            const InventoryReader::Status status = source.Stream->ReadRecord(record);
+            if (status == InventoryReader::EndOfInput) { chunk.Last = true; break; }
+            if (status == InventoryReader::RecordMalformed) { chunk.Warnings.push_back(source.Stream->LastError()); continue; }
+            chunk.Records.push_back(std::move(record));
+        }
+    }
+    return !chunk.Last;
+}
+
+// Materializes the fleet records of this shard, so the chunk is evaluated from Records (mapped text is filtered while
+// it is parsed, see ParseRange)
+static void SelectFleetShard(BatchChunk& chunk, const FleetFile& fleet, unsigned shard, unsigned shards) {
+    chunk.Records.reserve(chunk.FleetCount / shards + 1);
+    for (size_t i = chunk.FleetBegin; i < chunk.FleetBegin + chunk.FleetCount; ++i) {
+        size_t length = 0; const char* id = fleet.String(fleet.Record(i).MachineId, length);
+        if (ShardOf(id, length, i, shards) != shard) continue;
+        chunk.Ordinals.push_back(((ULONGLONG)chunk.Source << 40) | i); chunk.Records.emplace_back(); fleet.Materialize(i, chunk.Records.back());
+    }
+}
+
+// Mapped input with a result cache: a line whose bytes hash to what the cache stored under its MachineId is not parsed
+// at all; its row only gets the ID. Every other line goes through ParseRange as usual.
+static void ParseCachedRows(BatchChunk& chunk, const BatchSource& source, const ResultCache& cache) {
+    thread_local std::vector<MappedInventory::RawRow> rows; thread_local std::string id;
+    rows.clear(); source.Mapped.SplitRows(chunk.TextBegin, chunk.TextEnd, chunk.FirstLine, rows);
+    for (const MappedInventory::RawRow& row : rows) {
+        const ULONGLONG hash = RowHash(row.Bytes.data(), row.Bytes.size(), source.RowSeed);
+        id.assign(row.MachineId.data(), row.MachineId.size());
+        const CachedResult* hit = id.empty() ? NULL : cache.Find(id);
+        if (hit && hit->RowHash == hash) { chunk.Parsed.AppendIdOnly(row.MachineId); ++chunk.Unparsed; }
+        else {
+            hit = NULL;
+            const size_t parsed = chunk.Parsed.Size();
+            source.Mapped.ParseRange(row.Begin, row.Begin + row.Bytes.size(), row.Line, chunk.Parsed, chunk.Warnings);
+            if (chunk.Parsed.Size() == parsed) continue; // Malformed
+        }
+        chunk.RowHashes.push_back(hash); chunk.RowHits.push_back(hit);
+    }
+}
+
+bool ReadInputList(const std::string& path, std::vector<std::string>& inputs, std::string& error) {
+    std::ifstream list(path.c_str(), std::ios::binary);
+    if (!list) { error = "Could not open input list '" + path + "'"; return false; }
+    for (std::string line; std::getline(list, line);) {
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (!line.empty() && line[0] != '#') inputs.push_back(line);
+    }
+    return true;
+}
+
+// --- Verdict Formatting ---
+static void AppendCheckList(std::string& out, unsigned mask) {
+    bool first = true;
+    for (int id = 0; id < CheckCount; ++id) {
+        if (!(mask & (1u << id))) continue;
+        if (!first) out += ';';
+        out += CheckIdName((CheckId)id); first = false;
+    }
+}
+
+static const char* VerdictTag(unsigned fail, unsigned warn) { return fail ? "FAIL" : (warn ? "WARN" : "PASS"); }
+
+// --- Delta Lines (MachineId,Change,Result,PreviousResult,FailedChecks,PreviousFailedChecks,WarnedChecks,PreviousWarnedChecks) ---
+static const char* DeltaChange(const CachedResult* previous, unsigned fail, unsigned warn) { // NULL: nothing to report
+    if (!previous) return "New";
+    if (previous->Fail && !fail) return "NewlyPassing";
+    if (!previous->Fail && fail) return "NewlyFailing";
+    return (previous->Fail != fail || previous->Warn != warn) ? "ReasonsChanged" : NULL;
+}
+
+static void AppendDeltaLine(std::string& out, const std::string& machineId, const char* change, const CachedResult* current, const CachedResult* previous) {
+    std::string lists; // An absent side (a new or removed machine) leaves its columns empty
+    auto Verdict = [&](const CachedResult* result) { out += ','; if (result) out += VerdictTag(result->Fail, result->Warn); };
+    auto Checks = [&](const CachedResult* result, bool warnings) { out += ','; if (result) { lists.clear(); AppendCheckList(lists, warnings ? result->Warn : result->Fail); AppendCsvCell(out, lists); } };
+    AppendCsvCell(out, machineId); out += ','; out += change;
+    Verdict(current); Verdict(previous); Checks(current, false); Checks(previous, false); Checks(current, true); Checks(previous, true);
+    out += '\n';
+}
+
+// Chunk accessors covering every input: parsed records, compact rows of a mapped inventory, or records read in place
+// from a mapped fleet file
+static size_t ChunkSize(const BatchChunk& chunk, const FleetFile* fleet) { return fleet ? chunk.FleetCount : chunk.Records.size() + chunk.Parsed.Size(); }
+static MachineFeatures ChunkFeatures(const BatchChunk& chunk, const FleetFile* fleet, size_t i) {
+    return fleet ? fleet->Features(chunk.FleetBegin + i) : chunk.Records.empty() ? chunk.Parsed.Features[i] : ExtractFeatures(chunk.Records[i]);
+}
+static std::string ChunkMachineId(const BatchChunk& chunk, const FleetFile* fleet, size_t i) {
+    if (fleet) return fleet->StringUtf8(fleet->Record(chunk.FleetBegin + i).MachineId);
+    return chunk.Records.empty() ? std::string(chunk.Parsed.Get(i, MappedInventory::ParsedRows::MachineId)) : WideToUtf8(chunk.Records[i].MachineId);
+}
+static ULONGLONG ChunkDiskTotal(const BatchChunk& chunk, const FleetFile* fleet, size_t i) {
+    return fleet ? fleet->Record(chunk.FleetBegin + i).DiskTotalBytes : chunk.Records.empty() ? chunk.Parsed.DiskTotals[i] : chunk.Records[i].Disk.TotalBytes;
+}
+static void AppendMachineId(std::string& out, const BatchChunk& chunk, const FleetFile* fleet, size_t i) {
+    if (!fleet && chunk.Records.empty()) AppendCsvCell(out, chunk.Parsed.Get(i, MappedInventory::ParsedRows::MachineId));
+    else AppendCsvCell(out, ChunkMachineId(chunk, fleet, i));
+}
+// CPU and graphics name as UTF-8: views into the fleet file's string table or the parsed rows; a record's names are
+// converted into per-thread buffers, valid until the next call
+static void ChunkNames(const BatchChunk& chunk, const FleetFile* fleet, size_t i, std::string_view& cpu, std::string_view& gpu) {
+    if (fleet) {
+        const FleetRecord& record = fleet->Record(chunk.FleetBegin + i); size_t length = 0;
+        const char* text = fleet->String(record.CpuName, length); cpu = std::string_view(text, length);
+        text = fleet->String(record.GraphicsName, length); gpu = std::string_view(text, length);
+    } else if (chunk.Records.empty()) {
+        cpu = chunk.Parsed.Get(i, MappedInventory::ParsedRows::CpuName); gpu = chunk.Parsed.Get(i, MappedInventory::ParsedRows::GpuName);
+    } else {
+        thread_local std::string cpuText, gpuText;
+        cpuText.clear(); AppendUtf8(cpuText, chunk.Records[i].Cpu.Name); gpuText.clear(); AppendUtf8(gpuText, chunk.Records[i].Graphics.Name);
+        cpu = cpuText; gpu = gpuText;
+    }
+}
+static void ReleaseRows(BatchChunk& chunk) { // Rows are no longer needed once formatted; the chunk itself waits for the writer
+    chunk.Records.clear(); chunk.Records.shrink_to_fit(); chunk.Parsed = MappedInventory::ParsedRows();
+}
+
+// Chunks are evaluated column-wise: features are extracted once per record, then the SIMD kernel runs over the chunk
+static void EvaluateChunk(BatchChunk& chunk, const FleetFile* fleet, const WindowsRequirements& target, const std::string& targetName, const ReportRenderer* reports,
+                          FleetAggregate* aggregate, FleetSketch* sketch, const ResultCache* cache, ULONGLONG fingerprint, const UpgradeCosts* planCosts, bool store) {
+    thread_local FeatureColumns columns; thread_local CheckMaskColumns masks;
+    const size_t count = ChunkSize(chunk, fleet);
+    columns.Clear(); columns.Reserve(count);
+    for (size_t i = 0; i < count; ++i) columns.Append(chunk.RowHits.empty() || !chunk.RowHits[i] ? ChunkFeatures(chunk, fleet, i) : MachineFeatures());
+    if (!cache) EvaluateColumns(target, columns, masks);
+    else { // Incremental: machines whose line or hash matches the cache keep their masks; only the rest go through the kernel
+        thread_local FeatureColumns changed; thread_local CheckMaskColumns changedMasks; thread_local std::vector<size_t> changedRows, changedUpdates;
+        changed.Clear(); changedRows.clear(); changedUpdates.clear();
+        masks.Applicable = ApplicableChecks(target); masks.Fail.resize(count); masks.Warn.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!chunk.RowHits.empty() && chunk.RowHits[i]) { // Same line as last time (ParseCachedRows)
+                const CachedResult* hit = chunk.RowHits[i];
+                masks.Fail[i] = hit->Fail; masks.Warn[i] = hit->Warn; chunk.CacheHits.push_back(hit); ++chunk.Reused;
+                continue;
+            }
+            const MachineFeatures features = columns.Row(i);
+            CacheUpdate update; update.MachineId = ChunkMachineId(chunk, fleet, i); update.Result.Hash = FeatureHash(features, fingerprint);
+            update.Result.RowHash = chunk.RowHashes.empty() ? 0 : chunk.RowHashes[i];
+            update.Previous = cache->Find(update.MachineId);
+            if (update.Previous && update.Previous->Hash == update.Result.Hash) {
+                masks.Fail[i] = update.Result.Fail = update.Previous->Fail; masks.Warn[i] = update.Result.Warn = update.Previous->Warn; ++chunk.Reused;
+                if (update.Previous->RowHash == update.Result.RowHash) chunk.CacheHits.push_back(update.Previous);
+                else chunk.CacheUpdates.push_back(std::move(update)); // The line changed but no checked value did: keep the verdict, store the new line hash
+                continue;
+            }
+            changed.Append(features); changedRows.push_back(i); changedUpdates.push_back(chunk.CacheUpdates.size()); chunk.CacheUpdates.push_back(std::move(update));
+        }
+        EvaluateColumns(target, changed, changedMasks);
+        for (size_t k = 0; k < changedRows.size(); ++k) {
+            CacheUpdate& update = chunk.CacheUpdates[changedUpdates[k]];
+            update.Result.Fail = masks.Fail[changedRows[k]] = changedMasks.Fail[k]; update.Result.Warn = masks.Warn[changedRows[k]] = changedMasks.Warn[k];
+            const char* change = DeltaChange(update.Previous, update.Result.Fail, update.Result.Warn);
+            if (change) { AppendDeltaLine(chunk.Delta, update.MachineId, change, &update.Result, update.Previous); ++chunk.Changes; }
+        }
+    }
+
+    std::string lists;
+    if (store) chunk.Stored.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (chunk.Sharded) chunk.Starts.push_back(chunk.Output.size());
+        const unsigned short fail = masks.Fail[i], warn = masks.Warn[i];
+        if (fail) ++chunk.Failed; else ++chunk.Passed;
+        if (warn) ++chunk.WithWarnings;
+        if (aggregate || sketch || store) {
+            std::string_view cpu, gpu; ChunkNames(chunk, fleet, i, cpu, gpu);
+            if (aggregate) aggregate->Add(columns.Row(i), fail, warn, cpu.data(), cpu.size(), gpu.data(), gpu.size());
+            if (sketch) sketch->Add(columns.Row(i), fail, warn, cpu.data(), cpu.size(), gpu.data(), gpu.size());
+            if (store) {
+                StoredRow row; row.MachineId = ChunkMachineId(chunk, fleet, i); row.CpuName = cpu; row.GpuName = gpu;
+                row.Features = columns.Row(i); row.Fail = fail; row.Warn = warn;
+                chunk.Stored.push_back(std::move(row));
+            }
+        }
+        if (reports) { // Full report: the record's detected values are needed, so fleet records are materialized here
+            thread_local RequirementsReport report; thread_local MachineRecord materialized;
+            if (fleet) fleet->Materialize(chunk.FleetBegin + i, materialized);
+            CheckMasks checks; checks.Applicable = masks.Applicable; checks.Fail = fail; checks.Warn = warn;
+            BuildRequirementsReport(target, fleet ? materialized : chunk.Records[i], MakeEvaluationResult(checks, columns.Row(i)), report);
+            reports->Render(report, chunk.Output);
+            continue;
+        }
+        AppendMachineId(chunk.Output, chunk, fleet, i); chunk.Output += ',';
+        AppendCsvCell(chunk.Output, targetName); chunk.Output += ',';
+        chunk.Output += VerdictTag(fail, warn); chunk.Output += ',';
+        lists.clear(); AppendCheckList(lists, fail); AppendCsvCell(chunk.Output, lists); chunk.Output += ',';
+        lists.clear(); AppendCheckList(lists, warn); AppendCsvCell(chunk.Output, lists);
+        if (planCosts) { // ,PlanCost,Plan,UnfixableChecks (all empty for a passing machine)
+            thread_local UpgradePlan plan; char cost[32];
+            if (!fail) chunk.Output += ",,,";
+            else if (PlanUpgrade(target, columns.Row(i), ChunkDiskTotal(chunk, fleet, i), *planCosts, plan)) {
+                snprintf(cost, sizeof(cost), ",%.2f,", plan.Cost); chunk.Output += cost; AppendUpgradePlanCell(chunk.Output, plan); chunk.Output += ',';
+                chunk.PlanCost += plan.Cost;
+            } else { chunk.Output += ",,,"; lists.clear(); AppendCheckList(lists, plan.Fail); AppendCsvCell(chunk.Output, lists); ++chunk.Unfixable; }
+        }
+        chunk.Output += '\n';
+    }
+    ReleaseRows(chunk);
+}
+
+// All-targets mode: one line per machine with the newest satisfied profile and the full satisfied set
+static void EvaluateChunkAllTargets(BatchChunk& chunk, const FleetFile* fleet, const ReportRenderer* reports) {
+    const size_t count = ChunkSize(chunk, fleet);
+    for (size_t i = 0; i < count; ++i) {
+        if (chunk.Sharded) chunk.Starts.push_back(chunk.Output.size());
+        TargetSetResult targets = EvaluateAllBuiltinTargets(ChunkFeatures(chunk, fleet, i));
+        if (targets.Highest >= 0) ++chunk.Passed; else ++chunk.Failed;
+        if (reports) { TargetSummaryReport summary; summary.MachineId = ChunkMachineId(chunk, fleet, i); summary.Targets = targets; reports->Render(summary, chunk.Output); continue; }
+        AppendMachineId(chunk.Output, chunk, fleet, i); chunk.Output += ',';
+        chunk.Output += targets.Highest >= 0 ? WideToUtf8(BUILTIN_TARGETS[targets.Highest].Requirements.Name) : "None"; chunk.Output += ',';
+        bool first = true;
+        for (int id = 0; id < BuiltinTargetCount; ++id) {
+            if (!(targets.Satisfied & (1u << id))) continue;
+            if (!first) chunk.Output += ';';
+            chunk.Output += WideToUtf8(BUILTIN_TARGETS[id].Key); first = false;
+        }
+        chunk.Output += '\n';
+    }
+    ReleaseRows(chunk);
+}
+
+// Custom-profile mode: the threshold index resolves every profile at once, so the cost per machine barely depends on
+// how many baselines are loaded
+static void EvaluateChunkProfiles(BatchChunk& chunk, const FleetFile* fleet, const ProfileSet& profiles) {
+    thread_local ProfileMatch match;
+    const ProfileIndex& index = profiles.Index();
+    const size_t count = ChunkSize(chunk, fleet);
+    for (size_t i = 0; i < count; ++i) {
+        if (chunk.Sharded) chunk.Starts.push_back(chunk.Output.size());
+        index.Match(ChunkFeatures(chunk, fleet, i), match);
+        const size_t satisfied = index.SatisfiedCount(match);
+        if (satisfied) ++chunk.Passed; else ++chunk.Failed;
+        AppendMachineId(chunk.Output, chunk, fleet, i); chunk.Output += ','; chunk.Output += std::to_string(satisfied); chunk.Output += ',';
+        thread_local std::string names; names.clear(); bool warned = false;
+        for (size_t p = index.NextSatisfied(match, 0); p < index.Size(); p = index.NextSatisfied(match, p + 1)) {
+            if (!names.empty()) names += ';';
+            names += profiles.NameUtf8(p); warned = warned || !match.Clean(p);
+        }
+        if (warned) ++chunk.WithWarnings;
+        AppendCsvCell(chunk.Output, names); chunk.Output += '\n';
+    }
+    ReleaseRows(chunk);
+}
+
+// --- Batch Driver ---
+void BatchDocumentEdges(const BatchOptions& options, const WindowsRequirements* target, std::string& begin, std::string& end) {
+    begin.clear(); end.clear();
+    if (options.Reports) { options.Reports->BeginDocument(begin); options.Reports->EndDocument(end); }
+    else if (options.Profiles) begin = "MachineId,SatisfiedCount,SatisfiedProfiles\n";
+    else if (options.Plan) begin = "MachineId,Target,Result,FailedChecks,WarnedChecks,PlanCost,Plan,UnfixableChecks\n";
+    else begin = target ? "MachineId,Target,Result,FailedChecks,WarnedChecks\n" : "MachineId,HighestSupported,SatisfiedTargets\n";
+}
+
+bool RunBatch(const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error) {
+    stats = BatchStats();
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Every input is opened up front. A packed fleet file is evaluated in place, an inventory file is mapped and parsed by
+    // the evaluators in line ranges, and standard input goes through the streaming CSV reader.
+    std::vector<std::unique_ptr<BatchSource>> sources; bool readsStdin = false;
+    for (const std::string& path : options.InputPaths) {
+        if (path == "-" && readsStdin) { error = "Standard input can only be read once"; return false; }
+        if (path == "-" && options.ShardCount) { error = "Standard input cannot be split into shards"; return false; }
+        readsStdin = readsStdin || path == "-";
+        sources.emplace_back(new BatchSource()); sources.back()->Path = path;
+        if (!OpenSource(*sources.back(), error)) { if (options.InputPaths.size() > 1 && error.find(path) == std::string::npos) error = path + ": " + error; return false; }
+    }
+    if (sources.empty()) { error = "No inventory given"; return false; }
+    std::ofstream outputFile; std::ostream* output = &std::cout;
+    if (!options.OutputPath.empty() && options.OutputPath != "-") {
+        outputFile.open(options.OutputPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!outputFile) { error = "Could not create output file '" + options.OutputPath + "'"; return false; }
+        output = &outputFile;
+    }
+
+    if (options.Profiles && options.Reports) { error = "Full reports are not available when matching custom profiles"; return false; }
+    if (options.Plan && options.Reports) { error = "Upgrade plans are written with CSV verdicts, not with full reports"; return false; }
+
+    unsigned threads = options.Threads ? options.Threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    size_t chunkSize = options.ChunkSize ? options.ChunkSize : 1;
+    size_t depth = options.QueueDepth ? options.QueueDepth : (size_t)threads * 4;
+    if (options.Profiles) target = NULL;
+    if (options.Aggregate && !target) { error = "Aggregation needs a single target"; return false; }
+    if (options.Sketch && !target) { error = "The fleet sketch needs a single target"; return false; }
+    if (options.Cache && !target) { error = "The result cache needs a single target"; return false; }
+    if (options.Plan && !target) { error = "Upgrade planning needs a single target"; return false; }
+    if (options.Store && !target) { error = "The result store needs a single target"; return false; }
+    if (!options.DeltaPath.empty() && !options.Cache) { error = "A delta report needs a result cache"; return false; }
+    if (options.ShardCount && (options.ShardIndex >= options.ShardCount || options.Cache || options.Store)) { error = "A shard cannot use a result cache or store"; return false; }
+    const std::string targetName = target ? WideToUtf8(target->Name) : std::string();
+    const ULONGLONG fingerprint = options.Cache ? RequirementsFingerprint(*target) : 0;
+    std::ofstream deltaFile;
+    if (!options.DeltaPath.empty()) {
+        deltaFile.open(options.DeltaPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!deltaFile) { error = "Could not create delta file '" + options.DeltaPath + "'"; return false; }
+        deltaFile << "MachineId,Change,Result,PreviousResult,FailedChecks,PreviousFailedChecks,WarnedChecks,PreviousWarnedChecks\n";
+    }
+    if (options.Cache) options.Cache->ClearSeen();
+    // Unchanged lines of a mapped inventory are not parsed when only the verdict is needed; anything that reads the
+    // machine's values (aggregate, sketch, store, full reports, upgrade plans) parses every line
+    const bool rowCache = options.Cache && !options.Aggregate && !options.Sketch && !options.Store && !options.Reports && !options.Plan;
+
+    // --- Evaluators: work-stealing over chunk tasks (each worker with its own partial aggregate, merged at the end; sketches
+    // are per chunk and merged by the writer, so they come out the same for any thread count) ---
+    // A worker cuts a chunk off a source, pushes the rest back onto its own deque and evaluates the chunk; idle workers
+    // steal the rest. When depth finished chunks wait for the writer (it waits for an earlier, slower source), a worker
+    // takes the earliest remaining task instead and holds it until the writer has room again, unless that task starts
+    // with the very chunk the writer needs next. So at most depth + threads evaluated chunks are ever held.
+    WorkStealingPool<BatchTask> pool(threads);
+    for (size_t i = sources.size(); i-- > 0;) { // Lowest source last, so it is the first task its worker pops
+        BatchTask task; task.Source = i;
+        if (sources[i]->SourceKind == BatchSource::KindMapped) { task.Begin = sources[i]->Mapped.DataBegin(); task.Line = sources[i]->Mapped.DataLine(); }
+        if (sources[i]->SourceKind == BatchSource::KindMapped && rowCache) { const std::string_view header = sources[i]->Mapped.Header(); sources[i]->RowSeed = RowSeed(fingerprint, header.data(), header.size()); }
+        pool.Push(i % threads, task);
+    }
+    BoundedQueue<BatchChunk> doneQueue(depth);
+    std::atomic<size_t> buffered(0);        // Chunks evaluated but not written yet
+    std::mutex roomMutex; std::condition_variable room; std::pair<size_t, size_t> writerNext(0, 0); // (source, chunk) the writer waits for
+    MappedInventory::RowShard rowShard; rowShard.Index = options.ShardIndex; rowShard.Count = options.ShardCount;
+    std::vector<FleetAggregate> partials(options.Aggregate ? threads : 0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            FleetAggregate* aggregate = options.Aggregate ? &partials[i] : NULL;
+            TRACE_THREAD_NAME("batch evaluator");
+            BatchTask task; bool behind;
+            while (pool.Next(i, task, behind = buffered.load() >= depth)) {
+                if (behind) {
+                    TRACE_SPAN("Wait for writer", "batch");
+                    std::unique_lock<std::mutex> lock(roomMutex);
+                    room.wait(lock, [&] { return buffered.load() < depth || (task.Source == writerNext.first && task.Chunk == writerNext.second); });
+                }
+                BatchSource& source = *sources[task.Source]; BatchChunk chunk; BatchTask rest;
+                { TRACE_SPAN("Cut chunk", "batch"); if (CutChunk(source, task, chunkSize, chunk, rest)) pool.Push(i, rest); }
+                pool.Finished();
+                const FleetFile* fleet = (source.SourceKind == BatchSource::KindFleet) ? &source.Fleet : NULL;
+                chunk.Sharded = options.ShardCount > 0;
+                if (source.SourceKind == BatchSource::KindMapped) {
+                    TRACE_SPAN("Parse chunk", "batch");
+                    thread_local std::vector<size_t> lines; lines.clear();
+                    const MappedInventory::RowShard* shard = chunk.Sharded ? &rowShard : NULL; std::vector<size_t>* shardLines = chunk.Sharded ? &lines : NULL;
+                    if (options.Reports) { // A full report shows every detected value, so only then is the whole record kept
+                        chunk.Records.reserve(std::min(chunkSize, (size_t)4096));
+                        source.Mapped.ParseRange(chunk.TextBegin, chunk.TextEnd, chunk.FirstLine, chunk.Records, chunk.Warnings, shard, shardLines);
+                    } else {
+                        chunk.Parsed.Features.reserve(std::min(chunkSize, (size_t)4096));
+                        if (rowCache) ParseCachedRows(chunk, source, *options.Cache);
+                        else source.Mapped.ParseRange(chunk.TextBegin, chunk.TextEnd, chunk.FirstLine, chunk.Parsed, chunk.Warnings, shard, shardLines);
+                    }
+                    for (size_t line : lines) chunk.Ordinals.push_back(((ULONGLONG)chunk.Source << 40) | line);
+                }
+                if (chunk.Sharded && fleet) { SelectFleetShard(chunk, *fleet, options.ShardIndex, options.ShardCount); fleet = NULL; }
+                TRACE_SPAN("Evaluate chunk", "batch");
+                if (options.Profiles) EvaluateChunkProfiles(chunk, fleet, *options.Profiles);
+                else if (target) {
+                    if (options.Sketch) chunk.Sketch.reset(new FleetSketch());
+                    EvaluateChunk(chunk, fleet, *target, targetName, options.Reports, aggregate, chunk.Sketch.get(), options.Cache, fingerprint, options.Plan, options.Store != NULL);
+                } else EvaluateChunkAllTargets(chunk, fleet, options.Reports);
+                buffered.fetch_add(1);
+                doneQueue.Push(std::move(chunk));
+            }
+        });
+    }
+    std::thread closer([&] { for (std::thread& worker : workers) worker.join(); doneQueue.Close(); });
+
+    // --- Writer (this thread): emit chunks in input order ---
+    // A shard writes framed per-machine output instead (shard.h); the coordinator adds the document edges
+    std::string documentBegin, documentEnd;
+    if (!options.ShardCount) BatchDocumentEdges(options, target, documentBegin, documentEnd);
+    *output << documentBegin;
+    std::map<std::pair<size_t, size_t>, BatchChunk> pending; std::pair<size_t, size_t> next(0, 0); // (source, chunk) to write next
+    std::string framed;
+    std::vector<CacheUpdate> cacheUpdates; // Applied once the evaluators are done: inserting would invalidate their lookups
+    bool storeOk = true;
+    BatchChunk chunk;
+    while (doneQueue.Pop(chunk)) {
+        pending.emplace(std::make_pair(chunk.Source, chunk.Index), std::move(chunk));
+        for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+            BatchChunk& ready = it->second;
+            TRACE_SPAN("Write chunk", "batch");
+            for (const std::string& warning : ready.Warnings) std::cerr << "  Warning: Skipping inventory row. " << (sources.size() > 1 ? sources[ready.Source]->Path + ": " : std::string()) << warning << std::endl;
+            stats.MalformedRows += ready.Warnings.size();
+            if (ready.Sharded) {
+                framed.clear();
+                for (size_t k = 0; k < ready.Ordinals.size(); ++k) {
+                    const size_t begin = ready.Starts[k], end = k + 1 < ready.Starts.size() ? ready.Starts[k + 1] : ready.Output.size();
+                    const UINT32 length = (UINT32)(end - begin);
+                    framed.append((const char*)&ready.Ordinals[k], sizeof(ULONGLONG)); framed.append((const char*)&length, sizeof(length)); framed.append(ready.Output, begin, end - begin);
+                }
+                output->write(framed.data(), (std::streamsize)framed.size());
+            } else output->write(ready.Output.data(), (std::streamsize)ready.Output.size());
+            stats.Machines += ready.Passed + ready.Failed; stats.Passed += ready.Passed; stats.Failed += ready.Failed; stats.WithWarnings += ready.WithWarnings;
+            stats.PlanCost += ready.PlanCost; stats.Unfixable += ready.Unfixable;
+            for (const StoredRow& row : ready.Stored) storeOk = options.Store->Add(row.MachineId, row.Features, row.Fail, row.Warn, row.CpuName, row.GpuName) && storeOk;
+            if (ready.Sketch) { TRACE_SPAN("Merge sketch", "batch"); options.Sketch->Merge(*ready.Sketch); }
+            if (options.Cache) {
+                for (const CachedResult* hit : ready.CacheHits) options.Cache->MarkSeen(hit);
+                for (CacheUpdate& update : ready.CacheUpdates) { if (update.Previous) options.Cache->MarkSeen(update.Previous); cacheUpdates.push_back(std::move(update)); }
+                if (deltaFile.is_open()) deltaFile.write(ready.Delta.data(), (std::streamsize)ready.Delta.size());
+                stats.Reused += ready.Reused; stats.Unparsed += ready.Unparsed; stats.Changes += ready.Changes;
+            }
+            next = ready.Last ? std::make_pair(next.first + 1, (size_t)0) : std::make_pair(next.first, next.second + 1);
+            pending.erase(it); buffered.fetch_sub(1);
+            TRACE_COUNTER("Machines written", stats.Machines);
+            { std::lock_guard<std::mutex> lock(roomMutex); writerNext = next; }
+            room.notify_all();
+        }
+    }
+    closer.join();
+    stats.Steals = pool.Steals();
+    if (options.Aggregate) { TRACE_SPAN("Merge aggregates", "batch"); for (const FleetAggregate& partial : partials) options.Aggregate->Merge(partial); }
+    if (options.Cache) { // Machines missing from this inventory leave the cache (sorted, so the delta is reproducible)
+        TRACE_SPAN("Update result cache", "batch");
+        std::vector<std::pair<std::string, CachedResult>> removed;
+        for (const ResultCache::Table::value_type& entry : options.Cache->Entries()) { if (!entry.second.Seen) removed.push_back(entry); }
+        std::sort(removed.begin(), removed.end(), [](const std::pair<std::string, CachedResult>& a, const std::pair<std::string, CachedResult>& b) { return a.first < b.first; });
+        std::string lines;
+        for (const std::pair<std::string, CachedResult>& entry : removed) {
+            options.Cache->Erase(entry.first);
+            if (deltaFile.is_open()) AppendDeltaLine(lines, entry.first, "Removed", NULL, &entry.second);
+        }
+        for (const CacheUpdate& update : cacheUpdates) options.Cache->Store(update.MachineId, update.Result);
+        stats.Changes += removed.size();
+        if (deltaFile.is_open()) { deltaFile << lines; deltaFile.flush(); if (!deltaFile) { error = "Failed writing the delta report"; return false; } }
+    }
+    *output << documentEnd;
+    output->flush();
+
+    stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (!*output) { error = "Failed writing verdicts"; return false; }
+    if (!storeOk) { error = "Failed writing the result store"; return false; }
+    return true;
+}
+
+// --- Whole-fleet Loading (sweeps) ---
+bool LoadFleetFeatures(const std::string& path, FeatureColumns& columns, std::vector<ULONGLONG>& diskTotals, size_t& malformedRows, std::string& error) {
+    columns.Clear(); diskTotals.clear(); malformedRows = 0;
+    if (!path.empty() && path != "-" && IsFleetFile(path)) {
+        FleetFile fleet;
+        if (!fleet.Open(path, error)) return false;
+        columns.Reserve(fleet.Size()); diskTotals.reserve(fleet.Size());
+        for (size_t i = 0; i < fleet.Size(); ++i) { columns.Append(fleet.Features(i)); diskTotals.push_back(fleet.Record(i).DiskTotalBytes); }
+        return true;
+    }
+    if (!path.empty() && path != "-") {
+        MappedInventory inventory;
+        if (!inventory.Open(path, error)) return false;
+        std::vector<MachineRecord> records; std::vector<std::string> warnings;
+        for (size_t begin = inventory.DataBegin(), line = inventory.DataLine(), lines = 0; begin < inventory.Size(); line += lines) {
+            const size_t end = inventory.NextRange(begin, 4096, lines);
+            records.clear(); warnings.clear();
+            inventory.ParseRange(begin, end, line, records, warnings);
+            for (const std::string& warning : warnings) std::cerr << "  Warning: Skipping inventory row. " << warning << std::endl;
+            for (const MachineRecord& record : records) { columns.Append(ExtractFeatures(record)); diskTotals.push_back(record.Disk.TotalBytes); }
+            malformedRows += warnings.size(); begin = end;
+        }
+        return true;
+    }
+    InventoryReader reader(std::cin);
+    if (!reader.ReadHeader()) { error = reader.LastError(); return false; }
+    MachineRecord record;
+    for (InventoryReader::Status status; (status = reader.ReadRecord(record)) != InventoryReader::EndOfInput;) {
+        if (status == InventoryReader::RecordMalformed) { std::cerr << "  Warning: Skipping inventory row. " << reader.LastError() << std::endl; continue; }
+        columns.Append(ExtractFeatures(record)); diskTotals.push_back(record.Disk.TotalBytes);
+    }
+    malformedRows = reader.MalformedRows();
+    return true;
+}
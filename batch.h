@@ -0,0 +1,67 @@
+#ifndef BATCH_H_INCLUDED
+#define BATCH_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include "sysinfo.h"
+
+class ReportRenderer;
+class ProfileSet;
+class FleetAggregate;
+class FleetSketch;
+class ResultCache;
+class ResultStoreWriter;
+struct UpgradeCosts;
+struct FeatureColumns;
+
+// --- Headless Fleet Batch Mode ---
+// Reads machine records from one or more inventory exports (CSV or JSON Lines, mapped_inventory.h; or fleet files), evaluates each one
+// against the target profile on a pool of worker threads and writes one verdict line (or one rendered report) per machine, in input order.
+// Every input is cut into chunks of ChunkSize records on demand; the workers share the chunks through work stealing (work_stealing.h),
+// so one huge site among thousands of small ones keeps every core busy. Chunks are written in order, so a chunk that finishes early waits for
+// the ones before it; once QueueDepth chunks wait, evaluators only start the chunk the writer needs next. At most QueueDepth + Threads
+// evaluated chunks are held at any time: memory use depends on ChunkSize * (QueueDepth + Threads), not on the input size.
+struct BatchOptions {
+    std::vector<std::string> InputPaths; // Evaluated as if concatenated, in this order; "-" reads stdin
+    std::string OutputPath;     // Empty or "-" writes stdout
+    unsigned Threads = 0;       // 0 = one evaluator per hardware thread
+    size_t ChunkSize = 512;     // Records per unit of work
+    size_t QueueDepth = 0;      // Finished chunks the writer may hold for reordering; 0 = 4 per evaluator
+    const ReportRenderer* Reports = nullptr; // Set: one full rendered report per machine (report.h) instead of CSV verdicts
+    const ProfileSet* Profiles = nullptr;    // Set: match against these custom profiles (profile_index.h) instead of target
+    FleetAggregate* Aggregate = nullptr;     // Set (single target only): every worker's partial summary is merged into it (aggregate.h)
+    FleetSketch* Sketch = nullptr;           // Set (single target only): every machine is added to this fixed-size sketch (sketch.h)
+    ResultCache* Cache = nullptr;            // Set (single target only): unchanged machines reuse their cached verdict; updated in place (result_cache.h)
+    std::string DeltaPath;                   // With Cache: one line per machine that is new, removed or has a different verdict
+    const UpgradeCosts* Plan = nullptr;      // Set (single target only): each verdict line also carries the cheapest upgrade plan (upgrade_plan.h)
+    ResultStoreWriter* Store = nullptr;      // Set (single target only): every verdict is also appended to a columnar result store, in input order (result_store.h)
+    unsigned ShardIndex = 0, ShardCount = 0; // ShardCount > 0: only the machines of shard ShardIndex, written to OutputPath as a partial result (shard.h)
+};
+
+struct BatchStats {
+    size_t Machines = 0; size_t Passed = 0; size_t Failed = 0; size_t WithWarnings = 0; size_t MalformedRows = 0;
+    size_t Reused = 0; size_t Changes = 0;   // With a result cache: verdicts taken from it, and lines written to the delta
+    size_t Unparsed = 0;                     // Reused verdicts whose inventory line was identical, so it was not even parsed
+    double PlanCost = 0; size_t Unfixable = 0; // With Plan: summed over the failing machines that have a plan / machines without one
+    size_t Steals = 0;                       // Chunk tasks a worker took from another worker's deque
+    double Seconds = 0.0;
+};
+
+// target == nullptr evaluates every built-in profile in one pass and reports the highest one satisfied (Passed then
+// counts machines that satisfy at least one profile). With options.Profiles, target is ignored and each line lists the
+// custom profiles the machine satisfies (Passed/WithWarnings as for "all"). Returns false if the input/output could not be opened or the
+// inventory header is unusable (reason in error).
+bool RunBatch(const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error);
+
+// The header (CSV) or document opening and closing (reports) that RunBatch writes around the per-machine output
+void BatchDocumentEdges(const BatchOptions& options, const WindowsRequirements* target, std::string& begin, std::string& end);
+
+// Reads a whole inventory (CSV, JSON Lines, fleet file or "-") into feature columns plus each machine's drive size, for passes that
+// need the fleet more than once (upgrade sweeps). Malformed rows are skipped with a warning, as in RunBatch.
+bool LoadFleetFeatures(const std::string& path, FeatureColumns& columns, std::vector<ULONGLONG>& diskTotals, size_t& malformedRows, std::string& error);
+
+// Appends the inventory paths listed in a file, one per line ("#" starts a comment line): "--batch @sites.txt" for fleets
+// exported as thousands of per-site files, more than a command line holds
+bool ReadInputList(const std::string& path, std::vector<std::string>& inputs, std::string& error);
+
+#endif // BATCH_H_INCLUDED
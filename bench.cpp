@@ -0,0 +1,430 @@
+// --- WinReadyCheck Benchmark (separate "Bench" build target; portable, no windows.h, builds on Linux) ---
+// Usage: WinReadyCheckBench [--sizes 1,1000,1000000,10000000] [--seed N] [--only workload,...] [--output results.jsonl] [--trace bench.json]
+//        WinReadyCheckBench --generate <count> <inventory.csv> [--seed N]   (synthetic fleet for --batch testing)
+//        WinReadyCheckBench --scaling <dir> [--machines N] [--sites N] [--threads 1,2,4,8]   (batch scaling on skewed sites)
+//        WinReadyCheckBench --sharding <dir> [--machines N] [--processes 1,2,4]   (multi-process batch vs one process)
+// Every result is one JSON object per line (workload, machines, seconds, machines_per_sec, ns_per_machine, ns_per_check,
+// allocs_per_machine, peak_rss_kb) so runs can be diffed or fed to a regression dashboard; a table goes to stderr.
+// allocs_per_machine is informational here; that the evaluation and report workloads make no heap allocation once their
+// reused buffers are warm is checked by the self-test's "allocations" suite (selftest.cpp).
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>        // For strtoull / malloc
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "aggregate.h"
+#include "batch.h"
+#include "columnar.h"
+#include "evaluate.h"
+#include "inventory.h"
+#include "mapped_inventory.h"
+#include "profile_index.h"
+#include "report.h"
+#include "requirements.h"
+#include "shard.h"
+#include "synthetic_fleet.h"
+#include "trace.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h> // For getrusage (peak RSS)
+#endif
+
+// --- Allocation Counter (every operator new in the process; workloads read the delta) ---
+static std::atomic<unsigned long long> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static long PeakRssKb() { // 0 where the platform gives no cheap answer
+#if defined(__APPLE__)
+    struct rusage usage; return getrusage(RUSAGE_SELF, &usage) == 0 ? (long)(usage.ru_maxrss / 1024) : 0; // Bytes on macOS
+#elif defined(__unix__)
+    struct rusage usage; return getrusage(RUSAGE_SELF, &usage) == 0 ? (long)usage.ru_maxrss : 0;
+#else
+    return 0;
+#endif
+}
+
+// --- Working Set ---
+// Inputs are generated once (outside the timed region) and cycled, so 10M-machine runs measure the code under test
+// rather than the generator or memory for ten million records.
+static const size_t WORKING_SET_MAX = 65536;
+
+struct BenchInputs {
+    std::vector<MachineRecord> Records;
+    FeatureColumns Columns, TailColumns;    // Full working set / the first (machines % working set) rows
+    std::string Csv; std::vector<size_t> CsvRowEnd; // Header + rows; CsvRowEnd[i] = offset just past row i
+    ProfileSet Profiles;                    // Custom baselines for match_profiles (same for every size)
+};
+static const size_t BENCH_PROFILE_COUNT = 10000;
+
+static void PrepareInputs(size_t machines, unsigned long long seed, BenchInputs& inputs) {
+    const size_t count = machines < WORKING_SET_MAX ? machines : WORKING_SET_MAX;
+    SyntheticFleet fleet(seed); fleet.Generate(count, inputs.Records);
+    inputs.Columns.Clear(); inputs.TailColumns.Clear();
+    for (size_t i = 0; i < count; ++i) {
+        const MachineFeatures features = ExtractFeatures(inputs.Records[i]);
+        inputs.Columns.Append(features);
+        if (i < machines % count) inputs.TailColumns.Append(features);
+    }
+    std::ostringstream csv; WriteInventoryHeader(csv);
+    inputs.CsvRowEnd.clear(); inputs.CsvRowEnd.push_back((size_t)csv.tellp());
+    for (const MachineRecord& record : inputs.Records) { WriteInventoryRecord(csv, record); inputs.CsvRowEnd.push_back((size_t)csv.tellp()); }
+    inputs.Csv = csv.str();
+    if (inputs.Profiles.Size() == 0) {
+        SyntheticFleet baselines(seed); WindowsRequirements profile;
+        for (size_t i = 0; i < BENCH_PROFILE_COUNT; ++i) { baselines.NextProfile(profile); inputs.Profiles.Add(profile, L"Baseline " + std::to_wstring(i + 1)); }
+        inputs.Profiles.BuildIndex();
+    }
+}
+
+// --- Results ---
+struct BenchResult {
+    const char* Workload; size_t Machines; double Seconds;
+    double ChecksPerMachine;                 // 0 when the workload is not a requirement evaluation
+    unsigned long long Allocations; long PeakRssKb;
+};
+
+static void WriteJson(std::ostream& out, const BenchResult& r) {
+    const double nsPerMachine = r.Machines ? r.Seconds * 1e9 / (double)r.Machines : 0.0;
+    char line[512];
+    int length = snprintf(line, sizeof(line), "{\"workload\":\"%s\",\"machines\":%zu,\"seconds\":%.6f,\"machines_per_sec\":%.1f,\"ns_per_machine\":%.2f,",
+                          r.Workload, r.Machines, r.Seconds, r.Seconds > 0 ? (double)r.Machines / r.Seconds : 0.0, nsPerMachine);
+    if (r.ChecksPerMachine > 0) length += snprintf(line + length, sizeof(line) - length, "\"ns_per_check\":%.3f,", nsPerMachine / r.ChecksPerMachine);
+    else length += snprintf(line + length, sizeof(line) - length, "\"ns_per_check\":null,");
+    snprintf(line + length, sizeof(line) - length, "\"allocs_per_machine\":%.3f,\"peak_rss_kb\":%ld}", r.Machines ? (double)r.Allocations / (double)r.Machines : 0.0, r.PeakRssKb);
+    out << line << '\n';
+}
+
+static void WriteTableRow(const BenchResult& r) {
+    fprintf(stderr, "%-18s %10zu %10.3f s %14.0f /s %10.1f ns %8.3f allocs %9ld KB\n", r.Workload, r.Machines, r.Seconds,
+            r.Seconds > 0 ? (double)r.Machines / r.Seconds : 0.0, r.Machines ? r.Seconds * 1e9 / (double)r.Machines : 0.0,
+            r.Machines ? (double)r.Allocations / (double)r.Machines : 0.0, r.PeakRssKb);
+}
+
+// --- Workloads ---
+typedef std::chrono::steady_clock Clock;
+static volatile unsigned long long benchSink; // Keeps results alive so the timed loops are not optimized away
+
+template <typename Body>
+static BenchResult Measure(const char* workload, size_t machines, double checksPerMachine, Body body) {
+    const unsigned long long allocationsBefore = allocationCount.load();
+    const Clock::time_point start = Clock::now();
+    benchSink = benchSink + body();
+    BenchResult result;
+    result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.Allocations = allocationCount.load() - allocationsBefore;
+    result.Workload = workload; result.Machines = machines; result.ChecksPerMachine = checksPerMachine; result.PeakRssKb = PeakRssKb();
+    return result;
+}
+
+static const char* const WORKLOADS[] = { "evaluate", "evaluate_all", "evaluate_columnar", "match_profiles", "report_plain", "report_json", "parse_csv", "parse_mapped" };
+
+static BenchResult RunWorkload(const char* workload, size_t machines, const BenchInputs& in) { // workload is one of WORKLOADS
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    const size_t count = in.Records.size();
+    if (strcmp(workload, "evaluate") == 0) {
+        return Measure(workload, machines, CheckCount, [&]() {
+            unsigned long long passed = 0;
+            for (size_t i = 0, r = 0; i < machines; ++i, r = (r + 1 == count) ? 0 : r + 1) passed += EvaluateRequirements(win11, in.Records[r]).OverallPass;
+            return passed;
+        });
+    } else if (strcmp(workload, "evaluate_all") == 0) {
+        unsigned long long evaluations = 0;
+        BenchResult result = Measure(workload, machines, 0, [&]() {
+            unsigned long long highest = 0;
+            for (size_t i = 0, r = 0; i < machines; ++i, r = (r + 1 == count) ? 0 : r + 1) {
+                const TargetSetResult targets = EvaluateAllBuiltinTargets(ExtractFeatures(in.Records[r]));
+                highest += (unsigned long long)(targets.Highest + 1); evaluations += (unsigned long long)targets.Evaluations;
+            }
+            return highest;
+        });
+        result.ChecksPerMachine = (double)evaluations * CheckCount / (double)machines; // Profiles actually evaluated, not all five
+        return result;
+    } else if (strcmp(workload, "evaluate_columnar") == 0) {
+        CheckMaskColumns masks; EvaluateColumns(win11, in.Columns, masks); // Size the output once, like batch mode's reused buffers
+        return Measure(workload, machines, CheckCount, [&]() {
+            unsigned long long failed = 0;
+            for (size_t done = 0; done + count <= machines; done += count) { EvaluateColumns(win11, in.Columns, masks); failed += masks.Fail[0]; }
+            if (in.TailColumns.Size()) { EvaluateColumns(win11, in.TailColumns, masks); failed += masks.Fail[0]; }
+            return failed;
+        });
+    } else if (strcmp(workload, "match_profiles") == 0) { // ns_per_check: per (profile x check) the index stands in for
+        const ProfileIndex& index = in.Profiles.Index(); ProfileMatch match; index.Match(in.Columns.Row(0), match); // Sizes match once
+        return Measure(workload, machines, (double)index.Size() * CheckCount, [&]() {
+            unsigned long long satisfied = 0;
+            for (size_t i = 0, r = 0; i < machines; ++i, r = (r + 1 == count) ? 0 : r + 1) { index.Match(in.Columns.Row(r), match); satisfied += index.SatisfiedCount(match); }
+            return satisfied;
+        });
+    } else if (strcmp(workload, "report_plain") == 0 || strcmp(workload, "report_json") == 0) {
+        std::unique_ptr<ReportRenderer> renderer = CreateReportRenderer(strcmp(workload, "report_json") == 0 ? ReportJson : ReportPlain);
+        RequirementsReport report; std::string text;
+        for (size_t r = 0; r < count; ++r) { // Warm-up: grow the report's arena and buffers to the largest machine in the working set
+            BuildRequirementsReport(win11, in.Records[r], EvaluateRequirements(win11, in.Records[r]), report);
+            text.clear(); renderer->Render(report, text);
+        }
+        return Measure(workload, machines, 0, [&]() {
+            unsigned long long bytes = 0;
+            for (size_t i = 0, r = 0; i < machines; ++i, r = (r + 1 == count) ? 0 : r + 1) {
+                BuildRequirementsReport(win11, in.Records[r], EvaluateRequirements(win11, in.Records[r]), report);
+                text.clear(); renderer->Render(report, text); bytes += text.size();
+            }
+            return bytes;
+        });
+    } else if (strcmp(workload, "parse_mapped") == 0) { // The in-memory text stands in for the mapped file; parsed the way batch mode does
+        MappedInventory::ParsedRows parsedRows; std::vector<std::string> errors;
+        return Measure(workload, machines, 0, [&]() {
+            unsigned long long parsed = 0;
+            for (size_t done = 0; done < machines; done += count) {
+                const size_t rows = (machines - done < count) ? machines - done : count;
+                MappedInventory inventory; std::string error;
+                inventory.OpenMemory(in.Csv.data(), in.CsvRowEnd[rows], error);
+                parsedRows.Clear(); errors.clear();
+                inventory.ParseRange(inventory.DataBegin(), inventory.Size(), inventory.DataLine(), parsedRows, errors);
+                parsed += parsedRows.Size();
+            }
+            return parsed;
+        });
+    } else {
+        return Measure(workload, machines, 0, [&]() {
+            unsigned long long parsed = 0; MachineRecord record;
+            for (size_t done = 0; done < machines; done += count) {
+                const size_t rows = (machines - done < count) ? machines - done : count;
+                std::istringstream text(in.Csv.substr(0, in.CsvRowEnd[rows]));
+                InventoryReader reader(text); reader.ReadHeader();
+                while (reader.ReadRecord(record) != InventoryReader::EndOfInput) ++parsed;
+            }
+            return parsed;
+        });
+    }
+}
+
+// --- Entry Points ---
+static int GenerateInventory(int argc, char* argv[]) {
+    if (argc < 4) { std::cerr << "Usage: WinReadyCheckBench --generate <count> <inventory.csv> [--seed N]" << std::endl; return 1; }
+    const size_t count = (size_t)strtoull(argv[2], NULL, 10); unsigned long long seed = 1;
+    for (int i = 4; i + 1 < argc; ++i) { if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[++i], NULL, 10); }
+    std::ofstream out(argv[3], std::ios::binary);
+    if (!out) { std::cerr << "Error: Cannot create " << argv[3] << std::endl; return 1; }
+    SyntheticFleet fleet(seed); MachineRecord record;
+    WriteInventoryHeader(out);
+    for (size_t i = 0; i < count; ++i) { fleet.Next(record); WriteInventoryRecord(out, record); }
+    std::cerr << "Wrote " << count << " synthetic machines (seed " << seed << ") to " << argv[3] << std::endl;
+    return out ? 0 : 1;
+}
+
+static bool SplitList(const char* text, std::vector<std::string>& items) {
+    items.clear(); std::string item;
+    for (const char* p = text; ; ++p) {
+        if (*p == ',' || *p == '\0') { if (item.empty()) return false; items.push_back(item); item.clear(); if (!*p) return true; }
+        else item += *p;
+    }
+}
+
+// --- Scaling on a Skewed Fleet (--scaling) ---
+// Writes a fleet split into sites of very different sizes (half of it in one site, the rest in a long tail of small ones),
+// then runs the batch evaluator on all sites at each thread count: once with one task per site (the naive split, where
+// every core but one soon idles behind the largest site) and once with chunk tasks and work stealing. Every run must
+// write the same verdicts as the first one (exit code 2 otherwise).
+static bool ReadWholeFile(const std::string& path, std::string& text) {
+    std::ifstream file(path.c_str(), std::ios::binary); std::ostringstream buffer;
+    buffer << file.rdbuf(); text = buffer.str();
+    return (bool)file;
+}
+
+static int RunScaling(int argc, char* argv[]) {
+    const char* usage = "Usage: WinReadyCheckBench --scaling <existing work directory> [--machines N] [--sites N] [--threads 1,2,4,8] [--seed N] [--output results.jsonl]";
+    if (argc < 3 || argv[2][0] == '-') { std::cerr << usage << std::endl; return 1; }
+    const std::string directory = argv[2]; size_t machines = 1000000, sites = 1000; unsigned long long seed = 1; std::string outputPath;
+    static const unsigned DEFAULT_THREADS[] = { 1, 2, 4, 8 };
+    std::vector<unsigned> threadCounts(DEFAULT_THREADS, DEFAULT_THREADS + 4);
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc); std::vector<std::string> items;
+        if (arg == "--machines" && hasValue) { machines = (size_t)strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--sites" && hasValue) { sites = (size_t)strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--threads" && hasValue && SplitList(argv[++i], items)) { threadCounts.clear(); for (const std::string& item : items) threadCounts.push_back((unsigned)strtoul(item.c_str(), NULL, 10)); }
+        else if (arg == "--seed" && hasValue) { seed = strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--output" && hasValue) { outputPath = argv[++i]; }
+        else { std::cerr << usage << std::endl; return 1; }
+    }
+    if (machines == 0 || sites == 0) { std::cerr << usage << std::endl; return 1; }
+    std::ofstream file; if (!outputPath.empty()) { file.open(outputPath.c_str()); if (!file) { std::cerr << "Error: Cannot create " << outputPath << std::endl; return 1; } }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+
+    // Site sizes: the largest site holds half the fleet, the others follow 1/k (at least 10 machines each)
+    const size_t largest = (sites == 1) ? machines : machines / 2;
+    double harmonic = 0; for (size_t k = 1; k < sites; ++k) harmonic += 1.0 / (double)k;
+    auto siteSize = [&](size_t k) { if (k == 0) return largest; const size_t size = (size_t)((double)(machines - largest) / ((double)k * harmonic)); return size < 10 ? (size_t)10 : size; };
+    BatchOptions options; SyntheticFleet fleet(seed); MachineRecord record; size_t total = 0;
+    for (size_t k = 0; k < sites; ++k) {
+        char name[32]; snprintf(name, sizeof(name), "/site-%05zu.csv", k);
+        options.InputPaths.push_back(directory + name);
+        std::ofstream site(options.InputPaths.back().c_str(), std::ios::binary);
+        if (!site) { std::cerr << "Error: Cannot create " << options.InputPaths.back() << std::endl; return 1; }
+        WriteInventoryHeader(site);
+        for (size_t i = 0, size = siteSize(k); i < size; ++i) { fleet.Next(record); WriteInventoryRecord(site, record); }
+        total += siteSize(k);
+    }
+    fprintf(stderr, "Seed %llu, %zu machines in %zu sites (largest %zu, smallest %zu)\n", seed, total, sites, largest, siteSize(sites - 1));
+
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    options.OutputPath = directory + "/verdicts.csv";
+    std::string reference; int exitCode = 0;
+    for (int mode = 0; mode < 2; ++mode) {
+        const char* workload = mode == 0 ? "batch_per_site" : "batch_work_stealing";
+        options.ChunkSize = mode == 0 ? (size_t)-1 : 512; // One task per site / chunk tasks
+        double baseline = 0;
+        for (unsigned threads : threadCounts) {
+            options.Threads = threads ? threads : 1;
+            BatchStats stats; std::string error, verdicts;
+            { TraceSpan span(workload, "bench"); if (!RunBatch(options, &win11, stats, error)) { std::cerr << "Error: " << error << std::endl; return 1; } }
+            if (!ReadWholeFile(options.OutputPath, verdicts)) { std::cerr << "Error: Cannot read " << options.OutputPath << std::endl; return 1; }
+            if (reference.empty()) reference.swap(verdicts);
+            else if (verdicts != reference) { fprintf(stderr, "Error: %s with %u threads wrote different verdicts than the first run\n", workload, options.Threads); exitCode = 2; }
+            const double rate = stats.Seconds > 0 ? (double)stats.Machines / stats.Seconds : 0.0;
+            if (baseline == 0) baseline = rate / (double)options.Threads; // Per-thread rate of the first (smallest) run
+            const double speedup = baseline > 0 ? rate / baseline : 0.0;
+            char line[512];
+            snprintf(line, sizeof(line), "{\"workload\":\"%s\",\"machines\":%zu,\"sites\":%zu,\"threads\":%u,\"seconds\":%.6f,\"machines_per_sec\":%.1f,\"speedup\":%.2f,\"efficiency\":%.3f,\"steals\":%zu}",
+                     workload, stats.Machines, sites, options.Threads, stats.Seconds, rate, speedup, speedup / (double)options.Threads, stats.Steals);
+            out << line << '\n'; out.flush();
+            fprintf(stderr, "%-20s %3u threads %10.3f s %14.0f /s  speedup %6.2f  efficiency %5.1f%%  %8zu steals\n", workload, options.Threads, stats.Seconds, rate, speedup, 100.0 * speedup / (double)options.Threads, stats.Steals);
+        }
+    }
+    return exitCode;
+}
+
+// --- Sharded Runs (--sharding) ---
+// Writes a fleet as three inventories of unequal size, evaluates it in one process (one evaluator thread) with a fleet
+// aggregate, then again as N worker processes of this executable (one thread each, started with --shard-worker). The
+// merged verdicts and aggregate must be byte-identical to the single-process run (exit code 2 otherwise).
+static int RunShardWorkerMode(int argc, char* argv[]) { // --shard-worker <inventory>... [--aggregate] --shard k/N --partial <prefix>
+    BatchOptions options; FleetAggregate aggregate; std::string shard, prefix, error;
+    options.Threads = 1;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--aggregate") options.Aggregate = &aggregate;
+        else if (arg == "--shard" && hasValue) shard = argv[++i];
+        else if (arg == "--partial" && hasValue) prefix = argv[++i];
+        else options.InputPaths.push_back(arg);
+    }
+    if (!RunShardWorker(options, &BUILTIN_TARGETS[TargetWin11].Requirements, shard, prefix, error)) { std::cerr << "Error: " << error << std::endl; return 1; }
+    return 0;
+}
+
+static int RunSharding(int argc, char* argv[]) {
+    const char* usage = "Usage: WinReadyCheckBench --sharding <existing work directory> [--machines N] [--processes 1,2,4] [--seed N] [--output results.jsonl]";
+    if (argc < 3 || argv[2][0] == '-') { std::cerr << usage << std::endl; return 1; }
+    const std::string directory = argv[2]; size_t machines = 1000000; unsigned long long seed = 1; std::string outputPath;
+    static const unsigned DEFAULT_PROCESSES[] = { 1, 2, 4 };
+    std::vector<unsigned> processCounts(DEFAULT_PROCESSES, DEFAULT_PROCESSES + 3);
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc); std::vector<std::string> items;
+        if (arg == "--machines" && hasValue) { machines = (size_t)strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--processes" && hasValue && SplitList(argv[++i], items)) { processCounts.clear(); for (const std::string& item : items) processCounts.push_back((unsigned)strtoul(item.c_str(), NULL, 10)); }
+        else if (arg == "--seed" && hasValue) { seed = strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--output" && hasValue) { outputPath = argv[++i]; }
+        else { std::cerr << usage << std::endl; return 1; }
+    }
+    if (machines == 0) { std::cerr << usage << std::endl; return 1; }
+    std::ofstream file; if (!outputPath.empty()) { file.open(outputPath.c_str()); if (!file) { std::cerr << "Error: Cannot create " << outputPath << std::endl; return 1; } }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+
+    BatchOptions options; SyntheticFleet fleet(seed); MachineRecord record;
+    const size_t sizes[3] = { machines / 2, machines - machines / 2 - machines / 5, machines / 5 };
+    for (int k = 0; k < 3; ++k) {
+        options.InputPaths.push_back(directory + "/shard-input-" + std::to_string(k) + ".csv");
+        std::ofstream site(options.InputPaths.back().c_str(), std::ios::binary);
+        if (!site) { std::cerr << "Error: Cannot create " << options.InputPaths.back() << std::endl; return 1; }
+        WriteInventoryHeader(site);
+        for (size_t i = 0; i < sizes[k]; ++i) { fleet.Next(record); WriteInventoryRecord(site, record); }
+    }
+    fprintf(stderr, "Seed %llu, %zu machines in 3 inventories\n", seed, machines);
+
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    const std::string targetName = WideToUtf8(win11.Name);
+    options.OutputPath = directory + "/verdicts.csv"; options.Threads = 1;
+    std::string reference, referenceSummary; double baseline = 0; int exitCode = 0;
+    for (unsigned processes : processCounts) {
+        FleetAggregate aggregate; options.Aggregate = &aggregate;
+        BatchStats stats; std::string error, verdicts, summary;
+        ShardRun run; run.Processes = processes ? processes : 1; run.WorkDir = directory;
+        run.WorkerArgs.push_back("--shard-worker"); run.WorkerArgs.insert(run.WorkerArgs.end(), options.InputPaths.begin(), options.InputPaths.end()); run.WorkerArgs.push_back("--aggregate");
+        {
+            TraceSpan span("batch_sharded", "bench");
+            const bool ok = run.Processes > 1 ? RunShardedBatch(run, options, &win11, stats, error) : RunBatch(options, &win11, stats, error);
+            if (!ok) { std::cerr << "Error: " << error << std::endl; return 1; }
+        }
+        if (!ReadWholeFile(options.OutputPath, verdicts)) { std::cerr << "Error: Cannot read " << options.OutputPath << std::endl; return 1; }
+        FormatAggregateText(aggregate, targetName, 10, summary);
+        if (reference.empty()) { reference.swap(verdicts); referenceSummary.swap(summary); }
+        else if (verdicts != reference || summary != referenceSummary) { fprintf(stderr, "Error: %u processes wrote different %s than the first run\n", run.Processes, verdicts != reference ? "verdicts" : "aggregates"); exitCode = 2; }
+        const double rate = stats.Seconds > 0 ? (double)stats.Machines / stats.Seconds : 0.0;
+        if (baseline == 0) baseline = rate;
+        char line[512];
+        snprintf(line, sizeof(line), "{\"workload\":\"batch_sharded\",\"machines\":%zu,\"processes\":%u,\"seconds\":%.6f,\"machines_per_sec\":%.1f,\"speedup\":%.2f}",
+                 stats.Machines, run.Processes, stats.Seconds, rate, baseline > 0 ? rate / baseline : 0.0);
+        out << line << '\n'; out.flush();
+        fprintf(stderr, "batch_sharded        %3u processes %10.3f s %14.0f /s  speedup %6.2f\n", run.Processes, stats.Seconds, rate, baseline > 0 ? rate / baseline : 0.0);
+    }
+    return exitCode;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) return GenerateInventory(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--scaling") == 0) return RunScaling(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--sharding") == 0) return RunSharding(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--shard-worker") == 0) return RunShardWorkerMode(argc, argv);
+
+    std::vector<size_t> sizes = { 1, 1000, 1000000, 10000000 };
+    std::vector<std::string> only; unsigned long long seed = 1; std::string outputPath, tracePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc); std::vector<std::string> items;
+        if (arg == "--sizes" && hasValue && SplitList(argv[++i], items)) { sizes.clear(); for (const std::string& item : items) sizes.push_back((size_t)strtoull(item.c_str(), NULL, 10)); }
+        else if (arg == "--only" && hasValue && SplitList(argv[++i], only)) {}
+        else if (arg == "--seed" && hasValue) { seed = strtoull(argv[++i], NULL, 10); }
+        else if (arg == "--output" && hasValue) { outputPath = argv[++i]; }
+        else if (arg == "--trace" && hasValue) { tracePath = argv[++i]; }
+        else { std::cerr << "Usage: WinReadyCheckBench [--sizes 1,1000,1000000,10000000] [--seed N] [--only workload,...] [--output results.jsonl] [--trace bench.json]" << std::endl; return 1; }
+    }
+    for (const std::string& name : only) {
+        bool known = false; for (const char* workload : WORKLOADS) known = known || name == workload;
+        if (!known) { std::cerr << "Error: Unknown workload '" << name << "'. Available:"; for (const char* workload : WORKLOADS) std::cerr << ' ' << workload; std::cerr << std::endl; return 1; }
+    }
+    std::ofstream file; if (!outputPath.empty()) { file.open(outputPath.c_str()); if (!file) { std::cerr << "Error: Cannot create " << outputPath << std::endl; return 1; } }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+
+    fprintf(stderr, "Seed %llu, working set up to %zu machines, columnar kernel %s\n", seed, WORKING_SET_MAX, ColumnKernelName(BestColumnKernel()));
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("bench"); }
+    BenchInputs inputs;
+    for (size_t machines : sizes) {
+        if (machines == 0) continue;
+        { TRACE_SPAN("Prepare inputs", "bench"); PrepareInputs(machines, seed, inputs); }
+        for (const char* workload : WORKLOADS) {
+            bool selected = only.empty(); for (const std::string& name : only) selected = selected || name == workload;
+            if (!selected) continue;
+            BenchResult result;
+            { TraceSpan span(workload, "bench"); result = RunWorkload(workload, machines, inputs); }
+            WriteJson(out, result); out.flush(); WriteTableRow(result);
+        }
+    }
+    if (!tracePath.empty()) {
+        TraceStop(); std::string error, summary; FormatTraceSummary(summary); std::cerr << summary;
+        if (!SaveChromeTrace(tracePath, error)) { std::cerr << "Error: " << error << std::endl; return 1; }
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "columnar.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#define WRC_COLUMN_SIMD 1    // GCC/Clang on x86: SSE2 and AVX2 kernels selected at runtime
+#include <immintrin.h>
+#else
+#define WRC_COLUMN_SIMD 0    // Other compilers/architectures use the scalar kernel only
+#endif
+
+// --- Column Storage ---
+void FeatureColumns::Reserve(size_t count) {
+    CpuSpeedMHz.reserve(count); CpuCores.reserve(count); CpuGenerationLevel.reserve(count); RamBytes.reserve(count); DiskFreeBytes.reserve(count);
+    ScreenWidth.reserve(count); ScreenHeight.reserve(count); DXLevel.reserve(count); WDDMLevel.reserve(count); TpmVersionMajor.reserve(count); Flags.reserve(count);
+}
+
+void FeatureColumns::Clear() {
+    CpuSpeedMHz.clear(); CpuCores.clear(); CpuGenerationLevel.clear(); RamBytes.clear(); DiskFreeBytes.clear();
+    ScreenWidth.clear(); ScreenHeight.clear(); DXLevel.clear(); WDDMLevel.clear(); TpmVersionMajor.clear(); Flags.clear();
+}
+
+void FeatureColumns::Append(const MachineFeatures& f) {
+    CpuSpeedMHz.push_back(f.CpuSpeedMHz); CpuCores.push_back(f.CpuCores); CpuGenerationLevel.push_back(f.CpuGenerationLevel);
+    RamBytes.push_back(f.RamBytes); DiskFreeBytes.push_back(f.DiskFreeBytes);
+    ScreenWidth.push_back(f.ScreenWidth); ScreenHeight.push_back(f.ScreenHeight); DXLevel.push_back(f.DXLevel); WDDMLevel.push_back(f.WDDMLevel);
+    TpmVersionMajor.push_back(f.TpmVersionMajor); Flags.push_back(f.Flags);
+}
+
+MachineFeatures FeatureColumns::Row(size_t i) const {
+    MachineFeatures f;
+    f.CpuSpeedMHz = CpuSpeedMHz[i]; f.CpuCores = CpuCores[i]; f.CpuGenerationLevel = CpuGenerationLevel[i];
+    f.RamBytes = RamBytes[i]; f.DiskFreeBytes = DiskFreeBytes[i];
+    f.ScreenWidth = ScreenWidth[i]; f.ScreenHeight = ScreenHeight[i]; f.DXLevel = DXLevel[i]; f.WDDMLevel = WDDMLevel[i];
+    f.TpmVersionMajor = TpmVersionMajor[i]; f.Flags = Flags[i];
+    return f;
+}
+
+// --- Scalar Kernel (one machine per "register"; also handles the tail after the SIMD blocks) ---
+namespace scalar {
+struct Ops {
+    typedef UINT32 Reg; enum { Width = 1 };
+    static inline Reg Load(const UINT* p) { return *p; }
+    static inline Reg Splat(UINT v) { return v; }
+    static inline Reg Zero() { return 0; }
+    static inline Reg Ones() { return 0xFFFFFFFFu; }
+    static inline Reg And(Reg a, Reg b) { return a & b; }
+    static inline Reg Or(Reg a, Reg b) { return a | b; }
+    static inline Reg AndNot(Reg a, Reg b) { return ~a & b; }
+    static inline Reg GeU32(Reg a, Reg b) { return a >= b ? 0xFFFFFFFFu : 0; }
+    static inline Reg Eq(Reg a, Reg b) { return a == b ? 0xFFFFFFFFu : 0; }
+    static inline Reg GeU64(const ULONGLONG* p, ULONGLONG threshold) { return *p >= threshold ? 0xFFFFFFFFu : 0; }
+    static inline void Store16(unsigned short* p, Reg r) { *p = (unsigned short)r; }
+};
+#include "columnar_kernel.inl"
+}
+
+#if WRC_COLUMN_SIMD
+// --- SSE2 Kernel (4 machines per register) ---
+#pragma GCC push_options
+#pragma GCC target("sse2")
+namespace sse2 {
+struct Ops {
+    typedef __m128i Reg; enum { Width = 4 };
+    static inline Reg Load(const UINT* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static inline Reg Splat(UINT v) { return _mm_set1_epi32((int)v); }
+    static inline Reg Zero() { return _mm_setzero_si128(); }
+    static inline Reg Ones() { return _mm_set1_epi32(-1); }
+    static inline Reg And(Reg a, Reg b) { return _mm_and_si128(a, b); }
+    static inline Reg Or(Reg a, Reg b) { return _mm_or_si128(a, b); }
+    static inline Reg AndNot(Reg a, Reg b) { return _mm_andnot_si128(a, b); }
+    static inline Reg GeU32(Reg a, Reg b) { // SSE2 only has signed compares: flip the sign bits first
+        const Reg sign = _mm_set1_epi32((int)0x80000000u);
+        return AndNot(_mm_cmpgt_epi32(_mm_xor_si128(b, sign), _mm_xor_si128(a, sign)), Ones());
+    }
+    static inline Reg Eq(Reg a, Reg b) { return _mm_cmpeq_epi32(a, b); }
+    static inline Reg Borrow64(Reg a, Reg b) { // Top bit of each 64-bit lane set when a < b (unsigned)
+        return _mm_or_si128(_mm_andnot_si128(a, b), _mm_andnot_si128(_mm_xor_si128(a, b), _mm_sub_epi64(a, b)));
+    }
+    static inline Reg GeU64(const ULONGLONG* p, ULONGLONG threshold) {
+        const Reg t = _mm_set1_epi64x((long long)threshold);
+        Reg lo = _mm_srai_epi32(Borrow64(_mm_loadu_si128((const __m128i*)p), t), 31);
+        Reg hi = _mm_srai_epi32(Borrow64(_mm_loadu_si128((const __m128i*)(p + 2)), t), 31);
+        Reg lt = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1))); // High dword of each lane
+        return AndNot(lt, Ones());
+    }
+    static inline void Store16(unsigned short* p, Reg r) { _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(r, r)); } // Masks fit in 15 bits
+};
+#include "columnar_kernel.inl"
+}
+#pragma GCC pop_options
+
+// --- AVX2 Kernel (8 machines per register) ---
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+struct Ops {
+    typedef __m256i Reg; enum { Width = 8 };
+    static inline Reg Load(const UINT* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static inline Reg Splat(UINT v) { return _mm256_set1_epi32((int)v); }
+    static inline Reg Zero() { return _mm256_setzero_si256(); }
+    static inline Reg Ones() { return _mm256_set1_epi32(-1); }
+    static inline Reg And(Reg a, Reg b) { return _mm256_and_si256(a, b); }
+    static inline Reg Or(Reg a, Reg b) { return _mm256_or_si256(a, b); }
+    static inline Reg AndNot(Reg a, Reg b) { return _mm256_andnot_si256(a, b); }
+    static inline Reg GeU32(Reg a, Reg b) { return _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a); }
+    static inline Reg Eq(Reg a, Reg b) { return _mm256_cmpeq_epi32(a, b); }
+    static inline Reg GeU64(const ULONGLONG* p, ULONGLONG threshold) {
+        const Reg sign = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+        const Reg t = _mm256_xor_si256(_mm256_set1_epi64x((long long)threshold), sign);
+        Reg lt0 = _mm256_cmpgt_epi64(t, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), sign));
+        Reg lt1 = _mm256_cmpgt_epi64(t, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(p + 4)), sign));
+        const Reg even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6); // One dword per 64-bit lane into the low half
+        Reg lt = _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(lt0, even), _mm256_permutevar8x32_epi32(lt1, even), 0x20);
+        return AndNot(lt, Ones());
+    }
+    static inline void Store16(unsigned short* p, Reg r) { _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1))); }
+};
+#include "columnar_kernel.inl"
+}
+#pragma GCC pop_options
+#endif // WRC_COLUMN_SIMD
+
+// --- Dispatch ---
+ColumnKernel BestColumnKernel() {
+#if WRC_COLUMN_SIMD
+    static const ColumnKernel best = __builtin_cpu_supports("avx2") ? KernelAvx2 : (__builtin_cpu_supports("sse2") ? KernelSse2 : KernelScalar);
+    return best;
+#else
+    return KernelScalar;
+#endif
+}
+
+const char* ColumnKernelName(ColumnKernel kernel) {
+    switch (kernel) { case KernelScalar: return "scalar"; case KernelSse2: return "sse2"; case KernelAvx2: return "avx2"; default: return "auto"; }
+}
+
+void EvaluateColumns(const WindowsRequirements& target, const FeatureColumns& columns, CheckMaskColumns& out, ColumnKernel kernel) {
+    const size_t count = columns.Size();
+    out.Fail.resize(count); out.Warn.resize(count); out.Applicable = ApplicableChecks(target);
+    if (count == 0) return;
+    if (kernel == KernelAuto || kernel > BestColumnKernel()) kernel = BestColumnKernel();
+    unsigned short* fail = &out.Fail[0]; unsigned short* warn = &out.Warn[0];
+    size_t done = 0;
+#if WRC_COLUMN_SIMD
+    if (kernel == KernelAvx2) done = avx2::EvaluateBlocks<avx2::Ops>(target, columns, 0, count, fail, warn);
+    else if (kernel == KernelSse2) done = sse2::EvaluateBlocks<sse2::Ops>(target, columns, 0, count, fail, warn);
+#endif
+    scalar::EvaluateBlocks<scalar::Ops>(target, columns, done, count, fail, warn);
+}
@@ -0,0 +1,38 @@
+#ifndef COLUMNAR_H_INCLUDED
+#define COLUMNAR_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+#include "evaluate.h"
+
+// --- Structure-of-Arrays Storage for Many Machines ---
+// One contiguous column per MachineFeatures member, so a requirement profile can be evaluated over the whole fleet with
+// SIMD compares. Append() takes features produced by ExtractFeatures(), i.e. string interpretation is already done.
+struct FeatureColumns {
+    std::vector<UINT> CpuSpeedMHz, CpuCores, CpuGenerationLevel;
+    std::vector<ULONGLONG> RamBytes, DiskFreeBytes;
+    std::vector<UINT> ScreenWidth, ScreenHeight, DXLevel, WDDMLevel, TpmVersionMajor;
+    std::vector<UINT> Flags;
+
+    size_t Size() const { return Flags.size(); }
+    void Reserve(size_t count);
+    void Clear();
+    void Append(const MachineFeatures& features);
+    MachineFeatures Row(size_t index) const;
+};
+
+// --- Evaluation Output: one Fail and one Warn bitmask per machine (bit n = CheckId n; Pass = neither bit set) ---
+struct CheckMaskColumns {
+    std::vector<unsigned short> Fail, Warn;
+    unsigned short Applicable = 0;
+};
+
+enum ColumnKernel { KernelAuto, KernelScalar, KernelSse2, KernelAvx2 };
+
+// Evaluates target over every row; KernelAuto picks the widest instruction set the CPU supports.
+// Results are identical to calling EvaluateFeatures() on each Row().
+void EvaluateColumns(const WindowsRequirements& target, const FeatureColumns& columns, CheckMaskColumns& out, ColumnKernel kernel = KernelAuto);
+ColumnKernel BestColumnKernel();
+const char* ColumnKernelName(ColumnKernel kernel);
+
+#endif // COLUMNAR_H_INCLUDED
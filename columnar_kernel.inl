@@ -0,0 +1,74 @@
+// --- Column Evaluation Kernel ---
+// Included once per instruction set by columnar.cpp (inside a "#pragma GCC target" region and its own namespace), so the
+// same check logic is compiled for the scalar, SSE2 and AVX2 register types. No include guard on purpose.
+//
+// Ops provides Reg (one 32-bit lane per machine, all-ones = true), Width, Load/Splat/Zero/Ones, And/Or/AndNot (~a & b),
+// GeU32/Eq (unsigned lane compares), GeU64 (Width 64-bit values vs. a threshold) and Store16 (narrow lanes to masks).
+
+template <class Ops>
+static inline void AccumulateCheck(typename Ops::Reg& fail, typename Ops::Reg& warn, typename Ops::Reg met, typename Ops::Reg warnCond, typename Ops::Reg bit) {
+    typename Ops::Reg notMet = Ops::AndNot(met, Ops::Ones());
+    fail = Ops::Or(fail, Ops::And(Ops::AndNot(warnCond, notMet), bit));
+    warn = Ops::Or(warn, Ops::And(Ops::And(warnCond, notMet), bit));
+}
+
+template <class Ops>
+static inline typename Ops::Reg TestFlag(typename Ops::Reg flags, UINT flag) {
+    typename Ops::Reg f = Ops::Splat(flag);
+    return Ops::Eq(Ops::And(flags, f), f);
+}
+
+// Evaluates rows [begin, end) in whole blocks of Ops::Width and returns the first row it did not process
+template <class Ops>
+static size_t EvaluateBlocks(const WindowsRequirements& t, const FeatureColumns& c, size_t begin, size_t end, unsigned short* failOut, unsigned short* warnOut) {
+    typedef typename Ops::Reg Reg;
+    const Reg zero = Ops::Zero(), ones = Ops::Ones();
+    const Reg minSpeed = Ops::Splat(t.MinCpuSpeedMHz), minCores = Ops::Splat(t.MinCpuCores), minGen = Ops::Splat(t.MinCpuGenerationLevel);
+    const Reg minDX = Ops::Splat(t.MinDirectXFeatureLevelMajor), minWDDM = Ops::Splat(t.MinWDDMVersionMajor);
+    const Reg minWidth = Ops::Splat(t.MinScreenWidth), minHeight = Ops::Splat(t.MinScreenHeight), minTpm = Ops::Splat(t.MinTpmVersionMajor);
+    size_t i = begin;
+    for (; i + Ops::Width <= end; i += Ops::Width) {
+        Reg fail = zero, warn = zero;
+        const Reg flags = Ops::Load(&c.Flags[i]);
+
+        // --- CPU Checks ---
+        Reg speed = Ops::Load(&c.CpuSpeedMHz[i]);
+        AccumulateCheck<Ops>(fail, warn, Ops::GeU32(speed, minSpeed), Ops::Eq(speed, zero), Ops::Splat(1u << CheckCpuSpeed));
+        Reg cores = Ops::Load(&c.CpuCores[i]);
+        AccumulateCheck<Ops>(fail, warn, Ops::GeU32(cores, minCores), Ops::Eq(cores, zero), Ops::Splat(1u << CheckCpuCores));
+        if (t.Require64Bit) { AccumulateCheck<Ops>(fail, warn, TestFlag<Ops>(flags, FeatureIs64Bit), TestFlag<Ops>(flags, FeatureCpuTimedOut), Ops::Splat(1u << CheckCpuArchitecture)); }
+        if (t.MinCpuGenerationLevel > 0) {
+            Reg gen = Ops::Load(&c.CpuGenerationLevel[i]);
+            AccumulateCheck<Ops>(fail, warn, Ops::GeU32(gen, minGen), Ops::Eq(gen, zero), Ops::Splat(1u << CheckCpuGeneration));
+        }
+
+        // --- RAM / Disk Checks ---
+        AccumulateCheck<Ops>(fail, warn, Ops::GeU64(&c.RamBytes[i], t.MinRamBytes), TestFlag<Ops>(flags, FeatureRamTimedOut), Ops::Splat(1u << CheckRam));
+        AccumulateCheck<Ops>(fail, warn, Ops::GeU64(&c.DiskFreeBytes[i], t.MinDiskFreeBytes), TestFlag<Ops>(flags, FeatureDiskTimedOut), Ops::Splat(1u << CheckDisk));
+
+        // --- Firmware Check ---
+        const Reg uefi = TestFlag<Ops>(flags, FeatureUefi);
+        if (t.RequireUEFI) { AccumulateCheck<Ops>(fail, warn, uefi, TestFlag<Ops>(flags, FeatureFirmwareUncertain), Ops::Splat(1u << CheckFirmware)); }
+
+        // --- Graphics Checks ---
+        Reg dxKnown = TestFlag<Ops>(flags, FeatureDXKnown), wddmKnown = TestFlag<Ops>(flags, FeatureWDDMKnown);
+        AccumulateCheck<Ops>(fail, warn, Ops::And(dxKnown, Ops::GeU32(Ops::Load(&c.DXLevel[i]), minDX)), Ops::AndNot(dxKnown, ones), Ops::Splat(1u << CheckDirectX));
+        AccumulateCheck<Ops>(fail, warn, Ops::And(wddmKnown, Ops::GeU32(Ops::Load(&c.WDDMLevel[i]), minWDDM)), Ops::AndNot(wddmKnown, ones), Ops::Splat(1u << CheckWddm));
+
+        // --- Display Check ---
+        Reg width = Ops::Load(&c.ScreenWidth[i]), height = Ops::Load(&c.ScreenHeight[i]);
+        AccumulateCheck<Ops>(fail, warn, Ops::And(Ops::GeU32(width, minWidth), Ops::GeU32(height, minHeight)), Ops::Or(Ops::Eq(width, zero), Ops::Eq(height, zero)), Ops::Splat(1u << CheckDisplay));
+
+        // --- Security Checks ---
+        if (t.RequireTpm) {
+            Reg tpmReady = TestFlag<Ops>(flags, FeatureTpmReady);
+            AccumulateCheck<Ops>(fail, warn, Ops::And(tpmReady, Ops::GeU32(Ops::Load(&c.TpmVersionMajor[i]), minTpm)), Ops::AndNot(tpmReady, ones), Ops::Splat(1u << CheckTpm));
+        }
+        if (t.RequireSecureBoot) {
+            AccumulateCheck<Ops>(fail, warn, Ops::And(uefi, TestFlag<Ops>(flags, FeatureSecureBootEnabled)), Ops::Or(Ops::AndNot(uefi, ones), TestFlag<Ops>(flags, FeatureSecureBootUncertain)), Ops::Splat(1u << CheckSecureBoot));
+        }
+
+        Ops::Store16(failOut + i, fail); Ops::Store16(warnOut + i, warn);
+    }
+    return i;
+}
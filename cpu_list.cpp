@@ -0,0 +1,210 @@
+#include "cpu_list.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+// --- Bundled List ---
+// Patterns are normalized names (see NormalizeCpuName) without the padding spaces. A trailing '*' makes a prefix pattern;
+// every other pattern must end at a word boundary, so "i7-920" does not claim an "i7-9200". Exclusions and the
+// family catch-alls sit at CpuListNotListed and only win when no longer supported pattern matches.
+struct CpuListEntry { const char* Pattern; unsigned char Level; };
+static const CpuListEntry CPU_LIST[] = {
+    // --- Intel Core (8th generation and newer; 10th+ model numbers start with 1) ---
+    { "i3-8*", CpuListSupported }, { "i3-9*", CpuListSupported }, { "i3-1*", CpuListSupported }, { "i5-8*", CpuListSupported },
+    { "i5-9*", CpuListSupported }, { "i5-1*", CpuListSupported }, { "i7-8*", CpuListSupported }, { "i7-9*", CpuListSupported },
+    { "i7-1*", CpuListSupported }, { "i9-9*", CpuListSupported }, { "i9-1*", CpuListSupported }, { "i7-7820hq", CpuListSupported },
+    { "i3-n3*", CpuListSupported }, { "i3-l13g4", CpuListSupported }, { "i5-l16g7", CpuListSupported }, { "m3-8*", CpuListSupported },
+    { "core ultra*", CpuListSupported }, { "core 3 *", CpuListSupported }, { "core 5 *", CpuListSupported }, { "core 7 *", CpuListSupported },
+    { "processor n*", CpuListSupported }, { "processor u3*", CpuListSupported }, { "intel n*", CpuListSupported }, // "Intel(R) N100"
+    // --- Intel Pentium / Celeron / Atom ---
+    { "pentium gold g5*", CpuListSupported }, { "pentium gold g6*", CpuListSupported }, { "pentium gold g7*", CpuListSupported },
+    { "pentium gold 4425y", CpuListSupported }, { "pentium gold 5405u", CpuListSupported }, { "pentium gold 6405u", CpuListSupported },
+    { "pentium gold 6500y", CpuListSupported }, { "pentium gold 7505", CpuListSupported }, { "pentium gold 8500", CpuListSupported },
+    { "pentium gold 8505", CpuListSupported }, { "pentium silver*", CpuListSupported }, { "pentium j6426", CpuListSupported },
+    { "pentium n6415", CpuListSupported }, { "celeron g49*", CpuListSupported }, { "celeron g59*", CpuListSupported },
+    { "celeron g69*", CpuListSupported }, { "celeron 4205u", CpuListSupported }, { "celeron 4305u", CpuListSupported },
+    { "celeron 4305ue", CpuListSupported }, { "celeron 5205u", CpuListSupported }, { "celeron 5305u", CpuListSupported },
+    { "celeron 6305*", CpuListSupported }, { "celeron 6600he", CpuListSupported }, { "celeron 7300", CpuListSupported },
+    { "celeron 7305*", CpuListSupported }, { "celeron n4000*", CpuListSupported }, { "celeron n4020*", CpuListSupported },
+    { "celeron n4100", CpuListSupported }, { "celeron n4120", CpuListSupported }, { "celeron n4500", CpuListSupported },
+    { "celeron n4505", CpuListSupported }, { "celeron n5100", CpuListSupported }, { "celeron n5105", CpuListSupported },
+    { "celeron n6210", CpuListSupported }, { "celeron n6211", CpuListSupported }, { "celeron j4005", CpuListSupported },
+    { "celeron j4025", CpuListSupported }, { "celeron j4105", CpuListSupported }, { "celeron j4115", CpuListSupported },
+    { "celeron j4125", CpuListSupported }, { "celeron j6412", CpuListSupported }, { "celeron j6413", CpuListSupported },
+    { "atom x6*", CpuListSupported },
+    // --- Intel Xeon (Scalable 2nd generation and newer, E-2100+, W-1200+/W-2200+/W-3200+, D-1700+) ---
+    { "xeon e-21*", CpuListSupported }, { "xeon e-22*", CpuListSupported }, { "xeon e-23*", CpuListSupported }, { "xeon e-24*", CpuListSupported },
+    { "xeon w-108*", CpuListSupported }, { "xeon w-11*", CpuListSupported }, { "xeon w-12*", CpuListSupported }, { "xeon w-13*", CpuListSupported },
+    { "xeon w-22*", CpuListSupported }, { "xeon w-32*", CpuListSupported }, { "xeon w-33*", CpuListSupported }, { "xeon w3-*", CpuListSupported },
+    { "xeon w5-*", CpuListSupported }, { "xeon w7-*", CpuListSupported }, { "xeon w9-*", CpuListSupported }, { "xeon d-17*", CpuListSupported },
+    { "xeon d-18*", CpuListSupported }, { "xeon d-27*", CpuListSupported }, { "xeon d-28*", CpuListSupported },
+    { "xeon bronze 32*", CpuListSupported }, { "xeon bronze 33*", CpuListSupported }, { "xeon bronze 34*", CpuListSupported },
+    { "xeon bronze 35*", CpuListSupported }, { "xeon bronze 36*", CpuListSupported }, { "xeon silver 42*", CpuListSupported },
+    { "xeon silver 43*", CpuListSupported }, { "xeon silver 44*", CpuListSupported }, { "xeon silver 45*", CpuListSupported },
+    { "xeon silver 46*", CpuListSupported }, { "xeon gold 52*", CpuListSupported }, { "xeon gold 53*", CpuListSupported },
+    { "xeon gold 54*", CpuListSupported }, { "xeon gold 55*", CpuListSupported }, { "xeon gold 56*", CpuListSupported },
+    { "xeon gold 62*", CpuListSupported }, { "xeon gold 63*", CpuListSupported }, { "xeon gold 64*", CpuListSupported },
+    { "xeon gold 65*", CpuListSupported }, { "xeon gold 66*", CpuListSupported }, { "xeon platinum 82*", CpuListSupported },
+    { "xeon platinum 83*", CpuListSupported }, { "xeon platinum 84*", CpuListSupported }, { "xeon platinum 85*", CpuListSupported },
+    { "xeon platinum 86*", CpuListSupported }, { "xeon platinum 92*", CpuListSupported }, { "xeon platinum 93*", CpuListSupported },
+    { "xeon platinum 94*", CpuListSupported }, { "xeon platinum 95*", CpuListSupported }, { "xeon platinum 96*", CpuListSupported },
+    // --- AMD Ryzen (Zen+ and newer: 2000-series desktop parts, then everything from the 3000 series on) ---
+    { "ryzen 3 2300x", CpuListSupported }, { "ryzen 5 2500x", CpuListSupported }, { "ryzen 5 2600", CpuListSupported },
+    { "ryzen 5 2600e", CpuListSupported }, { "ryzen 5 2600x", CpuListSupported }, { "ryzen 7 2700", CpuListSupported },
+    { "ryzen 7 2700e", CpuListSupported }, { "ryzen 7 2700x", CpuListSupported }, { "ryzen 5 pro 2600", CpuListSupported },
+    { "ryzen 7 pro 2700", CpuListSupported }, { "ryzen 7 pro 2700x", CpuListSupported }, { "ryzen 3 3*", CpuListSupported },
+    { "ryzen 3 4*", CpuListSupported }, { "ryzen 3 5*", CpuListSupported }, { "ryzen 3 6*", CpuListSupported }, { "ryzen 3 7*", CpuListSupported },
+    { "ryzen 3 8*", CpuListSupported }, { "ryzen 3 9*", CpuListSupported }, { "ryzen 3 pro 3*", CpuListSupported },
+    { "ryzen 3 pro 4*", CpuListSupported }, { "ryzen 3 pro 5*", CpuListSupported }, { "ryzen 3 pro 6*", CpuListSupported },
+    { "ryzen 3 pro 7*", CpuListSupported }, { "ryzen 3 pro 8*", CpuListSupported }, { "ryzen 3 pro 9*", CpuListSupported },
+    { "ryzen 5 3*", CpuListSupported }, { "ryzen 5 4*", CpuListSupported }, { "ryzen 5 5*", CpuListSupported }, { "ryzen 5 6*", CpuListSupported },
+    { "ryzen 5 7*", CpuListSupported }, { "ryzen 5 8*", CpuListSupported }, { "ryzen 5 9*", CpuListSupported },
+    { "ryzen 5 pro 3*", CpuListSupported }, { "ryzen 5 pro 4*", CpuListSupported }, { "ryzen 5 pro 5*", CpuListSupported },
+    { "ryzen 5 pro 6*", CpuListSupported }, { "ryzen 5 pro 7*", CpuListSupported }, { "ryzen 5 pro 8*", CpuListSupported },
+    { "ryzen 5 pro 9*", CpuListSupported }, { "ryzen 7 3*", CpuListSupported }, { "ryzen 7 4*", CpuListSupported },
+    { "ryzen 7 5*", CpuListSupported }, { "ryzen 7 6*", CpuListSupported }, { "ryzen 7 7*", CpuListSupported }, { "ryzen 7 8*", CpuListSupported },
+    { "ryzen 7 9*", CpuListSupported }, { "ryzen 7 pro 3*", CpuListSupported }, { "ryzen 7 pro 4*", CpuListSupported },
+    { "ryzen 7 pro 5*", CpuListSupported }, { "ryzen 7 pro 6*", CpuListSupported }, { "ryzen 7 pro 7*", CpuListSupported },
+    { "ryzen 7 pro 8*", CpuListSupported }, { "ryzen 7 pro 9*", CpuListSupported }, { "ryzen 9 3*", CpuListSupported },
+    { "ryzen 9 4*", CpuListSupported }, { "ryzen 9 5*", CpuListSupported }, { "ryzen 9 6*", CpuListSupported }, { "ryzen 9 7*", CpuListSupported },
+    { "ryzen 9 8*", CpuListSupported }, { "ryzen 9 9*", CpuListSupported }, { "ryzen 9 pro 3*", CpuListSupported },
+    { "ryzen 9 pro 4*", CpuListSupported }, { "ryzen 9 pro 5*", CpuListSupported }, { "ryzen 9 pro 6*", CpuListSupported },
+    { "ryzen 9 pro 7*", CpuListSupported }, { "ryzen 9 pro 8*", CpuListSupported }, { "ryzen 9 pro 9*", CpuListSupported },
+    { "ryzen threadripper 29*", CpuListSupported }, { "ryzen threadripper 3*", CpuListSupported }, { "ryzen threadripper 5*", CpuListSupported },
+    { "ryzen threadripper 7*", CpuListSupported }, { "ryzen threadripper 9*", CpuListSupported }, { "ryzen threadripper pro*", CpuListSupported },
+    { "ryzen ai*", CpuListSupported }, { "ryzen z1*", CpuListSupported }, { "ryzen z2*", CpuListSupported },
+    // --- AMD Athlon / EPYC ---
+    { "athlon 3000g", CpuListSupported }, { "athlon 300ge", CpuListSupported }, { "athlon 300u", CpuListSupported },
+    { "athlon 320ge", CpuListSupported }, { "athlon gold 3*", CpuListSupported }, { "athlon silver 3*", CpuListSupported },
+    { "athlon gold 7*", CpuListSupported }, { "athlon silver 7*", CpuListSupported }, { "athlon pro 3*", CpuListSupported },
+    { "athlon gold pro 3*", CpuListSupported }, { "athlon silver pro 3*", CpuListSupported }, { "amd 3015e", CpuListSupported },
+    { "amd 3015ce", CpuListSupported }, { "amd 3020e", CpuListSupported }, { "epyc 4*", CpuListSupported }, { "epyc 7*", CpuListSupported },
+    { "epyc 8*", CpuListSupported }, { "epyc 9*", CpuListSupported },
+    // --- Qualcomm / Microsoft SQ ---
+    { "snapdragon 850", CpuListSupported }, { "snapdragon 7c*", CpuListSupported }, { "snapdragon 8c*", CpuListSupported },
+    { "snapdragon x*", CpuListSupported }, { "microsoft sq1", CpuListSupported }, { "microsoft sq2", CpuListSupported },
+    { "microsoft sq3", CpuListSupported },
+    // --- Older parts that a generation prefix above would otherwise claim (Nehalem i7-8xx/9xx, first-generation EPYC) ---
+    { "i7-820qm", CpuListNotListed }, { "i7-840qm", CpuListNotListed }, { "i7-860", CpuListNotListed }, { "i7-860s", CpuListNotListed },
+    { "i7-870", CpuListNotListed }, { "i7-870s", CpuListNotListed }, { "i7-875k", CpuListNotListed }, { "i7-880", CpuListNotListed },
+    { "i7-920", CpuListNotListed }, { "i7-920xm", CpuListNotListed }, { "i7-930", CpuListNotListed }, { "i7-940", CpuListNotListed },
+    { "i7-940xm", CpuListNotListed }, { "i7-950", CpuListNotListed }, { "i7-960", CpuListNotListed }, { "i7-965", CpuListNotListed },
+    { "i7-975", CpuListNotListed }, { "i7-980", CpuListNotListed }, { "i7-980x", CpuListNotListed }, { "i7-990x", CpuListNotListed },
+    { "epyc 7251", CpuListNotListed }, { "epyc 7261", CpuListNotListed }, { "epyc 7281", CpuListNotListed }, { "epyc 7301", CpuListNotListed },
+    { "epyc 7351", CpuListNotListed }, { "epyc 7351p", CpuListNotListed }, { "epyc 7371", CpuListNotListed }, { "epyc 7401", CpuListNotListed },
+    { "epyc 7401p", CpuListNotListed }, { "epyc 7451", CpuListNotListed }, { "epyc 7501", CpuListNotListed }, { "epyc 7551", CpuListNotListed },
+    { "epyc 7551p", CpuListNotListed }, { "epyc 7601", CpuListNotListed },
+    // --- Recognized families: anything of these not matched above is not on the list ---
+    { "i3-*", CpuListNotListed }, { "i5-*", CpuListNotListed }, { "i7-*", CpuListNotListed }, { "i9-*", CpuListNotListed },
+    { "core i3 *", CpuListNotListed }, { "core i5 *", CpuListNotListed }, { "core i7 *", CpuListNotListed }, // First generation: "Core(TM) i7 CPU 920"
+    { "m3-*", CpuListNotListed }, { "m5-*", CpuListNotListed }, { "m7-*", CpuListNotListed }, { "core m-*", CpuListNotListed },
+    { "core 2*", CpuListNotListed }, { "core duo*", CpuListNotListed }, { "core solo*", CpuListNotListed }, { "pentium*", CpuListNotListed },
+    { "celeron*", CpuListNotListed }, { "atom*", CpuListNotListed }, { "xeon*", CpuListNotListed }, { "ryzen*", CpuListNotListed },
+    { "athlon*", CpuListNotListed }, { "phenom*", CpuListNotListed }, { "opteron*", CpuListNotListed }, { "sempron*", CpuListNotListed },
+    { "turion*", CpuListNotListed }, { "epyc*", CpuListNotListed }, { "fx-*", CpuListNotListed }, { "a4-*", CpuListNotListed },
+    { "a6-*", CpuListNotListed }, { "a8-*", CpuListNotListed }, { "a9-*", CpuListNotListed }, { "a10-*", CpuListNotListed },
+    { "a12-*", CpuListNotListed }, { "e1-*", CpuListNotListed }, { "e2-*", CpuListNotListed },
+    { "fx *", CpuListNotListed }, // "AMD FX(tm)-8350": the "(tm)" mark ends the word, leaving "fx -8350"
+};
+static const size_t CPU_LIST_COUNT = sizeof(CPU_LIST) / sizeof(CPU_LIST[0]);
+
+size_t CpuListPatternCount() { return CPU_LIST_COUNT; }
+
+ULONGLONG CpuListFingerprint() {
+    ULONGLONG hash = 0xCBF29CE484222325ULL; // FNV-1a over "pattern\0level" per entry
+    for (const CpuListEntry& entry : CPU_LIST) {
+        for (const char* c = entry.Pattern; ; ++c) { hash = (hash ^ (unsigned char)*c) * 0x100000001B3ULL; if (!*c) break; }
+        hash = (hash ^ entry.Level) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// --- Normalization ---
+static bool IsTokenChar(wchar_t c) { return (c >= L'a' && c <= L'z') || (c >= L'0' && c <= L'9') || c == L'-'; }
+
+// Ends the current word: drops it if it is the filler "cpu" ("Celeron(R) CPU G4900" -> "celeron g4900"), then adds one space
+static void EndWord(std::string& out) {
+    if (out.size() >= 4 && out.compare(out.size() - 4, 4, " cpu") == 0) { out.resize(out.size() - 3); return; }
+    if (out.back() != ' ') out += ' ';
+}
+
+void NormalizeCpuName(const std::wstring& processorName, std::string& normalized) {
+    normalized.assign(1, ' ');
+    const size_t length = processorName.size();
+    for (size_t i = 0; i < length; ++i) {
+        wchar_t c = processorName[i];
+        if (c >= L'A' && c <= L'Z') c = (wchar_t)(c - L'A' + L'a');
+        if (c == L'@') break;  // "@ 2.40GHz": the clock speed is reported separately
+        if (c == L'(') {       // "(R)" / "(TM)" marks, any case
+            size_t close = processorName.find(L')', i);
+            if (close != std::wstring::npos && close - i <= 3) { i = close; EndWord(normalized); continue; }
+        }
+        if (IsTokenChar(c)) normalized += (char)c; else EndWord(normalized);
+    }
+    EndWord(normalized);
+}
+
+// --- Automaton ---
+// Alphabet: ' ', '-', '0'-'9', 'a'-'z'. Every pattern is compiled with a leading space, and exact patterns with a
+// trailing one, so word boundaries fall out of the normalized text's padding instead of being checked per match.
+static const int CPU_ALPHABET = 38;
+static inline int SymbolOf(char c) { return c == ' ' ? 0 : c == '-' ? 1 : (c >= '0' && c <= '9') ? 2 + (c - '0') : 12 + (c - 'a'); }
+
+struct CpuListAutomaton {
+    std::vector<std::array<unsigned short, CPU_ALPHABET>> Next; // Full goto function (failure links folded in)
+    std::vector<short> Output;        // Pattern ending exactly at this state, or -1
+    std::vector<unsigned short> DictLink; // Nearest proper suffix state with an output (0 = none; the root never has one)
+    std::vector<unsigned char> PatternLength;
+
+    CpuListAutomaton() {
+        Next.push_back({}); Output.push_back(-1);
+        PatternLength.resize(CPU_LIST_COUNT);
+        std::string compiled;
+        for (size_t p = 0; p < CPU_LIST_COUNT; ++p) {
+            const char* pattern = CPU_LIST[p].Pattern; const size_t length = strlen(pattern);
+            const bool isPrefix = length > 0 && pattern[length - 1] == '*';
+            compiled.assign(1, ' '); compiled.append(pattern, isPrefix ? length - 1 : length);
+            if (!isPrefix) compiled += ' ';
+            size_t state = 0;
+            for (char c : compiled) {
+                const int symbol = SymbolOf(c);
+                if (Next[state][symbol] == 0) { Next[state][symbol] = (unsigned short)Next.size(); Next.push_back({}); Output.push_back(-1); }
+                state = Next[state][symbol];
+            }
+            Output[state] = (short)p; PatternLength[p] = (unsigned char)compiled.size();
+        }
+        // Breadth-first: fill missing edges from the failure state, which is always finished first
+        std::vector<unsigned short> fail(Next.size(), 0), queue; DictLink.assign(Next.size(), 0);
+        for (int s = 0; s < CPU_ALPHABET; ++s) if (Next[0][s] != 0) queue.push_back(Next[0][s]);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const unsigned short state = queue[head];
+            for (int s = 0; s < CPU_ALPHABET; ++s) {
+                const unsigned short child = Next[state][s];
+                if (child == 0) { Next[state][s] = Next[fail[state]][s]; continue; }
+                const unsigned short f = Next[fail[state]][s];
+                fail[child] = f; DictLink[child] = Output[f] >= 0 ? f : DictLink[f];
+                queue.push_back(child);
+            }
+        }
+    }
+};
+
+static const CpuListAutomaton& Automaton() { static const CpuListAutomaton automaton; return automaton; }
+
+// --- Lookup ---
+UINT MatchCpuList(const std::wstring& processorName) {
+    thread_local std::string normalized;
+    NormalizeCpuName(processorName, normalized);
+    const CpuListAutomaton& a = Automaton();
+    int best = -1;
+    size_t state = 0;
+    for (char c : normalized) {
+        state = a.Next[state][SymbolOf(c)];
+        for (size_t hit = a.Output[state] >= 0 ? state : a.DictLink[state]; hit != 0; hit = a.DictLink[hit]) {
+            const int p = a.Output[hit];
+            if (best < 0 || a.PatternLength[p] > a.PatternLength[best] || (a.PatternLength[p] == a.PatternLength[best] && CPU_LIST[p].Level > CPU_LIST[best].Level)) best = p;
+        }
+    }
+    return best < 0 ? (UINT)CpuListUnknown : (UINT)CPU_LIST[best].Level;
+}
@@ -0,0 +1,28 @@
+#ifndef CPU_LIST_H_INCLUDED
+#define CPU_LIST_H_INCLUDED
+
+#include <string>
+#include "sysinfo.h"
+
+// --- Windows 11 Supported-Processor Matcher ---
+// Maps a Win32_Processor.Name string to the level stored in CpuInfo::MinCpuGenerationLevel, which the CPU generation
+// check compares against WindowsRequirements::MinCpuGenerationLevel (8 for Windows 11).
+//
+// The bundled list (cpu_list.cpp) holds normalized model patterns: exact models ("i7-7820hq"), model prefixes covering
+// whole generations ("i5-8*") and bare family names ("pentium*") for processors that are recognized but not listed.
+// All patterns are compiled once into an Aho-Corasick automaton, so a lookup is one table step per character of the
+// name no matter how many patterns there are. When several patterns match, the longest (most specific) one wins.
+enum CpuListLevel {
+    CpuListUnknown = 0,     // Name not recognized (VMs, new or unusual vendors) -> [WARN]
+    CpuListNotListed = 1,   // Known processor family, model not on the list -> [FAIL] for Windows 11
+    CpuListSupported = 8    // On the Windows 11 list
+};
+
+UINT MatchCpuList(const std::wstring& processorName);
+// Lowercase, "(R)"/"(TM)" and the "@ 2.40GHz" suffix dropped, anything but [a-z0-9-] turned into single spaces, padded
+// with one space on each side (e.g. " 11th gen intel core i7-1165g7 ")
+void NormalizeCpuName(const std::wstring& processorName, std::string& normalized);
+size_t CpuListPatternCount();
+ULONGLONG CpuListFingerprint(); // Hash of every pattern and level (cached verdicts of rows that were not re-parsed depend on it)
+
+#endif // CPU_LIST_H_INCLUDED
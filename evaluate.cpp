@@ -0,0 +1,56 @@
+#include "evaluate.h"
+
+// --- Requirement Evaluation (split out of CompareRequirements so batch mode can reuse it) ---
+
+MachineFeatures ExtractFeatures(const MachineRecord& machine) {
+    const FirmwareInfo& firm = machine.Firmware; const GraphicsInfo& graph = machine.Graphics; const SecurityInfo& sec = machine.Security;
+    MachineFeatures f;
+    f.CpuSpeedMHz = machine.Cpu.MaxClockSpeed; f.CpuCores = machine.Cpu.NumberOfCores; f.CpuGenerationLevel = machine.Cpu.MinCpuGenerationLevel;
+    f.RamBytes = machine.Ram.TotalPhysicalBytes; f.DiskFreeBytes = machine.Disk.FreeBytesAvailableToUser;
+    f.ScreenWidth = (UINT)machine.Screen.Width; f.ScreenHeight = (UINT)machine.Screen.Height; // Same UINT cast the display check always used
+    f.TpmVersionMajor = sec.TpmSpecVersionMajor;
+    if (machine.Cpu.Is64BitCapable) f.Flags |= FeatureIs64Bit;
+    if (firm.FirmwareType == FirmwareUefi) f.Flags |= FeatureUefi;
+    if (firm.FirmwareType == FirmwareUnknown || firm.Source == SourceAssumed) f.Flags |= FeatureFirmwareUncertain;
+    if (graph.DirectXFeatureLevel) { f.Flags |= FeatureDXKnown; f.DXLevel = VersionMajor(graph.DirectXFeatureLevel); }
+    if (graph.WDDMVersion) { f.Flags |= FeatureWDDMKnown; f.WDDMLevel = VersionMajor(graph.WDDMVersion); }
+    if (sec.TpmFound && sec.TpmEnabled) f.Flags |= FeatureTpmReady;
+    if (sec.SecureBootEnabled) f.Flags |= FeatureSecureBootEnabled;
+    const bool sbUnresolved = sec.SecureBoot == SecureBootUnknown || sec.SecureBoot == SecureBootNeedsAdmin || sec.SecureBoot == SecureBootQueryFailed || sec.SecureBoot == SecureBootApiUnavailable;
+    if (!sec.SecureBootCapable || sbUnresolved) f.Flags |= FeatureSecureBootUncertain;
+    if (machine.TimedOutSections & SectionCpu) f.Flags |= FeatureCpuTimedOut;
+    if (machine.TimedOutSections & SectionRam) f.Flags |= FeatureRamTimedOut;
+    if (machine.TimedOutSections & SectionDisk) f.Flags |= FeatureDiskTimedOut;
+    return f;
+}
+
+CheckMasks EvaluateFeatures(const WindowsRequirements& target, const MachineFeatures& features) { return EvaluateFeaturesInline(target, features); }
+
+EvaluationResult MakeEvaluationResult(const CheckMasks& masks, const MachineFeatures& features) {
+    EvaluationResult result;
+    result.ApplicableMask = masks.Applicable;
+    for (int id = 0; id < CheckCount; ++id) { result.Status[id] = (masks.Fail & (1u << id)) ? StatusFail : ((masks.Warn & (1u << id)) ? StatusWarn : StatusPass); }
+    result.OverallPass = (masks.Fail == 0); result.AnyWarnings = (masks.Warn != 0);
+    result.DXCheckPossible = (features.Flags & FeatureDXKnown) != 0; result.WDDMCheckPossible = (features.Flags & FeatureWDDMKnown) != 0;
+    result.DetectedDXLevel = features.DXLevel; result.DetectedWDDMLevel = features.WDDMLevel;
+    return result;
+}
+
+EvaluationResult EvaluateRequirements(const WindowsRequirements& target, const MachineRecord& machine) {
+    MachineFeatures features = ExtractFeatures(machine);
+    return MakeEvaluationResult(EvaluateFeatures(target, features), features);
+}
+
+const char* CheckIdName(CheckId id) {
+    switch (id) {
+        case CheckCpuSpeed: return "CpuSpeed"; case CheckCpuCores: return "CpuCores"; case CheckCpuArchitecture: return "CpuArchitecture";
+        case CheckCpuGeneration: return "CpuGeneration"; case CheckRam: return "Ram"; case CheckDisk: return "Disk";
+        case CheckFirmware: return "Firmware"; case CheckDirectX: return "DirectX"; case CheckWddm: return "Wddm";
+        case CheckDisplay: return "Display"; case CheckTpm: return "Tpm"; case CheckSecureBoot: return "SecureBoot";
+        default: return "Unknown";
+    }
+}
+
+const char* CheckStatusTag(CheckStatus status) {
+    switch (status) { case StatusPass: return "PASS"; case StatusWarn: return "WARN"; default: return "FAIL"; }
+}
@@ -0,0 +1,135 @@
+#ifndef EVALUATE_H_INCLUDED
+#define EVALUATE_H_INCLUDED
+
+#include "sysinfo.h"
+
+// --- Individual Requirement Checks (one line each in the comparison report) ---
+enum CheckId {
+    CheckCpuSpeed, CheckCpuCores, CheckCpuArchitecture, CheckCpuGeneration,
+    CheckRam, CheckDisk, CheckFirmware, CheckDirectX, CheckWddm, CheckDisplay,
+    CheckTpm, CheckSecureBoot,
+    CheckCount
+};
+
+enum CheckStatus { StatusPass, StatusWarn, StatusFail };
+
+// --- Numeric View of a MachineRecord (everything the checks need; built from the typed fields, no text involved) ---
+enum FeatureFlag {
+    FeatureIs64Bit            = 1 << 0,
+    FeatureUefi               = 1 << 1,  // FirmwareType == FirmwareUefi
+    FeatureFirmwareUncertain  = 1 << 2,  // FirmwareUnknown, or BIOS assumed because GetFirmwareType is missing
+    FeatureDXKnown            = 1 << 3,  // DirectXFeatureLevel was detected (non-zero)
+    FeatureWDDMKnown          = 1 << 4,  // WDDMVersion was detected (non-zero)
+    FeatureTpmReady           = 1 << 5,  // TPM found and enabled
+    FeatureSecureBootEnabled  = 1 << 6,
+    FeatureSecureBootUncertain= 1 << 7,  // Not capable, or the query failed / needed admin / never ran
+    // Probe deadline missed (MachineRecord::TimedOutSections). Only the sections whose defaults would otherwise read as a
+    // hard [FAIL] need a flag; the others (speed 0, "N/A", "Unknown", ...) already evaluate to [WARN].
+    FeatureCpuTimedOut        = 1 << 8,
+    FeatureRamTimedOut        = 1 << 9,
+    FeatureDiskTimedOut       = 1 << 10
+};
+
+struct MachineFeatures {
+    UINT CpuSpeedMHz = 0; UINT CpuCores = 0; UINT CpuGenerationLevel = 0;
+    ULONGLONG RamBytes = 0; ULONGLONG DiskFreeBytes = 0;
+    UINT ScreenWidth = 0; UINT ScreenHeight = 0;
+    UINT DXLevel = 0; UINT WDDMLevel = 0; UINT TpmVersionMajor = 0;
+    UINT Flags = 0;   // FeatureFlag bits
+};
+static_assert(sizeof(MachineFeatures) <= 64, "MachineFeatures should fit one cache line");
+
+MachineFeatures ExtractFeatures(const MachineRecord& machine); // Integer/enum tests only, once per machine
+
+// --- Per-check Bitmasks (bit n = CheckId n) ---
+struct CheckMasks { unsigned short Applicable = 0; unsigned short Warn = 0; unsigned short Fail = 0; };
+
+inline unsigned short ApplicableChecks(const WindowsRequirements& target) {
+    const unsigned all = (1u << CheckCount) - 1;
+    return (unsigned short)(target.MinCpuGenerationLevel > 0 ? all : (all & ~(1u << CheckCpuGeneration)));
+}
+
+// --- Requirement -> Probe Map ---
+// Record sections each check reads (see ExtractFeatures). A check the profile switches off (no minimum, RequireTpm=false,
+// ...) passes whatever was detected, so live detection only runs the probes behind the checks that can still fail or
+// warn. DirectX/WDDM are always live: an undetected level is a [WARN] even against a zero minimum.
+inline constexpr unsigned CHECK_SECTIONS[CheckCount] = {
+    SectionCpu, SectionCpu, SectionCpu, SectionCpu,
+    SectionRam, SectionDisk, SectionFirmware, SectionGraphics, SectionGraphics, SectionScreen,
+    SectionSecurity, SectionSecurity | SectionFirmware // Secure Boot is only evaluated on UEFI firmware
+};
+
+constexpr unsigned short LiveChecks(const WindowsRequirements& t) {
+    return (unsigned short)(((t.MinCpuSpeedMHz > 0) << CheckCpuSpeed) | ((t.MinCpuCores > 0) << CheckCpuCores) | (t.Require64Bit << CheckCpuArchitecture)
+        | ((t.MinCpuGenerationLevel > 0) << CheckCpuGeneration) | ((t.MinRamBytes > 0) << CheckRam) | ((t.MinDiskFreeBytes > 0) << CheckDisk)
+        | (t.RequireUEFI << CheckFirmware) | (1u << CheckDirectX) | (1u << CheckWddm) | ((t.MinScreenWidth > 0 || t.MinScreenHeight > 0) << CheckDisplay)
+        | (t.RequireTpm << CheckTpm) | (t.RequireSecureBoot << CheckSecureBoot));
+}
+
+constexpr unsigned RequiredSections(const WindowsRequirements& t) { // RecordSection bits live detection has to probe for this profile
+    unsigned sections = 0; const unsigned checks = LiveChecks(t);
+    for (int id = 0; id < CheckCount; ++id) { if (checks & (1u << id)) sections |= CHECK_SECTIONS[id]; }
+    return sections;
+}
+
+// Scalar reference kernel. Inline and branch-free per check so that callers passing a constexpr profile (see
+// requirements.h) get the disabled checks folded away; EvaluateFeatures() is the out-of-line copy for runtime profiles.
+inline CheckMasks EvaluateFeaturesInline(const WindowsRequirements& t, const MachineFeatures& f) {
+    CheckMasks masks; masks.Applicable = ApplicableChecks(t);
+    unsigned warn = 0, fail = 0;
+    auto Set = [&](CheckId id, bool met, bool warning) { warn |= (unsigned)(!met & warning) << id; fail |= (unsigned)(!met & !warning) << id; };
+    const bool uefi = (f.Flags & FeatureUefi) != 0;
+
+    // --- CPU Checks ---
+    Set(CheckCpuSpeed, f.CpuSpeedMHz >= t.MinCpuSpeedMHz, f.CpuSpeedMHz == 0);
+    Set(CheckCpuCores, f.CpuCores >= t.MinCpuCores, f.CpuCores == 0);
+    Set(CheckCpuArchitecture, (!t.Require64Bit) | ((f.Flags & FeatureIs64Bit) != 0), (f.Flags & FeatureCpuTimedOut) != 0);
+    Set(CheckCpuGeneration, f.CpuGenerationLevel >= t.MinCpuGenerationLevel, f.CpuGenerationLevel == 0); // Masked off below when the target sets no level
+
+    // --- RAM / Disk Checks ---
+    Set(CheckRam, f.RamBytes >= t.MinRamBytes, (f.Flags & FeatureRamTimedOut) != 0);
+    Set(CheckDisk, f.DiskFreeBytes >= t.MinDiskFreeBytes, (f.Flags & FeatureDiskTimedOut) != 0);
+
+    // --- Firmware Check ---
+    Set(CheckFirmware, (!t.RequireUEFI) | uefi, t.RequireUEFI & ((f.Flags & FeatureFirmwareUncertain) != 0));
+
+    // --- Graphics Checks ---
+    const bool dxKnown = (f.Flags & FeatureDXKnown) != 0, wddmKnown = (f.Flags & FeatureWDDMKnown) != 0;
+    Set(CheckDirectX, dxKnown & (f.DXLevel >= t.MinDirectXFeatureLevelMajor), !dxKnown);
+    Set(CheckWddm, wddmKnown & (f.WDDMLevel >= t.MinWDDMVersionMajor), !wddmKnown);
+
+    // --- Display Check ---
+    Set(CheckDisplay, (f.ScreenWidth >= t.MinScreenWidth) & (f.ScreenHeight >= t.MinScreenHeight), (f.ScreenWidth == 0) | (f.ScreenHeight == 0));
+
+    // --- Security Checks ---
+    const bool tpmReady = (f.Flags & FeatureTpmReady) != 0;
+    Set(CheckTpm, (!t.RequireTpm) | (tpmReady & (f.TpmVersionMajor >= t.MinTpmVersionMajor)), t.RequireTpm & !tpmReady);
+    Set(CheckSecureBoot, (!t.RequireSecureBoot) | (uefi & ((f.Flags & FeatureSecureBootEnabled) != 0)), t.RequireSecureBoot & ((!uefi) | ((f.Flags & FeatureSecureBootUncertain) != 0)));
+
+    masks.Warn = (unsigned short)(warn & masks.Applicable); masks.Fail = (unsigned short)(fail & masks.Applicable);
+    return masks;
+}
+
+CheckMasks EvaluateFeatures(const WindowsRequirements& target, const MachineFeatures& features);
+
+// --- Result of comparing one machine against one WindowsRequirements profile ---
+struct EvaluationResult {
+    CheckStatus Status[CheckCount] = {};
+    unsigned ApplicableMask = 0;   // Bit per CheckId; CPU generation is only checked when the target sets a level
+    bool OverallPass = true;       // No [FAIL] among the applicable checks
+    bool AnyWarnings = false;      // At least one [WARN] among the applicable checks
+    // Parsed graphics levels (the report shows these instead of the raw strings)
+    bool DXCheckPossible = false; bool WDDMCheckPossible = false;
+    UINT DetectedDXLevel = 0; UINT DetectedWDDMLevel = 0;
+
+    bool IsApplicable(CheckId id) const { return (ApplicableMask & (1u << id)) != 0; }
+};
+
+// Pure evaluation core: no console output, safe to call from any thread
+EvaluationResult EvaluateRequirements(const WindowsRequirements& target, const MachineRecord& machine);
+EvaluationResult MakeEvaluationResult(const CheckMasks& masks, const MachineFeatures& features);
+
+const char* CheckIdName(CheckId id);          // Short stable name, e.g. "Tpm" (used in batch output)
+const char* CheckStatusTag(CheckStatus status); // "PASS" / "WARN" / "FAIL"
+
+#endif // EVALUATE_H_INCLUDED
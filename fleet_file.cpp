@@ -0,0 +1,167 @@
+#include "fleet_file.h"
+
+#include <cstring>
+#include <iostream>
+#include "inventory.h"    // UTF-8 helpers
+#include "mapped_inventory.h"
+
+// --- Reader ---
+bool FleetFile::Open(const std::string& path, std::string& error) {
+    Close();
+    if (!mapping.Open(path, error)) return false;
+    if (mapping.Size() < sizeof(FleetFileHeader)) { error = "Fleet file '" + path + "' is too small"; Close(); return false; }
+    base = mapping.Data(); fileSize = mapping.Size();
+
+    // --- Header and bounds validation (O(strings); records are fixed width and need no scan) ---
+    const FleetFileHeader& header = *(const FleetFileHeader*)base;
+    auto Fits = [&](ULONGLONG offset, ULONGLONG count, ULONGLONG size) { return offset <= fileSize && (size == 0 || count <= (fileSize - offset) / size); };
+    if (memcmp(header.Magic, FLEET_FILE_MAGIC, sizeof(header.Magic)) != 0) error = "Not a fleet file";
+    else if (header.Version != FLEET_FILE_VERSION || header.RecordSize != sizeof(FleetRecord)) error = "Unsupported fleet file version " + std::to_string(header.Version);
+    else if (header.RecordsOffset % 8 != 0 || !Fits(header.RecordsOffset, header.RecordCount, sizeof(FleetRecord))) error = "Fleet file record table is truncated";
+    else if (header.StringIndexOffset % 4 != 0 || header.StringIndexOffset > fileSize // StringCount + 1 offsets; compared without the + 1 so ~0 cannot wrap
+             || header.StringCount >= (fileSize - header.StringIndexOffset) / sizeof(UINT32)) error = "Fleet file string index is truncated";
+    else if (!Fits(header.StringDataOffset, header.StringDataSize, 1)) error = "Fleet file string data is truncated";
+    if (error.empty()) {
+        stringOffsets = (const UINT32*)(base + header.StringIndexOffset); stringCount = (size_t)header.StringCount;
+        for (size_t i = 0; i < stringCount && error.empty(); ++i) { if (stringOffsets[i] > stringOffsets[i + 1]) error = "Fleet file string index is corrupt"; }
+        if (error.empty() && stringOffsets[stringCount] > header.StringDataSize) error = "Fleet file string index is corrupt";
+    }
+    if (!error.empty()) { error += " ('" + path + "')"; Close(); return false; }
+    records = (const FleetRecord*)(base + header.RecordsOffset); recordCount = (size_t)header.RecordCount;
+    stringData = (const char*)(base + header.StringDataOffset);
+    return true;
+}
+
+void FleetFile::Close() {
+    mapping.Close();
+    base = NULL; fileSize = 0; records = NULL; recordCount = 0; stringOffsets = NULL; stringData = NULL; stringCount = 0;
+}
+
+MachineFeatures FleetFile::Features(size_t index) const {
+    const FleetRecord& r = records[index];
+    MachineFeatures f;
+    f.CpuSpeedMHz = r.CpuMaxClockSpeed; f.CpuCores = r.CpuNumberOfCores; f.CpuGenerationLevel = r.CpuMinCpuGenerationLevel;
+    f.RamBytes = r.RamTotalPhysicalBytes; f.DiskFreeBytes = r.DiskFreeBytesAvailableToUser;
+    f.ScreenWidth = (UINT)r.ScreenWidth; f.ScreenHeight = (UINT)r.ScreenHeight;
+    f.DXLevel = r.DXLevel; f.WDDMLevel = r.WDDMLevel; f.TpmVersionMajor = r.TpmSpecVersionMajor;
+    f.Flags = r.FeatureFlags;
+    return f;
+}
+
+const char* FleetFile::String(UINT32 id, size_t& length) const {
+    if (id >= stringCount) { length = 0; return ""; }
+    length = stringOffsets[id + 1] - stringOffsets[id];
+    return stringData + stringOffsets[id];
+}
+
+void FleetFile::Materialize(size_t index, MachineRecord& m) const {
+    const FleetRecord& r = records[index];
+    auto Text = [&](UINT32 id) { return Utf8ToWide(StringUtf8(id)); };
+    m = MachineRecord();
+    m.MachineId = Text(r.MachineId);
+    m.Cpu.Name = Text(r.CpuName); m.Cpu.Architecture = Text(r.CpuArchitecture); m.Cpu.MaxClockSpeed = r.CpuMaxClockSpeed;
+    m.Cpu.NumberOfCores = r.CpuNumberOfCores; m.Cpu.NumberOfLogicalProcessors = r.CpuNumberOfLogicalProcessors;
+    m.Cpu.Is64BitCapable = (r.Bools & FleetIs64BitCapable) != 0; m.Cpu.MinCpuGenerationLevel = r.CpuMinCpuGenerationLevel;
+    m.Ram.TotalPhysicalBytes = r.RamTotalPhysicalBytes;
+    m.Disk.TotalBytes = r.DiskTotalBytes; m.Disk.FreeBytesAvailableToUser = r.DiskFreeBytesAvailableToUser; m.Disk.DriveLetter = (wchar_t)r.DiskDriveLetter;
+    m.Os.Caption = Text(r.OsCaption); m.Os.Version = Text(r.OsVersion); m.Os.BuildNumber = Text(r.OsBuildNumber);
+    m.Os.OSArchitecture = Text(r.OsArchitecture); m.Os.ServicePackMajorVersion = Text(r.OsServicePackMajorVersion);
+    m.Firmware.FirmwareType = (FirmwareKind)r.FirmwareType; m.Firmware.Source = (DetectionSource)r.FirmwareSource;
+    m.Graphics.Name = Text(r.GraphicsName); m.Graphics.AdapterRAM = r.GraphicsAdapterRAM; m.Graphics.DriverVersion = Text(r.GraphicsDriverVersion);
+    m.Graphics.VideoProcessor = Text(r.GraphicsVideoProcessor); m.Graphics.DirectXFeatureLevel = r.GraphicsDirectXFeatureLevel; m.Graphics.WDDMVersion = r.GraphicsWDDMVersion;
+    m.Screen.Width = r.ScreenWidth; m.Screen.Height = r.ScreenHeight;
+    m.Security.TpmEnabled = (r.Bools & FleetTpmEnabled) != 0; m.Security.TpmFound = (r.Bools & FleetTpmFound) != 0;
+    m.Security.TpmSpecVersionMajor = r.TpmSpecVersionMajor; m.Security.TpmSpecVersionMinor = r.TpmSpecVersionMinor; m.Security.TpmVersionString = Text(r.TpmVersionString);
+    m.Security.SecureBootEnabled = (r.Bools & FleetSecureBootEnabled) != 0; m.Security.SecureBootCapable = (r.Bools & FleetSecureBootCapable) != 0;
+    m.Security.SecureBoot = (SecureBootState)r.SecureBootState; m.Security.SecureBootSource = (DetectionSource)r.SecureBootSource; m.Security.SecureBootErrorCode = r.SecureBootErrorCode;
+    m.DirectX.InstalledVersion = Text(r.DirectXInstalledVersion);
+    m.TimedOutSections = r.TimedOutSections;
+}
+
+bool IsFleetFile(const std::string& path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    char magic[sizeof(FLEET_FILE_MAGIC)] = {};
+    return file.read(magic, sizeof(magic)) && memcmp(magic, FLEET_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+// --- Writer ---
+bool FleetWriter::Open(const std::string& path, std::string& error) {
+    output.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!output) { error = "Could not create fleet file '" + path + "'"; return false; }
+    FleetFileHeader placeholder = {}; // Rewritten by Finish() once the counts are known
+    output.write((const char*)&placeholder, sizeof(placeholder));
+    stringIds.clear(); stringOffsets.assign(1, 0); stringData.clear(); recordCount = 0;
+    return (bool)output;
+}
+
+UINT32 FleetWriter::Intern(const std::wstring& text) {
+    std::string utf8 = WideToUtf8(text);
+    auto found = stringIds.find(utf8);
+    if (found != stringIds.end()) return found->second;
+    const UINT32 id = (UINT32)(stringOffsets.size() - 1);
+    stringData += utf8; stringOffsets.push_back((UINT32)stringData.size());
+    stringIds.emplace(std::move(utf8), id);
+    return id;
+}
+
+bool FleetWriter::Add(const MachineRecord& m) {
+    if (stringData.size() > 0xF0000000u) return false; // Offsets are 32-bit
+    const MachineFeatures features = ExtractFeatures(m);
+    FleetRecord r = {};
+    r.RamTotalPhysicalBytes = m.Ram.TotalPhysicalBytes; r.DiskTotalBytes = m.Disk.TotalBytes; r.DiskFreeBytesAvailableToUser = m.Disk.FreeBytesAvailableToUser;
+    r.CpuMaxClockSpeed = m.Cpu.MaxClockSpeed; r.CpuNumberOfCores = m.Cpu.NumberOfCores; r.CpuNumberOfLogicalProcessors = m.Cpu.NumberOfLogicalProcessors;
+    r.CpuMinCpuGenerationLevel = m.Cpu.MinCpuGenerationLevel;
+    r.ScreenWidth = m.Screen.Width; r.ScreenHeight = m.Screen.Height;
+    r.DXLevel = features.DXLevel; r.WDDMLevel = features.WDDMLevel;
+    r.TpmSpecVersionMajor = m.Security.TpmSpecVersionMajor; r.TpmSpecVersionMinor = m.Security.TpmSpecVersionMinor;
+    r.GraphicsAdapterRAM = m.Graphics.AdapterRAM; r.FeatureFlags = features.Flags;
+    r.TimedOutSections = m.TimedOutSections; r.DiskDriveLetter = (WORD)m.Disk.DriveLetter;
+    r.Bools = (unsigned char)((m.Cpu.Is64BitCapable ? FleetIs64BitCapable : 0) | (m.Security.TpmEnabled ? FleetTpmEnabled : 0) | (m.Security.TpmFound ? FleetTpmFound : 0)
+                              | (m.Security.SecureBootEnabled ? FleetSecureBootEnabled : 0) | (m.Security.SecureBootCapable ? FleetSecureBootCapable : 0));
+    r.SecureBootErrorCode = m.Security.SecureBootErrorCode; r.GraphicsDirectXFeatureLevel = m.Graphics.DirectXFeatureLevel; r.GraphicsWDDMVersion = m.Graphics.WDDMVersion;
+    r.FirmwareType = m.Firmware.FirmwareType; r.FirmwareSource = m.Firmware.Source; r.SecureBootState = m.Security.SecureBoot; r.SecureBootSource = m.Security.SecureBootSource;
+    r.MachineId = Intern(m.MachineId); r.CpuName = Intern(m.Cpu.Name); r.CpuArchitecture = Intern(m.Cpu.Architecture);
+    r.OsCaption = Intern(m.Os.Caption); r.OsVersion = Intern(m.Os.Version); r.OsBuildNumber = Intern(m.Os.BuildNumber);
+    r.OsArchitecture = Intern(m.Os.OSArchitecture); r.OsServicePackMajorVersion = Intern(m.Os.ServicePackMajorVersion);
+    r.GraphicsName = Intern(m.Graphics.Name); r.GraphicsDriverVersion = Intern(m.Graphics.DriverVersion); r.GraphicsVideoProcessor = Intern(m.Graphics.VideoProcessor);
+    r.TpmVersionString = Intern(m.Security.TpmVersionString);
+    r.DirectXInstalledVersion = Intern(m.DirectX.InstalledVersion);
+    output.write((const char*)&r, sizeof(r)); ++recordCount;
+    return (bool)output;
+}
+
+bool FleetWriter::Finish(std::string& error) {
+    FleetFileHeader header = {};
+    memcpy(header.Magic, FLEET_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = FLEET_FILE_VERSION; header.RecordSize = sizeof(FleetRecord);
+    header.RecordCount = recordCount; header.RecordsOffset = sizeof(FleetFileHeader);
+    header.StringCount = stringOffsets.size() - 1;
+    header.StringIndexOffset = header.RecordsOffset + header.RecordCount * sizeof(FleetRecord); // Already 8-byte aligned
+    header.StringDataOffset = header.StringIndexOffset + stringOffsets.size() * sizeof(UINT32);
+    header.StringDataSize = stringData.size();
+    output.write((const char*)&stringOffsets[0], (std::streamsize)(stringOffsets.size() * sizeof(UINT32)));
+    output.write(stringData.data(), (std::streamsize)stringData.size());
+    output.seekp(0); output.write((const char*)&header, sizeof(header));
+    output.close();
+    if (!output) { error = "Failed writing fleet file"; return false; }
+    return true;
+}
+
+bool PackInventory(const std::string& inputPath, const std::string& outputPath, size_t& machines, size_t& malformedRows, std::string& error) {
+    machines = 0; malformedRows = 0;
+    MappedInventory inventory;
+    if (!inventory.Open(inputPath, error)) return false;
+    FleetWriter writer;
+    if (!writer.Open(outputPath, error)) return false;
+    std::vector<MachineRecord> records; std::vector<std::string> warnings;
+    for (size_t begin = inventory.DataBegin(), line = inventory.DataLine(), lines = 0; begin < inventory.Size(); line += lines) {
+        const size_t end = inventory.NextRange(begin, 4096, lines);
+        records.clear(); warnings.clear();
+        inventory.ParseRange(begin, end, line, records, warnings);
+        for (const std::string& warning : warnings) std::cerr << "  Warning: Skipping inventory row. " << warning << std::endl;
+        for (const MachineRecord& record : records) { if (!writer.Add(record)) { error = "Failed writing fleet file '" + outputPath + "'"; return false; } }
+        malformedRows += warnings.size(); begin = end;
+    }
+    machines = writer.Count();
+    return writer.Finish(error);
+}
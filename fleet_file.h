@@ -0,0 +1,97 @@
+#ifndef FLEET_FILE_H_INCLUDED
+#define FLEET_FILE_H_INCLUDED
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "evaluate.h"
+#include "mapped_file.h"
+
+// --- Binary Fleet File ---
+// Many machine records in one memory-mappable file (little-endian, every offset from the start of the file):
+//
+//   FleetFileHeader | FleetRecord x RecordCount | UINT32 string offsets x (StringCount + 1) | UTF-8 string data
+//
+// Records are fixed width, so record i lives at RecordsOffset + i * RecordSize. Text fields are ids into a
+// deduplicated string table (CPU/GPU names, driver and OS versions repeat across a fleet). The values the
+// checks need (DirectX/WDDM levels, FeatureFlag bits) are derived once when the file is packed, so evaluating a record
+// reads only numbers from the mapping: no parsing, no copies, no allocation.
+const char FLEET_FILE_MAGIC[8] = { 'W', 'R', 'C', 'F', 'L', 'E', 'E', 'T' };
+const UINT32 FLEET_FILE_VERSION = 2;   // Bump whenever FleetRecord or the layout changes
+
+struct FleetFileHeader {
+    char Magic[8];
+    UINT32 Version; UINT32 RecordSize;
+    ULONGLONG RecordCount; ULONGLONG RecordsOffset;
+    ULONGLONG StringCount; ULONGLONG StringIndexOffset; ULONGLONG StringDataOffset; ULONGLONG StringDataSize;
+};
+
+enum FleetRecordBool { FleetIs64BitCapable = 1, FleetTpmEnabled = 2, FleetTpmFound = 4, FleetSecureBootEnabled = 8, FleetSecureBootCapable = 16 };
+
+struct FleetRecord {
+    // --- Numbers (everything EvaluateFeatures() needs) ---
+    ULONGLONG RamTotalPhysicalBytes; ULONGLONG DiskTotalBytes; ULONGLONG DiskFreeBytesAvailableToUser;
+    UINT32 CpuMaxClockSpeed; UINT32 CpuNumberOfCores; UINT32 CpuNumberOfLogicalProcessors; UINT32 CpuMinCpuGenerationLevel;
+    int ScreenWidth; int ScreenHeight;
+    UINT32 DXLevel; UINT32 WDDMLevel;            // Major parts of the packed versions below
+    UINT32 TpmSpecVersionMajor; UINT32 TpmSpecVersionMinor;
+    UINT32 GraphicsAdapterRAM; UINT32 FeatureFlags; // FeatureFlag bits from ExtractFeatures()
+    UINT32 TimedOutSections; WORD DiskDriveLetter; unsigned char Bools; unsigned char Reserved; // Bools: FleetRecordBool bits
+    // --- Typed detection state (sysinfo.h enums, stored as-is) ---
+    UINT32 SecureBootErrorCode; WORD GraphicsDirectXFeatureLevel; WORD GraphicsWDDMVersion; // Packed versions
+    unsigned char FirmwareType; unsigned char FirmwareSource; unsigned char SecureBootState; unsigned char SecureBootSource;
+    // --- String table ids ---
+    UINT32 MachineId; UINT32 CpuName; UINT32 CpuArchitecture;
+    UINT32 OsCaption; UINT32 OsVersion; UINT32 OsBuildNumber; UINT32 OsArchitecture; UINT32 OsServicePackMajorVersion;
+    UINT32 GraphicsName; UINT32 GraphicsDriverVersion; UINT32 GraphicsVideoProcessor;
+    UINT32 TpmVersionString; UINT32 DirectXInstalledVersion;
+};
+
+static_assert(sizeof(FleetFileHeader) == 64, "FleetFileHeader layout is part of the file format");
+static_assert(sizeof(FleetRecord) == 144, "FleetRecord layout is part of the file format");
+
+// --- Reader (maps the file read-only; pages are only loaded for the records actually touched) ---
+class FleetFile {
+public:
+    FleetFile() {}
+    ~FleetFile() { Close(); }
+    FleetFile(const FleetFile&) = delete; FleetFile& operator=(const FleetFile&) = delete;
+
+    bool Open(const std::string& path, std::string& error); // Validates the header and the string index, not every record
+    void Close();
+    size_t Size() const { return recordCount; }
+    const FleetRecord& Record(size_t index) const { return records[index]; }
+    MachineFeatures Features(size_t index) const;      // Numbers only; same result as ExtractFeatures() on the source record
+    const char* String(UINT32 id, size_t& length) const; // UTF-8 in place (not terminated); unknown ids read as ""
+    std::string StringUtf8(UINT32 id) const { size_t length = 0; const char* text = String(id, length); return std::string(text, length); }
+    void Materialize(size_t index, MachineRecord& record) const; // Full record with wide strings (reports, CSV export)
+private:
+    const unsigned char* base = NULL; size_t fileSize = 0;
+    const FleetRecord* records = NULL; size_t recordCount = 0;
+    const UINT32* stringOffsets = NULL; const char* stringData = NULL; size_t stringCount = 0;
+    MappedFile mapping;
+};
+
+bool IsFleetFile(const std::string& path); // True if the file starts with FLEET_FILE_MAGIC
+
+// --- Writer (records stream to disk; only the distinct strings are held in memory) ---
+class FleetWriter {
+public:
+    bool Open(const std::string& path, std::string& error);
+    bool Add(const MachineRecord& record);
+    bool Finish(std::string& error);                   // Writes the string table and the final header
+    size_t Count() const { return recordCount; }
+private:
+    UINT32 Intern(const std::wstring& text);
+    std::ofstream output;
+    std::unordered_map<std::string, UINT32> stringIds;
+    std::vector<UINT32> stringOffsets; std::string stringData;
+    size_t recordCount = 0;
+};
+
+// Converts a CSV inventory export (see inventory.h) into a fleet file; malformed rows are skipped and counted
+bool PackInventory(const std::string& inputPath, const std::string& outputPath, size_t& machines, size_t& malformedRows, std::string& error);
+
+#endif // FLEET_FILE_H_INCLUDED
@@ -0,0 +1,205 @@
+#include "inventory.h"
+#include "cpu_list.h"     // Level for rows that only carry Cpu.Name
+
+#include <cerrno>
+#include <charconv>       // For std::from_chars
+#include <cstdlib>        // For strtoull / strtol
+#include <cstring>
+#include <cwchar>         // For wcslen
+#include <limits>         // For std::numeric_limits (field range checks)
+#include <cctype>         // For tolower
+
+// --- UTF-8 <-> Wide Conversion (wchar_t is UTF-16 on Windows, UTF-32 elsewhere) ---
+std::wstring Utf8ToWide(const std::string& text) {
+    std::wstring out; AssignUtf8(out, text);
+    return out;
+}
+
+void AssignUtf8(std::wstring& out, std::string_view text) {
+    size_t i = 0;
+    while (i < text.size() && (unsigned char)text[i] < 0x80) ++i; // ASCII prefix (usually the whole value) widens directly
+    out.resize(i); // Not assign(first, last): libstdc++ builds a temporary string for iterators of another character type
+    for (size_t k = 0; k < i; ++k) out[k] = (wchar_t)(unsigned char)text[k];
+    while (i < text.size()) {
+        unsigned char c = (unsigned char)text[i]; unsigned long cp = 0; size_t extra = 0;
+        if (c < 0x80) { cp = c; } else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; extra = 1; } else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; extra = 2; } else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; extra = 3; } else { cp = 0xFFFD; }
+        ++i;
+        for (size_t k = 0; k < extra; ++k, ++i) {
+            if (i >= text.size() || ((unsigned char)text[i] & 0xC0) != 0x80) { cp = 0xFFFD; break; }
+            cp = (cp << 6) | ((unsigned char)text[i] & 0x3F);
+        }
+        if (sizeof(wchar_t) == 2 && cp >= 0x10000) { cp -= 0x10000; out += (wchar_t)(0xD800 + (cp >> 10)); out += (wchar_t)(0xDC00 + (cp & 0x3FF)); }
+        else { out += (wchar_t)cp; }
+    }
+}
+
+std::string WideToUtf8(const std::wstring& text) {
+    std::string out; out.reserve(text.size());
+    AppendUtf8(out, text);
+    return out;
+}
+
+void AppendUtf8(std::string& out, const std::wstring& text) { AppendUtf8(out, text.data(), text.size()); }
+void AppendUtf8(std::string& out, const wchar_t* text) { AppendUtf8(out, text, wcslen(text)); }
+void AppendUtf8(std::string& out, const wchar_t* text, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        unsigned long cp = (unsigned long)text[i];
+        if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < length) { cp = 0x10000 + ((cp - 0xD800) << 10) + ((unsigned long)text[++i] - 0xDC00); }
+        if (cp < 0x80) { out += (char)cp; }
+        else if (cp < 0x800) { out += (char)(0xC0 | (cp >> 6)); out += (char)(0x80 | (cp & 0x3F)); }
+        else if (cp < 0x10000) { out += (char)(0xE0 | (cp >> 12)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+        else { out += (char)(0xF0 | (cp >> 18)); out += (char)(0x80 | ((cp >> 12) & 0x3F)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    }
+}
+
+// --- Value Parsers (std::from_chars: no locale, no terminator needed, so cells are parsed in place) ---
+static bool ParseUnsigned(std::string_view value, ULONGLONG& out) {
+    while (!value.empty() && isspace((unsigned char)value[0])) value.remove_prefix(1); // strtoull compatibility: " 12", "+12"
+    if (!value.empty() && value[0] == '+') value.remove_prefix(1);
+    unsigned long long v = 0; const char* end = value.data() + value.size();
+    const std::from_chars_result result = std::from_chars(value.data(), end, v);
+    if (value.empty() || result.ec != std::errc() || result.ptr != end) return false;
+    out = v; return true;
+}
+static bool ParseSigned(std::string_view value, int& out) { // Out of int range is malformed, not wrapped
+    while (!value.empty() && isspace((unsigned char)value[0])) value.remove_prefix(1);
+    if (value.size() > 1 && value[0] == '+' && value[1] != '-') value.remove_prefix(1);
+    int v = 0; const char* end = value.data() + value.size();
+    const std::from_chars_result result = std::from_chars(value.data(), end, v);
+    if (value.empty() || result.ec != std::errc() || result.ptr != end) return false;
+    out = v; return true;
+}
+static bool EqualsIgnoreCase(std::string_view value, const char* word) {
+    size_t i = 0;
+    for (; i < value.size() && word[i]; ++i) { if (tolower((unsigned char)value[i]) != word[i]) return false; }
+    return i == value.size() && !word[i];
+}
+static bool ParseBoolean(std::string_view value, bool& out) {
+    if (value == "1" || EqualsIgnoreCase(value, "true") || EqualsIgnoreCase(value, "yes") || EqualsIgnoreCase(value, "y")) { out = true; return true; }
+    if (value == "0" || EqualsIgnoreCase(value, "false") || EqualsIgnoreCase(value, "no") || EqualsIgnoreCase(value, "n")) { out = false; return true; }
+    return false;
+}
+static bool ParseText(std::string_view value, MachineRecord& record, bool (*parse)(const std::wstring&, MachineRecord&)) {
+    thread_local std::wstring text; AssignUtf8(text, value);
+    return parse(text, record);
+}
+
+// --- Field Table ---
+#define FIELD_WSTRING(name, member) { name, [](MachineRecord& r, std::string_view v) { AssignUtf8(r.member, v); return true; }, [](const MachineRecord& r, std::string& out) { out += WideToUtf8(r.member); } }
+#define FIELD_UNSIGNED(name, member, type) { name, [](MachineRecord& r, std::string_view v) { ULONGLONG n = 0; if (!ParseUnsigned(v, n) || n > std::numeric_limits<type>::max()) return false; r.member = (type)n; return true; }, [](const MachineRecord& r, std::string& out) { out += std::to_string((unsigned long long)r.member); } }
+#define FIELD_SIGNED(name, member) { name, [](MachineRecord& r, std::string_view v) { return ParseSigned(v, r.member); }, [](const MachineRecord& r, std::string& out) { out += std::to_string(r.member); } }
+#define FIELD_TEXT(name, parse, render) { name, [](MachineRecord& r, std::string_view v) { return ParseText(v, r, parse); }, [](const MachineRecord& r, std::string& out) { out += WideToUtf8(render(r)); } } // Typed member exported as its display text
+#define FIELD_BOOL(name, member) { name, [](MachineRecord& r, std::string_view v) { return ParseBoolean(v, r.member); }, [](const MachineRecord& r, std::string& out) { out += r.member ? "1" : "0"; } }
+
+static const RecordField recordFields[] = {
+    FIELD_WSTRING("MachineId", MachineId),
+    FIELD_WSTRING("Cpu.Name", Cpu.Name), FIELD_WSTRING("Cpu.Architecture", Cpu.Architecture),
+    FIELD_UNSIGNED("Cpu.MaxClockSpeed", Cpu.MaxClockSpeed, UINT), FIELD_UNSIGNED("Cpu.NumberOfCores", Cpu.NumberOfCores, UINT),
+    FIELD_UNSIGNED("Cpu.NumberOfLogicalProcessors", Cpu.NumberOfLogicalProcessors, UINT), FIELD_BOOL("Cpu.Is64BitCapable", Cpu.Is64BitCapable),
+    FIELD_UNSIGNED("Cpu.MinCpuGenerationLevel", Cpu.MinCpuGenerationLevel, UINT),
+    FIELD_UNSIGNED("Ram.TotalPhysicalBytes", Ram.TotalPhysicalBytes, ULONGLONG),
+    FIELD_UNSIGNED("Disk.TotalBytes", Disk.TotalBytes, ULONGLONG), FIELD_UNSIGNED("Disk.FreeBytesAvailableToUser", Disk.FreeBytesAvailableToUser, ULONGLONG),
+    { "Disk.DriveLetter", [](MachineRecord& r, std::string_view v) { if (v.size() != 1) return false; r.Disk.DriveLetter = (wchar_t)v[0]; return true; }, [](const MachineRecord& r, std::string& out) { out += (char)r.Disk.DriveLetter; } },
+    FIELD_WSTRING("Os.Caption", Os.Caption), FIELD_WSTRING("Os.Version", Os.Version), FIELD_WSTRING("Os.BuildNumber", Os.BuildNumber),
+    FIELD_WSTRING("Os.OSArchitecture", Os.OSArchitecture), FIELD_WSTRING("Os.ServicePackMajorVersion", Os.ServicePackMajorVersion),
+    FIELD_TEXT("Firmware.FirmwareType", [](const std::wstring& t, MachineRecord& r) { return ParseFirmwareText(t, r.Firmware); }, [](const MachineRecord& r) { return FirmwareText(r.Firmware); }),
+    FIELD_WSTRING("Graphics.Name", Graphics.Name), FIELD_UNSIGNED("Graphics.AdapterRAM", Graphics.AdapterRAM, UINT32),
+    FIELD_WSTRING("Graphics.DriverVersion", Graphics.DriverVersion), FIELD_WSTRING("Graphics.VideoProcessor", Graphics.VideoProcessor),
+    FIELD_TEXT("Graphics.DirectXFeatureLevel", [](const std::wstring& t, MachineRecord& r) { return ParseVersionText(t, r.Graphics.DirectXFeatureLevel); }, [](const MachineRecord& r) { return VersionText(r.Graphics.DirectXFeatureLevel, L'_'); }),
+    FIELD_TEXT("Graphics.WDDMVersion", [](const std::wstring& t, MachineRecord& r) { return ParseVersionText(t, r.Graphics.WDDMVersion); }, [](const MachineRecord& r) { return VersionText(r.Graphics.WDDMVersion, L'.'); }),
+    FIELD_SIGNED("Screen.Width", Screen.Width), FIELD_SIGNED("Screen.Height", Screen.Height),
+    FIELD_BOOL("Security.TpmEnabled", Security.TpmEnabled), FIELD_BOOL("Security.TpmFound", Security.TpmFound),
+    FIELD_UNSIGNED("Security.TpmSpecVersionMajor", Security.TpmSpecVersionMajor, UINT32), FIELD_UNSIGNED("Security.TpmSpecVersionMinor", Security.TpmSpecVersionMinor, UINT32),
+    FIELD_WSTRING("Security.TpmVersionString", Security.TpmVersionString),
+    FIELD_BOOL("Security.SecureBootEnabled", Security.SecureBootEnabled), FIELD_BOOL("Security.SecureBootCapable", Security.SecureBootCapable),
+    FIELD_TEXT("Security.SecureBootStatus", [](const std::wstring& t, MachineRecord& r) { return ParseSecureBootText(t, r.Security); }, [](const MachineRecord& r) { return SecureBootText(r.Security); }),
+    FIELD_WSTRING("DirectX.InstalledVersion", DirectX.InstalledVersion),
+    FIELD_UNSIGNED("TimedOutSections", TimedOutSections, UINT),
+};
+
+const RecordField* GetRecordFields(size_t& count) { count = sizeof(recordFields) / sizeof(recordFields[0]); return recordFields; }
+
+const RecordField* FindRecordField(std::string_view name) {
+    for (const RecordField& field : recordFields) { if (name == field.Name) return &field; }
+    return NULL;
+}
+
+// --- CSV Helpers ---
+bool SplitCsvLine(const std::string& line, std::vector<std::string>& cells) {
+    size_t count = 0; // The strings left in cells by the previous line are reused, capacity and all
+    auto NextCell = [&]() -> std::string* { if (count == cells.size()) cells.emplace_back(); cells[count].clear(); return &cells[count++]; };
+    std::string* cell = NextCell();
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"') { if (i + 1 < line.size() && line[i + 1] == '"') { *cell += '"'; ++i; } else { quoted = false; } }
+            else { *cell += c; }
+        } else if (c == '"' && cell->empty()) { quoted = true; }
+        else if (c == ',') { cell = NextCell(); }
+        else if (c != '\r') { *cell += c; }
+    }
+    cells.resize(count);
+    return !quoted; // An unterminated quote means the row is malformed
+}
+
+void AppendCsvCell(std::string& out, std::string_view value) {
+    if (value.find_first_of(",\"\r\n") == std::string_view::npos) { out += value; return; }
+    out += '"';
+    for (char c : value) { if (c == '"') out += '"'; out += c; }
+    out += '"';
+}
+
+// --- Reader ---
+bool InventoryReader::ReadHeader() {
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        if (line.empty() || line == "\r") continue;
+        if (!SplitCsvLine(line, cells)) { lastError = "Malformed header line"; return false; }
+        columns.clear(); bool anyKnown = false;
+        for (const std::string& name : cells) { const RecordField* field = FindRecordField(name); columns.push_back(field); anyKnown = anyKnown || field; }
+        if (!anyKnown) { lastError = "Header names no known record field"; return false; }
+        return true;
+    }
+    lastError = "Inventory is empty"; return false;
+}
+
+InventoryReader::Status InventoryReader::ReadRecord(MachineRecord& record) {
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        if (line.empty() || line == "\r") continue;
+        bool ok = SplitCsvLine(line, cells) && cells.size() == columns.size();
+        if (!ok) { lastError = "Line " + std::to_string(lineNumber) + ": expected " + std::to_string(columns.size()) + " columns"; }
+        record = MachineRecord();
+        for (size_t i = 0; ok && i < cells.size(); ++i) {
+            if (!columns[i] || cells[i].empty()) continue; // Ignored column or missing value keeps the default
+            if (!columns[i]->Parse(record, cells[i])) { ok = false; lastError = "Line " + std::to_string(lineNumber) + ": bad value '" + cells[i] + "' for " + columns[i]->Name; }
+        }
+        if (ok) {
+            FinishInventoryRecord(record);
+            return RecordOk;
+        }
+        ++malformedRows; return RecordMalformed;
+    }
+    return EndOfInput;
+}
+
+void FinishInventoryRecord(MachineRecord& record) {
+    if (record.Cpu.MinCpuGenerationLevel == 0 && record.Cpu.Name != L"N/A") record.Cpu.MinCpuGenerationLevel = MatchCpuList(record.Cpu.Name);
+}
+
+// --- Writer ---
+void WriteInventoryHeader(std::ostream& out) {
+    std::string line;
+    for (const RecordField& field : recordFields) { if (!line.empty()) line += ','; line += field.Name; }
+    out << line << '\n';
+}
+
+void WriteInventoryRecord(std::ostream& out, const MachineRecord& record) {
+    std::string line, value;
+    for (const RecordField& field : recordFields) {
+        if (&field != recordFields) line += ',';
+        value.clear(); field.Format(record, value); AppendCsvCell(line, value);
+    }
+    out << line << '\n';
+}
@@ -0,0 +1,57 @@
+#ifndef INVENTORY_H_INCLUDED
+#define INVENTORY_H_INCLUDED
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sysinfo.h"
+
+// --- Text Helpers (inventory exports are UTF-8, the info structs hold std::wstring) ---
+std::wstring Utf8ToWide(const std::string& text);
+void AssignUtf8(std::wstring& out, std::string_view text); // Reuses out's capacity
+std::string WideToUtf8(const std::wstring& text);
+void AppendUtf8(std::string& out, const std::wstring& text); // In place: no temporary once out has grown
+void AppendUtf8(std::string& out, const wchar_t* text);
+void AppendUtf8(std::string& out, const wchar_t* text, size_t length);
+
+// --- Record Field Table ---
+// Every MachineRecord member that can appear in an inventory export, keyed by "Struct.Field" (e.g. "Cpu.MaxClockSpeed").
+struct RecordField {
+    const char* Name;
+    bool (*Parse)(MachineRecord& record, std::string_view value); // Returns false if the value is malformed
+    void (*Format)(const MachineRecord& record, std::string& out);  // Appends the value as UTF-8
+};
+const RecordField* GetRecordFields(size_t& count);
+const RecordField* FindRecordField(std::string_view name);
+void FinishInventoryRecord(MachineRecord& record); // Fills what a row may leave out (CPU list level from Cpu.Name)
+
+// --- CSV Inventory Reader ---
+// The first line is a header naming the columns; unknown columns are ignored and missing fields keep their defaults.
+class InventoryReader {
+public:
+    explicit InventoryReader(std::istream& in) : input(in) {}
+    bool ReadHeader();                       // False if the stream is empty or has no usable column
+    enum Status { RecordOk, RecordMalformed, EndOfInput };
+    Status ReadRecord(MachineRecord& record); // A malformed row is counted and described by LastError(); keep reading after it
+    size_t LineNumber() const { return lineNumber; }
+    size_t MalformedRows() const { return malformedRows; }
+    const std::string& LastError() const { return lastError; }
+private:
+    std::istream& input;
+    std::vector<const RecordField*> columns; // nullptr for ignored columns
+    std::vector<std::string> cells;
+    std::string line;
+    size_t lineNumber = 0; size_t malformedRows = 0;
+    std::string lastError;
+};
+
+bool SplitCsvLine(const std::string& line, std::vector<std::string>& cells); // Handles "quoted, fields" and "" escapes
+void AppendCsvCell(std::string& out, std::string_view value);
+
+// --- CSV Inventory Writer (the same layout ReadRecord accepts) ---
+void WriteInventoryHeader(std::ostream& out);
+void WriteInventoryRecord(std::ostream& out, const MachineRecord& record);
+
+#endif // INVENTORY_H_INCLUDED
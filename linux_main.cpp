@@ -0,0 +1,118 @@
+// --- WinReadyCheck for Linux (separate "Linux" build target; POSIX, no windows.h) ---
+// Usage: WinReadyCheckLinux [--target <Vista|7|8.1|10|11|all>] [--format ansi|plain|json|html] [--root <dir>] [--export <inventory.csv>] [--trace <trace.json>]
+//        WinReadyCheckLinux --agent <socket> [--root <dir>] [--refresh-every Section=Seconds] [--probe-timeout <ms>]
+// Assesses a Linux (or dual-boot) machine for a Windows migration: the probes in linux_probe.cpp read /proc and /sys,
+// and the evaluation and report code is the same as the Windows build. --root runs the probes against a copied or
+// fixture tree instead of the live system; --export writes the record as a one-machine inventory for --batch.
+// --agent keeps running and answers readiness queries on a Unix domain socket (see agent.h).
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>        // For atoi
+#include <cstring>        // For strcmp
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>       // isatty
+#include "agent.h"
+#include "evaluate.h"
+#include "inventory.h"
+#include "linux_probe.h"
+#include "report.h"
+#include "requirements.h"
+#include "snapshot.h"       // RecordSectionName
+#include "trace.h"
+
+static std::atomic<bool> stopAgent(false);
+static void OnStopSignal(int) { stopAgent.store(true); }
+
+// --- Agent Mode (runs until SIGINT/SIGTERM) ---
+static int RunAgentMode(int argc, char* argv[]) {
+    std::string socketPath = argv[2], rootPath, tracePath; AgentOptions options = DefaultAgentOptions();
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc); std::string error;
+        if (arg == "--root" && hasValue) { rootPath = argv[++i]; while (rootPath.size() > 1 && rootPath.back() == '/') rootPath.pop_back(); }
+        else if (arg == "--refresh-every" && hasValue) { if (!SetAgentRefresh(options, argv[++i], error)) { std::cerr << "Error: " << error << std::endl; return 1; } }
+        else if (arg == "--probe-timeout" && hasValue && atoi(argv[i + 1]) > 0) { options.ProbeDeadlineMs = (unsigned)atoi(argv[++i]); }
+        else if (arg == "--trace" && hasValue) { tracePath = argv[++i]; }
+        else { std::cerr << "Usage: WinReadyCheckLinux --agent <socket> [--root <dir>] [--refresh-every Section=Seconds] [--probe-timeout <ms>] [--trace <trace.json>]" << std::endl; return 1; }
+    }
+    if (rootPath == "/") rootPath.clear();
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+    OsInfo os; std::wstring hostName; GetOsInfoLinux(rootPath, os, hostName);
+    if (!hostName.empty()) options.MachineId = hostName;
+
+    ReadinessAgent agent(options, [rootPath](ProbeScheduler& scheduler, unsigned sections) { AddLinuxProbes(scheduler, rootPath, sections); });
+    agent.Start();
+    signal(SIGINT, OnStopSignal); signal(SIGTERM, OnStopSignal); signal(SIGPIPE, SIG_IGN);
+    std::cerr << "Starting agent on " << socketPath << " (Ctrl+C to stop)" << std::endl;
+    std::string error; const bool ok = RunAgentSocketServer(agent, socketPath, stopAgent, error);
+    agent.Stop();
+    if (!ok) std::cerr << "Error: " << error << std::endl;
+    if (!tracePath.empty()) {
+        TraceStop(); std::string traceError, summary; FormatTraceSummary(summary); std::cerr << summary;
+        if (!SaveChromeTrace(tracePath, traceError)) { std::cerr << "Error: " << traceError << std::endl; return 1; }
+    }
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "--agent") == 0) return RunAgentMode(argc, argv);
+
+    std::string targetKey = "all", rootPath, exportPath, tracePath;
+    ReportFormat format = isatty(STDOUT_FILENO) ? ReportAnsi : ReportPlain;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--target" && hasValue) { targetKey = argv[++i]; }
+        else if (arg == "--format" && hasValue && ParseReportFormat(argv[i + 1], format)) { ++i; }
+        else if (arg == "--root" && hasValue) { rootPath = argv[++i]; while (rootPath.size() > 1 && rootPath.back() == '/') rootPath.pop_back(); }
+        else if (arg == "--export" && hasValue) { exportPath = argv[++i]; }
+        else if (arg == "--trace" && hasValue) { tracePath = argv[++i]; }
+        else { std::cerr << "Usage: WinReadyCheckLinux [--target <Vista|7|8.1|10|11|all>] [--format ansi|plain|json|html] [--root <dir>] [--export <inventory.csv>] [--trace <trace.json>]" << std::endl; return 1; }
+    }
+    const bool allTargets = (targetKey == "all");
+    const int targetIndex = allTargets ? -1 : FindBuiltinTarget(Utf8ToWide(targetKey).c_str());
+    if (!allTargets && targetIndex < 0) { std::cerr << "Error: Unknown target '" << targetKey << "'. Use Vista, 7, 8.1, 10, 11 or all." << std::endl; return 1; }
+    if (rootPath == "/") rootPath.clear();
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+
+    // Every section is probed even for a single target: it costs about a millisecond and --export wants them all
+    MachineRecord machine; unsigned probed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    { TRACE_SPAN("Probe /proc and /sys", "probe"); probed = ProbeLinuxMachine(rootPath, SectionAll, machine); }
+    const double probeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "Probed %s in %.2f ms", rootPath.empty() ? "the live system" : rootPath.c_str(), probeMs);
+    if (probed != SectionAll) { // Missing files (containers, minimal fixture trees) leave defaults, which the checks report as [WARN]
+        fprintf(stderr, "; not detected:");
+        for (int i = 0; i < RecordSectionCount; ++i) { if (~probed & SectionAll & (1u << i)) fprintf(stderr, " %s", RecordSectionName(i)); }
+    }
+    fprintf(stderr, "\n");
+
+    if (!exportPath.empty()) {
+        std::ofstream out(exportPath.c_str(), std::ios::binary);
+        if (out) { WriteInventoryHeader(out); WriteInventoryRecord(out, machine); }
+        if (!out) { std::cerr << "Error: Cannot write " << exportPath << std::endl; return 1; }
+    }
+
+    std::unique_ptr<ReportRenderer> renderer = CreateReportRenderer(format);
+    std::string text; renderer->BeginDocument(text);
+    if (allTargets) {
+        TargetSummaryReport summary; summary.MachineId = WideToUtf8(machine.MachineId);
+        { TRACE_SPAN("Evaluate all targets", "report"); summary.Targets = EvaluateAllBuiltinTargets(ExtractFeatures(machine)); }
+        TRACE_SPAN("Render", "report"); renderer->Render(summary, text);
+    } else {
+        const WindowsRequirements& target = BUILTIN_TARGETS[targetIndex].Requirements; RequirementsReport report;
+        { TRACE_SPAN("Evaluate", "report"); BuildRequirementsReport(target, machine, EvaluateRequirements(target, machine), report); }
+        TRACE_SPAN("Render", "report"); renderer->Render(report, text);
+    }
+    renderer->EndDocument(text);
+    fwrite(text.data(), 1, text.size(), stdout); fflush(stdout);
+
+    if (!tracePath.empty()) {
+        TraceStop(); std::string error, summary; FormatTraceSummary(summary); std::cerr << summary;
+        if (!SaveChromeTrace(tracePath, error)) { std::cerr << "Error: " << error << std::endl; return 1; }
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "linux_probe.h"
+
+#ifndef _WIN32 // Listed in the portable Test target too; nothing to build on Windows
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>        // For strtoul / strtod
+#include <cctype>         // For toupper
+#include <set>
+#include <utility>
+#include <vector>
+#include <dirent.h>       // opendir / readdir
+#include <fcntl.h>        // open
+#include <sys/stat.h>     // stat
+#include <sys/statvfs.h>  // statvfs
+#include <unistd.h>       // read / close / readlink
+#include "cpu_list.h"     // MatchCpuList
+#include "inventory.h"    // Utf8ToWide
+
+// --- File Helpers (sysfs files report a size of 4096 whatever they hold, so read until EOF) ---
+static int ReadFile(const std::string& path, std::string& out, size_t limit = 1 << 20) { // 0 or errno
+    out.clear();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno ? errno : EIO;
+    char buffer[4096];
+    for (;;) {
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0) { if (errno == EINTR) continue; const int error = errno; close(fd); return error; }
+        if (count == 0 || out.size() >= limit) break;
+        out.append(buffer, (size_t)count);
+    }
+    close(fd);
+    return 0;
+}
+
+static std::string Trim(const std::string& text) {
+    size_t begin = 0, end = text.size();
+    while (begin < end && (unsigned char)text[begin] <= ' ') ++begin;
+    while (end > begin && (unsigned char)text[end - 1] <= ' ') --end;
+    return text.substr(begin, end - begin);
+}
+
+static bool ReadLine(const std::string& path, std::string& out) { // First line, trimmed
+    if (ReadFile(path, out, 4096) != 0) return false;
+    out = Trim(out.substr(0, out.find('\n')));
+    return true;
+}
+
+static bool ReadUnsigned(const std::string& path, unsigned long long& value) {
+    std::string text;
+    if (!ReadLine(path, text) || text.empty()) return false;
+    char* end = NULL; value = strtoull(text.c_str(), &end, 0);
+    return end != text.c_str();
+}
+
+static bool Exists(const std::string& path) { struct stat info; return stat(path.c_str(), &info) == 0; }
+
+static void ListDirectory(const std::string& path, std::vector<std::string>& names) { // Sorted, without "." and ".."
+    names.clear();
+    if (DIR* dir = opendir(path.c_str())) {
+        while (dirent* entry = readdir(dir)) { if (entry->d_name[0] != '.') names.push_back(entry->d_name); }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+}
+
+// "key\t: value" lines (/proc/cpuinfo, /proc/meminfo); calls visit(key, value) for each
+template <typename Visit> static void ForEachKeyValue(const std::string& text, char separator, Visit visit) {
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find('\n', begin); if (end == std::string::npos) end = text.size();
+        const size_t colon = text.find(separator, begin);
+        if (colon < end) visit(Trim(text.substr(begin, colon - begin)), Trim(text.substr(colon + 1, end - colon - 1)));
+        else visit(std::string(), std::string()); // Blank line: /proc/cpuinfo block boundary
+        begin = end + 1;
+    }
+}
+
+// --- CPU ---
+bool GetCpuInfoLinux(const std::string& root, CpuInfo& cpu) {
+    std::string text;
+    if (ReadFile(root + "/proc/cpuinfo", text) != 0) return false;
+    std::string modelName, flags, armArchitecture; unsigned logical = 0; double currentMHz = 0;
+    std::set<std::pair<std::string, std::string>> coreIds; std::string physicalId;
+    ForEachKeyValue(text, ':', [&](const std::string& key, const std::string& value) {
+        if (key == "processor") ++logical;
+        else if (key == "model name" && modelName.empty()) modelName = value;
+        else if (key == "flags" && flags.empty()) flags = " " + value + " ";
+        else if (key == "CPU architecture" && armArchitecture.empty()) armArchitecture = value;
+        else if (key == "cpu MHz" && currentMHz == 0) currentMHz = strtod(value.c_str(), NULL);
+        else if (key == "physical id") physicalId = value;
+        else if (key == "core id") coreIds.insert(std::make_pair(physicalId, value));
+    });
+
+    // Physical cores: distinct (package, core) pairs from sysfs topology, which also covers ARM; /proc/cpuinfo otherwise
+    std::vector<std::string> cpus; ListDirectory(root + "/sys/devices/system/cpu", cpus);
+    std::set<std::pair<unsigned long long, unsigned long long>> topology;
+    for (const std::string& name : cpus) {
+        if (name.compare(0, 3, "cpu") != 0 || name.size() < 4 || name.find_first_not_of("0123456789", 3) != std::string::npos) continue;
+        unsigned long long package = 0, core = 0; const std::string base = root + "/sys/devices/system/cpu/" + name + "/topology/";
+        if (ReadUnsigned(base + "core_id", core)) { ReadUnsigned(base + "physical_package_id", package); topology.insert(std::make_pair(package, core)); }
+    }
+    cpu.NumberOfCores = (UINT)(!topology.empty() ? topology.size() : coreIds.size());
+    cpu.NumberOfLogicalProcessors = logical;
+
+    // Rated base clock, the figure WMI's MaxClockSpeed reports: intel_pstate's base_frequency (kHz), the ACPI CPPC nominal
+    // clock (MHz), the "@ 2.40GHz" of the Intel model name. cpuinfo_max_freq is the boost clock and only a fallback (ARM
+    // and older drivers expose nothing else); the current clock only when cpufreq is missing too (VMs)
+    const std::string cpu0 = root + "/sys/devices/system/cpu/cpu0/"; unsigned long long clock = 0; double ratedGHz = 0;
+    const size_t at = modelName.rfind('@');
+    if (at != std::string::npos) { char* end = NULL; ratedGHz = strtod(modelName.c_str() + at + 1, &end); if (Trim(end).compare(0, 3, "GHz") != 0) ratedGHz = 0; }
+    if (ReadUnsigned(cpu0 + "cpufreq/base_frequency", clock) && clock) cpu.MaxClockSpeed = (UINT)(clock / 1000);
+    else if (ReadUnsigned(cpu0 + "acpi_cppc/nominal_freq", clock) && clock) cpu.MaxClockSpeed = (UINT)clock;
+    else if (ratedGHz > 0) cpu.MaxClockSpeed = (UINT)(ratedGHz * 1000 + 0.5);
+    else if (ReadUnsigned(cpu0 + "cpufreq/cpuinfo_max_freq", clock) && clock) cpu.MaxClockSpeed = (UINT)(clock / 1000);
+    else cpu.MaxClockSpeed = (UINT)(currentMHz + 0.5);
+
+    if (!flags.empty()) {
+        cpu.Is64BitCapable = flags.find(" lm ") != std::string::npos;
+        cpu.Architecture = cpu.Is64BitCapable ? L"x64 (64-bit)" : L"x86 (32-bit)";
+    } else if (!armArchitecture.empty()) {
+        cpu.Is64BitCapable = strtoul(armArchitecture.c_str(), NULL, 10) >= 8;
+        cpu.Architecture = cpu.Is64BitCapable ? L"ARM64" : L"ARM";
+    } else { cpu.Architecture = L"Unknown/Other"; }
+    cpu.Name = modelName.empty() ? L"N/A" : Utf8ToWide(modelName);
+    cpu.MinCpuGenerationLevel = modelName.empty() ? 0 : MatchCpuList(cpu.Name);
+    return logical > 0;
+}
+
+// --- RAM / Disk ---
+bool GetRamInfoLinux(const std::string& root, RamInfo& ram) {
+    std::string text; unsigned long long kb = 0;
+    if (ReadFile(root + "/proc/meminfo", text) != 0) return false;
+    ForEachKeyValue(text, ':', [&](const std::string& key, const std::string& value) { if (key == "MemTotal") kb = strtoull(value.c_str(), NULL, 10); });
+    ram.TotalPhysicalBytes = kb * 1024;
+    return kb > 0;
+}
+
+bool GetDiskInfoLinux(const std::string& root, DiskInfo& disk) {
+    struct statvfs info;
+    if (statvfs(root.empty() ? "/" : root.c_str(), &info) != 0) return false;
+    disk.TotalBytes = (ULONGLONG)info.f_blocks * info.f_frsize;
+    disk.FreeBytesAvailableToUser = (ULONGLONG)info.f_bavail * info.f_frsize;
+    disk.DriveLetter = L'/';
+    return true;
+}
+
+// --- OS ---
+bool GetOsInfoLinux(const std::string& root, OsInfo& os, std::wstring& hostName) {
+    std::string text, prettyName, versionId, release, arch, host;
+    if (ReadFile(root + "/etc/os-release", text) == 0 || ReadFile(root + "/usr/lib/os-release", text) == 0) {
+        ForEachKeyValue(text, '=', [&](const std::string& key, const std::string& value) {
+            std::string unquoted = value;
+            if (unquoted.size() >= 2 && (unquoted[0] == '"' || unquoted[0] == '\'') && unquoted.back() == unquoted[0]) unquoted = unquoted.substr(1, unquoted.size() - 2);
+            if (key == "PRETTY_NAME") prettyName = unquoted; else if (key == "VERSION_ID") versionId = unquoted;
+        });
+    }
+    if (ReadLine(root + "/proc/sys/kernel/osrelease", release)) os.BuildNumber = Utf8ToWide(release);
+    if (ReadLine(root + "/proc/sys/kernel/arch", arch)) os.OSArchitecture = arch.find("64") != std::string::npos ? L"64-bit" : L"32-bit";
+    if (ReadLine(root + "/proc/sys/kernel/hostname", host) && !host.empty()) hostName = Utf8ToWide(host);
+    os.Caption = prettyName.empty() ? L"Linux" : Utf8ToWide(prettyName);
+    if (!versionId.empty()) os.Version = Utf8ToWide(versionId);
+    os.ServicePackMajorVersion = L"N/A";
+    return !prettyName.empty() || !release.empty();
+}
+
+// --- Firmware / Security ---
+bool GetFirmwareTypeLinux(const std::string& root, FirmwareInfo& firmware) {
+    if (!Exists(root + "/sys")) return false; // No sysfs (chroot, container without /sys): unknown rather than BIOS
+    firmware.FirmwareType = Exists(root + "/sys/firmware/efi") ? FirmwareUefi : FirmwareBios;
+    firmware.Source = SourceApi;
+    return true;
+}
+
+static const char* SECURE_BOOT_VARIABLE = "SecureBoot-8be4df61-93ca-11d2-aa0d-00e098032b8c";
+
+bool GetSecurityInfoLinux(const std::string& root, SecurityInfo& sec, const FirmwareInfo& firmware) {
+    // --- TPM ---
+    const std::string tpm = root + "/sys/class/tpm/tpm0";
+    unsigned long long major = 0; std::string value;
+    if (Exists(tpm)) {
+        sec.TpmFound = true;
+        if (!ReadUnsigned(tpm + "/tpm_version_major", major)) major = Exists(tpm + "/device/caps") ? 1 : 2; // Kernels before 5.6: 1.2 drivers expose caps
+        sec.TpmSpecVersionMajor = (UINT32)major; sec.TpmSpecVersionMinor = major == 1 ? 2 : 0;
+        sec.TpmVersionString = major == 1 ? L"1.2" : L"2.0";
+        // TPM 2.0 devices are only registered once the firmware has enabled them; 1.2 reports enabled/active separately
+        sec.TpmEnabled = major >= 2 || ((!ReadLine(tpm + "/device/enabled", value) || value == "1") && (!ReadLine(tpm + "/device/active", value) || value == "1"));
+    } else { sec.TpmFound = false; sec.TpmEnabled = false; sec.TpmVersionString = L"Not Found"; }
+
+    // --- Secure Boot (efivarfs: 4 attribute bytes, then the 1-byte value; the older sysfs efivars interface has a data file) ---
+    auto SetSecureBoot = [&](SecureBootState state) { sec.SecureBoot = state; sec.SecureBootSource = SourceApi; };
+    if (firmware.FirmwareType == FirmwareBios) { sec.SecureBoot = SecureBootNotApplicable; sec.SecureBootSource = SourceNone; sec.SecureBootCapable = false; sec.SecureBootEnabled = false; return true; }
+    if (firmware.FirmwareType != FirmwareUefi) { sec.SecureBoot = SecureBootUnknown; return true; }
+    std::string data; size_t header = 4;
+    int error = ReadFile(root + "/sys/firmware/efi/efivars/" + SECURE_BOOT_VARIABLE, data, 64);
+    if (error == ENOENT) { header = 0; error = ReadFile(root + "/sys/firmware/efi/vars/" + SECURE_BOOT_VARIABLE + "/data", data, 64); }
+    if (error == 0 && data.size() > header) { sec.SecureBootCapable = true; sec.SecureBootEnabled = (data[header] == 1); SetSecureBoot(sec.SecureBootEnabled ? SecureBootOn : SecureBootOff); }
+    else if (error == 0) { SetSecureBoot(SecureBootQueryFailed); sec.SecureBootErrorCode = EIO; } // Variable present but cut short: unresolved, not absent
+    else if (error == ENOENT) { sec.SecureBootCapable = false; SetSecureBoot(SecureBootNotFound); }
+    else if (error == EACCES || error == EPERM) SetSecureBoot(SecureBootNeedsAdmin);
+    else { SetSecureBoot(SecureBootQueryFailed); sec.SecureBootErrorCode = (UINT32)error; }
+    return true;
+}
+
+// --- Graphics / Display (DRM) ---
+bool GetGraphicsInfoLinux(const std::string& root, GraphicsInfo& graphics) {
+    std::vector<std::string> cards; ListDirectory(root + "/sys/class/drm", cards);
+    for (const std::string& card : cards) {
+        if (card.compare(0, 4, "card") != 0 || card.find('-') != std::string::npos) continue; // "card0", not "card0-HDMI-A-1"
+        const std::string device = root + "/sys/class/drm/" + card + "/device";
+        std::string vendor, id;
+        if (!ReadLine(device + "/vendor", vendor) || !ReadLine(device + "/device", id)) continue;
+        char target[256]; ssize_t length = readlink((device + "/driver").c_str(), target, sizeof(target) - 1);
+        std::string driver = length > 0 ? std::string(target, (size_t)length) : std::string();
+        driver = driver.substr(driver.find_last_of('/') + 1);
+        for (std::string* hex : { &vendor, &id }) { if (hex->compare(0, 2, "0x") == 0) hex->erase(0, 2); for (char& c : *hex) c = (char)toupper((unsigned char)c); }
+        graphics.Name = Utf8ToWide("PCI " + vendor + ":" + id + (driver.empty() ? std::string() : " (" + driver + ")"));
+        graphics.VideoProcessor = Utf8ToWide(driver.empty() ? std::string("N/A") : driver);
+        unsigned long long vram = 0; // amdgpu only; capped like Win32_VideoController.AdapterRAM
+        if (ReadUnsigned(device + "/mem_info_vram_total", vram)) graphics.AdapterRAM = (UINT32)(vram > 0xFFFFFFFFULL ? 0xFFFFFFFFULL : vram);
+        return true;
+    }
+    return false;
+}
+
+bool GetScreenResolutionLinux(const std::string& root, ScreenInfo& screen) {
+    std::vector<std::string> outputs; ListDirectory(root + "/sys/class/drm", outputs);
+    for (const std::string& output : outputs) {
+        if (output.compare(0, 4, "card") != 0 || output.find('-') == std::string::npos) continue;
+        std::string status, mode; const std::string base = root + "/sys/class/drm/" + output;
+        if (!ReadLine(base + "/status", status) || status != "connected" || !ReadLine(base + "/modes", mode)) continue;
+        int width = 0, height = 0;
+        if (sscanf(mode.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0) { screen.Width = width; screen.Height = height; return true; }
+    }
+    return false;
+}
+
+// --- Whole Machine ---
+unsigned ProbeLinuxMachine(const std::string& root, unsigned sections, MachineRecord& record) {
+    unsigned succeeded = 0; std::wstring hostName;
+    if ((sections & SectionCpu) && GetCpuInfoLinux(root, record.Cpu)) succeeded |= SectionCpu;
+    if ((sections & SectionRam) && GetRamInfoLinux(root, record.Ram)) succeeded |= SectionRam;
+    if ((sections & SectionDisk) && GetDiskInfoLinux(root, record.Disk)) succeeded |= SectionDisk;
+    if (GetOsInfoLinux(root, record.Os, hostName) && (sections & SectionOs)) succeeded |= SectionOs;   // Also names the machine
+    if (!hostName.empty()) record.MachineId = hostName;
+    if ((sections & (SectionFirmware | SectionSecurity)) && GetFirmwareTypeLinux(root, record.Firmware)) succeeded |= SectionFirmware & sections;
+    if ((sections & SectionSecurity) && GetSecurityInfoLinux(root, record.Security, record.Firmware)) succeeded |= SectionSecurity;
+    if ((sections & SectionGraphics) && GetGraphicsInfoLinux(root, record.Graphics)) succeeded |= SectionGraphics;
+    if ((sections & SectionScreen) && GetScreenResolutionLinux(root, record.Screen)) succeeded |= SectionScreen;
+    if (sections & SectionDirectX) { record.DirectX.InstalledVersion = L"N/A (Linux)"; succeeded |= SectionDirectX; }
+    return succeeded;
+}
+
+void AddLinuxProbes(ProbeScheduler& scheduler, const std::string& root, unsigned sections) {
+    auto Add = [&](const char* name, unsigned section, unsigned dependsOn, std::function<bool(MachineRecord&)> run) { if (sections & section) scheduler.AddProbe(std::make_shared<FunctionProbe>(name, section, dependsOn, run)); };
+    Add("CPU", SectionCpu, 0, [root](MachineRecord& r) { return GetCpuInfoLinux(root, r.Cpu); });
+    Add("RAM", SectionRam, 0, [root](MachineRecord& r) { return GetRamInfoLinux(root, r.Ram); });
+    Add("System Disk", SectionDisk, 0, [root](MachineRecord& r) { return GetDiskInfoLinux(root, r.Disk); });
+    Add("Operating System", SectionOs, 0, [root](MachineRecord& r) { std::wstring host; return GetOsInfoLinux(root, r.Os, host); });
+    Add("Firmware", SectionFirmware, 0, [root](MachineRecord& r) { return GetFirmwareTypeLinux(root, r.Firmware); });
+    Add("Screen Resolution", SectionScreen, 0, [root](MachineRecord& r) { return GetScreenResolutionLinux(root, r.Screen); });
+    Add("DirectX Runtime", SectionDirectX, 0, [](MachineRecord& r) { r.DirectX.InstalledVersion = L"N/A (Linux)"; return true; });
+    Add("Security Features", SectionSecurity, SectionFirmware, [root](MachineRecord& r) { return GetSecurityInfoLinux(root, r.Security, r.Firmware); }); // Needs the firmware type
+    Add("Graphics Card", SectionGraphics, 0, [root](MachineRecord& r) { return GetGraphicsInfoLinux(root, r.Graphics); });
+}
+
+#endif // _WIN32
@@ -0,0 +1,41 @@
+#ifndef LINUX_PROBE_H_INCLUDED
+#define LINUX_PROBE_H_INCLUDED
+
+#include <string>
+#include "probe.h"
+#include "sysinfo.h"
+
+// --- Linux Detection Backend (separate "Linux" build target; POSIX only) ---
+// Fills the same info structs as the Win32/WMI probes from the kernel's own files, so a Linux or dual-boot machine can
+// be assessed for a Windows migration with the unchanged evaluation and report code. Plain file reads, one statvfs()
+// and a few directory listings: no subprocesses, no libraries, a full probe takes about a millisecond.
+//
+//   Cpu       /proc/cpuinfo, /sys/devices/system/cpu/cpu*/topology, cpu0 base clock (cpufreq/base_frequency,
+//             acpi_cppc/nominal_freq, the model name's "@ x.xxGHz"; cpufreq/cpuinfo_max_freq, the boost clock, as fallback)
+//   Ram       /proc/meminfo (MemTotal)
+//   Disk      statvfs() of the root file system
+//   Os        /etc/os-release, /proc/sys/kernel/{osrelease,arch,hostname}
+//   Firmware  /sys/firmware/efi present -> UEFI, otherwise BIOS
+//   Security  /sys/class/tpm/tpm0 (tpm_version_major, device/enabled for 1.2) and the SecureBoot-8be4df61-... EFI variable;
+//             a variable too short to hold its value is a failed query, not "not found"
+//   Graphics  /sys/class/drm/card*/device (PCI vendor/device ids, kernel driver); DirectX/WDDM levels do not exist on
+//             Linux and stay undetected, which the checks report as [WARN] like an unknown adapter on Windows
+//   Screen    /sys/class/drm/card*-*/{status,modes}: preferred mode of the first connected output
+//
+// root prefixes every path ("" = the live system), so the probes run unchanged against a copied or fixture tree.
+bool GetCpuInfoLinux(const std::string& root, CpuInfo& cpu);
+bool GetRamInfoLinux(const std::string& root, RamInfo& ram);
+bool GetDiskInfoLinux(const std::string& root, DiskInfo& disk);
+bool GetOsInfoLinux(const std::string& root, OsInfo& os, std::wstring& hostName);
+bool GetFirmwareTypeLinux(const std::string& root, FirmwareInfo& firmware);
+bool GetSecurityInfoLinux(const std::string& root, SecurityInfo& security, const FirmwareInfo& firmware);
+bool GetGraphicsInfoLinux(const std::string& root, GraphicsInfo& graphics);
+bool GetScreenResolutionLinux(const std::string& root, ScreenInfo& screen);
+
+// Runs the probes for the given RecordSection bits (Secure Boot reads the firmware type first); returns the sections
+// whose probe succeeded
+unsigned ProbeLinuxMachine(const std::string& root, unsigned sections, MachineRecord& record);
+// The same probes as scheduler entries, one per RecordSection bit in sections (the --agent refresh rounds)
+void AddLinuxProbes(ProbeScheduler& scheduler, const std::string& root, unsigned sections);
+
+#endif // LINUX_PROBE_H_INCLUDED
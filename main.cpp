@@ -8,13 +8,42 @@
 #include <comdef.h>       // For _com_error, VARIANT types, _bstr_t
 #include <wbemidl.h>      // Main WMI header
 #include <sstream>        // For converting numbers to strings (stringstream)
-#include <map>            // Needed for requirements DB (std::map)
 #include <winreg.h>       // Needed for registry access (RegOpenKeyExW, etc.)
 #include <wincon.h>       // Required for console color functions (GetStdHandle, etc.)
 #include <limits>         // Required for numeric_limits (used for clearing cin errors)
 #include <ios>            // Required for streamsize
-#include <cwchar>         // For wcstok_s (needed in GetSecurityInfo)
+#include <cwchar>         // For wcstok_s (needed in GetSecurityInfo) and wcscmp
 #include <cctype>         // For toupper
+#include <cstring>        // For strcmp (command line parsing)
+#include <cstdlib>        // For atoi (command line parsing)
+#include <cstdio>         // For fwrite (redirected report output)
+#include "sysinfo.h"      // Info structs, MachineRecord and WindowsRequirements
+#include "evaluate.h"     // Pure requirement evaluation core
+#include "requirements.h" // Built-in constexpr requirement profiles
+#include "batch.h"        // Headless fleet batch mode
+#include "fleet_file.h"   // Binary fleet file packing
+#include "probe.h"        // Concurrent detection probes with deadlines
+#include "snapshot.h"     // Cached probe results with per-section TTL
+#include "report.h"       // Buffered report renderers (ANSI, plain, JSON, HTML)
+#include "inventory.h"    // Utf8ToWide (report buffers are UTF-8)
+#include "cpu_list.h"     // Windows 11 supported-processor list
+#include "profile_index.h" // Custom baseline profiles (--batch --profiles)
+#include "trace.h"        // --trace spans and counters
+#include "aggregate.h"    // Fleet summary (--batch --aggregate)
+#include "result_cache.h" // Incremental batch runs (--batch --cache)
+#include "upgrade_plan.h" // Cheapest upgrades to pass a target (--plan, --sweep)
+#include "columnar.h"     // FeatureColumns (--sweep loads the whole fleet)
+#include "agent.h"        // Resident readiness agent (--agent)
+#include "result_store.h" // Columnar verdict history (--batch --store, --query)
+#include "sketch.h"       // Fixed-size fleet statistics (--batch --sketch, --sketch-report)
+#include "shard.h"        // Multi-process batch runs (--batch --processes)
+#include <ctime>          // For time (snapshot timestamps)
+#include <functional>     // For std::function (probe bodies)
+#include <memory>         // For std::shared_ptr (probes)
+#include <fstream>        // For std::ofstream (--aggregate summary)
+#include <chrono>         // For steady_clock (--sweep timing)
+#include <thread>         // For hardware_concurrency (--sweep workers, --processes thread budget)
+#include <atomic>         // For the --agent stop flag
 
 // --- Console Color Definitions ---
 #define FG_BLACK            0
@@ -68,71 +97,120 @@ void InitConsoleColor() {
 }
 void SetConsoleColor(WORD color) { if (hConsole != INVALID_HANDLE_VALUE) SetConsoleTextAttribute(hConsole, color); }
 void ResetConsoleColor() { if (hConsole != INVALID_HANDLE_VALUE) SetConsoleTextAttribute(hConsole, defaultConsoleAttributes); }
-// --- End Console Color ---
 
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+bool consoleAnsi = false; // Console interprets ANSI escapes itself (Windows 10+)
+
+// Default report format: ANSI colors on a console (older consoles get them translated in WriteReport), plain text when redirected
+ReportFormat DefaultReportFormat() {
+    DWORD mode = 0;
+    if (hConsole == INVALID_HANDLE_VALUE || !GetConsoleMode(hConsole, &mode)) return ReportPlain;
+    consoleAnsi = (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) || SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    return ReportAnsi;
+}
 
-// --- Structures for Collected System Info ---
-struct CpuInfo {
-    std::wstring Name = L"N/A"; std::wstring Architecture = L"N/A"; UINT MaxClockSpeed = 0;
-    UINT NumberOfCores = 0; UINT NumberOfLogicalProcessors = 0; bool Is64BitCapable = false;
-    UINT MinCpuGenerationLevel = 0; // Used only in Simulation Mode for Win11 check proxy
-};
-struct RamInfo { ULONGLONG TotalPhysicalBytes = 0; };
-struct DiskInfo { ULONGLONG TotalBytes = 0; ULONGLONG FreeBytesAvailableToUser = 0; wchar_t DriveLetter = L'?'; };
-struct OsInfo { std::wstring Caption = L"N/A"; std::wstring Version = L"N/A"; std::wstring BuildNumber = L"N/A"; std::wstring OSArchitecture = L"N/A"; std::wstring ServicePackMajorVersion = L"N/A"; };
-struct FirmwareInfo { std::wstring FirmwareType = L"Unknown"; };
-struct GraphicsInfo { std::wstring Name = L"N/A"; UINT32 AdapterRAM = 0; std::wstring DriverVersion = L"N/A"; std::wstring VideoProcessor = L"N/A"; std::wstring DirectXFeatureLevel = L"N/A"; std::wstring WDDMVersion = L"N/A"; };
-struct ScreenInfo { int Width = 0; int Height = 0; };
-struct SecurityInfo { bool TpmEnabled = false; bool TpmFound = false; UINT32 TpmSpecVersionMajor = 0; UINT32 TpmSpecVersionMinor = 0; std::wstring TpmVersionString = L"N/A"; bool SecureBootEnabled = false; bool SecureBootCapable = false; std::wstring SecureBootStatus = L"N/A"; };
-struct DirectXInfo { std::wstring InstalledVersion = L"N/A"; };
-
-
-// --- Requirements Structure ---
-struct WindowsRequirements {
-    std::wstring Name;
-    UINT MinCpuSpeedMHz = 0; UINT MinCpuCores = 0; bool Require64Bit = false; UINT MinCpuGenerationLevel = 0;
-    ULONGLONG MinRamBytes = 0; ULONGLONG MinDiskFreeBytes = 0;
-    UINT MinDirectXFeatureLevelMajor = 0; UINT MinWDDMVersionMajor = 0;
-    UINT MinScreenWidth = 0; UINT MinScreenHeight = 0;
-    bool RequireUEFI = false; bool RequireSecureBoot = false; bool RequireTpm = false; UINT MinTpmVersionMajor = 0;
-    bool RequireInternetForSetup = false;
-};
+WORD AnsiToConsoleColor(long sgr) {
+    switch (sgr) {
+        case 90: return FG_DARK_GRAY; case 91: return FG_LIGHT_RED; case 92: return FG_LIGHT_GREEN; case 93: return FG_LIGHT_YELLOW;
+        case 94: return FG_LIGHT_BLUE; case 96: return FG_LIGHT_CYAN; case 97: return FG_WHITE; default: return defaultConsoleAttributes;
+    }
+}
+
+// Writes a rendered report with one call: WriteConsoleW on a console (so non-ASCII names survive), fwrite otherwise.
+// Consoles without ANSI support get the buffer replayed segment by segment with SetConsoleTextAttribute instead.
+void WriteReport(const std::string& text) {
+    std::cout.flush();
+    DWORD mode = 0, written = 0;
+    if (hConsole == INVALID_HANDLE_VALUE || !GetConsoleMode(hConsole, &mode)) { fwrite(text.data(), 1, text.size(), stdout); fflush(stdout); return; }
+    const std::wstring wide = Utf8ToWide(text);
+    if (consoleAnsi || wide.find(L'\x1b') == std::wstring::npos) { WriteConsoleW(hConsole, wide.c_str(), (DWORD)wide.size(), &written, NULL); return; }
+    size_t start = 0;
+    while (start < wide.size()) {
+        size_t escape = wide.find(L'\x1b', start); if (escape == std::wstring::npos) escape = wide.size();
+        if (escape > start) WriteConsoleW(hConsole, wide.c_str() + start, (DWORD)(escape - start), &written, NULL);
+        const size_t end = wide.find(L'm', escape); if (end == std::wstring::npos) break;
+        SetConsoleColor(AnsiToConsoleColor(wcstol(wide.c_str() + escape + 2, NULL, 10)));
+        start = end + 1;
+    }
+}
+// --- End Console Color ---
 
-// --- Global Requirements Database ---
-std::map<std::wstring, WindowsRequirements> windowsRequirementsDB;
 
 // --- Function Prototypes ---
 bool InitializeWMI(IWbemServices*& pSvc);
 void CleanupWMI(IWbemServices* pSvc);
 bool GetCpuInfoWMI(IWbemServices* pSvc, CpuInfo& cpuInfo);
+bool GetCpuInfoAPI(CpuInfo& cpuInfo); // Registry + GetLogicalProcessorInformation, used when WMI is not connected
 bool GetRamInfoAPI(RamInfo& ramInfo);
 bool GetDiskInfoAPI(DiskInfo& diskInfo);
 bool GetOsInfoWMI(IWbemServices* pSvc, OsInfo& osInfo);
 bool GetFirmwareTypeAPI(FirmwareInfo& firmwareInfo);
 bool GetGraphicsInfoWMI(IWbemServices* pSvc, GraphicsInfo& graphicsInfo);
+bool GetGraphicsInfoAPI(GraphicsInfo& graphicsInfo); // EnumDisplayDevices, used when WMI is not connected
 bool GetScreenResolutionAPI(ScreenInfo& screenInfo);
 bool GetSecurityInfo(IWbemServices* pSvc, SecurityInfo& secInfo, const FirmwareInfo& firmwareInfo);
 bool GetDirectXVersionRegistry(DirectXInfo& dxInfo);
 std::wstring GetProcessorArchitectureString(WORD processorArchitecture);
-void PopulateRequirementsDB();
 bool GetSimulatedSystemInfo(CpuInfo& cpu, RamInfo& ram, DiskInfo& disk, OsInfo& os, FirmwareInfo& firm, GraphicsInfo& graph, ScreenInfo& screen, SecurityInfo& sec, DirectXInfo& dx);
-void CompareRequirements(const WindowsRequirements& target, const CpuInfo& cpu, const RamInfo& ram, const DiskInfo& disk, const OsInfo& os, const FirmwareInfo& firm, const GraphicsInfo& graph, const ScreenInfo& screen, const SecurityInfo& sec, const DirectXInfo& dx);
+void CompareRequirements(const WindowsRequirements& target, const MachineRecord& machine, const ReportRenderer& renderer);
+void PrintHighestSupported(const MachineRecord& machine, const ReportRenderer& renderer); // One-line answer across all built-in targets
+void PrintUpgradePlan(const WindowsRequirements& target, const MachineRecord& machine, const UpgradeCosts& costs); // --plan
+int RunBatchMode(int argc, char* argv[]); // Non-interactive --batch entry point
+int RunPackMode(int argc, char* argv[]);  // --pack: CSV inventory -> binary fleet file
+int RunQueryMode(int argc, char* argv[]); // --query: filtered verdicts from a --store file
+int RunSketchReportMode(int argc, char* argv[]); // --sketch-report: merged summary of --sketch files
+int RunAgentMode(int argc, char* argv[]); // --agent: resident, answers readiness queries on a named pipe
+void AddLiveProbes(ProbeScheduler& scheduler, IWbemServices* pSvc, bool wmiInitialized, unsigned sections); // One probe per RecordSection bit in sections
+std::string DefaultSnapshotPath();
+std::wstring GetHostName();
+void FinishTrace(const std::string& tracePath); // Stops recording, writes the --trace file and prints the span summary to stderr
 int GetIntInput(const std::string& prompt); // Helper for simulation
 bool GetBoolInput(const std::string& prompt); // Helper for simulation
 
 
 // --- Main Function ---
-int main() {
+int main(int argc, char* argv[]) {
     InitConsoleColor(); // Initialize console color handling first
 
+    // --- Headless Batch Mode (no prompts, no WMI; stdout carries only verdicts) ---
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) { return RunBatchMode(argc, argv); }
+    if (argc > 1 && strcmp(argv[1], "--pack") == 0) { return RunPackMode(argc, argv); }
+    if (argc > 1 && strcmp(argv[1], "--query") == 0) { return RunQueryMode(argc, argv); }
+    if (argc > 1 && strcmp(argv[1], "--sketch-report") == 0) { return RunSketchReportMode(argc, argv); }
+    if (argc > 1 && strcmp(argv[1], "--agent") == 0) { return RunAgentMode(argc, argv); }
+
+    unsigned probeDeadlineMs = 15000; // Per-probe deadline for live detection (--probe-timeout <ms>)
+    bool refreshSnapshot = false;     // --refresh: ignore cached results and re-probe everything
+    std::string snapshotPath;         // --snapshot <path>: cache location (default under %LOCALAPPDATA%)
+    ReportFormat reportFormat = DefaultReportFormat(); // --format <ansi|plain|json|html>
+    std::wstring targetOSKey;         // --target <key|all>: skips the target prompt
+    std::string tracePath;            // --trace <file.json>: Chrome trace of probes, WMI calls and report phases
+    bool showPlan = false;            // --plan: cheapest upgrades that make the machine pass (--cost Name=Value adjusts the weights)
+    UpgradeCosts upgradeCosts;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--probe-timeout") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) { probeDeadlineMs = (unsigned)atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--refresh") == 0) { refreshSnapshot = true; }
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) { snapshotPath = argv[++i]; }
+        else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) { std::string key = argv[++i]; targetOSKey.assign(key.begin(), key.end()); }
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc && ParseReportFormat(argv[i + 1], reportFormat)) { ++i; }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) { tracePath = argv[++i]; }
+        else if (strcmp(argv[i], "--plan") == 0) { showPlan = true; }
+        else if (strcmp(argv[i], "--cost") == 0 && i + 1 < argc) {
+            std::string costError;
+            if (!SetUpgradeCost(upgradeCosts, argv[++i], costError)) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: " << costError << std::endl; ResetConsoleColor(); }
+        }
+        else { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: Ignoring unknown option '" << argv[i] << "'." << std::endl; ResetConsoleColor(); }
+    }
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+
     HRESULT hres;
+    bool comInitialized = false;
     bool wmiInitialized = false;
     IWbemServices* pSvc = NULL;
     bool simulationMode = false; // Flag for simulation mode
 
-    // --- Populate Requirements Database ---
-    PopulateRequirementsDB();
-
     // --- Mode Selection ---
     char modeChoice = ' ';
     while (modeChoice != 'L' && modeChoice != 'S') {
@@ -145,10 +223,33 @@ int main() {
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear input buffer
     }
 
+    // --- Target OS Selection ---
+    // Chosen before detection so live mode only runs the probes the target's checks need
+    int targetIndex = targetOSKey.empty() ? -1 : FindBuiltinTarget(targetOSKey.c_str());
+    bool allTargets = (targetOSKey == L"all" || targetOSKey == L"ALL");
+    if (!targetOSKey.empty() && targetIndex < 0 && !allTargets) { SetConsoleColor(COLOR_ERROR); std::wcerr << L"Invalid key '" << targetOSKey << L"'." << std::endl; ResetConsoleColor(); }
+    while (targetIndex < 0 && !allTargets) {
+        SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Select Target Windows Version ---" << std::endl; ResetConsoleColor();
+        SetConsoleColor(COLOR_LABEL); std::cout << "Available keys: ";
+        for (const BuiltinTarget& builtin : BUILTIN_TARGETS) { std::wcout << builtin.Key << L" "; }
+        std::cout << std::endl; ResetConsoleColor();
+        std::cout << "Enter target OS key (e.g., 11, or 'all' for the highest supported version): ";
+        std::wcin >> targetOSKey;
+        std::wcin.ignore(std::numeric_limits<std::streamsize>::max(), L'\n'); // Clear buffer after wcin
+
+        targetIndex = FindBuiltinTarget(targetOSKey.c_str());
+        allTargets = (targetOSKey == L"all" || targetOSKey == L"ALL");
+        if (targetIndex < 0 && !allTargets) {
+            SetConsoleColor(COLOR_ERROR); std::wcerr << L"Invalid key '" << targetOSKey << L"'. Please try again." << std::endl; ResetConsoleColor();
+            std::wcin.clear(); // Clear error flags if any
+        }
+    }
+
     // --- Declare Info Structs ---
-    CpuInfo cpuDetails = {}; RamInfo ramDetails = {}; DiskInfo diskDetails = {}; OsInfo osDetails = {};
-    FirmwareInfo firmwareDetails = {}; GraphicsInfo graphicsDetails = {}; ScreenInfo screenDetails = {};
-    SecurityInfo securityDetails = {}; DirectXInfo directXDetails = {};
+    MachineRecord machine;
+    CpuInfo& cpuDetails = machine.Cpu; RamInfo& ramDetails = machine.Ram; DiskInfo& diskDetails = machine.Disk; OsInfo& osDetails = machine.Os;
+    FirmwareInfo& firmwareDetails = machine.Firmware; GraphicsInfo& graphicsDetails = machine.Graphics; ScreenInfo& screenDetails = machine.Screen;
+    SecurityInfo& securityDetails = machine.Security; DirectXInfo& directXDetails = machine.DirectX;
 
 
     if (modeChoice == 'S') {
@@ -166,85 +267,94 @@ int main() {
         simulationMode = false;
         SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Running Live System Detection ---" << std::endl; ResetConsoleColor();
 
-        // Initialize COM/WMI (only needed for live detection)
-        hres = CoInitializeEx(0, COINIT_MULTITHREADED);
-        if (FAILED(hres)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Fatal Error: Failed to initialize COM library. Error code = 0x" << std::hex << hres << std::endl; ResetConsoleColor(); /* Decide if exit needed */ }
-        hres = CoInitializeSecurity( NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL );
-        if (FAILED(hres) && hres != RPC_E_TOO_LATE) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: Failed to initialize security. Error code = 0x" << std::hex << hres << ". WMI queries might fail." << std::endl; ResetConsoleColor(); }
-        else { SetConsoleColor(COLOR_SUCCESS); std::cout << "COM Initialized Successfully!" << std::endl; ResetConsoleColor(); }
-        wmiInitialized = InitializeWMI(pSvc);
-        if (!wmiInitialized) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Could not initialize WMI connection. WMI-dependent info will be unavailable." << std::endl; ResetConsoleColor(); }
-        else { SetConsoleColor(COLOR_SUCCESS); std::cout << "WMI Connected Successfully!" << std::endl; ResetConsoleColor(); }
-
-        SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Gathering System Information ---" << std::endl; ResetConsoleColor();
-
-        // Call all Get... functions
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking CPU..." << std::endl; ResetConsoleColor();
-        GetCpuInfoWMI(pSvc, cpuDetails); // Handles WMI fail + API fallback inside
-
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking RAM..." << std::endl; ResetConsoleColor();
-        GetRamInfoAPI(ramDetails); // Logs error inside
-
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking System Disk..." << std::endl; ResetConsoleColor();
-        GetDiskInfoAPI(diskDetails); // Logs error inside
-
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking Operating System..." << std::endl; ResetConsoleColor();
-        GetOsInfoWMI(pSvc, osDetails); // Handles WMI fail + API fallback inside
-
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking Firmware..." << std::endl; ResetConsoleColor();
-        GetFirmwareTypeAPI(firmwareDetails); // Logs error/info inside
+        // --- Probes the Target Needs (see RequiredSections; e.g. Vista-10 need no TPM/Secure Boot, so no WMI) ---
+        const unsigned neededSections = allTargets ? AllTargetsRequiredSections() : RequiredSections(BUILTIN_TARGETS[targetIndex].Requirements);
+
+        // --- Probe Snapshot (recently probed sections are reused; the rest are probed below) ---
+        const long long now = (long long)time(NULL);
+        if (snapshotPath.empty()) snapshotPath = DefaultSnapshotPath();
+        ProbeSnapshot snapshot; std::string snapshotError; unsigned cachedSections = 0;
+        const std::wstring hostName = GetHostName();
+        bool snapshotLoaded;
+        { TRACE_SPAN("Load snapshot", "snapshot"); snapshotLoaded = !refreshSnapshot && LoadSnapshotFile(snapshotPath, snapshot, snapshotError); }
+        if (snapshotLoaded) cachedSections = UseSnapshotSections(snapshot, hostName, DefaultSnapshotPolicy(), neededSections, now, machine);
+        else if (!snapshotError.empty()) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: Ignoring probe snapshot. " << snapshotError << std::endl; ResetConsoleColor(); }
+        if (snapshot.Host != hostName) { snapshot = ProbeSnapshot(); snapshot.Host = hostName; } // Refresh, no snapshot, or copied from another machine
+        if (cachedSections) {
+            SetConsoleColor(COLOR_INFO); std::cout << "Using cached results for:";
+            for (int i = 0; i < RecordSectionCount; ++i) { if (cachedSections & (1u << i)) std::cout << " " << RecordSectionName(i); }
+            std::cout << " (use --refresh to re-check everything)" << std::endl; ResetConsoleColor();
+        }
+        if (SectionAll & ~neededSections) {
+            SetConsoleColor(COLOR_INFO); std::cout << "Not needed for this target:";
+            for (int i = 0; i < RecordSectionCount; ++i) { if (~neededSections & (1u << i)) std::cout << " " << RecordSectionName(i); }
+            std::cout << std::endl; ResetConsoleColor();
+        }
 
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking Screen Resolution..." << std::endl; ResetConsoleColor();
-        GetScreenResolutionAPI(screenDetails); // Logs warning inside
+        const unsigned probeSections = neededSections & ~cachedSections;
+
+        // Initialize COM/WMI (only needed for the OS and TPM queries; CPU and graphics fall back to the registry / display APIs)
+        if (probeSections & (SectionOs | SectionSecurity)) {
+            TRACE_SPAN("COM/WMI setup", "wmi");
+            { TRACE_SPAN("CoInitializeEx", "wmi"); hres = CoInitializeEx(0, COINIT_MULTITHREADED); }
+            if (FAILED(hres) && hres != RPC_E_CHANGED_MODE) { SetConsoleColor(COLOR_ERROR); std::cerr << "Fatal Error: Failed to initialize COM library. Error code = 0x" << std::hex << hres << std::endl; ResetConsoleColor(); /* Decide if exit needed */ }
+            comInitialized = SUCCEEDED(hres); // RPC_E_CHANGED_MODE: COM is usable in the existing apartment, but this call did not initialize it
+            { TRACE_SPAN("CoInitializeSecurity", "wmi"); hres = CoInitializeSecurity( NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL ); }
+            if (FAILED(hres) && hres != RPC_E_TOO_LATE) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: Failed to initialize security. Error code = 0x" << std::hex << hres << ". WMI queries might fail." << std::endl; ResetConsoleColor(); }
+            else { SetConsoleColor(COLOR_SUCCESS); std::cout << "COM Initialized Successfully!" << std::endl; ResetConsoleColor(); }
+            { TRACE_SPAN("InitializeWMI", "wmi"); wmiInitialized = InitializeWMI(pSvc); }
+            if (!wmiInitialized) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Could not initialize WMI connection. WMI-dependent info will be unavailable." << std::endl; ResetConsoleColor(); }
+            else { SetConsoleColor(COLOR_SUCCESS); std::cout << "WMI Connected Successfully!" << std::endl; ResetConsoleColor(); }
+        }
 
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking DirectX Runtime..." << std::endl; ResetConsoleColor();
-        GetDirectXVersionRegistry(directXDetails); // Logs info/error inside
+        SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Gathering System Information ---" << std::endl; ResetConsoleColor();
 
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking Security Features..." << std::endl; ResetConsoleColor();
-        GetSecurityInfo(pSvc, securityDetails, firmwareDetails); // Logs status/errors inside
+        // Run all Get... functions concurrently; each has its own deadline, and a probe that hangs (e.g. a wedged WMI
+        // provider) is abandoned so its checks show up as [WARN] instead of blocking the whole report
+        ProbeScheduler scheduler(probeDeadlineMs);
+        AddLiveProbes(scheduler, pSvc, wmiInitialized, probeSections);
+        std::vector<ProbeOutcome> probeOutcomes;
+        scheduler.Run(machine, probeOutcomes, [](const SystemProbe& probe) { SetConsoleColor(COLOR_LABEL); std::cout << "Checking " << probe.Name() << "..." << std::endl; ResetConsoleColor(); });
+        for (const ProbeOutcome& outcome : probeOutcomes) {
+            if (outcome.State != ProbeTimedOut) continue;
+            SetConsoleColor(COLOR_WARNING); std::cerr << "  Warning: " << outcome.Name << " check timed out after " << probeDeadlineMs << " ms. Its results will be reported as [WARN]." << std::endl; ResetConsoleColor();
+        }
 
-        SetConsoleColor(COLOR_LABEL); std::cout << "Checking Graphics Card..." << std::endl; ResetConsoleColor();
-        if (wmiInitialized) { GetGraphicsInfoWMI(pSvc, graphicsDetails); } // Logs error inside
-        else { SetConsoleColor(COLOR_WARNING); std::cerr << "  Skipping WMI Graphics check as WMI failed to initialize." << std::endl; ResetConsoleColor(); }
+        // Only sections whose probe succeeded are cached; failed or timed-out ones are retried next run
+        unsigned probedSections = 0;
+        for (const ProbeOutcome& outcome : probeOutcomes) { if (outcome.State == ProbeSucceeded) probedSections |= outcome.Section; }
+        if (probedSections) {
+            TRACE_SPAN("Save snapshot", "snapshot");
+            StoreSnapshotSections(snapshot, probedSections, machine, now);
+            if (!SaveSnapshotFile(snapshotPath, snapshot, snapshotError)) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: Could not save probe snapshot. " << snapshotError << std::endl; ResetConsoleColor(); }
+        }
 
         SetConsoleColor(COLOR_HEADING); std::cout << "\n--- System Information Gathering Complete ---" << std::endl; ResetConsoleColor();
 
     } // End of Live Detection Mode block
 
 
-    // --- Target OS Selection ---
-    std::wstring targetOSKey;
-    bool validTarget = false;
-    while (!validTarget) {
-        SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Select Target Windows Version ---" << std::endl; ResetConsoleColor();
-        SetConsoleColor(COLOR_LABEL); std::cout << "Available keys: ";
-        for (const auto& pair : windowsRequirementsDB) { std::wcout << pair.first << L" "; }
-        std::cout << std::endl; ResetConsoleColor();
-        std::cout << "Enter target OS key (e.g., 11): ";
-        std::wcin >> targetOSKey;
-        std::wcin.ignore(std::numeric_limits<std::streamsize>::max(), L'\n'); // Clear buffer after wcin
-
-        if (windowsRequirementsDB.count(targetOSKey)) {
-            validTarget = true;
-        } else {
-            SetConsoleColor(COLOR_ERROR); std::wcerr << L"Invalid key '" << targetOSKey << L"'. Please try again." << std::endl; ResetConsoleColor();
-            std::wcin.clear(); // Clear error flags if any
-        }
-    }
-    const WindowsRequirements& targetReqs = windowsRequirementsDB[targetOSKey];
-
-
     // --- Call Comparison Function ---
-    SetConsoleColor(COLOR_HEADING); std::wcout << L"\n--- Comparing System Specs against " << targetReqs.Name << L" ---" << std::endl; ResetConsoleColor();
-    CompareRequirements(targetReqs, cpuDetails, ramDetails, diskDetails, osDetails, firmwareDetails, graphicsDetails, screenDetails, securityDetails, directXDetails);
+    std::unique_ptr<ReportRenderer> renderer = CreateReportRenderer(reportFormat);
+    if (allTargets) {
+        PrintHighestSupported(machine, *renderer);
+        if (reportFormat == ReportAnsi || reportFormat == ReportPlain) { SetConsoleColor(COLOR_NOTE); std::cout << "  Enter a single target key for the detailed report, including [WARN] items." << std::endl; ResetConsoleColor(); }
+    }
+    else {
+        CompareRequirements(BUILTIN_TARGETS[targetIndex].Requirements, machine, *renderer);
+        if (showPlan) PrintUpgradePlan(BUILTIN_TARGETS[targetIndex].Requirements, machine, upgradeCosts);
+    }
 
 
     // --- Cleanup (Only if Live Detection ran) ---
     if (!simulationMode) {
         if (wmiInitialized) { CleanupWMI(pSvc); SetConsoleColor(COLOR_INFO); std::cout << "\nWMI Cleaned up." << std::endl; ResetConsoleColor(); }
-        CoUninitialize(); SetConsoleColor(COLOR_INFO); std::cout << "COM Uninitialized." << std::endl; ResetConsoleColor();
+        if (comInitialized) { CoUninitialize(); SetConsoleColor(COLOR_INFO); std::cout << "COM Uninitialized." << std::endl; ResetConsoleColor(); }
     }
 
+    // --- Trace Export (before the exit prompt, so the file exists while the window is still open) ---
+    if (!tracePath.empty()) FinishTrace(tracePath);
+
     // --- Wait for user ---
     SetConsoleColor(COLOR_DEFAULT); // Ensure default color before exit prompt
     std::cout << "\nPress Enter to exit...";
@@ -256,20 +366,6 @@ int main() {
 
 // --- Function Implementations ---
 
-void PopulateRequirementsDB() {
-    SetConsoleColor(COLOR_INFO); std::cout << "Populating requirements database..." << std::endl; ResetConsoleColor();
-    // --- Windows Vista ---
-    windowsRequirementsDB[L"Vista"] = { L"Windows Vista", 800, 1, false, 0, 512ULL * 1024 * 1024, 15ULL * 1024 * 1024 * 1024, 9, 0, 800, 600, false, false, false, 0, false };
-    // --- Windows 7 ---
-    windowsRequirementsDB[L"7"] = { L"Windows 7", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 16ULL * 1024 * 1024 * 1024, 9, 1, 800, 600, false, false, false, 0, false };
-    // --- Windows 8.1 ---
-    windowsRequirementsDB[L"8.1"] = { L"Windows 8.1", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 16ULL * 1024 * 1024 * 1024, 9, 1, 1024, 768, false, false, false, 0, false };
-    // --- Windows 10 ---
-    windowsRequirementsDB[L"10"] = { L"Windows 10", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 32ULL * 1024 * 1024 * 1024, 9, 1, 800, 600, false, false, false, 0, false };
-    // --- Windows 11 ---
-    windowsRequirementsDB[L"11"] = { L"Windows 11", 1000, 2, true, 8, 4ULL * 1024 * 1024 * 1024, 64ULL * 1024 * 1024 * 1024, 12, 2, 1280, 720, true, true, true, 2, true };
-}
-
 bool InitializeWMI(IWbemServices*& pSvc) {
     pSvc = NULL; HRESULT hres; IWbemLocator* pLoc = NULL;
     hres = CoCreateInstance( CLSID_WbemLocator, 0, CLSCTX_INPROC_SERVER, IID_IWbemLocator, (LPVOID*)&pLoc);
@@ -286,6 +382,7 @@ void CleanupWMI(IWbemServices* pSvc) { if (pSvc) { pSvc->Release(); } }
 bool GetCpuInfoWMI(IWbemServices* pSvc, CpuInfo& cpuInfo) {
     bool wmiOk = false;
     if (pSvc) {
+        TRACE_SPAN("WMI Win32_Processor", "wmi");
         IEnumWbemClassObject* pEnumerator = NULL;
         HRESULT hres = pSvc->ExecQuery( bstr_t(L"WQL"), bstr_t(L"SELECT Name, MaxClockSpeed, NumberOfCores, NumberOfLogicalProcessors FROM Win32_Processor"), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &pEnumerator);
         if (SUCCEEDED(hres) && pEnumerator) {
@@ -310,9 +407,39 @@ bool GetCpuInfoWMI(IWbemServices* pSvc, CpuInfo& cpuInfo) {
          cpuInfo.NumberOfLogicalProcessors = sysInfo.dwNumberOfProcessors;
          cpuInfo.NumberOfCores = 0; cpuInfo.MaxClockSpeed = 0; cpuInfo.Name = L"N/A (WMI Failed)";
     }
+    cpuInfo.MinCpuGenerationLevel = wmiOk ? MatchCpuList(cpuInfo.Name) : (UINT)CpuListUnknown;
     return wmiOk;
 }
 
+bool GetCpuInfoAPI(CpuInfo& cpuInfo) {
+    SYSTEM_INFO sysInfo; GetSystemInfo(&sysInfo);
+    cpuInfo.Architecture = GetProcessorArchitectureString(sysInfo.wProcessorArchitecture);
+    cpuInfo.Is64BitCapable = (sysInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_AMD64 || sysInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_IA64);
+    cpuInfo.NumberOfLogicalProcessors = sysInfo.dwNumberOfProcessors;
+    // Name and rated speed (the same "~MHz" value Win32_Processor.MaxClockSpeed is usually built from)
+    HKEY hKey; LONG lResult = RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", 0, KEY_READ, &hKey);
+    if (lResult != ERROR_SUCCESS) { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: Failed to open CPU registry key. Code: " << lResult << std::endl; ResetConsoleColor(); return false; }
+    wchar_t nameStr[256] = {}; DWORD dwBufferSize = sizeof(nameStr) - sizeof(wchar_t);
+    if (RegQueryValueExW(hKey, L"ProcessorNameString", NULL, NULL, (LPBYTE)nameStr, &dwBufferSize) == ERROR_SUCCESS) { const wchar_t* start = nameStr; while (*start == L' ') { ++start; } cpuInfo.Name = start; } // Some BIOSes pad the name
+    DWORD mhz = 0; dwBufferSize = sizeof(mhz);
+    if (RegQueryValueExW(hKey, L"~MHz", NULL, NULL, (LPBYTE)&mhz, &dwBufferSize) == ERROR_SUCCESS) { cpuInfo.MaxClockSpeed = mhz; }
+    RegCloseKey(hKey);
+    // Physical cores (GetLogicalProcessorInformation: XP SP3 and newer; older systems keep 0, which the check reports as [WARN])
+    typedef BOOL (WINAPI *pGetLogicalProcessorInformation)(PSYSTEM_LOGICAL_PROCESSOR_INFORMATION, PDWORD);
+    HMODULE hKernel32 = GetModuleHandleW(L"kernel32.dll");
+    pGetLogicalProcessorInformation pGLPI = hKernel32 ? (pGetLogicalProcessorInformation)GetProcAddress(hKernel32, "GetLogicalProcessorInformation") : NULL;
+    DWORD length = 0;
+    if (pGLPI && !pGLPI(NULL, &length) && GetLastError() == ERROR_INSUFFICIENT_BUFFER) {
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) + 1);
+        if (pGLPI(&info[0], &length)) {
+            UINT cores = 0; for (size_t i = 0; i < length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION); ++i) { if (info[i].Relationship == RelationProcessorCore) ++cores; }
+            cpuInfo.NumberOfCores = cores;
+        }
+    }
+    cpuInfo.MinCpuGenerationLevel = MatchCpuList(cpuInfo.Name);
+    return true;
+}
+
 std::wstring GetProcessorArchitectureString(WORD arch) {
     switch (arch) {
         case PROCESSOR_ARCHITECTURE_AMD64: return L"x64 (64-bit)"; case PROCESSOR_ARCHITECTURE_ARM: return L"ARM";
@@ -340,6 +467,7 @@ bool GetDiskInfoAPI(DiskInfo& diskInfo) {
 bool GetOsInfoWMI(IWbemServices* pSvc, OsInfo& osInfo) {
     bool foundData = false;
     if (pSvc) { // Try WMI first
+        TRACE_SPAN("WMI Win32_OperatingSystem", "wmi");
         IEnumWbemClassObject* pEnumerator = NULL;
         HRESULT hres = pSvc->ExecQuery( bstr_t(L"WQL"), bstr_t(L"SELECT Caption, Version, BuildNumber, OSArchitecture, ServicePackMajorVersion FROM Win32_OperatingSystem"), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &pEnumerator);
         if (SUCCEEDED(hres) && pEnumerator) {
@@ -358,6 +486,7 @@ bool GetOsInfoWMI(IWbemServices* pSvc, OsInfo& osInfo) {
     }
     // Fallback using API if WMI failed or wasn't available
     if (!foundData) {
+         TRACE_SPAN("GetVersionExW fallback", "fallback");
          SetConsoleColor(COLOR_INFO); std::cerr << "  WMI OS query failed/skipped, attempting API fallback..." << std::endl; ResetConsoleColor();
          OSVERSIONINFOEXW osvi; ZeroMemory(&osvi, sizeof(OSVERSIONINFOEXW)); osvi.dwOSVersionInfoSize = sizeof(OSVERSIONINFOEXW);
          // Note: GetVersionExW is deprecated but needed for XP compatibility.
@@ -376,17 +505,19 @@ bool GetOsInfoWMI(IWbemServices* pSvc, OsInfo& osInfo) {
 bool GetFirmwareTypeAPI(FirmwareInfo& firmwareInfo) {
     typedef BOOL (WINAPI *pGetFirmwareType)(PFIRMWARE_TYPE);
     HMODULE hKernel32 = GetModuleHandleW(L"kernel32.dll");
-    if (!hKernel32) { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: Could not get handle to kernel32.dll. Code: " << GetLastError() << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = L"Unknown (Kernel32 Error)"; return false; }
+    if (!hKernel32) { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: Could not get handle to kernel32.dll. Code: " << GetLastError() << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = FirmwareUnknown; firmwareInfo.Source = SourceApi; return false; }
     pGetFirmwareType pGFT = (pGetFirmwareType)GetProcAddress(hKernel32, "GetFirmwareType");
-    if (pGFT == NULL) { SetConsoleColor(COLOR_INFO); std::cout << "  Info: GetFirmwareType API not available (likely Windows XP). Assuming BIOS." << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = L"BIOS (Assumed)"; return true; }
+    if (pGFT == NULL) { SetConsoleColor(COLOR_INFO); std::cout << "  Info: GetFirmwareType API not available (likely Windows XP). Assuming BIOS." << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = FirmwareBios; firmwareInfo.Source = SourceAssumed; return true; }
     FIRMWARE_TYPE ft = FirmwareTypeUnknown;
+    firmwareInfo.Source = SourceApi;
     if (pGFT(&ft)) {
-        switch (ft) { case FirmwareTypeBios: firmwareInfo.FirmwareType = L"BIOS"; break; case FirmwareTypeUefi: firmwareInfo.FirmwareType = L"UEFI"; break; default: firmwareInfo.FirmwareType = L"Unknown (API Result)"; break; } return true;
-    } else { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: GetFirmwareType API call failed. Code: " << GetLastError() << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = L"Unknown (API Error)"; return false; }
+        switch (ft) { case FirmwareTypeBios: firmwareInfo.FirmwareType = FirmwareBios; break; case FirmwareTypeUefi: firmwareInfo.FirmwareType = FirmwareUefi; break; default: firmwareInfo.FirmwareType = FirmwareUnknown; break; } return true;
+    } else { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: GetFirmwareType API call failed. Code: " << GetLastError() << std::endl; ResetConsoleColor(); firmwareInfo.FirmwareType = FirmwareUnknown; return false; }
 }
 
 bool GetGraphicsInfoWMI(IWbemServices* pSvc, GraphicsInfo& graphicsInfo) {
     if (!pSvc) return false; IEnumWbemClassObject* pEnumerator = NULL;
+    TRACE_SPAN("WMI Win32_VideoController", "wmi");
     HRESULT hres = pSvc->ExecQuery( bstr_t(L"WQL"), bstr_t(L"SELECT Name, AdapterRAM, DriverVersion, VideoProcessor FROM Win32_VideoController"), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &pEnumerator);
     if (FAILED(hres)) { SetConsoleColor(COLOR_ERROR); std::cerr << "  Error: WMI query Win32_VideoController failed. Code=0x" << std::hex << hres << std::endl; ResetConsoleColor(); return false; }
     IWbemClassObject* pclsObj = NULL; ULONG uReturn = 0; bool foundData = false;
@@ -399,10 +530,21 @@ bool GetGraphicsInfoWMI(IWbemServices* pSvc, GraphicsInfo& graphicsInfo) {
         pclsObj->Release(); if (!graphicsInfo.Name.empty()) { break; } // Take first named adapter
     }
     if (pEnumerator) { pEnumerator->Release(); } // Fixed braces
-    graphicsInfo.DirectXFeatureLevel = L"N/A"; graphicsInfo.WDDMVersion = L"N/A"; // Placeholders
+    graphicsInfo.DirectXFeatureLevel = 0; graphicsInfo.WDDMVersion = 0; // Not detected live (see dxdiag note in the report)
     return foundData;
 }
 
+bool GetGraphicsInfoAPI(GraphicsInfo& graphicsInfo) {
+    DISPLAY_DEVICEW device; device.cb = sizeof(device);
+    for (DWORD i = 0; EnumDisplayDevicesW(NULL, i, &device, 0); ++i) {
+        if (device.StateFlags & DISPLAY_DEVICE_PRIMARY_DEVICE) { graphicsInfo.Name = device.DeviceString; break; } // Adapter driving the primary display
+        device.cb = sizeof(device);
+    }
+    graphicsInfo.DirectXFeatureLevel = 0; graphicsInfo.WDDMVersion = 0; // Not detected live (see dxdiag note in the report)
+    if (graphicsInfo.Name == L"N/A") { SetConsoleColor(COLOR_WARNING); std::cerr << "  Warning: No primary display adapter found." << std::endl; ResetConsoleColor(); return false; }
+    return true;
+}
+
 bool GetScreenResolutionAPI(ScreenInfo& screenInfo) {
     screenInfo.Width = GetSystemMetrics(SM_CXSCREEN); screenInfo.Height = GetSystemMetrics(SM_CYSCREEN);
     if (screenInfo.Width == 0 || screenInfo.Height == 0) { SetConsoleColor(COLOR_WARNING); std::cerr << "  Warning: GetSystemMetrics returned 0 for screen dimensions. Error (if any): " << GetLastError() << std::endl; ResetConsoleColor(); return false; } return true;
@@ -421,6 +563,7 @@ bool GetSecurityInfo(IWbemServices* pSvc, SecurityInfo& secInfo, const FirmwareI
     // --- TPM Check ---
     if (pSvc) {
         tpmCheckAttempted = true; IEnumWbemClassObject* pEnumerator = NULL;
+        TRACE_SPAN("WMI Win32_Tpm", "wmi");
         HRESULT hres = pSvc->ExecQuery( bstr_t(L"WQL"), bstr_t(L"SELECT IsEnabled, IsActivated, IsOwned, SpecVersion FROM Win32_Tpm"), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &pEnumerator);
         if (SUCCEEDED(hres) && pEnumerator) {
             IWbemClassObject* pclsObj = NULL; ULONG uReturn = 0;
@@ -439,58 +582,107 @@ bool GetSecurityInfo(IWbemServices* pSvc, SecurityInfo& secInfo, const FirmwareI
         if (pEnumerator) { pEnumerator->Release(); }
     } else { secInfo.TpmVersionString = L"N/A (WMI Not Initialized)"; }
     // --- Secure Boot Check ---
-    secInfo.SecureBootStatus = L"N/A";
-    if (firmwareInfo.FirmwareType == L"UEFI") {
+    auto SetSecureBoot = [&](SecureBootState state, DetectionSource source) { secInfo.SecureBoot = state; secInfo.SecureBootSource = source; };
+    SetSecureBoot(SecureBootUnknown, SourceNone);
+    if (firmwareInfo.FirmwareType == FirmwareUefi) {
         sbCheckAttempted = true;
         typedef DWORD (WINAPI *pGFEVW)(LPCWSTR, LPCWSTR, PVOID, DWORD, PDWORD);
         HMODULE hK32 = GetModuleHandleW(L"kernel32.dll"); pGFEVW pGFEV = NULL; if(hK32) pGFEV = (pGFEVW)GetProcAddress(hK32, "GetFirmwareEnvironmentVariableW");
         if (pGFEV) {
+             TRACE_SPAN("GetFirmwareEnvironmentVariableW SecureBoot", "api");
              BYTE sbVal = 0; DWORD attr = 0; DWORD dataSize = sizeof(sbVal); DWORD ret = pGFEV(L"SecureBoot", L"{8be4df61-93ca-11d2-aa0d-00e098032b8c}", &sbVal, dataSize, &attr);
-             if (ret > 0) { secInfo.SecureBootCapable = true; secInfo.SecureBootEnabled = (sbVal == 1); secInfo.SecureBootStatus = secInfo.SecureBootEnabled ? L"Enabled (API)" : L"Disabled (API)"; }
-             else { DWORD err = GetLastError(); if (err == ERROR_ENVVAR_NOT_FOUND) { secInfo.SecureBootStatus = L"Not Found (API)"; secInfo.SecureBootCapable = false; } else if (err == ERROR_PRIVILEGE_NOT_HELD) { secInfo.SecureBootStatus = L"Requires Admin (API)"; } else { std::wstringstream ssErr; ssErr << L"Error (API Code: " << err << L")"; secInfo.SecureBootStatus = ssErr.str(); } }
-        } else { secInfo.SecureBootStatus = L"N/A (API Unavailable)"; }
+             if (ret > 0) { secInfo.SecureBootCapable = true; secInfo.SecureBootEnabled = (sbVal == 1); SetSecureBoot(secInfo.SecureBootEnabled ? SecureBootOn : SecureBootOff, SourceApi); }
+             else { DWORD err = GetLastError(); if (err == ERROR_ENVVAR_NOT_FOUND) { SetSecureBoot(SecureBootNotFound, SourceApi); secInfo.SecureBootCapable = false; } else if (err == ERROR_PRIVILEGE_NOT_HELD) { SetSecureBoot(SecureBootNeedsAdmin, SourceApi); } else { SetSecureBoot(SecureBootQueryFailed, SourceApi); secInfo.SecureBootErrorCode = err; } }
+        } else { SetSecureBoot(SecureBootApiUnavailable, SourceNone); }
         // WMI as fallback if API didn't give conclusive Enabled/Disabled status
-        if (pSvc && (secInfo.SecureBootStatus.find(L"Enabled") == std::wstring::npos && secInfo.SecureBootStatus.find(L"Disabled") == std::wstring::npos)) {
+        if (pSvc && secInfo.SecureBoot != SecureBootOn && secInfo.SecureBoot != SecureBootOff) {
+             TRACE_SPAN("ROOT\\WMI Secure Boot fallback", "fallback");
              IEnumWbemClassObject* pEnumSB = NULL; IWbemServices* pSvcWMI = NULL; IWbemLocator* pLocSB = NULL;
              if (SUCCEEDED(CoCreateInstance(CLSID_WbemLocator,0,CLSCTX_INPROC_SERVER,IID_IWbemLocator,(LPVOID*)&pLocSB))) {
                  if (SUCCEEDED(pLocSB->ConnectServer(_bstr_t(L"ROOT\\WMI"),NULL,NULL,0,0L,0,0,&pSvcWMI))) {
                      if (SUCCEEDED(CoSetProxyBlanket(pSvcWMI,RPC_C_AUTHN_WINNT,RPC_C_AUTHZ_NONE,NULL,RPC_C_AUTHN_LEVEL_CALL,RPC_C_IMP_LEVEL_IMPERSONATE,NULL,EOAC_NONE))) {
+                          TRACE_SPAN("WMI MSAcpi_SecureBoot", "wmi");
                           HRESULT hresSB = pSvcWMI->ExecQuery(bstr_t(L"WQL"), bstr_t(L"SELECT SecureBoot FROM MSAcpi_SecureBoot"), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &pEnumSB);
                           if (SUCCEEDED(hresSB) && pEnumSB) {
                                IWbemClassObject* pObjSB = NULL; ULONG uRetSB = 0;
                                if (SUCCEEDED(pEnumSB->Next(WBEM_INFINITE, 1, &pObjSB, &uRetSB)) && uRetSB != 0) {
                                     VARIANT vtPropSB; VariantInit(&vtPropSB); secInfo.SecureBootCapable = true;
                                     if (SUCCEEDED(pObjSB->Get(L"SecureBoot", 0, &vtPropSB, 0, 0)) && vtPropSB.vt == VT_BOOL) {
-                                        secInfo.SecureBootEnabled = vtPropSB.boolVal; secInfo.SecureBootStatus = secInfo.SecureBootEnabled ? L"Enabled (WMI)" : L"Disabled (WMI)";
+                                        secInfo.SecureBootEnabled = vtPropSB.boolVal; SetSecureBoot(secInfo.SecureBootEnabled ? SecureBootOn : SecureBootOff, SourceWmi);
                                     } else {
-                                        if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"Query Failed (WMI)"; }
+                                        if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootQueryFailed, SourceWmi); }
                                     }
                                     VariantClear(&vtPropSB); pObjSB->Release();
                                } else {
-                                    if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"Not Found (WMI Instance)"; }
+                                    if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootNotFound, SourceWmi); }
                                }
                                if (pEnumSB) { pEnumSB->Release(); }
                           } else {
-                               if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"Not Found (WMI Query Failed)"; }
+                               if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootNotFound, SourceWmi); }
                           }
                      } else {
-                          if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"N/A (Proxy Blanket ROOT\\WMI failed)"; }
+                          if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootQueryFailed, SourceWmi); } // Proxy blanket on ROOT\\WMI failed
                      }
                      if (pSvcWMI) { pSvcWMI->Release(); } // Fixed braces
                  } else {
-                      if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"N/A (ConnectServer ROOT\\WMI failed)"; }
+                      if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootQueryFailed, SourceWmi); } // ConnectServer ROOT\\WMI failed
                  }
                  if (pLocSB) { pLocSB->Release(); } // Fixed braces
              } else {
-                  if (secInfo.SecureBootStatus == L"N/A") { secInfo.SecureBootStatus = L"N/A (CreateInstance for ROOT\\WMI failed)"; }
+                  if (secInfo.SecureBoot == SecureBootUnknown) { SetSecureBoot(SecureBootQueryFailed, SourceWmi); } // CreateInstance for ROOT\\WMI failed
              }
         } // End WMI fallback
-    } else if (firmwareInfo.FirmwareType == L"BIOS") { secInfo.SecureBootStatus = L"Not Applicable (BIOS)"; secInfo.SecureBootCapable = false; secInfo.SecureBootEnabled = false; sbCheckAttempted = true; }
-    else { secInfo.SecureBootStatus = L"N/A (Firmware Unknown)"; }
+    } else if (firmwareInfo.FirmwareType == FirmwareBios && firmwareInfo.Source != SourceAssumed) { SetSecureBoot(SecureBootNotApplicable, SourceNone); secInfo.SecureBootCapable = false; secInfo.SecureBootEnabled = false; sbCheckAttempted = true; }
+    // Firmware unknown (or only assumed): Secure Boot stays SecureBootUnknown
     return tpmCheckAttempted || sbCheckAttempted;
 }
 
 
+// --- Live Detection Probes ---
+// Each probe runs on its own scheduler thread, so the WMI probes join the multithreaded apartment themselves. They also
+// hold a reference on the shared WMI proxy, so a query abandoned after its deadline can still finish safely after main()
+// has called CleanupWMI.
+class ComApartment {
+public:
+    ComApartment() : hr(CoInitializeEx(0, COINIT_MULTITHREADED)) {}
+    ~ComApartment() { if (SUCCEEDED(hr)) CoUninitialize(); }
+private:
+    HRESULT hr;
+};
+
+static std::function<bool(MachineRecord&)> WmiProbeBody(IWbemServices* pSvc, std::function<bool(IWbemServices*, MachineRecord&)> query) {
+    if (pSvc) pSvc->AddRef();
+    return [pSvc, query](MachineRecord& r) { ComApartment com; bool ok = query(pSvc, r); if (pSvc) pSvc->Release(); return ok; };
+}
+
+void AddLiveProbes(ProbeScheduler& scheduler, IWbemServices* pSvc, bool wmiInitialized, unsigned sections) {
+    auto Add = [&](const char* name, unsigned section, unsigned dependsOn, std::function<bool(MachineRecord&)> run) { if (sections & section) scheduler.AddProbe(std::make_shared<FunctionProbe>(name, section, dependsOn, run)); };
+    auto AddWmi = [&](const char* name, unsigned section, unsigned dependsOn, std::function<bool(IWbemServices*, MachineRecord&)> query) { if (sections & section) Add(name, section, dependsOn, WmiProbeBody(pSvc, query)); };
+    if (wmiInitialized) { AddWmi("CPU", SectionCpu, 0, [](IWbemServices* svc, MachineRecord& r) { return GetCpuInfoWMI(svc, r.Cpu); }); } // Handles WMI fail + API fallback inside
+    else { Add("CPU", SectionCpu, 0, [](MachineRecord& r) { return GetCpuInfoAPI(r.Cpu); }); } // WMI not needed for this target (or failed)
+    Add("RAM", SectionRam, 0, [](MachineRecord& r) { return GetRamInfoAPI(r.Ram); }); // Logs error inside
+    Add("System Disk", SectionDisk, 0, [](MachineRecord& r) { return GetDiskInfoAPI(r.Disk); }); // Logs error inside
+    AddWmi("Operating System", SectionOs, 0, [](IWbemServices* svc, MachineRecord& r) { return GetOsInfoWMI(svc, r.Os); }); // Handles WMI fail + API fallback inside
+    Add("Firmware", SectionFirmware, 0, [](MachineRecord& r) { return GetFirmwareTypeAPI(r.Firmware); }); // Logs error/info inside
+    Add("Screen Resolution", SectionScreen, 0, [](MachineRecord& r) { return GetScreenResolutionAPI(r.Screen); }); // Logs warning inside
+    Add("DirectX Runtime", SectionDirectX, 0, [](MachineRecord& r) { return GetDirectXVersionRegistry(r.DirectX); }); // Logs info/error inside
+    AddWmi("Security Features", SectionSecurity, SectionFirmware, [](IWbemServices* svc, MachineRecord& r) { return GetSecurityInfo(svc, r.Security, r.Firmware); }); // Needs the firmware type
+    if (wmiInitialized) { AddWmi("Graphics Card", SectionGraphics, 0, [](IWbemServices* svc, MachineRecord& r) { return GetGraphicsInfoWMI(svc, r.Graphics); }); } // Logs error inside
+    else { Add("Graphics Card", SectionGraphics, 0, [](MachineRecord& r) { return GetGraphicsInfoAPI(r.Graphics); }); } // Adapter name only; levels are never detected live
+}
+
+// --- Probe Snapshot Location ---
+std::string DefaultSnapshotPath() {
+    const char* base = getenv("LOCALAPPDATA");
+    if (!base || !*base) base = getenv("APPDATA"); // Windows XP has no LOCALAPPDATA
+    return (base && *base) ? std::string(base) + "\\WinReadyCheck.snapshot" : std::string("WinReadyCheck.snapshot");
+}
+
+std::wstring GetHostName() {
+    wchar_t name[MAX_COMPUTERNAME_LENGTH + 1] = {}; DWORD size = MAX_COMPUTERNAME_LENGTH + 1;
+    return GetComputerNameW(name, &size) ? std::wstring(name, size) : std::wstring(L"Unknown");
+}
+
 // --- Simulation Input Helper Functions ---
 int GetIntInput(const std::string& prompt) {
     int value = 0;
@@ -520,8 +712,8 @@ bool GetSimulatedSystemInfo(CpuInfo& cpu, RamInfo& ram, DiskInfo& disk, OsInfo&
     cpu.NumberOfLogicalProcessors = GetIntInput("  Number of Logical Processors (Threads, e.g., 8): ");
     cpu.Is64BitCapable = GetBoolInput("  Is CPU 64-bit Capable?");
     cpu.Architecture = cpu.Is64BitCapable ? L"x64 (64-bit)" : L"x86 (32-bit)";
-    SetConsoleColor(COLOR_NOTE); std::cout << "  CPU Generation Level (for Win11 check): 0=Pre-Win11, 8=Win11 Min (Intel 8th+/Ryzen 2k+)" << std::endl; ResetConsoleColor();
-    cpu.MinCpuGenerationLevel = GetIntInput("  Enter Level (0 or 8): "); cpu.Name = L"Simulated CPU";
+    SetConsoleColor(COLOR_NOTE); std::cout << "  CPU Generation Level (for Win11 check): 0=Unknown, 1=Not on Win11 list, 8=On Win11 list (Intel 8th+/Ryzen 2k+)" << std::endl; ResetConsoleColor();
+    cpu.MinCpuGenerationLevel = GetIntInput("  Enter Level (0, 1 or 8): "); cpu.Name = L"Simulated CPU";
     // --- RAM ---
     SetConsoleColor(COLOR_LABEL); std::cout << "--- RAM ---" << std::endl; ResetConsoleColor();
     int ramGB = GetIntInput("  Total RAM (GB, e.g., 8): "); ram.TotalPhysicalBytes = (ULONGLONG)ramGB * 1024 * 1024 * 1024;
@@ -530,128 +722,404 @@ bool GetSimulatedSystemInfo(CpuInfo& cpu, RamInfo& ram, DiskInfo& disk, OsInfo&
     int diskGB = GetIntInput("  Free Space on System Drive (GB, e.g., 100): "); disk.FreeBytesAvailableToUser = (ULONGLONG)diskGB * 1024 * 1024 * 1024; disk.DriveLetter = L'C';
     // --- Firmware ---
     SetConsoleColor(COLOR_LABEL); std::cout << "--- Firmware ---" << std::endl; ResetConsoleColor();
-    char fwChoice = ' '; while (fwChoice != 'B' && fwChoice != 'U') { SetConsoleColor(COLOR_LABEL); std::cout << "  Firmware Type ([B]IOS / [U]EFI): "; ResetConsoleColor(); std::cin >> fwChoice; fwChoice = toupper(fwChoice); std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); if (fwChoice == 'B') firm.FirmwareType = L"BIOS"; else if (fwChoice == 'U') firm.FirmwareType = L"UEFI"; else { SetConsoleColor(COLOR_ERROR); std::cerr << "Invalid input." << std::endl; ResetConsoleColor(); } }
+    char fwChoice = ' '; while (fwChoice != 'B' && fwChoice != 'U') { SetConsoleColor(COLOR_LABEL); std::cout << "  Firmware Type ([B]IOS / [U]EFI): "; ResetConsoleColor(); std::cin >> fwChoice; fwChoice = toupper(fwChoice); std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); firm.Source = SourceSimulated; if (fwChoice == 'B') firm.FirmwareType = FirmwareBios; else if (fwChoice == 'U') firm.FirmwareType = FirmwareUefi; else { SetConsoleColor(COLOR_ERROR); std::cerr << "Invalid input." << std::endl; ResetConsoleColor(); } }
     // --- Graphics ---
     SetConsoleColor(COLOR_LABEL); std::cout << "--- Graphics ---" << std::endl; ResetConsoleColor(); graph.Name = L"Simulated Graphics";
-    int dxLevel = 0; while (dxLevel < 9 || dxLevel > 12) { dxLevel = GetIntInput("  DirectX Feature Level Supported (9, 10, 11, 12): "); if (dxLevel < 9 || dxLevel > 12) { SetConsoleColor(COLOR_ERROR); std::cerr << "Enter 9, 10, 11, or 12." << std::endl; ResetConsoleColor(); } } graph.DirectXFeatureLevel = std::to_wstring(dxLevel);
-    int wddmLevel = 0; while (wddmLevel < 1 || wddmLevel > 2) { wddmLevel = GetIntInput("  WDDM Version Supported (1 or 2): "); if (wddmLevel < 1 || wddmLevel > 2) { SetConsoleColor(COLOR_ERROR); std::cerr << "Enter 1 or 2." << std::endl; ResetConsoleColor(); } } graph.WDDMVersion = std::to_wstring(wddmLevel) + L".0";
+    int dxLevel = 0; while (dxLevel < 9 || dxLevel > 12) { dxLevel = GetIntInput("  DirectX Feature Level Supported (9, 10, 11, 12): "); if (dxLevel < 9 || dxLevel > 12) { SetConsoleColor(COLOR_ERROR); std::cerr << "Enter 9, 10, 11, or 12." << std::endl; ResetConsoleColor(); } } graph.DirectXFeatureLevel = PackVersion(dxLevel, 0);
+    int wddmLevel = 0; while (wddmLevel < 1 || wddmLevel > 2) { wddmLevel = GetIntInput("  WDDM Version Supported (1 or 2): "); if (wddmLevel < 1 || wddmLevel > 2) { SetConsoleColor(COLOR_ERROR); std::cerr << "Enter 1 or 2." << std::endl; ResetConsoleColor(); } } graph.WDDMVersion = PackVersion(wddmLevel, 0);
     // --- Display ---
     SetConsoleColor(COLOR_LABEL); std::cout << "--- Display ---" << std::endl; ResetConsoleColor(); screen.Width = GetIntInput("  Screen Width (pixels, e.g., 1920): "); screen.Height = GetIntInput("  Screen Height (pixels, e.g., 1080): ");
     // --- Security ---
     SetConsoleColor(COLOR_LABEL); std::cout << "--- Security ---" << std::endl; ResetConsoleColor(); sec.TpmFound = GetBoolInput("  TPM Found?");
     if (sec.TpmFound) { sec.TpmEnabled = GetBoolInput("    TPM Enabled & Ready?"); double tpmVer = 0.0; while (tpmVer != 1.2 && tpmVer != 2.0) { SetConsoleColor(COLOR_LABEL); std::cout << "    TPM Specification Version (1.2 or 2.0): "; ResetConsoleColor(); std::cin >> tpmVer; if (std::cin.fail() || (tpmVer != 1.2 && tpmVer != 2.0)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Invalid input. Enter 1.2 or 2.0." << std::endl; ResetConsoleColor(); std::cin.clear(); std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); tpmVer = 0.0; } else { std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); } } sec.TpmSpecVersionMajor = (UINT32)tpmVer; sec.TpmSpecVersionMinor = (tpmVer == 1.2) ? 2 : 0; sec.TpmVersionString = (tpmVer == 1.2) ? L"1.2" : L"2.0"; }
     else { sec.TpmEnabled = false; sec.TpmSpecVersionMajor = 0; sec.TpmSpecVersionMinor = 0; sec.TpmVersionString = L"Not Found"; }
-    if (firm.FirmwareType == L"UEFI") { sec.SecureBootCapable = true; sec.SecureBootEnabled = GetBoolInput("  Secure Boot Enabled?"); sec.SecureBootStatus = sec.SecureBootEnabled ? L"Enabled (Simulated)" : L"Disabled (Simulated)"; }
-    else { sec.SecureBootCapable = false; sec.SecureBootEnabled = false; sec.SecureBootStatus = L"Not Applicable (BIOS)"; }
+    if (firm.FirmwareType == FirmwareUefi) { sec.SecureBootCapable = true; sec.SecureBootEnabled = GetBoolInput("  Secure Boot Enabled?"); sec.SecureBoot = sec.SecureBootEnabled ? SecureBootOn : SecureBootOff; sec.SecureBootSource = SourceSimulated; }
+    else { sec.SecureBootCapable = false; sec.SecureBootEnabled = false; sec.SecureBoot = SecureBootNotApplicable; }
     // --- Other ---
     dx.InstalledVersion = L"N/A (Simulated)"; os.Caption = L"Simulated System"; os.Version = L"N/A"; os.BuildNumber = L"N/A"; os.OSArchitecture = cpu.Is64BitCapable ? L"64-bit" : L"32-bit"; os.ServicePackMajorVersion = L"N/A";
     SetConsoleColor(COLOR_SUCCESS); std::cout << "\nSimulation data entered successfully." << std::endl; ResetConsoleColor(); return true;
 }
 
 
-// --- Comparison Function Implementation (with Warning Tracking & Sign Compare Fix) ---
-void CompareRequirements(const WindowsRequirements& target, const CpuInfo& cpu, const RamInfo& ram, const DiskInfo& disk, const OsInfo& os, const FirmwareInfo& firm, const GraphicsInfo& graph, const ScreenInfo& screen, const SecurityInfo& sec, const DirectXInfo& dx) {
+// --- Comparison Function Implementation (the verdicts come from EvaluateRequirements, the wording from report.cpp) ---
+void CompareRequirements(const WindowsRequirements& target, const MachineRecord& machine, const ReportRenderer& renderer) {
+    RequirementsReport report;
+    { TRACE_SPAN("Evaluate", "report"); BuildRequirementsReport(target, machine, EvaluateRequirements(target, machine), report); }
+    std::string text;
+    { TRACE_SPAN("Render", "report"); renderer.BeginDocument(text); renderer.Render(report, text); renderer.EndDocument(text); }
+    TRACE_SPAN("Write report", "report");
+    WriteReport(text);
+}
+
+// --- All-targets Summary (single pass over the machine's data instead of one report per version) ---
+void PrintHighestSupported(const MachineRecord& machine, const ReportRenderer& renderer) {
+    TargetSummaryReport summary; summary.MachineId = WideToUtf8(machine.MachineId);
+    { TRACE_SPAN("Evaluate all targets", "report"); summary.Targets = EvaluateAllBuiltinTargets(ExtractFeatures(machine)); }
+    std::string text;
+    { TRACE_SPAN("Render", "report"); renderer.BeginDocument(text); renderer.Render(summary, text); renderer.EndDocument(text); }
+    TRACE_SPAN("Write report", "report");
+    WriteReport(text);
+}
+
+// --- Upgrade Plan (console only; the report formats stay as they are) ---
+void PrintUpgradePlan(const WindowsRequirements& target, const MachineRecord& machine, const UpgradeCosts& costs) {
+    UpgradePlan plan;
+    { TRACE_SPAN("Plan upgrade", "report"); PlanUpgrade(target, ExtractFeatures(machine), machine.Disk.TotalBytes, costs, plan); }
+    SetConsoleColor(COLOR_HEADING); std::wcout << L"\n--- Upgrade Plan for " << target.Name << L" ---" << std::endl; ResetConsoleColor();
+    if (plan.Feasible && plan.StepCount == 0) { SetConsoleColor(COLOR_SUCCESS); std::cout << "  No hardware changes needed." << std::endl; ResetConsoleColor(); return; }
+    if (!plan.Feasible) {
+        SetConsoleColor(COLOR_ERROR); std::cout << "  No plan: no supported upgrade fixes";
+        for (int id = 0; id < CheckCount; ++id) { if (plan.Fail & (1u << id)) std::cout << " " << CheckIdName((CheckId)id); }
+        std::cout << "." << std::endl; ResetConsoleColor(); return;
+    }
+    for (int i = 0; i < plan.StepCount; ++i) {
+        SetConsoleColor(COLOR_LABEL); std::cout << "  " << (i + 1) << ". " << UpgradeStepText(plan.Steps[i]);
+        SetConsoleColor(COLOR_NOTE); std::cout << "  (cost " << plan.Steps[i].Cost << ")" << std::endl; ResetConsoleColor();
+    }
+    SetConsoleColor(COLOR_INFO); std::cout << "  Total cost: " << plan.Cost << "  (adjust with --cost Name=Value)" << std::endl; ResetConsoleColor();
+}
+
+// --- Trace Export ---
+void FinishTrace(const std::string& tracePath) {
+    TraceStop(); std::string traceError, summary; FormatTraceSummary(summary);
+    if (!SaveChromeTrace(tracePath, traceError)) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: " << traceError << std::endl; ResetConsoleColor(); return; }
+    SetConsoleColor(COLOR_INFO); std::cerr << "\nTrace written to " << tracePath << "\n" << summary; ResetConsoleColor();
+}
 
-    bool overallPass = true; // Assume pass initially
-    bool anyWarnings = false; // Track if any warnings occurred
+// --- Upgrade Sweep (--batch ... --sweep): one CSV line per grid point instead of one per machine ---
+static int RunSweepMode(const BatchOptions& options, const WindowsRequirements& base, const std::vector<SweepAxis>& axes, const UpgradeCosts& costs) {
+    FeatureColumns fleet; std::vector<ULONGLONG> diskTotals; std::vector<SweepPoint> points; size_t malformedRows = 0; std::string error;
+    auto startTime = std::chrono::steady_clock::now();
+    bool ok;
+    { TRACE_SPAN("Load fleet", "sweep"); ok = LoadFleetFeatures(options.InputPaths[0], fleet, diskTotals, malformedRows, error); }
+    unsigned threads = options.Threads ? options.Threads : std::thread::hardware_concurrency();
+    if (ok) { TRACE_SPAN("Sweep", "sweep"); ok = RunUpgradeSweep(fleet, diskTotals, base, axes, costs, threads ? threads : 1, points, error); }
+    if (!ok) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+    std::string text; FormatSweepCsv(axes, points, text);
+    if (options.OutputPath.empty() || options.OutputPath == "-") { fwrite(text.data(), 1, text.size(), stdout); fflush(stdout); }
+    else {
+        std::ofstream file(options.OutputPath.c_str(), std::ios::binary);
+        if (!file || !file.write(text.data(), (std::streamsize)text.size())) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Could not write " << options.OutputPath << std::endl; ResetConsoleColor(); return 1; }
+    }
+    SetConsoleColor(COLOR_INFO);
+    std::cerr << "Swept " << points.size() << " targets over " << fleet.Size() << " machines (" << malformedRows << " malformed rows skipped) in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s" << std::endl;
+    ResetConsoleColor();
+    return 0;
+}
 
-    // Helper lambda function to print a check result line
-    auto PrintCheck = [&](const std::wstring& label, const std::wstring& required, const std::wstring& detected, bool pass, bool warning = false, const std::wstring& note = L"") {
-        SetConsoleColor(COLOR_LABEL);
-        // Pad label for alignment
-        std::wstring paddedLabel = label;
-        paddedLabel.resize(19, L' '); // Adjust size as needed for alignment
-        std::wcout << L"  " << paddedLabel << L": ";
+// --- Batch Mode Entry Point ---
+// Usage: WinReadyCheck --batch <inventory.csv|fleet.wrcf|-> --target <key|all> [--output <verdicts.csv>] [--report <format>] [--threads N] [--chunk N] [--trace <file.json>]
+//                      [--aggregate <summary.txt|summary.json>] [--top K] [--cache <results.wrcc> [--delta <changes.csv>]]
+//                      [--plan] [--cost Name=Value]... [--sweep Field=Value:Value...]... [--store <results.wrcr>] [--sketch <stats.wrcs>]
+//                      [--processes N [--shard-dir <dir>]]   (worker processes get "--shard k/N --partial <prefix>" added, and their share of --threads)
+//        WinReadyCheck --batch <inventory.csv|fleet.wrcf|-> --profiles <baselines.csv> [--output <matches.csv>] [--threads N] [--chunk N]
+int RunBatchMode(int argc, char* argv[]) {
+    BatchOptions options; std::string targetKey, tracePath, profilesPath, aggregatePath; ProfileSet profiles;
+    FleetAggregate aggregate; size_t topK = 10; std::string cachePath; ResultCache cache; std::string storePath; ResultStoreWriter store;
+    std::string sketchPath; FleetSketch sketch;
+    ShardRun shardRun; unsigned processes = 1; std::string shardSpec, partialPrefix;
+    UpgradeCosts upgradeCosts; std::vector<SweepAxis> sweepAxes; std::string optionError;
+    std::unique_ptr<ReportRenderer> renderer; ReportFormat reportFormat = ReportPlain;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--target" && hasValue) { targetKey = argv[++i]; }
+        else if (arg == "--output" && hasValue) { options.OutputPath = argv[++i]; }
+        else if (arg == "--report" && hasValue && ParseReportFormat(argv[i + 1], reportFormat)) { renderer = CreateReportRenderer(reportFormat); options.Reports = renderer.get(); ++i; }
+        else if (arg == "--threads" && hasValue) { options.Threads = (unsigned)atoi(argv[++i]); }
+        else if (arg == "--chunk" && hasValue) { options.ChunkSize = (size_t)atoi(argv[++i]); }
+        else if (arg == "--trace" && hasValue) { tracePath = argv[++i]; }
+        else if (arg == "--profiles" && hasValue) { profilesPath = argv[++i]; }
+        else if (arg == "--aggregate" && hasValue) { aggregatePath = argv[++i]; options.Aggregate = &aggregate; }
+        else if (arg == "--top" && hasValue) { topK = (size_t)atoi(argv[++i]); }
+        else if (arg == "--cache" && hasValue) { cachePath = argv[++i]; options.Cache = &cache; }
+        else if (arg == "--delta" && hasValue) { options.DeltaPath = argv[++i]; }
+        else if (arg == "--store" && hasValue) { storePath = argv[++i]; }
+        else if (arg == "--sketch" && hasValue) { sketchPath = argv[++i]; options.Sketch = &sketch; }
+        else if (arg == "--processes" && hasValue) { processes = (unsigned)atoi(argv[++i]); }
+        else if (arg == "--shard-dir" && hasValue) { shardRun.WorkDir = argv[++i]; }
+        else if (arg == "--shard" && hasValue) { shardSpec = argv[++i]; }
+        else if (arg == "--partial" && hasValue) { partialPrefix = argv[++i]; }
+        else if (arg == "--plan") { options.Plan = &upgradeCosts; }
+        else if (arg == "--cost" && hasValue) { if (!SetUpgradeCost(upgradeCosts, argv[++i], optionError)) break; }
+        else if (arg == "--sweep" && hasValue) { SweepAxis axis; if (!ParseSweepAxis(argv[++i], axis, optionError)) break; sweepAxes.push_back(axis); }
+        else if (arg[0] == '@' && arg.size() > 1) { if (!ReadInputList(arg.substr(1), options.InputPaths, optionError)) break; }
+        else if (arg == "-" || arg[0] != '-') { options.InputPaths.push_back(arg); }
+        else { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Unknown or incomplete batch option '" << arg << "'." << std::endl; ResetConsoleColor(); return 1; }
+    }
+    if (!optionError.empty()) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << optionError << std::endl; ResetConsoleColor(); return 1; }
+    std::wstring targetKeyW(targetKey.begin(), targetKey.end());
+    int targetIndex = FindBuiltinTarget(targetKeyW.c_str());
+    bool allTargets = (targetKey == "all");
+    if (!profilesPath.empty()) {
+        std::string profileError;
+        if (!profiles.LoadFile(profilesPath, profileError)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << profileError << std::endl; ResetConsoleColor(); return 1; }
+        options.Profiles = &profiles; allTargets = true; // --target is not needed
+        SetConsoleColor(COLOR_INFO); std::cerr << "Loaded " << profiles.Size() << " profiles (index " << profiles.Index().MemoryBytes() / 1024 << " KB)" << std::endl; ResetConsoleColor();
+    }
+    if (options.InputPaths.empty() || (targetIndex < 0 && !allTargets)) {
+        SetConsoleColor(COLOR_ERROR); std::cerr << "Usage: WinReadyCheck --batch <inventory.csv|.jsonl|fleet.wrcf|-|@list.txt>... --target <key|all> [--output <file>] [--report ansi|plain|json|html] [--threads N] [--chunk N] [--trace <file.json>]" << std::endl;
+        std::cerr << "         [--aggregate <summary.txt|summary.json>] [--top K] [--cache <results.wrcc> [--delta <changes.csv>]]" << std::endl;
+        std::cerr << "         [--plan] [--cost Name=Value]... [--sweep Field=Value:Value...]... [--store <results.wrcr>] [--sketch <stats.wrcs>]   (single target only)" << std::endl;
+        std::cerr << "         [--processes N [--shard-dir <dir>]]" << std::endl;
+        std::cerr << "       WinReadyCheck --batch <inventory.csv|.jsonl|fleet.wrcf|-|@list.txt>... --profiles <baselines.csv> [--output <file>] [--threads N] [--chunk N]" << std::endl;
+        std::cerr << "Available keys: "; for (const BuiltinTarget& builtin : BUILTIN_TARGETS) { std::wcerr << builtin.Key << L" "; } std::cerr << "all" << std::endl; ResetConsoleColor();
+        return 1;
+    }
 
-        SetConsoleColor(COLOR_NOTE);
-        std::wcout << L"(Required: " << required << L") ";
-        SetConsoleColor(COLOR_LABEL);
-        std::wcout << L"Detected: ";
+    if (!sweepAxes.empty()) {
+        if (targetIndex < 0) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: --sweep needs a single --target as its starting point" << std::endl; ResetConsoleColor(); return 1; }
+        if (options.InputPaths.size() != 1) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: --sweep reads a single inventory" << std::endl; ResetConsoleColor(); return 1; }
+        if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+        const int result = RunSweepMode(options, BUILTIN_TARGETS[targetIndex].Requirements, sweepAxes, upgradeCosts);
+        if (!tracePath.empty()) FinishTrace(tracePath);
+        return result;
+    }
 
-        WORD valueColor = COLOR_VALUE; WORD statusColor = COLOR_SUCCESS; std::wstring statusText = L" [PASS]";
-        if (!pass) {
-            if (warning) { valueColor = COLOR_VALUE_WARN; statusColor = COLOR_WARNING; statusText = L" [WARN]"; anyWarnings = true; } // Set warning flag
-            else { valueColor = COLOR_VALUE_FAIL; statusColor = COLOR_FAILURE; statusText = L" [FAIL]"; overallPass = false; } // Hard failure
+    BatchStats stats; std::string error;
+    const WindowsRequirements* target = allTargets ? NULL : &BUILTIN_TARGETS[targetIndex].Requirements;
+    if (!shardSpec.empty()) { // Worker of a --processes run: partial results only, the coordinator reports and writes the files
+        if (partialPrefix.empty()) error = "--shard needs --partial <prefix>";
+        else if (!RunShardWorker(options, target, shardSpec, partialPrefix, error)) { if (error.empty()) error = "Shard " + shardSpec + " failed"; }
+        if (!error.empty()) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+        return 0;
+    }
+    if (processes > 1) { // The workers rerun this command line, minus the options only the coordinator acts on
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if ((arg == "--processes" || arg == "--shard-dir" || arg == "--output" || arg == "--trace" || arg == "--threads") && i + 1 < argc) { ++i; continue; }
+            shardRun.WorkerArgs.push_back(arg);
         }
-        SetConsoleColor(valueColor); std::wcout << detected; SetConsoleColor(statusColor); std::wcout << statusText;
-        if (!note.empty()) { SetConsoleColor(COLOR_NOTE); std::wcout << L" (" << note << L")"; }
-        std::wcout << std::endl; ResetConsoleColor();
-    };
-
-    // --- CPU Checks ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nCPU Requirements:" << std::endl; ResetConsoleColor();
-    bool cpuSpeedMet = cpu.MaxClockSpeed >= target.MinCpuSpeedMHz;
-    PrintCheck(L"Speed", std::to_wstring(target.MinCpuSpeedMHz) + L" MHz", (cpu.MaxClockSpeed == 0 ? L"N/A" : std::to_wstring(cpu.MaxClockSpeed) + L" MHz"), cpuSpeedMet, (cpu.MaxClockSpeed == 0));
-    bool cpuCoresMet = cpu.NumberOfCores >= target.MinCpuCores;
-    PrintCheck(L"Cores", std::to_wstring(target.MinCpuCores), (cpu.NumberOfCores == 0 ? L"N/A" : std::to_wstring(cpu.NumberOfCores)), cpuCoresMet, (cpu.NumberOfCores == 0));
-    bool cpuArchMet = !target.Require64Bit || cpu.Is64BitCapable;
-    PrintCheck(L"Architecture", (target.Require64Bit ? L"64-bit" : L"Any"), cpu.Architecture, cpuArchMet);
-    if (target.MinCpuGenerationLevel > 0) {
-        bool cpuGenMet = cpu.MinCpuGenerationLevel >= target.MinCpuGenerationLevel; std::wstring detectedGen = (cpu.MinCpuGenerationLevel > 0) ? (L"Simulated Level " + std::to_wstring(cpu.MinCpuGenerationLevel)) : L"Unknown (Live Detection)";
-        PrintCheck(L"CPU Generation", L"Supported List (Level " + std::to_wstring(target.MinCpuGenerationLevel) + L"+)", detectedGen, cpuGenMet, (cpu.MinCpuGenerationLevel == 0), L"Simplified Check");
-    }
-
-    // --- RAM Check ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nRAM Requirements:" << std::endl; ResetConsoleColor();
-    bool ramMet = ram.TotalPhysicalBytes >= target.MinRamBytes;
-    PrintCheck(L"Installed RAM", std::to_wstring(target.MinRamBytes / (1024*1024)) + L" MB", std::to_wstring(ram.TotalPhysicalBytes / (1024*1024)) + L" MB", ramMet);
-
-    // --- Disk Check ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nDisk Requirements:" << std::endl; ResetConsoleColor();
-    bool diskMet = disk.FreeBytesAvailableToUser >= target.MinDiskFreeBytes;
-    PrintCheck(L"System Drive Free", std::to_wstring(target.MinDiskFreeBytes / (1024*1024*1024)) + L" GB", std::to_wstring(disk.FreeBytesAvailableToUser / (1024*1024*1024)) + L" GB", diskMet);
-
-    // --- Firmware Check ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nFirmware Requirements:" << std::endl; ResetConsoleColor();
-    bool firmwareMet = !target.RequireUEFI || firm.FirmwareType == L"UEFI";
-    bool firmwareWarn = firm.FirmwareType == L"Unknown" || firm.FirmwareType == L"BIOS (Assumed)";
-    PrintCheck(L"System Firmware", (target.RequireUEFI ? L"UEFI" : L"Any"), firm.FirmwareType, firmwareMet, (firmwareWarn && target.RequireUEFI));
-
-    // --- Graphics Checks ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nGraphics Requirements:" << std::endl; ResetConsoleColor();
-    bool dxMet = false; bool wddmMet = false; UINT detectedDXLevel = 0; UINT detectedWDDMLevel = 0;
-    bool dxCheckPossible = graph.DirectXFeatureLevel != L"N/A"; bool wddmCheckPossible = graph.WDDMVersion != L"N/A";
-    try { if (dxCheckPossible) { detectedDXLevel = std::stoi(graph.DirectXFeatureLevel); dxMet = detectedDXLevel >= target.MinDirectXFeatureLevelMajor; } if (wddmCheckPossible) { size_t dotPos = graph.WDDMVersion.find(L'.'); if (dotPos != std::wstring::npos) { detectedWDDMLevel = std::stoi(graph.WDDMVersion.substr(0, dotPos)); } else { detectedWDDMLevel = std::stoi(graph.WDDMVersion); } wddmMet = detectedWDDMLevel >= target.MinWDDMVersionMajor; } } catch(...) {}
-    PrintCheck(L"DirectX Feature Lvl", L"v" + std::to_wstring(target.MinDirectXFeatureLevelMajor) + L".0+", (dxCheckPossible ? std::to_wstring(detectedDXLevel) : graph.DirectXFeatureLevel), dxMet, !dxCheckPossible, L"Manual check recommended");
-    PrintCheck(L"WDDM Driver Model", L"v" + std::to_wstring(target.MinWDDMVersionMajor) + L".0+", (wddmCheckPossible ? (std::to_wstring(detectedWDDMLevel) + L".x") : graph.WDDMVersion), wddmMet, !wddmCheckPossible, L"Manual check recommended");
-
-    // --- Display Check ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nDisplay Requirements:" << std::endl; ResetConsoleColor();
-    // Fixed sign comparison warning by casting screen dimensions to UINT
-    bool displayMet = (UINT)screen.Width >= target.MinScreenWidth && (UINT)screen.Height >= target.MinScreenHeight;
-    PrintCheck(L"Screen Resolution", std::to_wstring(target.MinScreenWidth) + L"x" + std::to_wstring(target.MinScreenHeight), std::to_wstring(screen.Width) + L"x" + std::to_wstring(screen.Height), displayMet, (screen.Width == 0 || screen.Height == 0));
-
-    // --- Security Checks ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\nSecurity Requirements:" << std::endl; ResetConsoleColor();
-    bool tpmMet = !target.RequireTpm || (sec.TpmFound && sec.TpmEnabled && sec.TpmSpecVersionMajor >= target.MinTpmVersionMajor);
-    bool tpmWarn = target.RequireTpm && (!sec.TpmFound || !sec.TpmEnabled);
-    std::wstring tpmDetectedStr = L"N/A"; if (sec.TpmVersionString != L"N/A") { tpmDetectedStr = sec.TpmFound ? (L"Yes, v" + std::to_wstring(sec.TpmSpecVersionMajor) + L"." + std::to_wstring(sec.TpmSpecVersionMinor) + (sec.TpmEnabled ? L", Enabled" : L", Disabled/Not Ready")) : sec.TpmVersionString; }
-    PrintCheck(L"TPM", (target.RequireTpm ? (L"v" + std::to_wstring(target.MinTpmVersionMajor) + L".0+, Enabled") : L"Not Required"), tpmDetectedStr, tpmMet, tpmWarn);
-    bool sbMet = !target.RequireSecureBoot || (firm.FirmwareType == L"UEFI" && sec.SecureBootEnabled);
-    bool sbWarn = target.RequireSecureBoot && (firm.FirmwareType != L"UEFI" || !sec.SecureBootCapable || sec.SecureBootStatus.find(L"Error") != std::wstring::npos || sec.SecureBootStatus.find(L"Admin") != std::wstring::npos || sec.SecureBootStatus.find(L"Unknown") != std::wstring::npos || sec.SecureBootStatus.find(L"N/A") != std::wstring::npos);
-    std::wstring sbDetectedStr = (firm.FirmwareType == L"UEFI") ? sec.SecureBootStatus : L"N/A (BIOS)";
-    PrintCheck(L"Secure Boot", (target.RequireSecureBoot ? L"Enabled" : L"Not Required"), sbDetectedStr, sbMet, sbWarn);
-
-    // --- Connectivity Check ---
-    if (target.RequireInternetForSetup) {
-        SetConsoleColor(COLOR_HEADING); std::cout << "\nOther Requirements:" << std::endl; ResetConsoleColor();
-        SetConsoleColor(COLOR_LABEL); std::cout << "  Internet Connection: "; SetConsoleColor(COLOR_WARNING); std::cout << "(Required for Setup/Activation of this edition)" << std::endl; ResetConsoleColor();
-    }
-
-    // --- Final Result (Updated) ---
-    SetConsoleColor(COLOR_HEADING); std::cout << "\n--- Overall Result ---" << std::endl; ResetConsoleColor();
-    if (overallPass) {
-        SetConsoleColor(COLOR_SUCCESS); std::wcout << L"This system appears to meet the minimum requirements for installing " << target.Name << L"." << std::endl;
-        if (anyWarnings) { SetConsoleColor(COLOR_WARNING); std::cout << "However, please review the [WARN] items above as they indicate potential issues or uncertainties." << std::endl; }
-    } else {
-        SetConsoleColor(COLOR_FAILURE); std::wcout << L"This system does NOT meet the minimum requirements for installing " << target.Name << L"." << std::endl;
-        SetConsoleColor(COLOR_NOTE); std::cout << "Please review the [FAIL] items above.";
-        if (anyWarnings) { std::cout << " Also review any [WARN] items for additional context."; }
-        std::cout << std::endl;
-    }
-    if (target.Name == L"Windows 11") { SetConsoleColor(COLOR_NOTE); std::cout << "Note: Windows 11 also has a specific CPU compatibility list. This tool uses a simplified generation check." << std::endl << "      For definitive CPU compatibility, check Microsoft's official list or PC Health Check app." << std::endl; }
-    if (target.MinDirectXFeatureLevelMajor >= 12 || target.MinWDDMVersionMajor >= 2) { SetConsoleColor(COLOR_NOTE); std::cout << "Note: Graphics checks (DirectX Feature Level, WDDM Version) are basic. Manual verification using 'dxdiag' command is recommended." << std::endl; }
-    if (target.RequireSecureBoot && sec.SecureBootStatus == L"Requires Admin (API)") { SetConsoleColor(COLOR_NOTE); std::cout << "Note: Run this tool as Administrator for a more accurate Secure Boot status check." << std::endl; }
+        // --threads (default: every hardware thread) is the budget for the whole run, shared out so N workers do not start N * T threads
+        const unsigned budget = options.Threads ? options.Threads : std::thread::hardware_concurrency();
+        shardRun.WorkerArgs.push_back("--threads"); shardRun.WorkerArgs.push_back(std::to_string(budget / processes ? budget / processes : 1));
+        shardRun.Processes = processes;
+        if (!cachePath.empty() || !storePath.empty()) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: The result cache and result store need a single process" << std::endl; ResetConsoleColor(); return 1; }
+    }
+    if (!cachePath.empty() && !cache.Load(cachePath, error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+    if (!storePath.empty()) {
+        if (allTargets) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: The result store needs a single target" << std::endl; ResetConsoleColor(); return 1; }
+        if (!store.Open(storePath, BUILTIN_TARGETS[targetIndex].Requirements, 0, error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+        options.Store = &store;
+    }
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+    const bool ok = processes > 1 ? RunShardedBatch(shardRun, options, target, stats, error) : RunBatch(options, target, stats, error);
+    if (!tracePath.empty()) FinishTrace(tracePath);
+    if (!ok) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+    SetConsoleColor(COLOR_INFO);
+    std::cerr << "Evaluated " << stats.Machines << " machines (" << stats.Passed << " pass, " << stats.Failed << " fail, " << stats.WithWarnings << " with warnings, "
+              << stats.MalformedRows << " malformed rows skipped) in " << stats.Seconds << " s" << std::endl;
+    if (options.Plan) std::cerr << "Upgrade plans: total cost " << stats.PlanCost << " for " << stats.Failed - stats.Unfixable << " failing machines, " << stats.Unfixable << " with no plan" << std::endl;
+    if (!cachePath.empty()) std::cerr << "Result cache: " << stats.Reused << " verdicts reused (" << stats.Unparsed << " unchanged rows not parsed), " << stats.Machines - stats.Reused << " machines evaluated, " << stats.Changes << " changes" << std::endl;
     ResetConsoleColor();
+    if (!cachePath.empty() && !cache.Save(cachePath, error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+    if (!storePath.empty()) {
+        if (!store.Finish(error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+        SetConsoleColor(COLOR_INFO); std::cerr << "Result store: " << store.Rows() << " verdicts written to " << storePath << std::endl; ResetConsoleColor();
+    }
+    if (!aggregatePath.empty()) {
+        const std::string targetName = WideToUtf8(BUILTIN_TARGETS[targetIndex].Requirements.Name); std::string summary;
+        const bool json = aggregatePath.size() >= 5 && aggregatePath.compare(aggregatePath.size() - 5, 5, ".json") == 0;
+        if (json) FormatAggregateJson(aggregate, targetName, topK, summary); else FormatAggregateText(aggregate, targetName, topK, summary);
+        std::ofstream file(aggregatePath.c_str(), std::ios::binary);
+        if (!file || !file.write(summary.data(), (std::streamsize)summary.size())) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Cannot write aggregate summary to " << aggregatePath << std::endl; ResetConsoleColor(); return 1; }
+        SetConsoleColor(COLOR_INFO); std::cerr << "Aggregate summary written to " << aggregatePath << std::endl; ResetConsoleColor();
+    }
+    if (!sketchPath.empty()) {
+        if (!SaveSketchFile(sketchPath, sketch, WideToUtf8(BUILTIN_TARGETS[targetIndex].Requirements.Name), error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+        SetConsoleColor(COLOR_INFO); std::cerr << "Fleet sketch (" << sketch.MemoryBytes() / 1024 << " KB) written to " << sketchPath << std::endl; ResetConsoleColor();
+    }
+    return 0;
 }
 // --- End Function Implementations ---
+
+// --- Fleet File Packing ---
+// Usage: WinReadyCheck --pack <inventory.csv> <fleet.wrcf>   (--batch accepts the packed file in place of the CSV)
+int RunPackMode(int argc, char* argv[]) {
+    if (argc != 4) { SetConsoleColor(COLOR_ERROR); std::cerr << "Usage: WinReadyCheck --pack <inventory.csv> <fleet.wrcf>" << std::endl; ResetConsoleColor(); return 1; }
+    size_t machines = 0, malformedRows = 0; std::string error;
+    if (!PackInventory(argv[2], argv[3], machines, malformedRows, error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+    SetConsoleColor(COLOR_INFO); std::cerr << "Packed " << machines << " machines (" << malformedRows << " malformed rows skipped) into " << argv[3] << std::endl; ResetConsoleColor();
+    return 0;
+}
+
+// --- Result Store Queries ---
+// Usage: WinReadyCheck --query <results.wrcr> [--failing Check;Check...] [--where Column=Min:Max] [--output <matches.csv>]
+// Writes MachineId,Result,FailedChecks,WarnedChecks,CpuName,GraphicsName for every stored machine that fails all listed
+// checks and lies inside the range; blocks whose statistics rule out a match are not read.
+int RunQueryMode(int argc, char* argv[]) {
+    std::string storePath, outputPath, error; ResultFilter filter;
+    for (int i = 2; i < argc && error.empty(); ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--failing" && hasValue) {
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin <= list.size() && error.empty();) {
+                size_t end = list.find(';', begin); if (end == std::string::npos) end = list.size();
+                const std::string name = list.substr(begin, end - begin); int id = 0;
+                while (id < CheckCount && name != CheckIdName((CheckId)id)) ++id;
+                if (id == CheckCount) { error = "Unknown check '" + name + "'. Available:"; for (int k = 0; k < CheckCount; ++k) { error += ' '; error += CheckIdName((CheckId)k); } }
+                else filter.Failing |= (unsigned short)(1u << id);
+                begin = end + 1;
+            }
+        }
+        else if (arg == "--where" && hasValue) { ParseResultFilterRange(argv[++i], filter, error); }
+        else if (arg == "--output" && hasValue) { outputPath = argv[++i]; }
+        else if (storePath.empty() && arg[0] != '-') { storePath = arg; }
+        else { error = "Unknown or incomplete query option '" + arg + "'."; }
+    }
+    if (error.empty() && storePath.empty()) {
+        SetConsoleColor(COLOR_ERROR); std::cerr << "Usage: WinReadyCheck --query <results.wrcr> [--failing Check;Check...] [--where Column=Min:Max] [--output <matches.csv>]" << std::endl; ResetConsoleColor();
+        return 1;
+    }
+    ResultStoreReader reader;
+    if (error.empty()) reader.Open(storePath, error);
+    std::ofstream outputFile; std::ostream* output = &std::cout;
+    if (error.empty() && !outputPath.empty() && outputPath != "-") {
+        outputFile.open(outputPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!outputFile) error = "Could not create output file '" + outputPath + "'";
+        output = &outputFile;
+    }
+    if (!error.empty()) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+
+    std::string text = "MachineId,Result,FailedChecks,WarnedChecks,CpuName,GraphicsName\n", lists; size_t matched = 0, blocksRead = 0;
+    auto AppendChecks = [&](unsigned mask) {
+        lists.clear();
+        for (int id = 0; id < CheckCount; ++id) { if (mask & (1u << id)) { if (!lists.empty()) lists += ';'; lists += CheckIdName((CheckId)id); } }
+        AppendCsvCell(text, lists);
+    };
+    const bool ok = reader.Scan(filter, [&](const ResultBlock& block, size_t row) {
+        const unsigned fail = block.Checks.Fail[row], warn = block.Checks.Warn[row];
+        AppendCsvCell(text, block.MachineIds[row]); text += ','; text += fail ? "FAIL" : (warn ? "WARN" : "PASS"); text += ',';
+        AppendChecks(fail); text += ','; AppendChecks(warn); text += ',';
+        AppendCsvCell(text, reader.DictionaryString(block.CpuName[row])); text += ','; AppendCsvCell(text, reader.DictionaryString(block.GpuName[row])); text += '\n';
+        ++matched;
+        if (text.size() >= (1 << 16)) { output->write(text.data(), (std::streamsize)text.size()); text.clear(); }
+    }, blocksRead, error);
+    output->write(text.data(), (std::streamsize)text.size()); output->flush();
+    if (!ok || !*output) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << (ok ? std::string("Failed writing query results") : error) << std::endl; ResetConsoleColor(); return 1; }
+    SetConsoleColor(COLOR_INFO);
+    std::cerr << "Matched " << matched << " of " << reader.Rows() << " machines (target " << reader.TargetName() << "); read " << blocksRead << " of " << reader.BlockCount() << " blocks" << std::endl;
+    ResetConsoleColor();
+    return 0;
+}
+
+// --- Fleet Sketch Reports ---
+// Usage: WinReadyCheck --sketch-report <stats.wrcs>... [--top K] [--output <summary.txt|summary.json>] [--save <merged.wrcs>]
+// Merges the sketch files of separate runs (sites, days, shards) for the same target and prints the combined summary.
+int RunSketchReportMode(int argc, char* argv[]) {
+    std::vector<std::string> paths; std::string outputPath, savePath, targetName, error; size_t topK = 10;
+    for (int i = 2; i < argc && error.empty(); ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--top" && hasValue) { topK = (size_t)atoi(argv[++i]); }
+        else if (arg == "--output" && hasValue) { outputPath = argv[++i]; }
+        else if (arg == "--save" && hasValue) { savePath = argv[++i]; }
+        else if (arg[0] != '-') { paths.push_back(arg); }
+        else { error = "Unknown or incomplete sketch report option '" + arg + "'."; }
+    }
+    if (error.empty() && paths.empty()) {
+        SetConsoleColor(COLOR_ERROR); std::cerr << "Usage: WinReadyCheck --sketch-report <stats.wrcs>... [--top K] [--output <summary.txt|summary.json>] [--save <merged.wrcs>]" << std::endl; ResetConsoleColor();
+        return 1;
+    }
+    FleetSketch merged;
+    for (size_t i = 0; i < paths.size() && error.empty(); ++i) { // In command line order, so a given list always merges to the same sketch
+        FleetSketch part; std::string partTarget;
+        if (!LoadSketchFile(paths[i], part, partTarget, error)) break;
+        if (i && partTarget != targetName) { error = "'" + paths[i] + "' was made for target " + partTarget + ", not " + targetName; break; }
+        targetName = partTarget; merged.Merge(part);
+    }
+    if (error.empty() && !savePath.empty()) SaveSketchFile(savePath, merged, targetName, error);
+    if (!error.empty()) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; }
+
+    std::string summary;
+    const bool json = outputPath.size() >= 5 && outputPath.compare(outputPath.size() - 5, 5, ".json") == 0;
+    if (json) FormatSketchJson(merged, targetName, topK, summary); else FormatSketchText(merged, targetName, topK, summary);
+    if (outputPath.empty() || outputPath == "-") { std::cout << summary; return 0; }
+    std::ofstream file(outputPath.c_str(), std::ios::binary);
+    if (!file || !file.write(summary.data(), (std::streamsize)summary.size())) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Cannot write sketch summary to " << outputPath << std::endl; ResetConsoleColor(); return 1; }
+    SetConsoleColor(COLOR_INFO); std::cerr << "Sketch summary of " << merged.Machines() << " machines written to " << outputPath << std::endl; ResetConsoleColor();
+    return 0;
+}
+
+// --- Readiness Agent ---
+// Usage: WinReadyCheck --agent [--pipe <\\.\pipe\name>] [--refresh-every Section=Seconds] [--probe-timeout <ms>] [--trace <file.json>]
+// COM/WMI are initialized once and the probes re-run in the background (agent.h); every client connection gets its own
+// pipe instance and thread, and each read is answered as one batch. Runs until Ctrl+C / Ctrl+Break / logoff.
+#ifndef PIPE_REJECT_REMOTE_CLIENTS
+#define PIPE_REJECT_REMOTE_CLIENTS 0x00000008 // Vista+; hidden by _WIN32_WINNT 0x0502 (XP rejects it, see RunAgentMode)
+#endif
+static std::atomic<bool> agentStopping(false);
+static std::atomic<int> agentBusy(0);     // Connection threads inside HandleRequests (waited for before the agent goes away)
+static std::string agentPipeName;
+
+static BOOL WINAPI OnAgentControl(DWORD) {
+    agentStopping.store(true);
+    HANDLE wake = CreateFileA(agentPipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL); // Unblocks ConnectNamedPipe
+    if (wake != INVALID_HANDLE_VALUE) CloseHandle(wake);
+    return TRUE;
+}
+
+static void ServeAgentPipe(ReadinessAgent& agent, HANDLE pipe) {
+    std::string pending, reply; std::vector<ReadinessAgent::Request> batch; char buffer[4096]; DWORD count = 0, written = 0;
+    while (!agentStopping.load() && (ReadFile(pipe, buffer, sizeof(buffer), &count, NULL) || GetLastError() == ERROR_MORE_DATA)) {
+        pending.append(buffer, count);
+        agentBusy.fetch_add(1);
+        if (agentStopping.load()) { agentBusy.fetch_sub(1); break; }
+        size_t begin = 0, newline; batch.clear();
+        while ((newline = pending.find('\n', begin)) != std::string::npos) { batch.push_back(ReadinessAgent::Request{ pending.substr(begin, newline - begin), &reply }); begin = newline + 1; }
+        pending.erase(0, begin);
+        if (!batch.empty()) { reply.clear(); agent.HandleRequests(batch); }
+        agentBusy.fetch_sub(1);
+        if (pending.size() > 4096) break; // No newline in sight: not a client of this protocol
+        if (!batch.empty() && !WriteFile(pipe, reply.data(), (DWORD)reply.size(), &written, NULL)) break;
+    }
+    DisconnectNamedPipe(pipe); CloseHandle(pipe);
+}
+
+int RunAgentMode(int argc, char* argv[]) {
+    AgentOptions options = DefaultAgentOptions(); std::string tracePath; agentPipeName = "\\\\.\\pipe\\WinReadyCheck";
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc); std::string error;
+        if (arg == "--pipe" && hasValue) { agentPipeName = argv[++i]; if (agentPipeName.find('\\') == std::string::npos) agentPipeName = "\\\\.\\pipe\\" + agentPipeName; }
+        else if (arg == "--refresh-every" && hasValue) { if (!SetAgentRefresh(options, argv[++i], error)) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: " << error << std::endl; ResetConsoleColor(); return 1; } }
+        else if (arg == "--probe-timeout" && hasValue && atoi(argv[i + 1]) > 0) { options.ProbeDeadlineMs = (unsigned)atoi(argv[++i]); }
+        else if (arg == "--trace" && hasValue) { tracePath = argv[++i]; }
+        else { SetConsoleColor(COLOR_ERROR); std::cerr << "Usage: WinReadyCheck --agent [--pipe <name>] [--refresh-every Section=Seconds] [--probe-timeout <ms>] [--trace <file.json>]" << std::endl; ResetConsoleColor(); return 1; }
+    }
+    if (!tracePath.empty()) { TraceStart(); TRACE_THREAD_NAME("main"); }
+
+    // --- COM/WMI once for the agent's lifetime (the refresh rounds reuse the connection) ---
+    IWbemServices* pSvc = NULL; bool wmiInitialized = false;
+    HRESULT hres = CoInitializeEx(0, COINIT_MULTITHREADED);
+    const bool comInitialized = SUCCEEDED(hres);
+    if (comInitialized) {
+        CoInitializeSecurity(NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL);
+        wmiInitialized = InitializeWMI(pSvc);
+    }
+    if (!wmiInitialized) { SetConsoleColor(COLOR_WARNING); std::cerr << "Warning: WMI is unavailable; the agent uses the API probes only." << std::endl; ResetConsoleColor(); }
+    options.MachineId = GetHostName();
+
+    ReadinessAgent agent(options, [pSvc, wmiInitialized](ProbeScheduler& scheduler, unsigned sections) { AddLiveProbes(scheduler, pSvc, wmiInitialized, sections); });
+    agent.Start();
+    SetConsoleCtrlHandler(OnAgentControl, TRUE);
+    SetConsoleColor(COLOR_INFO); std::cerr << "Agent listening on " << agentPipeName << " (Ctrl+C to stop)" << std::endl; ResetConsoleColor();
+
+    // --- Pipe instances: one per connected client (served by a detached thread), plus the one waiting in ConnectNamedPipe ---
+    int exitCode = 0;
+    DWORD localOnly = PIPE_REJECT_REMOTE_CLIENTS;
+    while (!agentStopping.load()) {
+        HANDLE pipe = CreateNamedPipeA(agentPipeName.c_str(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | localOnly, PIPE_UNLIMITED_INSTANCES, 65536, 4096, 0, NULL);
+        if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_INVALID_PARAMETER && localOnly) { localOnly = 0; continue; } // Windows XP: no PIPE_REJECT_REMOTE_CLIENTS
+        if (pipe == INVALID_HANDLE_VALUE) { SetConsoleColor(COLOR_ERROR); std::cerr << "Error: Cannot create pipe " << agentPipeName << " (error " << GetLastError() << ")" << std::endl; ResetConsoleColor(); exitCode = 1; break; }
+        if (!ConnectNamedPipe(pipe, NULL) && GetLastError() != ERROR_PIPE_CONNECTED) { CloseHandle(pipe); continue; }
+        if (agentStopping.load()) { DisconnectNamedPipe(pipe); CloseHandle(pipe); break; }
+        std::thread(ServeAgentPipe, std::ref(agent), pipe).detach();
+    }
+    // Idle clients stay blocked in ReadFile and see the pipe close when the process exits; a batch in progress finishes first
+    while (agentBusy.load()) Sleep(1);
+    agent.Stop();
+
+    if (wmiInitialized) CleanupWMI(pSvc);
+    if (comInitialized) CoUninitialize();
+    if (!tracePath.empty()) FinishTrace(tracePath);
+    return exitCode;
+}
@@ -0,0 +1,50 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>        // open
+#include <sys/mman.h>     // mmap / munmap
+#include <sys/stat.h>     // fstat
+#include <unistd.h>       // close
+#endif
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) { error = "Could not open '" + path + "'"; return false; }
+    LARGE_INTEGER fileSize; fileHandle = file;
+    if (!GetFileSizeEx(file, &fileSize) || (ULONGLONG)fileSize.QuadPart > (ULONGLONG)(size_t)-1) { error = "'" + path + "' is too large to map"; Close(); return false; }
+    if (fileSize.QuadPart == 0) return true; // CreateFileMapping rejects empty files
+    size = (size_t)fileSize.QuadPart;
+    mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mappingHandle) { error = "Could not map '" + path + "'"; Close(); return false; }
+    base = (const unsigned char*)MapViewOfFile((HANDLE)mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!base) { error = "Could not map '" + path + "' (a 32-bit build cannot map files near 2 GB)"; Close(); return false; }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = "Could not open '" + path + "'"; return false; }
+    struct stat info;
+    if (fstat(fd, &info) != 0) { error = "Could not open '" + path + "'"; close(fd); return false; }
+    if (info.st_size == 0) { close(fd); return true; } // mmap rejects a zero length
+    size = (size_t)info.st_size;
+    void* view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file referenced
+    if (view == MAP_FAILED) { error = "Could not map '" + path + "'"; size = 0; return false; }
+    base = (const unsigned char*)view;
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+    fileHandle = NULL; mappingHandle = NULL;
+#else
+    if (base) munmap((void*)base, size);
+#endif
+    base = NULL; size = 0;
+}
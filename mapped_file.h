@@ -0,0 +1,26 @@
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// --- Read-only File Mapping (fleet files, inventory exports) ---
+// Pages are loaded by the OS as they are touched; several threads may read the mapping at once.
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete; MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path, std::string& error); // An empty file maps as Size() == 0
+    void Close();
+    const unsigned char* Data() const { return base; }
+    size_t Size() const { return size; }
+private:
+    const unsigned char* base = NULL; size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = NULL; void* mappingHandle = NULL;
+#endif
+};
+
+#endif // MAPPED_FILE_H_INCLUDED
@@ -0,0 +1,353 @@
+#include "mapped_inventory.h"
+
+#include <algorithm>      // For std::search
+#include <cstring>        // For memchr
+#include "inventory.h"    // RecordField table, SplitCsvLine, FinishInventoryRecord
+#include "shard.h"        // ShardOf
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define WRC_PARSE_SSE2 1     // SSE2 is part of every x86-64 target, so no runtime dispatch is needed
+#include <emmintrin.h>
+#else
+#define WRC_PARSE_SSE2 0     // Other compilers/architectures (and 32-bit builds without -msse2) scan bytewise
+#endif
+
+// --- Delimiter Search ---
+// Next byte equal to a, b or c in [p, end); end if there is none. 16 bytes per step with SSE2.
+static const char* FindAny(const char* p, const char* end, char a, char b, char c) {
+#if WRC_PARSE_SSE2
+    const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)p);
+        const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)), _mm_cmpeq_epi8(block, vc));
+        const unsigned mask = (unsigned)_mm_movemask_epi8(hits);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+#endif
+    for (; p < end; ++p) { if (*p == a || *p == b || *p == c) return p; }
+    return end;
+}
+
+// Position just past the maxLines-th '\n' in [p, end) (end if there are fewer); lines gets the number of '\n' passed
+static const char* SkipLines(const char* p, const char* end, size_t maxLines, size_t& lines) {
+    lines = 0;
+    if (maxLines == 0) return p;
+#if WRC_PARSE_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+        const size_t count = (size_t)__builtin_popcount(mask);
+        if (lines + count < maxLines) { lines += count; continue; }
+        for (;; mask &= mask - 1) { if (++lines == maxLines) return p + __builtin_ctz(mask) + 1; }
+    }
+#endif
+    for (; p < end; ++p) { if (*p == '\n' && ++lines == maxLines) return p + 1; }
+    return end;
+}
+
+// --- Opening ---
+bool MappedInventory::Open(const std::string& path, std::string& error) {
+    if (!file.Open(path, error)) { error = "Could not open inventory file '" + path + "'"; return false; }
+    return OpenMemory((const char*)file.Data(), file.Size(), error);
+}
+
+bool MappedInventory::OpenMemory(const char* data, size_t length, std::string& error) {
+    text = data; size = length; columns.clear(); idColumn = (size_t)-1; dataBegin = 0; dataLine = 1; headerBegin = headerLength = 0;
+    if (size >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0) dataBegin = 3; // UTF-8 byte order mark (Excel, PowerShell exports)
+    const char* first = text + dataBegin;
+    while (first < text + size && (*first == ' ' || *first == '\t' || *first == '\r' || *first == '\n')) ++first;
+    if (first == text + size) { error = "Inventory is empty"; return false; }
+    format = (*first == '{') ? FormatJsonLines : FormatCsv;
+    return format == FormatJsonLines || ReadHeader(error);
+}
+
+bool MappedInventory::ReadHeader(std::string& error) {
+    const char* p = text + dataBegin; const char* end = text + size;
+    for (; p < end; ++dataLine) {
+        const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p)); if (!lineEnd) lineEnd = end;
+        const std::string line(p, lineEnd);
+        p = (lineEnd < end) ? lineEnd + 1 : end;
+        if (line.empty() || line == "\r") continue;
+        std::vector<std::string> cells;
+        if (!SplitCsvLine(line, cells)) { error = "Malformed header line"; return false; }
+        bool anyKnown = false;
+        for (const std::string& name : cells) {
+            const RecordField* field = FindRecordField(name);
+            if (field && strcmp(field->Name, "MachineId") == 0) idColumn = columns.size();
+            columns.push_back(field); anyKnown = anyKnown || field;
+        }
+        if (!anyKnown) { error = "Header names no known record field"; return false; }
+        headerBegin = (size_t)(lineEnd - text) - line.size(); headerLength = line.size() - (line[line.size() - 1] == '\r');
+        dataBegin = (size_t)(p - text); ++dataLine;
+        return true;
+    }
+    error = "Inventory is empty"; return false;
+}
+
+size_t MappedInventory::NextRange(size_t begin, size_t maxLines, size_t& lines) const {
+    return (size_t)(SkipLines(text + begin, text + size, maxLines, lines) - text);
+}
+
+// --- Parsing ---
+// Next line of [p, stop) that ParseRange reads; false at the end of the range. Advances p and lineNumber past it.
+static bool NextDataLine(const char*& p, const char* stop, bool csv, size_t& lineNumber, const char*& line, const char*& lineEnd) {
+    for (; p < stop; ++lineNumber) {
+        lineEnd = (const char*)memchr(p, '\n', (size_t)(stop - p)); if (!lineEnd) lineEnd = stop;
+        line = p; p = (lineEnd < stop) ? lineEnd + 1 : stop;
+        if (csv && (lineEnd == line || (lineEnd - line == 1 && *line == '\r'))) continue;
+        if (!csv) {
+            const char* first = line; while (first < lineEnd && (*first == ' ' || *first == '\t' || *first == '\r')) ++first;
+            if (first == lineEnd) continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+// One data line into record (fresh or reset to the defaults): false for a malformed row (error set) or one of another shard
+bool MappedInventory::ParseLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error, const RowShard* shard, bool& owned) const {
+    thread_local std::string id;
+    owned = true;
+    const bool ok = (format == FormatCsv) ? ParseCsvLine(line, end, lineNumber, record, error, shard, owned) : ParseJsonLine(line, end, lineNumber, record, error);
+    if (shard && format == FormatJsonLines) { // Keys come in any order: the whole object is read first
+        static const std::wstring defaultId = MachineRecord().MachineId; // Key missing or null; like a malformed object, no ID
+        id.clear(); if (ok && record.MachineId != defaultId) AppendUtf8(id, record.MachineId);
+        owned = ShardOf(id.data(), id.size(), lineNumber, shard->Count) == shard->Index;
+    }
+    if (ok && owned) FinishInventoryRecord(record);
+    return ok && owned;
+}
+
+void MappedInventory::ParseRange(size_t begin, size_t end, size_t firstLine, std::vector<MachineRecord>& records, std::vector<std::string>& errors,
+                                 const RowShard* shard, std::vector<size_t>* lines) const {
+    thread_local std::string error;
+    const char* p = text + begin; const char* stop = text + end; const char* line; const char* lineEnd; bool owned;
+    for (size_t lineNumber = firstLine; NextDataLine(p, stop, format == FormatCsv, lineNumber, line, lineEnd); ++lineNumber) {
+        records.emplace_back();
+        if (ParseLine(line, lineEnd, lineNumber, records.back(), error, shard, owned)) { if (lines) lines->push_back(lineNumber); continue; }
+        records.pop_back(); if (owned) errors.push_back(error);
+    }
+}
+
+void MappedInventory::ParseRange(size_t begin, size_t end, size_t firstLine, ParsedRows& rows, std::vector<std::string>& errors,
+                                 const RowShard* shard, std::vector<size_t>* lines) const {
+    thread_local std::string error; thread_local MachineRecord record;
+    static const MachineRecord defaults;
+    const char* p = text + begin; const char* stop = text + end; const char* line; const char* lineEnd; bool owned;
+    for (size_t lineNumber = firstLine; NextDataLine(p, stop, format == FormatCsv, lineNumber, line, lineEnd); ++lineNumber) {
+        record = defaults; // Copy-assigned: the strings keep their capacity from earlier rows
+        if (ParseLine(line, lineEnd, lineNumber, record, error, shard, owned)) { rows.Append(record); if (lines) lines->push_back(lineNumber); }
+        else if (owned) errors.push_back(error);
+    }
+}
+
+void MappedInventory::ParsedRows::Append(const MachineRecord& record) {
+    Features.push_back(ExtractFeatures(record)); DiskTotals.push_back(record.Disk.TotalBytes);
+    AppendUtf8(Names, record.MachineId); NameEnds.push_back(Names.size());
+    AppendUtf8(Names, record.Cpu.Name); NameEnds.push_back(Names.size());
+    AppendUtf8(Names, record.Graphics.Name); NameEnds.push_back(Names.size());
+}
+
+void MappedInventory::ParsedRows::AppendIdOnly(std::string_view machineId) {
+    Features.push_back(MachineFeatures()); DiskTotals.push_back(0);
+    Names.append(machineId.data(), machineId.size()); NameEnds.push_back(Names.size());
+    NameEnds.push_back(Names.size()); NameEnds.push_back(Names.size());
+}
+
+void MappedInventory::SplitRows(size_t begin, size_t end, size_t firstLine, std::vector<RawRow>& rows) const {
+    static const char idKey[] = "\"MachineId\"";
+    const char* p = text + begin; const char* stop = text + end;
+    for (size_t lineNumber = firstLine; p < stop; ++lineNumber) {
+        const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(stop - p)); if (!lineEnd) lineEnd = stop;
+        const char* line = p; p = (lineEnd < stop) ? lineEnd + 1 : stop;
+        if (lineEnd > line && lineEnd[-1] == '\r') --lineEnd;
+        if (format == FormatCsv && lineEnd == line) continue;
+        if (format == FormatJsonLines) {
+            const char* first = line; while (first < lineEnd && (*first == ' ' || *first == '\t' || *first == '\r')) ++first;
+            if (first == lineEnd) continue;
+        }
+        rows.emplace_back(); RawRow& row = rows.back();
+        row.Begin = (size_t)(line - text); row.Line = lineNumber; row.Bytes = std::string_view(line, (size_t)(lineEnd - line));
+        if (format == FormatCsv) { // Cells up to the ID column; a quote on the way means the row needs the real parser
+            if (idColumn == (size_t)-1) continue;
+            const char* cell = line;
+            for (size_t column = 0; ; ++column) {
+                const char* q = FindAny(cell, lineEnd, ',', '"', '"');
+                if (q < lineEnd && *q == '"') break;
+                if (column == idColumn) { row.MachineId = std::string_view(cell, (size_t)(q - cell)); break; }
+                if (q == lineEnd) break;
+                cell = q + 1;
+            }
+        } else { // "MachineId": "value" anywhere in the object, value without escapes
+            const char* key = std::search(line, lineEnd, idKey, idKey + sizeof(idKey) - 1);
+            if (key == lineEnd) continue;
+            const char* v = key + sizeof(idKey) - 1;
+            while (v < lineEnd && (*v == ' ' || *v == '\t')) ++v;
+            if (v == lineEnd || *v++ != ':') continue;
+            while (v < lineEnd && (*v == ' ' || *v == '\t')) ++v;
+            if (v == lineEnd || *v++ != '"') continue;
+            const char* close = FindAny(v, lineEnd, '"', '\\', '"');
+            if (close < lineEnd && *close == '"') row.MachineId = std::string_view(v, (size_t)(close - v));
+        }
+    }
+}
+
+// --- CSV Rows ---
+// Fast path: cells are views into the mapping, split at the commas FindAny finds. A row with a quote or a stray '\r'
+// takes the general SplitCsvLine path, so both readers accept exactly the same rows.
+bool MappedInventory::ParseCsvLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error, const RowShard* shard, bool& owned) const {
+    thread_local std::vector<std::string_view> cells; thread_local std::vector<std::string> unquoted; thread_local std::string copy;
+    cells.clear();
+    for (const char* cell = line;;) {
+        const char* q = FindAny(cell, end, ',', '"', '\r');
+        if (q == end || *q == ',') { cells.emplace_back(cell, (size_t)(q - cell)); if (q == end) break; cell = q + 1; continue; }
+        if (*q == '\r' && q + 1 == end) { cells.emplace_back(cell, (size_t)(q - cell)); break; }
+        cells.clear(); copy.assign(line, end); // Quoted cell or embedded '\r'
+        if (SplitCsvLine(copy, unquoted)) { for (const std::string& value : unquoted) cells.emplace_back(value); }
+        else cells.clear();
+        break;
+    }
+    if (shard) { // The raw MachineId cell decides (the line number for a row without one), so other shards' rows cost only the split
+        const std::string_view id = idColumn < cells.size() ? cells[idColumn] : std::string_view();
+        owned = ShardOf(id.data(), id.size(), lineNumber, shard->Count) == shard->Index;
+        if (!owned) return true;
+    }
+    if (cells.size() != columns.size()) { error = "Line " + std::to_string(lineNumber) + ": expected " + std::to_string(columns.size()) + " columns"; return false; }
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (!columns[i] || cells[i].empty()) continue; // Ignored column or missing value keeps the default
+        if (!columns[i]->Parse(record, cells[i])) { error = "Line " + std::to_string(lineNumber) + ": bad value '" + std::string(cells[i]) + "' for " + columns[i]->Name; return false; }
+    }
+    return true;
+}
+
+// --- JSON Lines Rows ---
+namespace {
+struct JsonLine {
+    const char* p; const char* end;
+    size_t LineNumber; MachineRecord* Record; std::string* Error;
+    std::string Key;                       // Dotted path of the current key ("Cpu.Name")
+    size_t Ordinal = 0;                    // Index of the current key within the line (key lookup cache)
+
+    bool Fail(const char* what) { *Error = "Line " + std::to_string(LineNumber) + ": malformed JSON (" + what + ")"; return false; }
+    void SkipSpace() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p; }
+
+    // String at p (opening quote); value views the line, or scratch when escapes had to be decoded
+    bool String(std::string& scratch, std::string_view& value) {
+        const char* start = ++p;
+        p = FindAny(p, end, '"', '\\', '"');
+        if (p < end && *p == '"') { value = std::string_view(start, (size_t)(p - start)); ++p; return true; }
+        scratch.assign(start, p);
+        while (p < end && *p != '"') {
+            if (*p != '\\') { scratch += *p++; continue; }
+            if (++p == end) break;
+            const char escape = *p++;
+            switch (escape) {
+                case '"': case '\\': case '/': scratch += escape; break;
+                case 'b': scratch += '\b'; break; case 'f': scratch += '\f'; break; case 'n': scratch += '\n'; break;
+                case 'r': scratch += '\r'; break; case 't': scratch += '\t'; break;
+                case 'u': {
+                    unsigned long cp = 0;
+                    if (!Hex4(cp)) return Fail("bad \\u escape");
+                    if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') { // Surrogate pair
+                        unsigned long low = 0; p += 2;
+                        if (!Hex4(low) || low < 0xDC00 || low > 0xDFFF) return Fail("bad surrogate pair");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD; // Unpaired surrogate
+                    AppendCodePoint(scratch, cp); break;
+                }
+                default: return Fail("bad escape");
+            }
+        }
+        if (p == end) return Fail("unterminated string");
+        ++p; value = scratch;
+        return true;
+    }
+    bool Hex4(unsigned long& cp) {
+        if (end - p < 4) return false;
+        for (int i = 0; i < 4; ++i, ++p) {
+            const char c = *p; cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= (unsigned long)(c - '0'); else if (c >= 'a' && c <= 'f') cp |= (unsigned long)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') cp |= (unsigned long)(c - 'A' + 10); else return false;
+        }
+        return true;
+    }
+    static void AppendCodePoint(std::string& out, unsigned long cp) {
+        if (cp < 0x80) { out += (char)cp; }
+        else if (cp < 0x800) { out += (char)(0xC0 | (cp >> 6)); out += (char)(0x80 | (cp & 0x3F)); }
+        else if (cp < 0x10000) { out += (char)(0xE0 | (cp >> 12)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+        else { out += (char)(0xF0 | (cp >> 18)); out += (char)(0x80 | ((cp >> 12) & 0x3F)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    }
+
+    // Arrays (and values under unknown keys) are stepped over without interpretation
+    bool SkipComposite() {
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') { thread_local std::string ignored; std::string_view unused; if (!String(ignored, unused)) return false; continue; }
+            ++p;
+            if (c == '{' || c == '[') ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0) return true;
+        }
+        return Fail("unterminated array or object");
+    }
+
+    // Cache of the fields the keys of the previous lines mapped to (exports repeat one key order on every line)
+    const RecordField* Field() {
+        thread_local std::vector<std::pair<std::string, const RecordField*>> cache;
+        if (Ordinal >= cache.size()) cache.resize(Ordinal + 1);
+        std::pair<std::string, const RecordField*>& slot = cache[Ordinal++];
+        if (slot.first != Key) { slot.first = Key; slot.second = FindRecordField(Key); }
+        return slot.second;
+    }
+
+    bool Object(int depth) {
+        if (depth > 8) return Fail("nested too deeply");
+        ++p; SkipSpace();
+        if (p < end && *p == '}') { ++p; return true; }
+        thread_local std::string keyScratch, valueScratch;
+        for (;;) {
+            SkipSpace();
+            std::string_view key;
+            if (p == end || *p != '"') return Fail("expected a key");
+            if (!String(keyScratch, key)) return false;
+            SkipSpace();
+            if (p == end || *p != ':') return Fail("expected ':'");
+            ++p; SkipSpace();
+            if (p == end) return Fail("expected a value");
+            const size_t keyLength = Key.size(); Key.append(key.data(), key.size());
+            if (*p == '{') { Key += '.'; if (!Object(depth + 1)) return false; }
+            else {
+                const RecordField* field = Field();
+                std::string_view value; bool present = true;
+                if (*p == '"') { if (!String(valueScratch, value)) return false; }
+                else if (*p == '[') { if (!SkipComposite()) return false; if (field) { *Error = "Line " + std::to_string(LineNumber) + ": bad value (array) for " + field->Name; return false; } present = false; }
+                else { // Number, true, false or null: the bare token
+                    const char* start = p;
+                    while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+                    value = std::string_view(start, (size_t)(p - start));
+                    if (value.empty()) return Fail("expected a value");
+                    present = (value != "null");
+                }
+                if (field && present && !value.empty() && !field->Parse(*Record, value)) { *Error = "Line " + std::to_string(LineNumber) + ": bad value '" + std::string(value) + "' for " + field->Name; return false; }
+            }
+            Key.resize(keyLength);
+            SkipSpace();
+            if (p < end && *p == ',') { ++p; continue; }
+            if (p < end && *p == '}') { ++p; return true; }
+            return Fail("expected ',' or '}'");
+        }
+    }
+};
+}
+
+bool MappedInventory::ParseJsonLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error) const {
+    thread_local JsonLine parser;
+    parser.p = line; parser.end = end; parser.LineNumber = lineNumber; parser.Record = &record; parser.Error = &error;
+    parser.Key.clear(); parser.Ordinal = 0;
+    parser.SkipSpace();
+    if (parser.p == end || *parser.p != '{') return parser.Fail("expected an object");
+    if (!parser.Object(0)) return false;
+    parser.SkipSpace();
+    return parser.p == end || parser.Fail("text after the object");
+}
@@ -0,0 +1,81 @@
+#ifndef MAPPED_INVENTORY_H_INCLUDED
+#define MAPPED_INVENTORY_H_INCLUDED
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "evaluate.h"
+#include "mapped_file.h"
+#include "sysinfo.h"
+
+struct RecordField;
+
+// --- Memory-mapped Inventory Parser (CSV or JSON Lines export) ---
+// Reads an inventory file in place instead of line by line through a stream. The file is mapped once; one thread cuts
+// it into ranges of whole lines (an SSE2 newline count, so this runs at memory speed), and any number of threads parse
+// ranges at the same time. Rows are split on SSE2 searches for the next delimiter, numbers go through std::from_chars,
+// and cells are handed to the record field table (inventory.h) without copies unless they need unquoting.
+//   CSV          Same rules as InventoryReader: a header line names the RecordField columns, one record per line
+//   JSON Lines   One object per line; keys are RecordField names ("Cpu.Name") or nested objects ({"Cpu":{"Name":..}}),
+//                strings, numbers, true/false; null or a missing key keeps the default, unknown keys are skipped
+// A malformed row is reported (with its line number, same wording as InventoryReader) and parsing goes on.
+class MappedInventory {
+public:
+    enum Format { FormatCsv, FormatJsonLines };
+
+    bool Open(const std::string& path, std::string& error);    // Maps the file; reads the CSV header
+    bool OpenMemory(const char* data, size_t size, std::string& error); // Same over a caller-owned buffer (bench)
+    Format TextFormat() const { return format; }
+    size_t Size() const { return size; }
+    size_t DataBegin() const { return dataBegin; }               // First byte after the CSV header
+    size_t DataLine() const { return dataLine; }                 // Line number of the line starting at DataBegin()
+    std::string_view Header() const { return std::string_view(text + headerBegin, headerLength); } // CSV header line; empty for JSON Lines
+
+    // End of the range that starts at begin (a line start) and holds up to maxLines lines; lines gets the count
+    size_t NextRange(size_t begin, size_t maxLines, size_t& lines) const;
+    // Appends the records of [begin, end) to records and one message per malformed row to errors. Thread-safe: ranges
+    // may be parsed concurrently (scratch buffers are per thread). With shard, only the rows whose MachineId belongs to
+    // that shard (ShardOf, shard.h) are kept or reported; a CSV row of another shard is dropped once it is split into
+    // cells, before any value is parsed. lines (optional) gets each appended record's line number.
+    struct RowShard { unsigned Index = 0, Count = 1; };
+    void ParseRange(size_t begin, size_t end, size_t firstLine, std::vector<MachineRecord>& records, std::vector<std::string>& errors,
+                    const RowShard* shard = NULL, std::vector<size_t>* lines = NULL) const;
+    // What batch evaluation keeps of a row when no full report is written: the checked values, the drive size (upgrade
+    // plans) and the names as UTF-8 views into one buffer. Rows are parsed into a per-thread record that is reset, not
+    // rebuilt, so a warm parse makes no allocation per row; the record's other display strings are dropped.
+    struct ParsedRows {
+        enum Name { MachineId, CpuName, GpuName, NameCount };
+        std::vector<MachineFeatures> Features; std::vector<ULONGLONG> DiskTotals;
+        std::string Names; std::vector<size_t> NameEnds; // Per row, NameCount ends in Names, back to back
+        size_t Size() const { return Features.size(); }
+        std::string_view Get(size_t row, Name name) const {
+            const size_t k = row * NameCount + name, begin = k ? NameEnds[k - 1] : 0;
+            return std::string_view(Names.data() + begin, NameEnds[k] - begin);
+        }
+        void Append(const MachineRecord& record);   // Its features, Disk.TotalBytes and names
+        void AppendIdOnly(std::string_view machineId); // Default features, no names (a row the result cache already has)
+        void Clear() { Features.clear(); DiskTotals.clear(); Names.clear(); NameEnds.clear(); }
+    };
+    void ParseRange(size_t begin, size_t end, size_t firstLine, ParsedRows& rows, std::vector<std::string>& errors,
+                    const RowShard* shard = NULL, std::vector<size_t>* lines = NULL) const;
+    // The data lines of [begin, end) without parsing them (the ones ParseRange would read): the line's bytes without its
+    // line break, and its unquoted MachineId value. MachineId is a guess from a quick scan and is empty when the row has
+    // none or it needs unescaping; the result cache only trusts it together with a hash of the whole line.
+    struct RawRow { size_t Begin = 0, Line = 0; std::string_view Bytes, MachineId; };
+    void SplitRows(size_t begin, size_t end, size_t firstLine, std::vector<RawRow>& rows) const;
+
+private:
+    bool ReadHeader(std::string& error);
+    bool ParseCsvLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error, const RowShard* shard, bool& owned) const;
+    bool ParseJsonLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error) const;
+    bool ParseLine(const char* line, const char* end, size_t lineNumber, MachineRecord& record, std::string& error, const RowShard* shard, bool& owned) const;
+    MappedFile file;
+    const char* text = NULL; size_t size = 0;
+    Format format = FormatCsv;
+    size_t dataBegin = 0, dataLine = 1;
+    size_t headerBegin = 0, headerLength = 0;
+    std::vector<const RecordField*> columns;                     // CSV: nullptr for ignored columns
+    size_t idColumn = (size_t)-1;                                // CSV: the MachineId column, if any
+};
+
+#endif // MAPPED_INVENTORY_H_INCLUDED
@@ -0,0 +1,122 @@
+#include "probe.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "trace.h"
+
+// --- Record Section Copy ---
+void CopyRecordSections(unsigned sections, const MachineRecord& from, MachineRecord& to) {
+    if (sections & SectionCpu) to.Cpu = from.Cpu;
+    if (sections & SectionRam) to.Ram = from.Ram;
+    if (sections & SectionDisk) to.Disk = from.Disk;
+    if (sections & SectionOs) to.Os = from.Os;
+    if (sections & SectionFirmware) to.Firmware = from.Firmware;
+    if (sections & SectionScreen) to.Screen = from.Screen;
+    if (sections & SectionDirectX) to.DirectX = from.DirectX;
+    if (sections & SectionSecurity) to.Security = from.Security;
+    if (sections & SectionGraphics) to.Graphics = from.Graphics;
+}
+
+const char* ProbeStateName(ProbeState state) {
+    switch (state) {
+        case ProbePending: return "pending"; case ProbeRunning: return "running"; case ProbeSucceeded: return "ok";
+        case ProbeFailed: return "failed"; case ProbeTimedOut: return "timed out"; default: return "skipped";
+    }
+}
+
+// --- Scheduler ---
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// Shared with the probe threads by shared_ptr, so an abandoned thread never touches freed memory
+struct CompletionChannel {
+    std::mutex Mutex;
+    std::condition_variable Signal;
+    std::vector<size_t> Finished;   // Indices of probes whose Run() returned, in completion order
+};
+
+struct ProbeJob {
+    std::shared_ptr<SystemProbe> Probe;
+    MachineRecord Scratch;          // Private copy the probe writes into
+    bool Ok = false;                // Written by the probe thread before it signals the channel
+};
+}
+
+void ProbeScheduler::AddProbe(std::shared_ptr<SystemProbe> probe, unsigned deadlineMs) {
+    Entry entry; entry.Probe = probe; entry.DeadlineMs = deadlineMs;
+    probes.push_back(entry);
+}
+
+void ProbeScheduler::Run(MachineRecord& record, std::vector<ProbeOutcome>& outcomes, const std::function<void(const SystemProbe&)>& onLaunch) {
+    const size_t count = probes.size();
+    std::shared_ptr<CompletionChannel> channel = std::make_shared<CompletionChannel>();
+    std::vector<std::shared_ptr<ProbeJob>> jobs(count);
+    std::vector<Clock::time_point> started(count), deadlines(count);
+    outcomes.assign(count, ProbeOutcome());
+    std::vector<unsigned long long> traceStarted(count, 0); unsigned timedOut = 0; // Trace span start per probe (only while tracing)
+    TRACE_SPAN("Probe scheduler", "phase");
+
+    unsigned scheduled = 0, resolved = 0;  // Sections some probe fills / sections whose probe has finished one way or another
+    for (size_t i = 0; i < count; ++i) { outcomes[i].Name = probes[i].Probe->Name(); outcomes[i].Section = probes[i].Probe->Section(); scheduled |= outcomes[i].Section; }
+
+    auto Elapsed = [&](size_t i, Clock::time_point now) { return std::chrono::duration<double, std::milli>(now - started[i]).count(); };
+    std::vector<size_t> finished;
+    for (;;) {
+        // --- Launch every pending probe whose dependencies are resolved (dependencies no probe fills are ignored) ---
+        size_t running = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (outcomes[i].State == ProbePending) {
+                const unsigned needs = probes[i].Probe->DependsOn() & scheduled;
+                if ((needs & resolved) != needs) continue;
+                std::shared_ptr<ProbeJob> job = std::make_shared<ProbeJob>();
+                job->Probe = probes[i].Probe; job->Scratch = record; jobs[i] = job;
+                if (onLaunch) onLaunch(*job->Probe);
+                started[i] = Clock::now();
+                deadlines[i] = started[i] + std::chrono::milliseconds(probes[i].DeadlineMs ? probes[i].DeadlineMs : defaultDeadlineMs);
+                outcomes[i].State = ProbeRunning;
+                if (TraceEnabled()) traceStarted[i] = TraceNowNs();
+                std::thread([job, channel, i]() {
+                    TRACE_THREAD_NAME(job->Probe->Name());
+                    bool ok;
+                    { TRACE_SPAN(job->Probe->Name(), "probe"); ok = job->Probe->Run(job->Scratch); }
+                    std::lock_guard<std::mutex> lock(channel->Mutex);
+                    job->Ok = ok; channel->Finished.push_back(i);
+                    channel->Signal.notify_one();
+                }).detach(); // Never joined: a probe stuck past its deadline must not hold up the report
+            }
+            if (outcomes[i].State == ProbeRunning) ++running;
+        }
+        if (running == 0) {
+            for (size_t i = 0; i < count; ++i) { if (outcomes[i].State == ProbePending) outcomes[i].State = ProbeSkipped; } // Dependency cycle
+            break;
+        }
+
+        // --- Wait for a completion or the earliest running deadline ---
+        Clock::time_point earliest = Clock::time_point::max();
+        for (size_t i = 0; i < count; ++i) { if (outcomes[i].State == ProbeRunning && deadlines[i] < earliest) earliest = deadlines[i]; }
+        {
+            std::unique_lock<std::mutex> lock(channel->Mutex);
+            channel->Signal.wait_until(lock, earliest, [&] { return !channel->Finished.empty(); });
+            finished.swap(channel->Finished); channel->Finished.clear();
+        }
+
+        const Clock::time_point now = Clock::now();
+        for (size_t i : finished) {
+            if (outcomes[i].State != ProbeRunning) continue; // Already declared timed out; its late result is discarded
+            CopyRecordSections(outcomes[i].Section, jobs[i]->Scratch, record);
+            outcomes[i].State = jobs[i]->Ok ? ProbeSucceeded : ProbeFailed;
+            outcomes[i].Milliseconds = Elapsed(i, now); resolved |= outcomes[i].Section;
+            jobs[i].reset();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (outcomes[i].State != ProbeRunning || now < deadlines[i]) continue;
+            outcomes[i].State = ProbeTimedOut; outcomes[i].Milliseconds = Elapsed(i, now);
+            if (traceStarted[i]) { TraceRecordSpan(outcomes[i].Name, "timeout", traceStarted[i], TraceNowNs()); TRACE_COUNTER("Probes timed out", ++timedOut); }
+            CopyRecordSections(outcomes[i].Section, MachineRecord(), record); // Defaults, so checks see "not detected"
+            record.TimedOutSections |= outcomes[i].Section; resolved |= outcomes[i].Section;
+            jobs[i].reset();
+        }
+    }
+}
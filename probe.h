@@ -0,0 +1,66 @@
+#ifndef PROBE_H_INCLUDED
+#define PROBE_H_INCLUDED
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "sysinfo.h"
+
+// --- Detection Probes ---
+// A probe fills one RecordSection of a MachineRecord (GetCpuInfoWMI -> Cpu, GetSecurityInfo -> Security, ...). Probes
+// are independent unless they declare a dependency (Secure Boot detection needs the firmware type first).
+class SystemProbe {
+public:
+    virtual ~SystemProbe() {}
+    virtual const char* Name() const = 0;           // Shown as "Checking <Name>..."
+    virtual unsigned Section() const = 0;           // RecordSection bit this probe fills
+    virtual unsigned DependsOn() const { return 0; } // Sections that must be finished (or timed out) before Run starts
+    // Runs on its own thread against a private copy of the record (dependencies already filled in). Only the probe's
+    // own section is copied back, and only if it finishes before its deadline.
+    virtual bool Run(MachineRecord& record) = 0;
+};
+
+// Adapter so plain detection functions can be scheduled without writing a class per probe
+class FunctionProbe : public SystemProbe {
+public:
+    FunctionProbe(const char* name, unsigned section, unsigned dependsOn, std::function<bool(MachineRecord&)> run)
+        : name(name), section(section), dependsOn(dependsOn), run(run) {}
+    const char* Name() const { return name; }
+    unsigned Section() const { return section; }
+    unsigned DependsOn() const { return dependsOn; }
+    bool Run(MachineRecord& record) { return run(record); }
+private:
+    const char* name; unsigned section; unsigned dependsOn;
+    std::function<bool(MachineRecord&)> run;
+};
+
+// --- Probe Scheduler ---
+enum ProbeState { ProbePending, ProbeRunning, ProbeSucceeded, ProbeFailed, ProbeTimedOut, ProbeSkipped };
+
+struct ProbeOutcome {
+    const char* Name = ""; unsigned Section = 0;
+    ProbeState State = ProbePending;
+    double Milliseconds = 0.0;   // Time from launch to result (or to the deadline)
+};
+
+// Runs every probe whose dependencies are satisfied concurrently, each on its own thread with its own deadline. A probe
+// that misses its deadline is abandoned: its thread keeps its private record copy and shared state alive until the
+// blocked call returns, and the record section is marked in MachineRecord::TimedOutSections so its checks become [WARN].
+// Wall time is close to the slowest probe chain rather than the sum of all probes.
+class ProbeScheduler {
+public:
+    explicit ProbeScheduler(unsigned defaultDeadlineMs = 15000) : defaultDeadlineMs(defaultDeadlineMs) {}
+    void AddProbe(std::shared_ptr<SystemProbe> probe, unsigned deadlineMs = 0); // 0 = scheduler default
+    void SetDefaultDeadline(unsigned deadlineMs) { defaultDeadlineMs = deadlineMs; }
+    void Run(MachineRecord& record, std::vector<ProbeOutcome>& outcomes, const std::function<void(const SystemProbe&)>& onLaunch = nullptr);
+private:
+    struct Entry { std::shared_ptr<SystemProbe> Probe; unsigned DeadlineMs; };
+    std::vector<Entry> probes;
+    unsigned defaultDeadlineMs;
+};
+
+// Copies the given RecordSection parts of one record into another
+void CopyRecordSections(unsigned sections, const MachineRecord& from, MachineRecord& to);
+const char* ProbeStateName(ProbeState state);
+
+#endif // PROBE_H_INCLUDED
@@ -0,0 +1,216 @@
+#include "profile_index.h"
+
+#include <algorithm>
+#include <cctype>         // For tolower
+#include <cerrno>
+#include <cstdlib>        // For strtoull
+#include <fstream>
+#include "inventory.h"    // SplitCsvLine, Utf8ToWide / WideToUtf8
+
+// --- Value Parsers ---
+static bool ParseProfileUnsigned(const std::string& value, ULONGLONG& out) {
+    if (value.empty() || value[0] == '-') return false;
+    errno = 0; char* end = NULL; unsigned long long v = strtoull(value.c_str(), &end, 10);
+    if (errno != 0 || end == value.c_str() || *end != '\0') return false;
+    out = v; return true;
+}
+bool ParseProfileBytes(const std::string& value, ULONGLONG& out) {
+    size_t digits = 0; while (digits < value.size() && isdigit((unsigned char)value[digits])) ++digits;
+    std::string suffix; for (size_t i = digits; i < value.size(); ++i) { if (value[i] != ' ') suffix += (char)tolower((unsigned char)value[i]); }
+    ULONGLONG n = 0; if (!ParseProfileUnsigned(value.substr(0, digits), n)) return false;
+    int shift = 0;
+    if (suffix.empty() || suffix == "b") shift = 0; else if (suffix == "kb") shift = 10; else if (suffix == "mb") shift = 20; else if (suffix == "gb") shift = 30; else if (suffix == "tb") shift = 40; else return false;
+    if (shift && n > (~0ULL >> shift)) return false;
+    out = n << shift; return true;
+}
+static bool ParseProfileBoolean(const std::string& value, bool& out) {
+    std::string v; for (char c : value) v += (char)tolower((unsigned char)c);
+    if (v == "1" || v == "true" || v == "yes" || v == "y") { out = true; return true; }
+    if (v == "0" || v == "false" || v == "no" || v == "n") { out = false; return true; }
+    return false;
+}
+
+// --- Profile Field Table (column name = WindowsRequirements member) ---
+struct ProfileField { const char* Name; bool (*Parse)(WindowsRequirements& profile, const std::string& value); };
+#define PROFILE_UINT(member) { #member, [](WindowsRequirements& p, const std::string& v) { ULONGLONG n = 0; if (!ParseProfileUnsigned(v, n) || n > 0xFFFFFFFFULL) return false; p.member = (UINT)n; return true; } }
+#define PROFILE_BYTES(member) { #member, [](WindowsRequirements& p, const std::string& v) { return ParseProfileBytes(v, p.member); } }
+#define PROFILE_BOOL(member) { #member, [](WindowsRequirements& p, const std::string& v) { return ParseProfileBoolean(v, p.member); } }
+
+static const ProfileField profileFields[] = {
+    PROFILE_UINT(MinCpuSpeedMHz), PROFILE_UINT(MinCpuCores), PROFILE_BOOL(Require64Bit), PROFILE_UINT(MinCpuGenerationLevel),
+    PROFILE_BYTES(MinRamBytes), PROFILE_BYTES(MinDiskFreeBytes),
+    PROFILE_UINT(MinDirectXFeatureLevelMajor), PROFILE_UINT(MinWDDMVersionMajor),
+    PROFILE_UINT(MinScreenWidth), PROFILE_UINT(MinScreenHeight),
+    PROFILE_BOOL(RequireUEFI), PROFILE_BOOL(RequireSecureBoot), PROFILE_BOOL(RequireTpm), PROFILE_UINT(MinTpmVersionMajor),
+    PROFILE_BOOL(RequireInternetForSetup),
+};
+
+bool SetProfileField(WindowsRequirements& profile, const std::string& name, const std::string& value, std::string& error) {
+    for (const ProfileField& field : profileFields) {
+        if (name != field.Name) continue;
+        if (!field.Parse(profile, value)) { error = "bad value '" + value + "' for " + name; return false; }
+        return true;
+    }
+    error = "unknown requirement '" + name + "'"; return false;
+}
+
+// --- Loading ---
+void ProfileSet::Add(const WindowsRequirements& profile, const std::wstring& name) {
+    names.push_back(name); namesUtf8.push_back(WideToUtf8(name));
+    profiles.push_back(profile); profiles.back().Name = names.back().c_str();
+}
+
+bool ProfileSet::Load(std::istream& in, std::string& error) {
+    std::string line; std::vector<std::string> cells; size_t lineNumber = 0;
+    std::vector<const ProfileField*> columns; int nameColumn = -1;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line == "\r" || line[0] == '#') continue; // '#' lines are comments
+        const std::string where = "Line " + std::to_string(lineNumber) + ": ";
+        if (!SplitCsvLine(line, cells)) { error = where + "unterminated quote"; return false; }
+        if (columns.empty() && nameColumn < 0) { // Header
+            for (size_t i = 0; i < cells.size(); ++i) {
+                const ProfileField* field = NULL;
+                for (const ProfileField& candidate : profileFields) { if (cells[i] == candidate.Name) field = &candidate; }
+                if (cells[i] == "Name") nameColumn = (int)i;
+                else if (!field) { error = where + "unknown profile column '" + cells[i] + "'"; return false; } // A typo would silently drop a requirement
+                columns.push_back(field);
+            }
+            if (nameColumn < 0) { error = where + "header has no Name column"; return false; }
+            continue;
+        }
+        if (cells.size() != columns.size()) { error = where + "expected " + std::to_string(columns.size()) + " columns"; return false; }
+        WindowsRequirements profile;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (!columns[i] || cells[i].empty()) continue;
+            if (!columns[i]->Parse(profile, cells[i])) { error = where + "bad value '" + cells[i] + "' for " + columns[i]->Name; return false; }
+        }
+        if (cells[nameColumn].empty()) { error = where + "profile has no name"; return false; }
+        Add(profile, Utf8ToWide(cells[nameColumn]));
+    }
+    if (profiles.empty()) { error = "Profile file defines no profiles"; return false; }
+    BuildIndex(); return true;
+}
+
+bool ProfileSet::LoadFile(const std::string& path, std::string& error) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) { error = "Could not open profile file '" + path + "'"; return false; }
+    if (!Load(in, error)) { error = path + ": " + error; return false; }
+    return true;
+}
+
+// --- Index Construction ---
+void ProfileIndex::Build(const std::vector<WindowsRequirements>& profiles) {
+    count = profiles.size(); words = (count + 63) / 64;
+    tailMask = (count % 64) ? (1ULL << (count % 64)) - 1 : ~0ULL;
+    none.assign(words, 0);
+    auto Threshold = [](const WindowsRequirements& p, int dim) -> ULONGLONG {
+        switch (dim) {
+            case DimCpuSpeed: return p.MinCpuSpeedMHz; case DimCpuCores: return p.MinCpuCores; case DimCpuGeneration: return p.MinCpuGenerationLevel;
+            case DimRam: return p.MinRamBytes; case DimDisk: return p.MinDiskFreeBytes;
+            case DimDirectX: return p.MinDirectXFeatureLevelMajor; case DimWddm: return p.MinWDDMVersionMajor;
+            case DimScreenWidth: return p.MinScreenWidth; case DimScreenHeight: return p.MinScreenHeight;
+            default: return p.RequireTpm ? p.MinTpmVersionMajor : 0; // A version minimum only counts when a TPM is required
+        }
+    };
+    for (int dim = 0; dim < DimCount; ++dim) {
+        Cuts& cuts = dims[dim]; cuts.Values.clear();
+        for (const WindowsRequirements& p : profiles) cuts.Values.push_back(Threshold(p, dim));
+        std::sort(cuts.Values.begin(), cuts.Values.end());
+        cuts.Values.erase(std::unique(cuts.Values.begin(), cuts.Values.end()), cuts.Values.end());
+        cuts.Rows.assign(cuts.Values.size() * words, 0);
+        for (size_t p = 0; p < count; ++p) {
+            const size_t row = std::lower_bound(cuts.Values.begin(), cuts.Values.end(), Threshold(profiles[p], dim)) - cuts.Values.begin();
+            cuts.Rows[row * words + (p >> 6)] |= 1ULL << (p & 63);
+        }
+        for (size_t row = 1; row < cuts.Values.size(); ++row) { // Prefix OR: row r = every threshold up to Values[r]
+            for (size_t w = 0; w < words; ++w) cuts.Rows[row * words + w] |= cuts.Rows[(row - 1) * words + w];
+        }
+    }
+    for (int req = 0; req < ReqCount; ++req) required[req].assign(words, 0);
+    for (size_t p = 0; p < count; ++p) {
+        const WindowsRequirements& t = profiles[p]; const unsigned long long bit = 1ULL << (p & 63);
+        if (t.Require64Bit) required[ReqIs64Bit][p >> 6] |= bit;
+        if (t.RequireUEFI) required[ReqUefi][p >> 6] |= bit;
+        if (t.RequireTpm) required[ReqTpm][p >> 6] |= bit;
+        if (t.RequireSecureBoot) required[ReqSecureBoot][p >> 6] |= bit;
+    }
+}
+
+const unsigned long long* ProfileIndex::Met(Dimension dim, ULONGLONG value) const {
+    const std::vector<ULONGLONG>& values = dims[dim].Values;
+    const size_t cut = std::upper_bound(values.begin(), values.end(), value) - values.begin();
+    return cut ? dims[dim].Rows.data() + (cut - 1) * words : none.data();
+}
+
+// --- Matching (mirrors EvaluateFeaturesInline check by check) ---
+void ProfileIndex::Match(const MachineFeatures& f, ProfileMatch& out) const {
+    out.Fail.assign(words, 0); out.Warn.assign(words, 0);
+    unsigned long long* const fail = out.Fail.data(); unsigned long long* const warn = out.Warn.data();
+    // Profiles that did not meet a check get [WARN] when the machine's value is missing/uncertain, [FAIL] otherwise
+    auto NotMet = [&](const unsigned long long* met, bool warning) { unsigned long long* o = warning ? warn : fail; for (size_t w = 0; w < words; ++w) o[w] |= ~met[w]; };
+    auto Requiring = [&](Requirement req, bool warning) { unsigned long long* o = warning ? warn : fail; const unsigned long long* set = required[req].data(); for (size_t w = 0; w < words; ++w) o[w] |= set[w]; };
+    const bool uefi = (f.Flags & FeatureUefi) != 0;
+
+    // --- CPU / RAM / Disk ---
+    NotMet(Met(DimCpuSpeed, f.CpuSpeedMHz), f.CpuSpeedMHz == 0);
+    NotMet(Met(DimCpuCores, f.CpuCores), f.CpuCores == 0);
+    if (!(f.Flags & FeatureIs64Bit)) Requiring(ReqIs64Bit, (f.Flags & FeatureCpuTimedOut) != 0);
+    NotMet(Met(DimCpuGeneration, f.CpuGenerationLevel), f.CpuGenerationLevel == 0); // Level 0 meets every profile that sets none
+    NotMet(Met(DimRam, f.RamBytes), (f.Flags & FeatureRamTimedOut) != 0);
+    NotMet(Met(DimDisk, f.DiskFreeBytes), (f.Flags & FeatureDiskTimedOut) != 0);
+
+    // --- Firmware ---
+    if (!uefi) Requiring(ReqUefi, (f.Flags & FeatureFirmwareUncertain) != 0);
+
+    // --- Graphics (an undetected level is a [WARN] for every profile, even one with no minimum) ---
+    NotMet((f.Flags & FeatureDXKnown) ? Met(DimDirectX, f.DXLevel) : none.data(), !(f.Flags & FeatureDXKnown));
+    NotMet((f.Flags & FeatureWDDMKnown) ? Met(DimWddm, f.WDDMLevel) : none.data(), !(f.Flags & FeatureWDDMKnown));
+
+    // --- Display (width and height must both be met) ---
+    const unsigned long long* width = Met(DimScreenWidth, f.ScreenWidth); const unsigned long long* height = Met(DimScreenHeight, f.ScreenHeight);
+    unsigned long long* const display = (f.ScreenWidth == 0 || f.ScreenHeight == 0) ? warn : fail;
+    for (size_t w = 0; w < words; ++w) display[w] |= ~(width[w] & height[w]);
+
+    // --- Security ---
+    if (f.Flags & FeatureTpmReady) NotMet(Met(DimTpmVersion, f.TpmVersionMajor), false);
+    else Requiring(ReqTpm, true);
+    if (!(uefi && (f.Flags & FeatureSecureBootEnabled))) Requiring(ReqSecureBoot, !uefi || (f.Flags & FeatureSecureBootUncertain) != 0);
+
+    if (words) { fail[words - 1] &= tailMask; warn[words - 1] &= tailMask; }
+}
+
+static inline size_t PopCount64(unsigned long long v) {
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    return (size_t)((((v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL) >> 56);
+}
+
+size_t ProfileIndex::SatisfiedCount(const ProfileMatch& match) const {
+    size_t failed = 0;
+    for (size_t w = 0; w < words; ++w) failed += PopCount64(match.Fail[w]);
+    return count - failed;
+}
+
+static inline size_t LowestBit64(unsigned long long v) { // v != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(v);
+#else
+    size_t bit = 0; while (!(v & 1)) { v >>= 1; ++bit; } return bit;
+#endif
+}
+
+size_t ProfileIndex::NextSatisfied(const ProfileMatch& match, size_t from) const {
+    for (size_t w = from >> 6; w < words; ++w) {
+        unsigned long long bits = ~match.Fail[w] & (w + 1 == words ? tailMask : ~0ULL);
+        if (w == (from >> 6)) bits &= ~0ULL << (from & 63);
+        if (bits) return w * 64 + LowestBit64(bits);
+    }
+    return count;
+}
+
+size_t ProfileIndex::MemoryBytes() const {
+    size_t bytes = (ReqCount + 1) * words * sizeof(unsigned long long);
+    for (const Cuts& cuts : dims) bytes += cuts.Values.size() * sizeof(ULONGLONG) + cuts.Rows.size() * sizeof(unsigned long long);
+    return bytes;
+}
@@ -0,0 +1,76 @@
+#ifndef PROFILE_INDEX_H_INCLUDED
+#define PROFILE_INDEX_H_INCLUDED
+
+#include <deque>
+#include <istream>
+#include <string>
+#include <vector>
+#include "evaluate.h"
+
+// --- Per-dimension Threshold Index ---
+// Matching a machine against N profiles one by one costs N evaluations. The index instead sorts the distinct thresholds
+// of every numeric requirement (speed, cores, CPU level, RAM, disk, DX, WDDM, width, height, TPM version) and stores, for
+// each cut, the bitset of profiles whose threshold is at or below it. A machine value then costs one binary search and
+// the profiles meeting that check are a ready-made row; the yes/no requirements (64-bit, UEFI, TPM, Secure Boot) are
+// one bitset each. Per check, the profiles not met become [WARN] or [FAIL] depending only on what the machine reported
+// (value 0, probe timed out, ...), exactly as EvaluateFeatures() decides, so the result matches N evaluations.
+// Memory is (distinct thresholds per dimension) * N / 8 bytes; baselines use round numbers, so the cuts stay few.
+struct ProfileMatch {
+    std::vector<unsigned long long> Fail; // Bit p: profile p has at least one [FAIL]
+    std::vector<unsigned long long> Warn; // Bit p: profile p has at least one [WARN]
+    bool Satisfied(size_t p) const { return !((Fail[p >> 6] >> (p & 63)) & 1); }  // No [FAIL]: "appears to meet"
+    bool Clean(size_t p) const { return !(((Fail[p >> 6] | Warn[p >> 6]) >> (p & 63)) & 1); }
+};
+
+class ProfileIndex {
+public:
+    void Build(const std::vector<WindowsRequirements>& profiles);
+    size_t Size() const { return count; }
+    // Reuses out's buffers, so matching a stream of machines does not allocate after the first call
+    void Match(const MachineFeatures& features, ProfileMatch& out) const;
+    size_t SatisfiedCount(const ProfileMatch& match) const;
+    size_t NextSatisfied(const ProfileMatch& match, size_t from) const; // First satisfied profile >= from; Size() when none
+    size_t MemoryBytes() const;
+private:
+    enum Dimension { DimCpuSpeed, DimCpuCores, DimCpuGeneration, DimRam, DimDisk, DimDirectX, DimWddm, DimScreenWidth, DimScreenHeight, DimTpmVersion, DimCount };
+    enum Requirement { ReqIs64Bit, ReqUefi, ReqTpm, ReqSecureBoot, ReqCount };
+    struct Cuts {
+        std::vector<ULONGLONG> Values;            // Distinct thresholds, ascending
+        std::vector<unsigned long long> Rows;     // Row r: profiles with threshold <= Values[r]
+    };
+    const unsigned long long* Met(Dimension dim, ULONGLONG value) const; // Profiles whose threshold value meets
+    size_t count = 0; size_t words = 0;
+    Cuts dims[DimCount];
+    std::vector<unsigned long long> required[ReqCount]; // Profiles that set the yes/no requirement
+    std::vector<unsigned long long> none;                // All zero: nothing met below the smallest cut
+    unsigned long long tailMask = ~0ULL;                 // Valid bits of the last word
+};
+
+bool ParseProfileBytes(const std::string& value, ULONGLONG& out); // "4294967296", "4GB", "512 MB"
+
+// --- User-defined Requirement Profiles (--profiles <baselines.csv>) ---
+// One profile per row; the header names WindowsRequirements members ("Name,MinCpuSpeedMHz,MinRamBytes,RequireTpm,...").
+// Missing columns keep their defaults (no requirement). Byte sizes accept an optional KB/MB/GB/TB suffix ("4GB").
+// Unlike an inventory, a malformed row fails the whole load: a silently dropped baseline would change verdicts.
+class ProfileSet {
+public:
+    bool Load(std::istream& in, std::string& error);
+    bool LoadFile(const std::string& path, std::string& error);
+    void Add(const WindowsRequirements& profile, const std::wstring& name); // Name pointer is redirected to owned storage
+    void BuildIndex() { index.Build(profiles); } // Load() calls this; after Add(), call it once all profiles are in
+    const ProfileIndex& Index() const { return index; }
+    size_t Size() const { return profiles.size(); }
+    const WindowsRequirements& Profile(size_t i) const { return profiles[i]; }
+    const std::vector<WindowsRequirements>& Profiles() const { return profiles; }
+    const std::string& NameUtf8(size_t i) const { return namesUtf8[i]; }
+private:
+    std::vector<WindowsRequirements> profiles;
+    std::deque<std::wstring> names;           // Deque: Name pointers stay valid as profiles are added
+    std::vector<std::string> namesUtf8;       // Batch output is UTF-8; converted once here, not per machine
+    ProfileIndex index;
+};
+
+// Sets the member named like a profile column ("MinRamBytes", value "8GB"); false with error on an unknown name or bad value
+bool SetProfileField(WindowsRequirements& profile, const std::string& name, const std::string& value, std::string& error);
+
+#endif // PROFILE_INDEX_H_INCLUDED
@@ -0,0 +1,310 @@
+#include "report.h"
+
+#include <cstring>        // For strlen
+#include <cwchar>         // For wcscmp
+#include "inventory.h"    // WideToUtf8
+#include "cpu_list.h"     // CpuListLevel
+
+// --- Number Formatting (appends in place; no temporary strings) ---
+static void AppendUnsigned(std::string& out, ULONGLONG value) {
+    char digits[20]; int count = 0;
+    do { digits[count++] = (char)('0' + value % 10); value /= 10; } while (value);
+    while (count) out += digits[--count];
+}
+static void AppendSigned(std::string& out, long long value) {
+    if (value < 0) { out += '-'; AppendUnsigned(out, 0ULL - (ULONGLONG)value); } else { AppendUnsigned(out, (ULONGLONG)value); }
+}
+
+// --- Report Construction (the wording CompareRequirements has always used) ---
+// Composed values are built in one scratch buffer per thread and copied into report.Text; fixed wording points at literals
+void BuildRequirementsReport(const WindowsRequirements& target, const MachineRecord& machine, const EvaluationResult& result, RequirementsReport& report) {
+    const CpuInfo& cpu = machine.Cpu; const SecurityInfo& sec = machine.Security;
+    thread_local std::string text;
+    report.Clear(); text.clear();
+    AppendUtf8(report.MachineId, machine.MachineId); AppendUtf8(report.TargetName, target.Name);
+
+    auto Keep = [&]() { const char* stored = report.Text.Store(text); text.clear(); return stored; };
+    auto Section = [&](const char* title) { ReportSection section = { title, report.Checks.size(), 0 }; report.Sections.push_back(section); };
+    auto Check = [&](CheckId id, const char* label, unsigned recordSection, const char* note = "") -> ReportCheck& {
+        report.Checks.emplace_back(); ReportCheck& check = report.Checks.back();
+        check.Id = id; check.Label = label; check.Status = result.Status[id];
+        check.Note = (machine.TimedOutSections & recordSection) ? "Detection timed out" : note;
+        ++report.Sections.back().CheckCount;
+        return check;
+    };
+
+    // --- CPU Checks ---
+    Section("CPU Requirements");
+    ReportCheck* c = &Check(CheckCpuSpeed, "Speed", SectionCpu);
+    AppendUnsigned(text, target.MinCpuSpeedMHz); text += " MHz"; c->Required = Keep();
+    if (cpu.MaxClockSpeed == 0) c->Detected = "N/A"; else { AppendUnsigned(text, cpu.MaxClockSpeed); text += " MHz"; c->Detected = Keep(); }
+    c = &Check(CheckCpuCores, "Cores", SectionCpu);
+    AppendUnsigned(text, target.MinCpuCores); c->Required = Keep();
+    if (cpu.NumberOfCores == 0) c->Detected = "N/A"; else { AppendUnsigned(text, cpu.NumberOfCores); c->Detected = Keep(); }
+    c = &Check(CheckCpuArchitecture, "Architecture", SectionCpu);
+    c->Required = target.Require64Bit ? "64-bit" : "Any"; AppendUtf8(text, cpu.Architecture); c->Detected = Keep();
+    if (result.IsApplicable(CheckCpuGeneration)) {
+        c = &Check(CheckCpuGeneration, "CPU Generation", SectionCpu, "Bundled CPU List");
+        text += "Supported List (Level "; AppendUnsigned(text, target.MinCpuGenerationLevel); text += "+)"; c->Required = Keep();
+        if (cpu.MinCpuGenerationLevel >= CpuListSupported) c->Detected = "On Supported List";
+        else if (cpu.MinCpuGenerationLevel > CpuListUnknown) c->Detected = "Not on Supported List";
+        else c->Detected = "Unknown (Not Recognized)";
+    }
+
+    // --- RAM / Disk Checks ---
+    Section("RAM Requirements");
+    c = &Check(CheckRam, "Installed RAM", SectionRam);
+    AppendUnsigned(text, target.MinRamBytes / (1024*1024)); text += " MB"; c->Required = Keep();
+    AppendUnsigned(text, machine.Ram.TotalPhysicalBytes / (1024*1024)); text += " MB"; c->Detected = Keep();
+    Section("Disk Requirements");
+    c = &Check(CheckDisk, "System Drive Free", SectionDisk);
+    AppendUnsigned(text, target.MinDiskFreeBytes / (1024*1024*1024)); text += " GB"; c->Required = Keep();
+    AppendUnsigned(text, machine.Disk.FreeBytesAvailableToUser / (1024*1024*1024)); text += " GB"; c->Detected = Keep();
+
+    // --- Firmware / Graphics / Display Checks ---
+    Section("Firmware Requirements");
+    c = &Check(CheckFirmware, "System Firmware", SectionFirmware);
+    c->Required = target.RequireUEFI ? "UEFI" : "Any"; AppendFirmwareText(text, machine.Firmware); c->Detected = Keep();
+    Section("Graphics Requirements");
+    c = &Check(CheckDirectX, "DirectX Feature Lvl", SectionGraphics, "Manual check recommended");
+    text += 'v'; AppendUnsigned(text, target.MinDirectXFeatureLevelMajor); text += ".0+"; c->Required = Keep();
+    AppendVersionText(text, machine.Graphics.DirectXFeatureLevel, '_'); c->Detected = Keep();
+    c = &Check(CheckWddm, "WDDM Driver Model", SectionGraphics, "Manual check recommended");
+    text += 'v'; AppendUnsigned(text, target.MinWDDMVersionMajor); text += ".0+"; c->Required = Keep();
+    AppendVersionText(text, machine.Graphics.WDDMVersion, '.'); c->Detected = Keep();
+    Section("Display Requirements");
+    c = &Check(CheckDisplay, "Screen Resolution", SectionScreen);
+    AppendUnsigned(text, target.MinScreenWidth); text += 'x'; AppendUnsigned(text, target.MinScreenHeight); c->Required = Keep();
+    AppendSigned(text, machine.Screen.Width); text += 'x'; AppendSigned(text, machine.Screen.Height); c->Detected = Keep();
+
+    // --- Security Checks ---
+    Section("Security Requirements");
+    c = &Check(CheckTpm, "TPM", SectionSecurity);
+    if (target.RequireTpm) { text += 'v'; AppendUnsigned(text, target.MinTpmVersionMajor); text += ".0+, Enabled"; c->Required = Keep(); } else { c->Required = "Not Required"; }
+    if (sec.TpmVersionString == L"N/A") { c->Detected = "N/A"; }
+    else if (!sec.TpmFound) { AppendUtf8(text, sec.TpmVersionString); c->Detected = Keep(); }
+    else {
+        text += "Yes, v"; AppendUnsigned(text, sec.TpmSpecVersionMajor); text += '.'; AppendUnsigned(text, sec.TpmSpecVersionMinor);
+        text += sec.TpmEnabled ? ", Enabled" : ", Disabled/Not Ready"; c->Detected = Keep();
+    }
+    c = &Check(CheckSecureBoot, "Secure Boot", SectionSecurity);
+    c->Required = target.RequireSecureBoot ? "Enabled" : "Not Required";
+    if (machine.Firmware.FirmwareType == FirmwareUefi) { AppendSecureBootText(text, sec); c->Detected = Keep(); }
+    else c->Detected = (machine.Firmware.FirmwareType == FirmwareBios) ? "N/A (BIOS)" : "N/A";
+
+    // --- Verdict and Notes ---
+    report.InternetRequired = target.RequireInternetForSetup;
+    report.OverallPass = result.OverallPass; report.AnyWarnings = result.AnyWarnings;
+    if (wcscmp(target.Name, BUILTIN_TARGETS[TargetWin11].Requirements.Name) == 0) report.Notes.push_back("Windows 11 also has a specific CPU compatibility list. This tool matches the CPU name against a bundled copy of that list. For definitive CPU compatibility, check Microsoft's official list or PC Health Check app.");
+    if (target.MinDirectXFeatureLevelMajor >= 12 || target.MinWDDMVersionMajor >= 2) report.Notes.push_back("Graphics checks (DirectX Feature Level, WDDM Version) are basic. Manual verification using 'dxdiag' command is recommended.");
+    if (target.RequireSecureBoot && sec.SecureBoot == SecureBootNeedsAdmin) report.Notes.push_back("Run this tool as Administrator for a more accurate Secure Boot status check.");
+}
+
+bool ParseReportFormat(const std::string& name, ReportFormat& format) {
+    if (name == "ansi") format = ReportAnsi;
+    else if (name == "plain" || name == "text") format = ReportPlain;
+    else if (name == "json") format = ReportJson;
+    else if (name == "html") format = ReportHtml;
+    else return false;
+    return true;
+}
+
+static const char* StatusKey(CheckStatus status) { return status == StatusFail ? "fail" : (status == StatusWarn ? "warn" : "pass"); }
+
+// Shared with the aggregate summary (aggregate.cpp)
+void AppendJsonString(std::string& out, const std::string& text) { AppendJsonString(out, text.data(), text.size()); }
+void AppendJsonString(std::string& out, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned char ch = (unsigned char)text[i];
+        switch (ch) {
+            case '"': out += "\\\""; break; case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break; case '\r': out += "\\r"; break; case '\t': out += "\\t"; break;
+            default:
+                if (ch < 0x20) { out += "\\u00"; out += hex[ch >> 4]; out += hex[ch & 15]; } else { out += (char)ch; }
+        }
+    }
+    out += '"';
+}
+static void AppendJsonString(std::string& out, const char* text) { AppendJsonString(out, text, strlen(text)); } // Labels, titles, report fields
+
+// Builtin target names/keys as UTF-8 without a temporary per call (the renderers are shared by threads)
+static const std::string& TargetText(const wchar_t* text) { thread_local std::string utf8; utf8.clear(); AppendUtf8(utf8, text); return utf8; }
+
+// --- Text (ANSI-colored or plain) ---
+namespace {
+// SGR colors matching the console palette in main.cpp (COLOR_HEADING, COLOR_LABEL, ...)
+const char* const SGR_RESET = "0"; const char* const SGR_HEADING = "96"; const char* const SGR_LABEL = "97"; const char* const SGR_NOTE = "90";
+const char* const SGR_PASS = "92"; const char* const SGR_WARN = "93"; const char* const SGR_FAIL = "91";
+
+class TextReportRenderer : public ReportRenderer {
+public:
+    explicit TextReportRenderer(bool ansi) : ansi(ansi) {}
+    void Render(const RequirementsReport& report, std::string& out) const override;
+    void Render(const TargetSummaryReport& summary, std::string& out) const override;
+private:
+    void Color(std::string& out, const char* sgr) const { if (ansi) { out += "\x1b["; out += sgr; out += 'm'; } }
+    static const char* StatusColor(CheckStatus status) { return status == StatusFail ? SGR_FAIL : (status == StatusWarn ? SGR_WARN : SGR_PASS); }
+    bool ansi;
+};
+
+void TextReportRenderer::Render(const RequirementsReport& report, std::string& out) const {
+    Color(out, SGR_HEADING); out += "\n--- Comparing "; out += report.MachineId.empty() ? "System Specs" : report.MachineId.c_str();
+    out += " against "; out += report.TargetName; out += " ---\n";
+    for (const ReportSection& section : report.Sections) {
+        Color(out, SGR_HEADING); out += '\n'; out += section.Title; out += ":\n";
+        for (size_t i = section.FirstCheck; i < section.FirstCheck + section.CheckCount; ++i) {
+            const ReportCheck& check = report.Checks[i];
+            Color(out, SGR_LABEL); out += "  "; out += check.Label;
+            for (size_t pad = std::char_traits<char>::length(check.Label); pad < 19; ++pad) out += ' '; // Align the ':' column
+            out += ": ";
+            Color(out, SGR_NOTE); out += "(Required: "; out += check.Required; out += ") ";
+            Color(out, SGR_LABEL); out += "Detected: ";
+            Color(out, StatusColor(check.Status)); out += check.Detected; out += " ["; out += CheckStatusTag(check.Status); out += ']';
+            if (*check.Note) { Color(out, SGR_NOTE); out += " ("; out += check.Note; out += ')'; }
+            Color(out, SGR_RESET); out += '\n';
+        }
+    }
+    if (report.InternetRequired) {
+        Color(out, SGR_HEADING); out += "\nOther Requirements:\n";
+        Color(out, SGR_LABEL); out += "  Internet Connection: "; Color(out, SGR_WARN); out += "(Required for Setup/Activation of this edition)"; Color(out, SGR_RESET); out += '\n';
+    }
+
+    Color(out, SGR_HEADING); out += "\n--- Overall Result ---\n";
+    if (report.OverallPass) {
+        Color(out, SGR_PASS); out += "This system appears to meet the minimum requirements for installing "; out += report.TargetName; out += ".\n";
+        if (report.AnyWarnings) { Color(out, SGR_WARN); out += "However, please review the [WARN] items above as they indicate potential issues or uncertainties.\n"; }
+    } else {
+        Color(out, SGR_FAIL); out += "This system does NOT meet the minimum requirements for installing "; out += report.TargetName; out += ".\n";
+        Color(out, SGR_NOTE); out += "Please review the [FAIL] items above.";
+        if (report.AnyWarnings) out += " Also review any [WARN] items for additional context.";
+        out += '\n';
+    }
+    for (const char* note : report.Notes) { Color(out, SGR_NOTE); out += "Note: "; out += note; out += '\n'; }
+    Color(out, SGR_RESET);
+}
+
+void TextReportRenderer::Render(const TargetSummaryReport& summary, std::string& out) const {
+    Color(out, SGR_HEADING); out += "\n--- Highest Supported Windows Version";
+    if (!summary.MachineId.empty()) { out += ": "; out += summary.MachineId; }
+    out += " ---\n";
+    Color(out, SGR_LABEL); out += "  Result: ";
+    if (summary.Targets.Highest >= 0) { Color(out, SGR_PASS); out += TargetText(BUILTIN_TARGETS[summary.Targets.Highest].Requirements.Name); }
+    else { Color(out, SGR_FAIL); out += "None of the supported targets"; }
+    Color(out, SGR_NOTE); out += "  (";
+    for (int id = 0; id < BuiltinTargetCount; ++id) {
+        const bool met = (summary.Targets.Satisfied & (1u << id)) != 0;
+        Color(out, met ? SGR_PASS : SGR_FAIL); out += TargetText(BUILTIN_TARGETS[id].Key); out += met ? " PASS" : " FAIL";
+        Color(out, SGR_NOTE); if (id + 1 < BuiltinTargetCount) out += ", ";
+    }
+    out += ")\n";
+    Color(out, SGR_RESET);
+}
+
+// --- JSON (one object per line) ---
+class JsonReportRenderer : public ReportRenderer {
+public:
+    void Render(const RequirementsReport& report, std::string& out) const override {
+        out += "{\"machineId\":"; AppendJsonString(out, report.MachineId);
+        out += ",\"target\":"; AppendJsonString(out, report.TargetName);
+        out += ",\"result\":\""; out += report.OverallPass ? (report.AnyWarnings ? "warn" : "pass") : "fail"; out += "\",\"sections\":[";
+        for (size_t s = 0; s < report.Sections.size(); ++s) {
+            const ReportSection& section = report.Sections[s];
+            if (s) out += ',';
+            out += "{\"title\":"; AppendJsonString(out, section.Title); out += ",\"checks\":[";
+            for (size_t i = section.FirstCheck; i < section.FirstCheck + section.CheckCount; ++i) {
+                const ReportCheck& check = report.Checks[i];
+                if (i != section.FirstCheck) out += ',';
+                out += "{\"check\":\""; out += CheckIdName(check.Id); out += "\",\"label\":"; AppendJsonString(out, check.Label);
+                out += ",\"required\":"; AppendJsonString(out, check.Required); out += ",\"detected\":"; AppendJsonString(out, check.Detected);
+                out += ",\"status\":\""; out += StatusKey(check.Status); out += '"';
+                if (*check.Note) { out += ",\"note\":"; AppendJsonString(out, check.Note); }
+                out += '}';
+            }
+            out += "]}";
+        }
+        out += "],\"internetRequired\":"; out += report.InternetRequired ? "true" : "false";
+        out += ",\"notes\":[";
+        for (size_t i = 0; i < report.Notes.size(); ++i) { if (i) out += ','; AppendJsonString(out, report.Notes[i]); }
+        out += "]}\n";
+    }
+    void Render(const TargetSummaryReport& summary, std::string& out) const override {
+        out += "{\"machineId\":"; AppendJsonString(out, summary.MachineId); out += ",\"highestSupported\":";
+        if (summary.Targets.Highest >= 0) AppendJsonString(out, TargetText(BUILTIN_TARGETS[summary.Targets.Highest].Requirements.Name)); else out += "null";
+        out += ",\"targets\":[";
+        for (int id = 0; id < BuiltinTargetCount; ++id) {
+            if (id) out += ',';
+            out += "{\"key\":"; AppendJsonString(out, TargetText(BUILTIN_TARGETS[id].Key));
+            out += ",\"satisfied\":"; out += (summary.Targets.Satisfied & (1u << id)) ? "true" : "false"; out += '}';
+        }
+        out += "]}\n";
+    }
+};
+
+// --- Static HTML ---
+static void AppendHtmlText(std::string& out, const char* text) {
+    for (; *text; ++text) {
+        const char ch = *text;
+        switch (ch) {
+            case '&': out += "&amp;"; break; case '<': out += "&lt;"; break; case '>': out += "&gt;"; break; case '"': out += "&quot;"; break;
+            default: out += ch;
+        }
+    }
+}
+static void AppendHtmlText(std::string& out, const std::string& text) { AppendHtmlText(out, text.c_str()); }
+
+class HtmlReportRenderer : public ReportRenderer {
+public:
+    void BeginDocument(std::string& out) const override {
+        out += "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>WinReadyCheck Report</title><style>\n"
+               "body{font-family:Segoe UI,sans-serif;margin:2em}table{border-collapse:collapse;margin-bottom:1em}th,td{padding:2px 10px;text-align:left}\n"
+               "th.section{padding-top:10px}.pass{color:#1a7f37}.warn{color:#9a6700}.fail{color:#cf222e}.note{color:#6e7781}\n"
+               "</style></head><body>\n";
+    }
+    void Render(const RequirementsReport& report, std::string& out) const override {
+        out += "<section class=\"report\"><h2>";
+        if (!report.MachineId.empty()) { AppendHtmlText(out, report.MachineId); out += " &ndash; "; }
+        AppendHtmlText(out, report.TargetName); out += "</h2>\n<table>\n<tr><th>Check</th><th>Required</th><th>Detected</th><th>Result</th><th>Note</th></tr>\n";
+        for (const ReportSection& section : report.Sections) {
+            out += "<tr><th class=\"section\" colspan=\"5\">"; AppendHtmlText(out, section.Title); out += "</th></tr>\n";
+            for (size_t i = section.FirstCheck; i < section.FirstCheck + section.CheckCount; ++i) {
+                const ReportCheck& check = report.Checks[i];
+                out += "<tr><td>"; AppendHtmlText(out, check.Label); out += "</td><td>"; AppendHtmlText(out, check.Required);
+                out += "</td><td>"; AppendHtmlText(out, check.Detected); out += "</td><td class=\""; out += StatusKey(check.Status); out += "\">";
+                out += CheckStatusTag(check.Status); out += "</td><td class=\"note\">"; AppendHtmlText(out, check.Note); out += "</td></tr>\n";
+            }
+        }
+        out += "</table>\n";
+        if (report.InternetRequired) out += "<p class=\"warn\">Internet connection required for Setup/Activation of this edition.</p>\n";
+        out += report.OverallPass ? "<p class=\"pass\">This system appears to meet the minimum requirements for installing " : "<p class=\"fail\">This system does NOT meet the minimum requirements for installing ";
+        AppendHtmlText(out, report.TargetName); out += ".</p>\n";
+        if (report.AnyWarnings) out += "<p class=\"warn\">Please review the [WARN] items above as they indicate potential issues or uncertainties.</p>\n";
+        for (const char* note : report.Notes) { out += "<p class=\"note\">Note: "; AppendHtmlText(out, note); out += "</p>\n"; }
+        out += "</section>\n";
+    }
+    void Render(const TargetSummaryReport& summary, std::string& out) const override {
+        out += "<section class=\"summary\"><h2>Highest Supported Windows Version";
+        if (!summary.MachineId.empty()) { out += ": "; AppendHtmlText(out, summary.MachineId); }
+        out += "</h2>\n<p>";
+        if (summary.Targets.Highest >= 0) { out += "<span class=\"pass\">"; AppendHtmlText(out, TargetText(BUILTIN_TARGETS[summary.Targets.Highest].Requirements.Name)); out += "</span>"; }
+        else out += "<span class=\"fail\">None of the supported targets</span>";
+        out += "</p>\n<ul>\n";
+        for (int id = 0; id < BuiltinTargetCount; ++id) {
+            const bool met = (summary.Targets.Satisfied & (1u << id)) != 0;
+            out += met ? "<li class=\"pass\">" : "<li class=\"fail\">"; AppendHtmlText(out, TargetText(BUILTIN_TARGETS[id].Requirements.Name)); out += met ? ": PASS</li>\n" : ": FAIL</li>\n";
+        }
+        out += "</ul></section>\n";
+    }
+    void EndDocument(std::string& out) const override { out += "</body></html>\n"; }
+};
+}
+
+std::unique_ptr<ReportRenderer> CreateReportRenderer(ReportFormat format) {
+    switch (format) {
+        case ReportJson: return std::unique_ptr<ReportRenderer>(new JsonReportRenderer());
+        case ReportHtml: return std::unique_ptr<ReportRenderer>(new HtmlReportRenderer());
+        case ReportPlain: return std::unique_ptr<ReportRenderer>(new TextReportRenderer(false));
+        default: return std::unique_ptr<ReportRenderer>(new TextReportRenderer(true));
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef REPORT_H_INCLUDED
+#define REPORT_H_INCLUDED
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "evaluate.h"
+#include "requirements.h"
+
+// --- Structured Requirements Report ---
+// Everything the detailed comparison report shows, as data (UTF-8 text). Renderers format it into one growable buffer
+// without touching the console, so the caller writes a whole report with a single call and batch mode can produce
+// thousands of reports bounded by formatting speed rather than console syscalls and flushes.
+// Built text lives in the report's arena and every buffer keeps its capacity across Clear(), so a report object reused
+// for machine after machine (batch workers, the bench) does no heap allocation once it has seen its largest machine.
+struct ReportCheck {
+    CheckId Id = CheckCpuSpeed; const char* Label = "";  // Label as shown in the text report, e.g. "Installed RAM"
+    const char* Required = ""; const char* Detected = ""; const char* Note = ""; // Literals or RequirementsReport::Text
+    CheckStatus Status = StatusPass;
+};
+struct ReportSection { const char* Title; size_t FirstCheck; size_t CheckCount; }; // "CPU Requirements" -> Checks[FirstCheck...]
+
+struct RequirementsReport {
+    std::string MachineId;                   // Empty for the local machine
+    std::string TargetName;
+    std::vector<ReportSection> Sections; std::vector<ReportCheck> Checks;
+    bool InternetRequired = false;           // "Internet Connection" line under Other Requirements
+    bool OverallPass = false; bool AnyWarnings = false;
+    std::vector<const char*> Notes;          // Advisory notes printed after the verdict
+    TextArena Text{1024};                    // Storage for the built Required/Detected strings; reset by Clear()
+    void Clear() { MachineId.clear(); TargetName.clear(); Sections.clear(); Checks.clear(); Notes.clear(); Text.Reset(); InternetRequired = OverallPass = AnyWarnings = false; }
+};
+void BuildRequirementsReport(const WindowsRequirements& target, const MachineRecord& machine, const EvaluationResult& result, RequirementsReport& report);
+
+// --- All-targets Summary ---
+struct TargetSummaryReport { std::string MachineId; TargetSetResult Targets; };
+
+// --- Renderers ---
+enum ReportFormat { ReportAnsi, ReportPlain, ReportJson, ReportHtml };
+bool ParseReportFormat(const std::string& name, ReportFormat& format); // "ansi", "plain" (or "text"), "json", "html"
+
+// Renderers append to out and keep no state, so one instance can be shared by worker threads. A document is
+// BeginDocument, any number of Render calls, then EndDocument (HTML wraps the page around the reports; JSON writes
+// one object per line).
+class ReportRenderer {
+public:
+    virtual ~ReportRenderer() {}
+    virtual void BeginDocument(std::string& out) const { (void)out; }
+    virtual void Render(const RequirementsReport& report, std::string& out) const = 0;
+    virtual void Render(const TargetSummaryReport& summary, std::string& out) const = 0;
+    virtual void EndDocument(std::string& out) const { (void)out; }
+};
+std::unique_ptr<ReportRenderer> CreateReportRenderer(ReportFormat format);
+void AppendJsonString(std::string& out, const std::string& text); // Quoted and escaped
+void AppendJsonString(std::string& out, const char* text, size_t length);
+
+#endif // REPORT_H_INCLUDED
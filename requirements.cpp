@@ -0,0 +1,20 @@
+#include "requirements.h"
+
+// --- Single-pass "Highest Supported Version" Evaluation ---
+
+static constexpr unsigned DOMINATED[BuiltinTargetCount] = { DominatedTargets(0), DominatedTargets(1), DominatedTargets(2), DominatedTargets(3), DominatedTargets(4) };
+static constexpr unsigned DOMINATING[BuiltinTargetCount] = { DominatingTargets(0), DominatingTargets(1), DominatingTargets(2), DominatingTargets(3), DominatingTargets(4) };
+
+TargetSetResult EvaluateAllBuiltinTargets(const MachineFeatures& features) {
+    TargetSetResult result;
+    unsigned resolved = 0, satisfied = 0;
+    for (int id = BuiltinTargetCount - 1; id >= 0; --id) {
+        if (resolved & (1u << id)) continue;
+        ++result.Evaluations;
+        if (BUILTIN_EVALUATORS[id](features).Fail == 0) { satisfied |= DOMINATED[id]; resolved |= DOMINATED[id]; }
+        else { resolved |= DOMINATING[id]; } // Anything at least as strict fails too
+        if (result.Highest < 0 && (satisfied & (1u << id))) result.Highest = id;
+    }
+    result.Satisfied = (unsigned char)satisfied;
+    return result;
+}
@@ -0,0 +1,99 @@
+#ifndef REQUIREMENTS_H_INCLUDED
+#define REQUIREMENTS_H_INCLUDED
+
+#include "evaluate.h"
+
+// --- Built-in Requirement Profiles (compile-time table; no startup work, no heap) ---
+enum BuiltinTargetId { TargetVista, TargetWin7, TargetWin81, TargetWin10, TargetWin11, BuiltinTargetCount };
+
+struct BuiltinTarget { const wchar_t* Key; WindowsRequirements Requirements; };
+
+// Oldest to newest; the user-facing keys are the ones accepted at the "Select Target Windows Version" prompt
+inline constexpr BuiltinTarget BUILTIN_TARGETS[BuiltinTargetCount] = {
+    // --- Windows Vista ---
+    { L"Vista", { L"Windows Vista", 800, 1, false, 0, 512ULL * 1024 * 1024, 15ULL * 1024 * 1024 * 1024, 9, 0, 800, 600, false, false, false, 0, false } },
+    // --- Windows 7 ---
+    { L"7", { L"Windows 7", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 16ULL * 1024 * 1024 * 1024, 9, 1, 800, 600, false, false, false, 0, false } },
+    // --- Windows 8.1 ---
+    { L"8.1", { L"Windows 8.1", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 16ULL * 1024 * 1024 * 1024, 9, 1, 1024, 768, false, false, false, 0, false } },
+    // --- Windows 10 ---
+    { L"10", { L"Windows 10", 1000, 1, false, 0, 1ULL * 1024 * 1024 * 1024, 32ULL * 1024 * 1024 * 1024, 9, 1, 800, 600, false, false, false, 0, false } },
+    // --- Windows 11 ---
+    { L"11", { L"Windows 11", 1000, 2, true, 8, 4ULL * 1024 * 1024 * 1024, 64ULL * 1024 * 1024 * 1024, 12, 2, 1280, 720, true, true, true, 2, true } },
+};
+
+// --- Key -> Index Mapping (usable in constant expressions, linear over five short keys at runtime) ---
+constexpr bool TargetKeyEquals(const wchar_t* a, const wchar_t* b) {
+    while (*a && *a == *b) { ++a; ++b; }
+    return *a == *b;
+}
+
+constexpr int FindBuiltinTarget(const wchar_t* key) { // -1 if the key is unknown
+    for (int i = 0; i < BuiltinTargetCount; ++i) { if (TargetKeyEquals(BUILTIN_TARGETS[i].Key, key)) return i; }
+    return -1;
+}
+
+static_assert(FindBuiltinTarget(L"Vista") == TargetVista && FindBuiltinTarget(L"7") == TargetWin7 && FindBuiltinTarget(L"8.1") == TargetWin81
+              && FindBuiltinTarget(L"10") == TargetWin10 && FindBuiltinTarget(L"11") == TargetWin11, "BUILTIN_TARGETS order must match BuiltinTargetId");
+
+// --- Per-target Evaluators ---
+// Each instantiation sees its profile as constants, so checks the profile switches off (RequireTpm=false, no CPU
+// generation level, ...) fold away and the rest become compares against immediates.
+template <int Id>
+CheckMasks EvaluateBuiltinTarget(const MachineFeatures& features) { return EvaluateFeaturesInline(BUILTIN_TARGETS[Id].Requirements, features); }
+
+typedef CheckMasks (*TargetEvaluator)(const MachineFeatures& features);
+
+inline constexpr TargetEvaluator BUILTIN_EVALUATORS[BuiltinTargetCount] = {
+    &EvaluateBuiltinTarget<TargetVista>, &EvaluateBuiltinTarget<TargetWin7>, &EvaluateBuiltinTarget<TargetWin81>,
+    &EvaluateBuiltinTarget<TargetWin10>, &EvaluateBuiltinTarget<TargetWin11>,
+};
+
+// --- Dominance Between Profiles ---
+// "hi" dominates "lo" when every threshold of hi is at least as strict. A machine with no [FAIL] against hi then has no
+// [FAIL] against lo either, so one passing evaluation settles several targets.
+constexpr bool TargetDominates(const WindowsRequirements& hi, const WindowsRequirements& lo) {
+    return hi.MinCpuSpeedMHz >= lo.MinCpuSpeedMHz && hi.MinCpuCores >= lo.MinCpuCores && hi.Require64Bit >= lo.Require64Bit
+        && hi.MinCpuGenerationLevel >= lo.MinCpuGenerationLevel && hi.MinRamBytes >= lo.MinRamBytes && hi.MinDiskFreeBytes >= lo.MinDiskFreeBytes
+        && hi.MinDirectXFeatureLevelMajor >= lo.MinDirectXFeatureLevelMajor && hi.MinWDDMVersionMajor >= lo.MinWDDMVersionMajor
+        && hi.MinScreenWidth >= lo.MinScreenWidth && hi.MinScreenHeight >= lo.MinScreenHeight
+        && hi.RequireUEFI >= lo.RequireUEFI && hi.RequireSecureBoot >= lo.RequireSecureBoot && hi.RequireTpm >= lo.RequireTpm
+        && hi.MinTpmVersionMajor >= lo.MinTpmVersionMajor;
+}
+
+constexpr unsigned DominatedTargets(int hi) { // Bitset of built-in targets (including hi itself) that hi dominates
+    unsigned mask = 0;
+    for (int lo = 0; lo < BuiltinTargetCount; ++lo) { if (TargetDominates(BUILTIN_TARGETS[hi].Requirements, BUILTIN_TARGETS[lo].Requirements)) mask |= 1u << lo; }
+    return mask;
+}
+
+constexpr unsigned DominatingTargets(int lo) { // Bitset of built-in targets (including lo itself) that dominate lo
+    unsigned mask = 0;
+    for (int hi = 0; hi < BuiltinTargetCount; ++hi) { if (TargetDominates(BUILTIN_TARGETS[hi].Requirements, BUILTIN_TARGETS[lo].Requirements)) mask |= 1u << hi; }
+    return mask;
+}
+
+static_assert((DominatedTargets(TargetWin10) & (1u << TargetVista)) && (DominatedTargets(TargetWin81) & (1u << TargetWin7)), "Expected Vista <= 7 <= 8.1 and 7 <= 10");
+
+// --- Probes for the "all" Target Set ---
+constexpr unsigned AllTargetsRequiredSections() {
+    unsigned sections = 0;
+    for (int i = 0; i < BuiltinTargetCount; ++i) sections |= RequiredSections(BUILTIN_TARGETS[i].Requirements);
+    return sections;
+}
+
+static_assert(!(RequiredSections(BUILTIN_TARGETS[TargetWin10].Requirements) & (SectionSecurity | SectionFirmware)) && (RequiredSections(BUILTIN_TARGETS[TargetWin11].Requirements) & SectionSecurity),
+              "Targets up to Windows 10 should not need the TPM/Secure Boot probes");
+
+// --- Single-pass Evaluation Against Every Built-in Profile ---
+struct TargetSetResult {
+    unsigned char Satisfied = 0;   // Bit per BuiltinTargetId: no [FAIL] (the report would say "appears to meet")
+    int Highest = -1;              // Newest satisfied BuiltinTargetId, -1 if none
+    int Evaluations = 0;           // Profiles actually evaluated (the rest were implied by dominance)
+};
+
+// Features are extracted once by the caller; targets are tried newest first and every pass/fail also settles the
+// profiles it dominates / is dominated by, so typically two or three of the five profiles are evaluated.
+TargetSetResult EvaluateAllBuiltinTargets(const MachineFeatures& features);
+
+#endif // REQUIREMENTS_H_INCLUDED
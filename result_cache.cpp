@@ -0,0 +1,100 @@
+#include "result_cache.h"
+
+#include <algorithm>
+#include <cstdio>         // For std::rename / std::remove
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "cpu_list.h"     // CpuListFingerprint
+
+// --- Hashing ---
+// 64-bit multiply/xor-shift mixing per field; the fields are fed one by one (not as raw struct bytes) so padding never
+// reaches the hash and a cache file stays valid across compilers
+static ULONGLONG Mix(ULONGLONG hash, ULONGLONG value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL;
+    hash *= 0xBF58476D1CE4E5B9ULL; hash ^= hash >> 31;
+    return hash;
+}
+
+ULONGLONG RequirementsFingerprint(const WindowsRequirements& t) {
+    ULONGLONG hash = Mix(0xCBF29CE484222325ULL, RESULT_CACHE_VERSION);
+    for (const wchar_t* c = t.Name; c && *c; ++c) hash = Mix(hash, (ULONGLONG)*c);
+    const ULONGLONG values[] = { t.MinCpuSpeedMHz, t.MinCpuCores, t.Require64Bit, t.MinCpuGenerationLevel, t.MinRamBytes, t.MinDiskFreeBytes,
+        t.MinDirectXFeatureLevelMajor, t.MinWDDMVersionMajor, t.MinScreenWidth, t.MinScreenHeight, t.RequireUEFI, t.RequireSecureBoot,
+        t.RequireTpm, t.MinTpmVersionMajor, (ULONGLONG)CheckCount };
+    for (ULONGLONG value : values) hash = Mix(hash, value);
+    return hash;
+}
+
+ULONGLONG FeatureHash(const MachineFeatures& f, ULONGLONG seed) {
+    ULONGLONG hash = seed;
+    hash = Mix(hash, ((ULONGLONG)f.CpuSpeedMHz << 32) | f.CpuCores); hash = Mix(hash, ((ULONGLONG)f.CpuGenerationLevel << 32) | f.Flags);
+    hash = Mix(hash, f.RamBytes); hash = Mix(hash, f.DiskFreeBytes);
+    hash = Mix(hash, ((ULONGLONG)f.ScreenWidth << 32) | f.ScreenHeight);
+    hash = Mix(hash, ((ULONGLONG)f.DXLevel << 32) | f.WDDMLevel); hash = Mix(hash, f.TpmVersionMajor);
+    return hash;
+}
+
+ULONGLONG RowSeed(ULONGLONG fingerprint, const char* header, size_t headerLength) {
+    return RowHash(header, headerLength, Mix(fingerprint, CpuListFingerprint()));
+}
+
+ULONGLONG RowHash(const char* row, size_t length, ULONGLONG seed) { // 8 bytes per step; the length keeps "a" and "a\0" apart
+    ULONGLONG hash = Mix(seed, length);
+    for (; length >= 8; row += 8, length -= 8) { ULONGLONG word; memcpy(&word, row, 8); hash = Mix(hash, word); }
+    ULONGLONG tail = 0; memcpy(&tail, row, length);
+    hash = Mix(hash, tail);
+    return hash ? hash : 1;
+}
+
+// --- Cache File (little-endian) ---
+//   magic[8] | UINT32 version | UINT32 reserved | ULONGLONG entry count
+//   per entry: UINT32 id length | UTF-8 MachineId | ULONGLONG hash | ULONGLONG row hash (version 2+) | WORD fail | WORD warn
+bool ResultCache::Load(const std::string& path, std::string& error) {
+    entries.clear();
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) return true; // First run
+    char magic[8]; UINT32 version = 0, reserved = 0; ULONGLONG count = 0;
+    file.read(magic, sizeof(magic)); file.read((char*)&version, sizeof(version)); file.read((char*)&reserved, sizeof(reserved)); file.read((char*)&count, sizeof(count));
+    if (!file || memcmp(magic, RESULT_CACHE_MAGIC, sizeof(magic)) != 0) { error = "'" + path + "' is not a result cache file"; return false; }
+    if (version != RESULT_CACHE_VERSION && version != 1) { error = "Unsupported result cache version " + std::to_string(version) + " ('" + path + "'); delete it to rebuild"; return false; }
+    entries.reserve((size_t)std::min<ULONGLONG>(count, 1u << 24)); // A corrupt count must not trigger a huge allocation
+    std::string id; const std::string truncated = "Result cache '" + path + "' is truncated; delete it to rebuild";
+    for (ULONGLONG i = 0; i < count; ++i) {
+        UINT32 length = 0; CachedResult result;
+        if (!file.read((char*)&length, sizeof(length)) || length > (1u << 20)) { error = truncated; entries.clear(); return false; }
+        id.resize(length);
+        if (length) file.read(&id[0], length);
+        file.read((char*)&result.Hash, sizeof(result.Hash)); if (version >= 2) file.read((char*)&result.RowHash, sizeof(result.RowHash));
+        file.read((char*)&result.Fail, sizeof(result.Fail)); file.read((char*)&result.Warn, sizeof(result.Warn));
+        if (!file) { error = truncated; entries.clear(); return false; }
+        entries[id] = result;
+    }
+    return true;
+}
+
+bool ResultCache::Save(const std::string& path, std::string& error) const {
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) { error = "Cannot write " + temp; return false; }
+        const UINT32 version = RESULT_CACHE_VERSION, reserved = 0; const ULONGLONG count = entries.size();
+        file.write(RESULT_CACHE_MAGIC, sizeof(RESULT_CACHE_MAGIC)); file.write((const char*)&version, sizeof(version)); file.write((const char*)&reserved, sizeof(reserved)); file.write((const char*)&count, sizeof(count));
+        std::vector<char> buffer; // One write per entry would dominate a million-machine save
+        for (const Table::value_type& entry : entries) {
+            const UINT32 length = (UINT32)entry.first.size(); const CachedResult& result = entry.second;
+            buffer.insert(buffer.end(), (const char*)&length, (const char*)&length + sizeof(length));
+            buffer.insert(buffer.end(), entry.first.begin(), entry.first.end());
+            buffer.insert(buffer.end(), (const char*)&result.Hash, (const char*)&result.Hash + sizeof(result.Hash));
+            buffer.insert(buffer.end(), (const char*)&result.RowHash, (const char*)&result.RowHash + sizeof(result.RowHash));
+            buffer.insert(buffer.end(), (const char*)&result.Fail, (const char*)&result.Fail + sizeof(result.Fail));
+            buffer.insert(buffer.end(), (const char*)&result.Warn, (const char*)&result.Warn + sizeof(result.Warn));
+            if (buffer.size() >= (1u << 16)) { file.write(buffer.data(), (std::streamsize)buffer.size()); buffer.clear(); }
+        }
+        file.write(buffer.data(), (std::streamsize)buffer.size());
+        if (!file.flush()) { error = "Cannot write " + temp; return false; }
+    }
+    std::remove(path.c_str()); // rename() does not replace an existing file on Windows
+    if (std::rename(temp.c_str(), path.c_str()) != 0) { error = "Cannot replace " + path; std::remove(temp.c_str()); return false; }
+    return true;
+}
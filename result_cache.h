@@ -0,0 +1,51 @@
+#ifndef RESULT_CACHE_H_INCLUDED
+#define RESULT_CACHE_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include "evaluate.h"
+
+// --- Incremental Batch Results (--batch ... --cache <results.wrcc> [--delta <changes.csv>]) ---
+// Nightly inventory exports differ in only a few machines. The cache keeps, per MachineId, a hash of the machine's
+// MachineFeatures (the normalized record: every value the checks read, strings already interpreted) seeded with a
+// fingerprint of the target profile, plus the Fail/Warn masks that record produced. On the next run a machine whose
+// hash is unchanged reuses its masks; only new or changed machines are evaluated. Editing the profile changes the seed,
+// so every machine misses once and the delta lists exactly the verdicts the edit flipped.
+// Entries read from a mapped inventory also keep a hash of the raw line. A line whose bytes hash the same as last time
+// is not even parsed: the batch reader takes its MachineId straight from the line and reuses the cached masks.
+const char RESULT_CACHE_MAGIC[8] = { 'W', 'R', 'C', 'R', 'E', 'S', 'L', 'T' };
+const UINT32 RESULT_CACHE_VERSION = 2;   // Bump whenever the hash or the check set changes (version 1 files load without line hashes)
+
+struct CachedResult {
+    ULONGLONG Hash = 0;
+    ULONGLONG RowHash = 0;               // RowHash() of the inventory line it came from; 0 if not read from a mapped inventory
+    unsigned short Fail = 0; unsigned short Warn = 0;
+    bool Seen = false;                   // Set by MarkSeen() during a run; entries never seen were removed from the inventory
+};
+
+ULONGLONG RequirementsFingerprint(const WindowsRequirements& target);   // Name, every threshold and RESULT_CACHE_VERSION
+ULONGLONG FeatureHash(const MachineFeatures& features, ULONGLONG seed);   // seed = RequirementsFingerprint(target)
+// A line's meaning depends on the CSV header (column order) and the bundled CPU list as well as on the profile
+ULONGLONG RowSeed(ULONGLONG fingerprint, const char* header, size_t headerLength);
+ULONGLONG RowHash(const char* row, size_t length, ULONGLONG seed);        // Never 0
+
+class ResultCache {
+public:
+    typedef std::unordered_map<std::string, CachedResult> Table;
+
+    bool Load(const std::string& path, std::string& error); // True with an empty cache if there is no file yet
+    bool Save(const std::string& path, std::string& error) const; // Writes a temp file, then renames it
+    // Find() may run on many threads at once while one thread calls MarkSeen(); Store()/Erase() may insert or rehash, so
+    // they must wait until no lookups are running
+    const CachedResult* Find(const std::string& machineId) const { Table::const_iterator it = entries.find(machineId); return it == entries.end() ? NULL : &it->second; }
+    void MarkSeen(const CachedResult* entry) { const_cast<CachedResult*>(entry)->Seen = true; } // Entry from Find()
+    void Store(const std::string& machineId, const CachedResult& result) { CachedResult& entry = entries[machineId]; entry = result; entry.Seen = true; }
+    void ClearSeen() { for (Table::value_type& entry : entries) entry.second.Seen = false; }
+    const Table& Entries() const { return entries; }
+    void Erase(const std::string& machineId) { entries.erase(machineId); }
+    size_t Size() const { return entries.size(); }
+private:
+    Table entries;
+};
+
+#endif // RESULT_CACHE_H_INCLUDED
@@ -0,0 +1,292 @@
+#include "result_store.h"
+
+#include <cstring>
+#include <ctime>          // For time (CreatedAt)
+#include "inventory.h"    // WideToUtf8
+#include "profile_index.h" // ParseProfileBytes (range bounds such as "4GB")
+#include "varint.h"
+
+// --- Column Names ---
+const char* ResultNumericColumnName(int column) {
+    static const char* const names[ResultNumericColumnCount] = {
+        "CpuSpeedMHz", "CpuCores", "CpuGenerationLevel", "RamBytes", "DiskFreeBytes",
+        "ScreenWidth", "ScreenHeight", "DXLevel", "WDDMLevel", "TpmVersionMajor"
+    };
+    return column >= 0 && column < ResultNumericColumnCount ? names[column] : "Unknown";
+}
+
+int FindResultNumericColumn(const std::string& name) {
+    for (int column = 0; column < ResultNumericColumnCount; ++column) { if (name == ResultNumericColumnName(column)) return column; }
+    return -1;
+}
+
+static ULONGLONG NumericValue(const FeatureColumns& f, int column, size_t row) {
+    switch (column) {
+        case ResultCpuSpeedMHz: return f.CpuSpeedMHz[row]; case ResultCpuCores: return f.CpuCores[row]; case ResultCpuGenerationLevel: return f.CpuGenerationLevel[row];
+        case ResultRamBytes: return f.RamBytes[row]; case ResultDiskFreeBytes: return f.DiskFreeBytes[row];
+        case ResultScreenWidth: return f.ScreenWidth[row]; case ResultScreenHeight: return f.ScreenHeight[row];
+        case ResultDXLevel: return f.DXLevel[row]; case ResultWDDMLevel: return f.WDDMLevel[row]; case ResultTpmVersionMajor: return f.TpmVersionMajor[row];
+        default: return 0;
+    }
+}
+
+// --- Zigzag Delta Encoding (varints from varint.h) ---
+template <typename T> static void EncodeDeltas(std::string& out, const std::vector<T>& values, ULONGLONG& min, ULONGLONG& max) {
+    ULONGLONG previous = 0; min = ~0ULL; max = 0;
+    for (T value : values) {
+        const long long delta = (long long)((ULONGLONG)value - previous); previous = value;
+        PutVarint(out, ((ULONGLONG)delta << 1) ^ (ULONGLONG)(delta >> 63));
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+}
+
+template <typename T> static bool DecodeDeltas(const unsigned char* p, const unsigned char* end, size_t rows, std::vector<T>& values) {
+    values.resize(rows); ULONGLONG previous = 0, zigzag = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        if (!GetVarint(p, end, zigzag)) return false;
+        previous += (zigzag >> 1) ^ (ULONGLONG)(-(long long)(zigzag & 1));
+        values[i] = (T)previous;
+    }
+    return p == end;
+}
+
+static bool DecodeVarints(const unsigned char* p, const unsigned char* end, size_t rows, std::vector<UINT>& values) {
+    values.resize(rows); ULONGLONG value = 0;
+    for (size_t i = 0; i < rows; ++i) { if (!GetVarint(p, end, value)) return false; values[i] = (UINT)value; }
+    return p == end;
+}
+
+// --- Writer ---
+bool ResultStoreWriter::Open(const std::string& path, const WindowsRequirements& target, size_t rowsPerBlock, std::string& error) {
+    output.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!output) { error = "Could not create result store '" + path + "'"; return false; }
+    blockRows = rowsPerBlock ? rowsPerBlock : 8192; rowCount = 0;
+    const std::string name = WideToUtf8(target.Name);
+    header = ResultStoreHeader(); memcpy(header.Magic, RESULT_STORE_MAGIC, sizeof(header.Magic));
+    header.Version = RESULT_STORE_VERSION; header.BlockRows = (UINT32)blockRows;
+    header.CreatedAt = (ULONGLONG)time(NULL); header.Applicable = ApplicableChecks(target); header.TargetNameLength = (UINT32)name.size();
+    output.write((const char*)&header, sizeof(header)); // Rewritten by Finish() once the counts are known
+    output.write(name.data(), (std::streamsize)name.size());
+    machineIds.clear(); fails.clear(); warns.clear(); features.Clear(); cpuNames.clear(); gpuNames.clear();
+    blocks.clear(); dictionaryIds.clear(); dictionary.clear();
+    return (bool)output;
+}
+
+UINT32 ResultStoreWriter::Intern(const std::string& text) {
+    auto found = dictionaryIds.find(text);
+    if (found != dictionaryIds.end()) return found->second;
+    const UINT32 id = (UINT32)dictionary.size();
+    dictionary.push_back(text); dictionaryIds.emplace(text, id);
+    return id;
+}
+
+bool ResultStoreWriter::Add(const std::string& machineId, const MachineFeatures& row, unsigned short fail, unsigned short warn, const std::string& cpuName, const std::string& gpuName) {
+    size_t shared = 0; // Front coding: inventories are mostly sorted, so neighbouring ids share a long prefix
+    while (shared < machineId.size() && shared < previousId.size() && machineId[shared] == previousId[shared] && shared < 0xFFFF) ++shared;
+    if (fails.empty()) shared = 0; // Every block decodes on its own
+    PutVarint(machineIds, shared); PutVarint(machineIds, machineId.size() - shared); machineIds.append(machineId, shared, std::string::npos);
+    previousId = machineId;
+    fails.push_back(fail); warns.push_back(warn); features.Append(row);
+    cpuNames.push_back(Intern(cpuName)); gpuNames.push_back(Intern(gpuName));
+    ++rowCount;
+    return fails.size() < blockRows || FlushBlock();
+}
+
+bool ResultStoreWriter::FlushBlock() {
+    const size_t rows = fails.size();
+    if (rows == 0) return true;
+    ResultBlockInfo info = {};
+    info.Offset = (ULONGLONG)output.tellp(); info.FirstRow = rowCount - rows; info.Rows = (UINT32)rows;
+    encoded.clear();
+    size_t lengthAt = 0;
+    auto Begin = [&]() { lengthAt = encoded.size(); encoded.append(4, '\0'); };
+    auto End = [&]() { const UINT32 length = (UINT32)(encoded.size() - lengthAt - 4); memcpy(&encoded[lengthAt], &length, 4); };
+
+    Begin(); encoded += machineIds; End();
+    Begin(); // Checks: one run of ceil(rows / 4) bytes per CheckId
+    for (int id = 0; id < CheckCount; ++id) {
+        const size_t runAt = encoded.size(); encoded.append((rows + 3) / 4, '\0');
+        const unsigned bit = 1u << id;
+        for (size_t i = 0; i < rows; ++i) {
+            const unsigned state = !(header.Applicable & bit) ? ResultCheckSkipped : (fails[i] & bit) ? ResultCheckFail : (warns[i] & bit) ? ResultCheckWarn : ResultCheckPass;
+            encoded[runAt + i / 4] = (char)(encoded[runAt + i / 4] | (state << ((i % 4) * 2)));
+        }
+    }
+    End();
+    for (size_t i = 0; i < rows; ++i) { info.FailAny |= fails[i]; info.WarnAny |= warns[i]; if (fails[i]) ++info.Failed; }
+    auto Deltas = [&](auto& values, int column) { Begin(); EncodeDeltas(encoded, values, info.Min[column], info.Max[column]); End(); };
+    Deltas(features.CpuSpeedMHz, ResultCpuSpeedMHz); Deltas(features.CpuCores, ResultCpuCores); Deltas(features.CpuGenerationLevel, ResultCpuGenerationLevel);
+    Deltas(features.RamBytes, ResultRamBytes); Deltas(features.DiskFreeBytes, ResultDiskFreeBytes);
+    Deltas(features.ScreenWidth, ResultScreenWidth); Deltas(features.ScreenHeight, ResultScreenHeight);
+    Deltas(features.DXLevel, ResultDXLevel); Deltas(features.WDDMLevel, ResultWDDMLevel); Deltas(features.TpmVersionMajor, ResultTpmVersionMajor);
+    auto Varints = [&](const std::vector<UINT>& values) { Begin(); for (UINT value : values) PutVarint(encoded, value); End(); };
+    Varints(features.Flags); Varints(cpuNames); Varints(gpuNames);
+
+    info.Size = encoded.size();
+    output.write(encoded.data(), (std::streamsize)encoded.size());
+    blocks.push_back(info);
+    machineIds.clear(); fails.clear(); warns.clear(); features.Clear(); cpuNames.clear(); gpuNames.clear();
+    return (bool)output;
+}
+
+bool ResultStoreWriter::Finish(std::string& error) {
+    if (!FlushBlock()) { error = "Failed writing result store"; return false; }
+    header.RowCount = rowCount; header.BlockCount = blocks.size();
+    header.IndexOffset = (ULONGLONG)output.tellp();
+    if (!blocks.empty()) output.write((const char*)&blocks[0], (std::streamsize)(blocks.size() * sizeof(ResultBlockInfo)));
+    header.DictionaryOffset = (ULONGLONG)output.tellp();
+    encoded.clear();
+    for (const std::string& text : dictionary) { PutVarint(encoded, text.size()); encoded += text; }
+    header.DictionarySize = encoded.size();
+    output.write(encoded.data(), (std::streamsize)encoded.size());
+    output.seekp(0); output.write((const char*)&header, sizeof(header));
+    output.close();
+    if (!output) { error = "Failed writing result store"; return false; }
+    return true;
+}
+
+// --- Filters ---
+bool ResultFilter::MayMatch(const ResultBlockInfo& block) const {
+    if ((block.FailAny & Failing) != Failing) return false;
+    return Column < 0 || Column >= ResultNumericColumnCount || (block.Max[Column] >= Min && block.Min[Column] <= Max);
+}
+
+bool ResultFilter::Matches(const ResultBlock& block, size_t row) const {
+    if ((block.Checks.Fail[row] & Failing) != Failing) return false;
+    if (Column < 0 || Column >= ResultNumericColumnCount) return true;
+    const ULONGLONG value = NumericValue(block.Features, Column, row);
+    return value >= Min && value <= Max;
+}
+
+bool ParseResultFilterRange(const std::string& spec, ResultFilter& filter, std::string& error) {
+    const size_t equals = spec.find('='), colon = spec.find(':', equals == std::string::npos ? 0 : equals);
+    const int column = FindResultNumericColumn(spec.substr(0, equals));
+    if (column < 0) {
+        error = "Unknown column '" + spec.substr(0, equals) + "'. Available:";
+        for (int i = 0; i < ResultNumericColumnCount; ++i) { error += ' '; error += ResultNumericColumnName(i); }
+        return false;
+    }
+    ULONGLONG min = 0, max = ~0ULL;
+    const std::string low = equals == std::string::npos || colon == std::string::npos ? std::string() : spec.substr(equals + 1, colon - equals - 1);
+    const std::string high = colon == std::string::npos ? std::string() : spec.substr(colon + 1);
+    if (equals == std::string::npos || colon == std::string::npos || (!low.empty() && !ParseProfileBytes(low, min)) || (!high.empty() && !ParseProfileBytes(high, max)) || min > max) {
+        error = "Expected Column=Min:Max (either bound may be empty), got '" + spec + "'."; return false;
+    }
+    filter.Column = column; filter.Min = min; filter.Max = max;
+    return true;
+}
+
+// --- Reader ---
+bool ResultStoreReader::Open(const std::string& path, std::string& error) {
+    input.close(); input.clear(); blocks.clear(); dictionary.clear(); bufferBlock = (size_t)-1;
+    input.open(path.c_str(), std::ios::binary);
+    if (!input) { error = "Could not open result store '" + path + "'"; return false; }
+    input.seekg(0, std::ios::end); const ULONGLONG fileSize = (ULONGLONG)input.tellg(); input.seekg(0);
+    if (!input.read((char*)&header, sizeof(header)) || memcmp(header.Magic, RESULT_STORE_MAGIC, sizeof(header.Magic)) != 0) { error = "Not a result store ('" + path + "')"; return false; }
+    if (header.Version != RESULT_STORE_VERSION) { error = "Unsupported result store version " + std::to_string(header.Version) + " ('" + path + "')"; return false; }
+    const ULONGLONG dataStart = sizeof(header) + (ULONGLONG)header.TargetNameLength;
+    if (dataStart > fileSize || header.IndexOffset < dataStart || header.IndexOffset > fileSize || header.BlockCount > (fileSize - header.IndexOffset) / sizeof(ResultBlockInfo)
+        || header.DictionaryOffset != header.IndexOffset + header.BlockCount * sizeof(ResultBlockInfo) || header.DictionarySize > fileSize - header.DictionaryOffset) {
+        error = "Result store is truncated ('" + path + "')"; return false;
+    }
+    targetName.resize(header.TargetNameLength);
+    if (header.TargetNameLength) input.read(&targetName[0], header.TargetNameLength);
+    blocks.resize((size_t)header.BlockCount);
+    input.seekg((std::streamoff)header.IndexOffset);
+    if (!blocks.empty()) input.read((char*)&blocks[0], (std::streamsize)(blocks.size() * sizeof(ResultBlockInfo)));
+    ULONGLONG rows = 0, blockEnd = dataStart;
+    for (const ResultBlockInfo& block : blocks) { // Blocks are written back to back; a row takes at least 2 bytes (its MachineId lengths)
+        if (block.Offset < blockEnd || block.Offset > header.IndexOffset || block.Size > header.IndexOffset - block.Offset || block.FirstRow != rows
+            || !block.Rows || block.Rows > header.BlockRows || 2 * (ULONGLONG)block.Rows > block.Size) { error = "Result store block index is corrupt ('" + path + "')"; return false; }
+        rows += block.Rows; blockEnd = block.Offset + block.Size;
+    }
+    if (rows != header.RowCount) { error = "Result store block index is corrupt ('" + path + "')"; return false; }
+    buffer.resize((size_t)header.DictionarySize);
+    if (!buffer.empty()) input.read(&buffer[0], (std::streamsize)buffer.size());
+    if (!input) { error = "Could not read result store '" + path + "'"; return false; }
+    const unsigned char* p = (const unsigned char*)buffer.data(); const unsigned char* end = p + buffer.size();
+    while (p < end) {
+        ULONGLONG length = 0;
+        if (!GetVarint(p, end, length) || length > (ULONGLONG)(end - p)) { error = "Result store dictionary is corrupt ('" + path + "')"; return false; }
+        dictionary.emplace_back((const char*)p, (size_t)length); p += length;
+    }
+    buffer.clear();
+    return true;
+}
+
+const std::string& ResultStoreReader::DictionaryString(UINT32 id) const {
+    static const std::string empty;
+    return id < dictionary.size() ? dictionary[id] : empty;
+}
+
+bool ResultStoreReader::ReadBlock(size_t index, unsigned columns, ResultBlock& block, std::string& error) {
+    const ResultBlockInfo& info = blocks[index];
+    if (bufferBlock != index) { // Raw bytes stay around, so a second call for more columns of the same block does not re-read
+        buffer.resize((size_t)info.Size); bufferBlock = (size_t)-1;
+        input.clear(); input.seekg((std::streamoff)info.Offset);
+        if (!input.read(&buffer[0], (std::streamsize)buffer.size())) { error = "Could not read result store block " + std::to_string(index); return false; }
+        bufferBlock = index;
+    }
+    const size_t rows = info.Rows; block.FirstRow = (size_t)info.FirstRow; block.Rows = rows;
+    const unsigned char* p = (const unsigned char*)buffer.data(); const unsigned char* end = p + buffer.size();
+    int column = 0; bool ok = true;
+    auto Next = [&](const unsigned char*& begin, const unsigned char*& finish) { // Next column's bytes
+        UINT32 length = 0;
+        if ((size_t)(end - p) < 4) return false;
+        memcpy(&length, p, 4); p += 4;
+        if (length > (size_t)(end - p)) return false;
+        begin = p; finish = p + length; p = finish; ++column;
+        return true;
+    };
+    const unsigned char* begin = NULL; const unsigned char* finish = NULL;
+
+    ok = Next(begin, finish);
+    if (ok && (columns & ResultColumnMachineId)) {
+        block.MachineIds.resize(rows);
+        for (size_t i = 0; ok && i < rows; ++i) {
+            ULONGLONG shared = 0, length = 0;
+            ok = GetVarint(begin, finish, shared) && GetVarint(begin, finish, length) && length <= (ULONGLONG)(finish - begin) && shared <= (i ? block.MachineIds[i - 1].size() : 0);
+            if (ok) { block.MachineIds[i].assign(i ? block.MachineIds[i - 1] : std::string(), 0, (size_t)shared); block.MachineIds[i].append((const char*)begin, (size_t)length); begin += length; }
+        }
+    }
+    ok = ok && Next(begin, finish);
+    if (ok && (columns & ResultColumnChecks)) {
+        const size_t run = (rows + 3) / 4;
+        ok = (size_t)(finish - begin) == run * CheckCount;
+        block.Checks.Applicable = Applicable(); block.Checks.Fail.assign(rows, 0); block.Checks.Warn.assign(rows, 0);
+        for (int id = 0; ok && id < CheckCount; ++id) {
+            const unsigned char* states = begin + id * run;
+            for (size_t i = 0; i < rows; ++i) {
+                const unsigned state = (states[i / 4] >> ((i % 4) * 2)) & 3;
+                if (state == ResultCheckFail) block.Checks.Fail[i] |= (unsigned short)(1u << id);
+                else if (state == ResultCheckWarn) block.Checks.Warn[i] |= (unsigned short)(1u << id);
+            }
+        }
+    }
+    FeatureColumns& f = block.Features; const bool features = (columns & ResultColumnFeatures) != 0;
+    auto Deltas = [&](auto& values) { ok = ok && Next(begin, finish) && (!features || DecodeDeltas(begin, finish, rows, values)); };
+    Deltas(f.CpuSpeedMHz); Deltas(f.CpuCores); Deltas(f.CpuGenerationLevel); Deltas(f.RamBytes); Deltas(f.DiskFreeBytes);
+    Deltas(f.ScreenWidth); Deltas(f.ScreenHeight); Deltas(f.DXLevel); Deltas(f.WDDMLevel); Deltas(f.TpmVersionMajor);
+    ok = ok && Next(begin, finish) && (!features || DecodeVarints(begin, finish, rows, f.Flags));
+    const bool names = (columns & ResultColumnNames) != 0;
+    ok = ok && Next(begin, finish) && (!names || DecodeVarints(begin, finish, rows, block.CpuName));
+    ok = ok && Next(begin, finish) && (!names || DecodeVarints(begin, finish, rows, block.GpuName));
+    if (!ok) { error = "Result store block " + std::to_string(index) + " is corrupt (column " + std::to_string(column) + ")"; return false; }
+    return true;
+}
+
+bool ResultStoreReader::Scan(const ResultFilter& filter, const std::function<void(const ResultBlock&, size_t)>& visit, size_t& blocksRead, std::string& error) {
+    ResultBlock block; std::vector<size_t> matches; blocksRead = 0;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (!filter.MayMatch(blocks[b])) continue;
+        ++blocksRead;
+        if (!ReadBlock(b, ResultColumnChecks | ResultColumnFeatures, block, error)) return false;
+        matches.clear();
+        for (size_t i = 0; i < block.Rows; ++i) { if (filter.Matches(block, i)) matches.push_back(i); }
+        if (matches.empty()) continue;
+        if (!ReadBlock(b, ResultColumnAll, block, error)) return false;
+        for (size_t i : matches) visit(block, i);
+    }
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef RESULT_STORE_H_INCLUDED
+#define RESULT_STORE_H_INCLUDED
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "columnar.h"
+
+// --- Columnar Result Store (batch --store; kept for compliance trend reports) ---
+// One file per batch run against one target (little-endian, offsets from the start of the file):
+//
+//   ResultStoreHeader | target name | block x BlockCount | ResultBlockInfo x BlockCount | dictionary
+//
+// Rows are cut into blocks of BlockRows machines. Inside a block every column is stored on its own, prefixed by its
+// UINT32 byte length, so a reader decodes only the columns it needs:
+//   MachineId           per row: varint length of the prefix shared with the previous id, varint length + UTF-8 bytes of the rest
+//   Checks              2 bits per row and check (ResultCheckState), one packed run per CheckId
+//   10 feature columns  zigzag varint of the difference to the previous row (fleets are sorted by model, so mostly 1 byte)
+//   Flags               varint
+//   CpuName, GpuName    varint ids into the dictionary (distinct strings only, written once at the end)
+// The block index carries per-block statistics (OR of the failed / warned check masks, min/max of every numeric
+// column) so a scan for "failing TPM" or "RAM below 4 GB" skips blocks that cannot contain a match. Writing streams:
+// only the current block and the distinct strings are held in memory.
+const char RESULT_STORE_MAGIC[8] = { 'W', 'R', 'C', 'R', 'S', 'T', 'O', 'R' };
+const UINT32 RESULT_STORE_VERSION = 1;
+
+enum ResultCheckState { ResultCheckPass = 0, ResultCheckWarn = 1, ResultCheckFail = 2, ResultCheckSkipped = 3 }; // Skipped: not applicable to the target
+
+// Numeric columns in storage order (the MachineFeatures members; Flags is stored but has no min/max)
+enum ResultNumericColumn {
+    ResultCpuSpeedMHz, ResultCpuCores, ResultCpuGenerationLevel, ResultRamBytes, ResultDiskFreeBytes,
+    ResultScreenWidth, ResultScreenHeight, ResultDXLevel, ResultWDDMLevel, ResultTpmVersionMajor,
+    ResultNumericColumnCount
+};
+const char* ResultNumericColumnName(int column);        // "RamBytes", ... (the FeatureColumns member names)
+int FindResultNumericColumn(const std::string& name);   // -1 if unknown
+
+struct ResultStoreHeader {
+    char Magic[8];
+    UINT32 Version; UINT32 BlockRows;
+    ULONGLONG RowCount; ULONGLONG BlockCount;
+    ULONGLONG IndexOffset; ULONGLONG DictionaryOffset; ULONGLONG DictionarySize;
+    ULONGLONG CreatedAt;                    // Unix time of the run
+    UINT32 Applicable; UINT32 TargetNameLength; // Checks the target evaluates (CheckId bits); name follows the header
+};
+static_assert(sizeof(ResultStoreHeader) == 72, "ResultStoreHeader layout is part of the file format");
+
+struct ResultBlockInfo {
+    ULONGLONG Offset; ULONGLONG Size; ULONGLONG FirstRow;
+    UINT32 Rows; UINT32 Failed;             // Failed: rows with at least one [FAIL]
+    UINT32 FailAny; UINT32 WarnAny;         // OR over the block's Fail / Warn masks
+    ULONGLONG Min[ResultNumericColumnCount]; ULONGLONG Max[ResultNumericColumnCount];
+};
+static_assert(sizeof(ResultBlockInfo) == 200, "ResultBlockInfo layout is part of the file format");
+
+// --- Writer ---
+class ResultStoreWriter {
+public:
+    bool Open(const std::string& path, const WindowsRequirements& target, size_t blockRows, std::string& error); // blockRows 0 = 8192
+    bool Add(const std::string& machineId, const MachineFeatures& features, unsigned short fail, unsigned short warn, const std::string& cpuName, const std::string& gpuName);
+    bool Finish(std::string& error);        // Last block, index, dictionary, final header
+    size_t Rows() const { return rowCount; }
+private:
+    bool FlushBlock();
+    UINT32 Intern(const std::string& text);
+    std::ofstream output; ResultStoreHeader header = {};
+    size_t blockRows = 0, rowCount = 0;
+    // --- Current block ---
+    std::string machineIds, previousId; std::vector<unsigned short> fails, warns; FeatureColumns features; std::vector<UINT32> cpuNames, gpuNames;
+    std::vector<ResultBlockInfo> blocks; std::string encoded;
+    std::unordered_map<std::string, UINT32> dictionaryIds; std::vector<std::string> dictionary;
+};
+
+// --- Reader ---
+// The header, block index and dictionary are loaded by Open(); blocks are read and decoded on demand.
+enum ResultColumnSet { ResultColumnMachineId = 1, ResultColumnChecks = 2, ResultColumnFeatures = 4, ResultColumnNames = 8, ResultColumnAll = 15 };
+
+struct ResultBlock {
+    size_t FirstRow = 0; size_t Rows = 0;
+    std::vector<std::string> MachineIds;    // ResultColumnMachineId
+    CheckMaskColumns Checks;                // ResultColumnChecks
+    FeatureColumns Features;                // ResultColumnFeatures (including Flags)
+    std::vector<UINT32> CpuName, GpuName;   // ResultColumnNames (dictionary ids)
+};
+
+// Rows failing every check in Failing and (if Column >= 0) with Min <= value <= Max in that numeric column
+struct ResultFilter {
+    unsigned short Failing = 0;
+    int Column = -1; ULONGLONG Min = 0; ULONGLONG Max = ~0ULL;
+    bool MayMatch(const ResultBlockInfo& block) const;
+    bool Matches(const ResultBlock& block, size_t row) const; // Needs the Checks and Features columns
+};
+bool ParseResultFilterRange(const std::string& spec, ResultFilter& filter, std::string& error); // "RamBytes=0:4GB"
+
+class ResultStoreReader {
+public:
+    bool Open(const std::string& path, std::string& error);
+    size_t Rows() const { return (size_t)header.RowCount; }
+    size_t BlockCount() const { return blocks.size(); }
+    const ResultBlockInfo& Block(size_t index) const { return blocks[index]; }
+    const std::string& TargetName() const { return targetName; }
+    unsigned short Applicable() const { return (unsigned short)header.Applicable; }
+    long long CreatedAt() const { return (long long)header.CreatedAt; }
+    const std::string& DictionaryString(UINT32 id) const; // "" for an unknown id
+    bool ReadBlock(size_t index, unsigned columns, ResultBlock& block, std::string& error); // columns: ResultColumnSet bits
+    // Calls visit(block, row) for every matching row in file order, reading only the blocks whose statistics allow a
+    // match (and the remaining columns of a block only once one of its rows matched); blocksRead counts the reads
+    bool Scan(const ResultFilter& filter, const std::function<void(const ResultBlock&, size_t)>& visit, size_t& blocksRead, std::string& error);
+private:
+    std::ifstream input; ResultStoreHeader header = {}; std::string targetName;
+    std::vector<ResultBlockInfo> blocks; std::vector<std::string> dictionary;
+    std::string buffer; size_t bufferBlock = (size_t)-1; // Raw bytes of the last block read
+};
+
+#endif // RESULT_STORE_H_INCLUDED
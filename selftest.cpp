@@ -0,0 +1,1716 @@
+// --- WinReadyCheck Self-test (separate "Test" build target; portable, no windows.h, builds on Linux) ---
+// Usage: WinReadyCheckTest [--only suite,...] [--fixtures <dir>] [--seed N]
+// Runs each suite and prints one line per suite; a failed expectation is printed with what was expected and what came
+// out. Exits with code 1 if any expectation failed, so a change that breaks one of these properties fails CI.
+// Suites that need files read them from --fixtures (default tests/fixtures, relative to the repository root).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>          // For isfinite
+#include <cstdio>
+#include <cstdlib>        // For strtoull / strtod / malloc
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "agent.h"
+#include "aggregate.h"
+#include "batch.h"
+#include "columnar.h"
+#include "cpu_list.h"
+#include "evaluate.h"
+#include "fleet_file.h"
+#include "inventory.h"
+#include "mapped_inventory.h"
+#ifndef _WIN32
+#include "linux_probe.h"
+#endif
+#include "probe.h"
+#include "profile_index.h"
+#include "report.h"
+#include "requirements.h"
+#include "result_cache.h"
+#include "result_store.h"
+#include "shard.h"
+#include "sketch.h"
+#include "snapshot.h"
+#include "synthetic_fleet.h"
+#include "trace.h"
+#include "upgrade_plan.h"
+#include "varint.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// --- Allocation Counter (every operator new, counted per thread; the allocations suite reads its own thread's delta) ---
+// Per thread because earlier suites can leave workers behind (an abandoned timed-out probe, say) that allocate while it measures
+static thread_local unsigned long long allocationCount = 0;
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC pairs new with delete, not with the free() they both map to here
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// --- Expectations ---
+struct TestContext {
+    std::string Fixtures; unsigned long long Seed = 1;
+    unsigned Checks = 0, Failures = 0;
+};
+
+static bool Expect(TestContext& t, bool ok, const std::string& what) {
+    ++t.Checks;
+    if (!ok && ++t.Failures <= 20) fprintf(stderr, "    FAIL %s\n", what.c_str());
+    return ok;
+}
+
+static std::string Hex(unsigned value) { char text[16]; snprintf(text, sizeof(text), "0x%04X", value); return text; }
+
+// --- Minimal JSON Reader (for checking exported files; numbers as double, \u escapes above ASCII become '?') ---
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object } Type = Null;
+    double Value = 0; std::string Text; std::vector<JsonValue> Items; std::vector<std::pair<std::string, JsonValue>> Members;
+    const JsonValue* Get(const char* key) const { for (const auto& m : Members) { if (m.first == key) return &m.second; } return NULL; }
+    double NumberOr(const char* key, double fallback) const { const JsonValue* v = Get(key); return v && v->Type == Number ? v->Value : fallback; }
+    std::string TextOr(const char* key, const char* fallback) const { const JsonValue* v = Get(key); return v && v->Type == String ? v->Text : fallback; }
+};
+
+class JsonReader {
+public:
+    JsonReader(const std::string& text) : p(text.data()), end(text.data() + text.size()) {}
+    bool Read(JsonValue& value) { if (!Parse(value, 0)) return false; Skip(); return p == end; }
+private:
+    void Skip() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p; }
+    bool Literal(const char* word) { const size_t n = strlen(word); if ((size_t)(end - p) < n || memcmp(p, word, n) != 0) return false; p += n; return true; }
+    bool ParseString(std::string& out) {
+        if (p >= end || *p != '"') return false;
+        for (++p; p < end && *p != '"'; ++p) {
+            if (*p != '\\') { out += *p; continue; }
+            if (++p >= end) return false;
+            switch (*p) {
+                case 'n': out += '\n'; break; case 't': out += '\t'; break; case 'r': out += '\r'; break; case 'b': out += '\b'; break; case 'f': out += '\f'; break;
+                case 'u': { if (end - p < 5) return false; const unsigned code = (unsigned)strtoul(std::string(p + 1, 4).c_str(), NULL, 16); out += code < 0x80 ? (char)code : '?'; p += 4; break; }
+                default: out += *p;
+            }
+        }
+        if (p >= end) return false;
+        ++p; return true;
+    }
+    bool Parse(JsonValue& v, int depth) {
+        Skip();
+        if (p >= end || depth > 64) return false;
+        if (*p == '{') {
+            v.Type = JsonValue::Object; ++p; Skip();
+            if (p < end && *p == '}') { ++p; return true; }
+            for (;;) {
+                Skip(); std::pair<std::string, JsonValue> member;
+                if (!ParseString(member.first)) return false;
+                Skip(); if (p >= end || *p++ != ':') return false;
+                if (!Parse(member.second, depth + 1)) return false;
+                v.Members.push_back(member); Skip();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == '}') { ++p; return true; }
+                return false;
+            }
+        }
+        if (*p == '[') {
+            v.Type = JsonValue::Array; ++p; Skip();
+            if (p < end && *p == ']') { ++p; return true; }
+            for (;;) {
+                v.Items.push_back(JsonValue());
+                if (!Parse(v.Items.back(), depth + 1)) return false;
+                Skip();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == ']') { ++p; return true; }
+                return false;
+            }
+        }
+        if (*p == '"') { v.Type = JsonValue::String; return ParseString(v.Text); }
+        if (Literal("true")) { v.Type = JsonValue::Bool; v.Value = 1; return true; }
+        if (Literal("false")) { v.Type = JsonValue::Bool; return true; }
+        if (Literal("null")) return true;
+        const std::string number(p, (size_t)std::min<ptrdiff_t>(end - p, 64)); char* stop = NULL;
+        v.Type = JsonValue::Number; v.Value = strtod(number.c_str(), &stop);
+        if (stop == number.c_str()) return false;
+        p += stop - number.c_str(); return true;
+    }
+    const char* p; const char* end;
+};
+
+static std::string TempPath(const char* name) { // Scratch file for a suite; removed by the suite
+    const char* base = getenv("TMPDIR"); if (!base || !*base) base = getenv("TEMP"); if (!base || !*base) base = ".";
+    return std::string(base) + "/wrc-selftest-" + name;
+}
+
+static std::string ReadWholeFile(const std::string& path) { std::ifstream file(path.c_str(), std::ios::binary); std::ostringstream content; content << file.rdbuf(); return content.str(); }
+static bool WriteWholeFile(const std::string& path, const std::string& content) { std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc); file << content; return (bool)file; }
+
+static std::string FormatRecord(const MachineRecord& record) { // Every inventory field, "Name=value" per line
+    size_t count = 0; const RecordField* fields = GetRecordFields(count); std::string out;
+    for (size_t i = 0; i < count; ++i) { out += fields[i].Name; out += '='; fields[i].Format(record, out); out += '\n'; }
+    return out;
+}
+
+static bool SameFeatures(const MachineFeatures& a, const MachineFeatures& b) {
+    return a.CpuSpeedMHz == b.CpuSpeedMHz && a.CpuCores == b.CpuCores && a.CpuGenerationLevel == b.CpuGenerationLevel && a.RamBytes == b.RamBytes
+        && a.DiskFreeBytes == b.DiskFreeBytes && a.ScreenWidth == b.ScreenWidth && a.ScreenHeight == b.ScreenHeight && a.DXLevel == b.DXLevel
+        && a.WDDMLevel == b.WDDMLevel && a.TpmVersionMajor == b.TpmVersionMajor && a.Flags == b.Flags;
+}
+
+// --- Columnar Kernels (columnar.cpp, requirements.cpp) ---
+// Every kernel the CPU can run must give the same Warn/Fail masks as EvaluateFeatures() (and the constexpr per-target
+// evaluators) for every built-in profile and a few custom ones, over random rows and rows on every edge: all fields
+// zero, each flag alone, thresholds -1/0/+1, values with the top bit set (the SSE2 path emulates unsigned compares).
+// Over the same rows, EvaluateAllBuiltinTargets() must report exactly the built-in targets without a [FAIL] (its
+// dominance shortcuts never settle a target wrongly) and the newest of them as Highest.
+static MachineFeatures RandomFeatures(unsigned long long& state) {
+    auto next = [&state]() { state += 0x9E3779B97F4A7C15ULL; unsigned long long z = state; z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL; z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL; return z ^ (z >> 31); };
+    auto pick = [&next](const ULONGLONG* values, size_t count) { return values[next() % count]; };
+    static const ULONGLONG small[] = { 0, 1, 2, 4, 8, 9, 11, 12, 13, 800, 999, 1000, 1001, 2400, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF };
+    static const ULONGLONG bytes[] = { 0, 1, 512ULL << 20, (1ULL << 30) - 1, 1ULL << 30, 4ULL << 30, (4ULL << 30) - 1, 64ULL << 30, (64ULL << 30) + 1,
+                                       0x7FFFFFFFFFFFFFFFULL, 0x8000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL };
+    MachineFeatures f;
+    const bool edge = (next() & 1) != 0;
+    f.CpuSpeedMHz = edge ? (UINT)pick(small, 17) : (UINT)next(); f.CpuCores = edge ? (UINT)pick(small, 17) : (UINT)(next() % 64);
+    f.CpuGenerationLevel = (UINT)pick(small, 17); f.DXLevel = (UINT)pick(small, 17); f.WDDMLevel = (UINT)pick(small, 17); f.TpmVersionMajor = (UINT)pick(small, 17);
+    f.ScreenWidth = edge ? (UINT)pick(small, 17) : (UINT)(next() % 4000); f.ScreenHeight = edge ? (UINT)pick(small, 17) : (UINT)(next() % 3000);
+    f.RamBytes = edge ? pick(bytes, 12) : next(); f.DiskFreeBytes = edge ? pick(bytes, 12) : next();
+    f.Flags = (UINT)(next() & ((1u << 11) - 1));
+    return f;
+}
+
+static void AddEdgeRows(const WindowsRequirements& t, FeatureColumns& columns) {
+    MachineFeatures zero; columns.Append(zero);
+    for (unsigned bit = 0; bit < 11; ++bit) { MachineFeatures f; f.Flags = 1u << bit; columns.Append(f); }
+    MachineFeatures all; all.Flags = (1u << 11) - 1; columns.Append(all);
+    for (int delta = -1; delta <= 1; ++delta) { // Every threshold just below / at / above the profile's minimum
+        MachineFeatures f; f.Flags = FeatureIs64Bit | FeatureUefi | FeatureDXKnown | FeatureWDDMKnown | FeatureTpmReady | FeatureSecureBootEnabled;
+        f.CpuSpeedMHz = t.MinCpuSpeedMHz + delta; f.CpuCores = t.MinCpuCores + delta; f.CpuGenerationLevel = t.MinCpuGenerationLevel + delta;
+        f.RamBytes = t.MinRamBytes + delta; f.DiskFreeBytes = t.MinDiskFreeBytes + delta;
+        f.ScreenWidth = t.MinScreenWidth + delta; f.ScreenHeight = t.MinScreenHeight + delta;
+        f.DXLevel = t.MinDirectXFeatureLevelMajor + delta; f.WDDMLevel = t.MinWDDMVersionMajor + delta; f.TpmVersionMajor = t.MinTpmVersionMajor + delta;
+        columns.Append(f);
+        f.Flags |= FeatureCpuTimedOut | FeatureRamTimedOut | FeatureDiskTimedOut | FeatureFirmwareUncertain | FeatureSecureBootUncertain; columns.Append(f);
+        f.Flags &= ~(FeatureDXKnown | FeatureWDDMKnown | FeatureTpmReady | FeatureUefi); columns.Append(f);
+    }
+}
+
+static void TestColumnar(TestContext& t) {
+    std::vector<WindowsRequirements> targets;
+    for (int i = 0; i < BuiltinTargetCount; ++i) targets.push_back(BUILTIN_TARGETS[i].Requirements);
+    WindowsRequirements none; none.Name = L"No minimums"; targets.push_back(none);
+    WindowsRequirements top = BUILTIN_TARGETS[TargetWin11].Requirements; top.Name = L"Top-bit thresholds";
+    top.MinCpuSpeedMHz = 0x80000000u; top.MinRamBytes = 0x8000000000000000ULL; top.MinDiskFreeBytes = 0xFFFFFFFFFFFFFFFFULL; targets.push_back(top);
+    SyntheticFleet fleet(t.Seed);
+    for (int i = 0; i < 8; ++i) { WindowsRequirements custom; fleet.NextProfile(custom); targets.push_back(custom); }
+
+    std::vector<MachineRecord> records; fleet.Generate(500, records);
+    unsigned long long state = t.Seed;
+    const ColumnKernel kernels[] = { KernelScalar, KernelSse2, KernelAvx2 };
+    for (size_t k = 0; k < targets.size(); ++k) {
+        const WindowsRequirements& target = targets[k];
+        FeatureColumns columns;
+        AddEdgeRows(target, columns);
+        for (size_t i = 0; i < records.size(); ++i) columns.Append(ExtractFeatures(records[i]));
+        for (size_t i = 0; i < 2003; ++i) columns.Append(RandomFeatures(state)); // Odd count: the SIMD kernels leave a tail
+
+        std::vector<CheckMasks> expected(columns.Size());
+        for (size_t i = 0; i < columns.Size(); ++i) {
+            expected[i] = EvaluateFeatures(target, columns.Row(i));
+            if (k < BuiltinTargetCount) {
+                const CheckMasks folded = BUILTIN_EVALUATORS[k](columns.Row(i));
+                Expect(t, folded.Fail == expected[i].Fail && folded.Warn == expected[i].Warn, "constexpr evaluator for target " + std::to_string(k) + ", row " + std::to_string(i));
+            }
+        }
+        for (ColumnKernel kernel : kernels) {
+            if (kernel > BestColumnKernel()) { if (k == 0) printf("    %s kernel not supported by this CPU, skipped\n", ColumnKernelName(kernel)); continue; }
+            CheckMaskColumns out; EvaluateColumns(target, columns, out, kernel);
+            Expect(t, out.Applicable == ApplicableChecks(target), std::string(ColumnKernelName(kernel)) + ": applicable mask for target " + std::to_string(k));
+            size_t mismatches = 0;
+            for (size_t i = 0; i < columns.Size(); ++i) {
+                if (out.Fail[i] == expected[i].Fail && out.Warn[i] == expected[i].Warn) continue;
+                if (++mismatches <= 3) {
+                    Expect(t, false, std::string(ColumnKernelName(kernel)) + ": target " + std::to_string(k) + ", row " + std::to_string(i) + ": fail " + Hex(out.Fail[i]) + " warn " + Hex(out.Warn[i])
+                           + ", expected fail " + Hex(expected[i].Fail) + " warn " + Hex(expected[i].Warn));
+                }
+            }
+            Expect(t, mismatches == 0, std::string(ColumnKernelName(kernel)) + ": " + std::to_string(mismatches) + " mismatching rows for target " + std::to_string(k));
+        }
+
+        size_t setMismatches = 0;
+        for (size_t i = 0; i < columns.Size(); ++i) {
+            const MachineFeatures features = columns.Row(i);
+            unsigned satisfied = 0; int highest = -1;
+            for (int id = 0; id < BuiltinTargetCount; ++id) {
+                if (EvaluateFeatures(BUILTIN_TARGETS[id].Requirements, features).Fail == 0) { satisfied |= 1u << id; highest = id; }
+            }
+            const TargetSetResult set = EvaluateAllBuiltinTargets(features);
+            if (set.Satisfied == satisfied && set.Highest == highest && set.Evaluations >= 1 && set.Evaluations <= BuiltinTargetCount) continue;
+            if (++setMismatches <= 3) {
+                Expect(t, false, "EvaluateAllBuiltinTargets, edge rows of target " + std::to_string(k) + ", row " + std::to_string(i) + ": satisfied " + Hex(set.Satisfied) + " highest " + std::to_string(set.Highest)
+                       + " after " + std::to_string(set.Evaluations) + " evaluations, expected " + Hex(satisfied) + " and " + std::to_string(highest));
+            }
+        }
+        Expect(t, setMismatches == 0, "EvaluateAllBuiltinTargets: " + std::to_string(setMismatches) + " mismatching rows among the edge rows of target " + std::to_string(k));
+    }
+}
+
+// --- Profile Threshold Index (profile_index.cpp) ---
+// ProfileIndex::Match must agree with EvaluateFeatures() run on every profile: bit p of Fail set exactly when profile p
+// has a [FAIL], of Warn exactly when it has a [WARN]. Profiles are the built-in ones, a profile with no minimums, one
+// with top-bit thresholds, duplicates and 200 synthetic baselines (so the bitsets span several words and end in a partial
+// one); rows are the columnar suite's random rows plus the edge rows of a spread of those profiles.
+static void TestProfileIndex(TestContext& t) {
+    std::vector<WindowsRequirements> profiles;
+    for (int i = 0; i < BuiltinTargetCount; ++i) profiles.push_back(BUILTIN_TARGETS[i].Requirements);
+    WindowsRequirements none; none.Name = L"No minimums"; profiles.push_back(none);
+    WindowsRequirements top = BUILTIN_TARGETS[TargetWin11].Requirements; top.Name = L"Top-bit thresholds";
+    top.MinCpuSpeedMHz = 0x80000000u; top.MinRamBytes = 0x8000000000000000ULL; top.MinDiskFreeBytes = 0xFFFFFFFFFFFFFFFFULL; profiles.push_back(top);
+    profiles.push_back(BUILTIN_TARGETS[TargetWin10].Requirements); // Same thresholds twice
+    SyntheticFleet fleet(t.Seed);
+    for (int i = 0; i < 200; ++i) { WindowsRequirements custom; fleet.NextProfile(custom); profiles.push_back(custom); }
+    ProfileIndex index; index.Build(profiles);
+    if (!Expect(t, index.Size() == profiles.size(), std::to_string(index.Size()) + " profiles indexed")) return;
+
+    FeatureColumns columns;
+    for (size_t p = 0; p < profiles.size(); p += 7) AddEdgeRows(profiles[p], columns);
+    std::vector<MachineRecord> records; fleet.Generate(300, records);
+    for (const MachineRecord& record : records) columns.Append(ExtractFeatures(record));
+    unsigned long long state = t.Seed;
+    for (size_t i = 0; i < 2000; ++i) columns.Append(RandomFeatures(state));
+
+    ProfileMatch match; size_t mismatches = 0, counts = 0;
+    for (size_t row = 0; row < columns.Size(); ++row) {
+        const MachineFeatures features = columns.Row(row);
+        index.Match(features, match);
+        size_t satisfied = 0, next = index.NextSatisfied(match, 0), walked = 0;
+        for (size_t p = 0; p < profiles.size(); ++p) {
+            const CheckMasks expected = EvaluateFeatures(profiles[p], features);
+            const bool fail = !match.Satisfied(p), warn = ((match.Warn[p >> 6] >> (p & 63)) & 1) != 0;
+            if (fail != (expected.Fail != 0) || warn != (expected.Warn != 0)) {
+                if (++mismatches <= 3) Expect(t, false, "row " + std::to_string(row) + ", profile " + std::to_string(p) + ": index fail " + std::to_string(fail) + " warn " + std::to_string(warn)
+                                              + ", EvaluateFeatures fail " + Hex(expected.Fail) + " warn " + Hex(expected.Warn));
+            }
+            if (!expected.Fail) { ++satisfied; if (next == p) { ++walked; next = index.NextSatisfied(match, p + 1); } }
+        }
+        if (index.SatisfiedCount(match) != satisfied || walked != satisfied || next != index.Size()) ++counts;
+    }
+    Expect(t, mismatches == 0, std::to_string(mismatches) + " (row, profile) pairs differ from EvaluateFeatures over " + std::to_string(columns.Size()) + " rows");
+    Expect(t, counts == 0, std::to_string(counts) + " rows where SatisfiedCount or NextSatisfied disagree with the per-profile results");
+}
+
+// --- Probe Scheduler (probe.cpp) ---
+// Fake probes that sleep: the ones that overrun their deadline must come back timed out with their sections in
+// TimedOutSections and default values, the rest must be copied back, a dependent probe must see its dependency's result,
+// and the run must take about as long as the slowest probe or deadline rather than the sum of all sleeps.
+static std::shared_ptr<SystemProbe> SleepingProbe(const char* name, unsigned section, unsigned dependsOn, unsigned sleepMs, bool ok, std::function<void(MachineRecord&)> fill) {
+    return std::make_shared<FunctionProbe>(name, section, dependsOn, [sleepMs, ok, fill](MachineRecord& record) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs)); fill(record); return ok;
+    });
+}
+
+static void TestProbeScheduler(TestContext& t) {
+    typedef std::chrono::steady_clock Clock;
+    std::shared_ptr<std::atomic<bool>> sawUefi = std::make_shared<std::atomic<bool>>(false);
+    ProbeScheduler scheduler(250);
+    scheduler.AddProbe(SleepingProbe("CPU", SectionCpu, 0, 40, true, [](MachineRecord& r) { r.Cpu.NumberOfCores = 8; }));
+    scheduler.AddProbe(SleepingProbe("RAM", SectionRam, 0, 120, true, [](MachineRecord& r) { r.Ram.TotalPhysicalBytes = 16ULL << 30; }));
+    scheduler.AddProbe(SleepingProbe("Disk", SectionDisk, 0, 900, true, [](MachineRecord& r) { r.Disk.FreeBytesAvailableToUser = 1; }));     // Default deadline (250 ms)
+    scheduler.AddProbe(SleepingProbe("OS", SectionOs, 0, 700, true, [](MachineRecord& r) { r.Os.Caption = L"Late"; }), 150);
+    scheduler.AddProbe(SleepingProbe("Screen", SectionScreen, 0, 10, false, [](MachineRecord& r) { r.Screen.Width = 1; }));
+    scheduler.AddProbe(SleepingProbe("Firmware", SectionFirmware, 0, 60, true, [](MachineRecord& r) { r.Firmware.FirmwareType = FirmwareUefi; }));
+    scheduler.AddProbe(SleepingProbe("Security", SectionSecurity, SectionFirmware, 80, true,
+                                     [sawUefi](MachineRecord& r) { sawUefi->store(r.Firmware.FirmwareType == FirmwareUefi); r.Security.TpmFound = true; }));
+    scheduler.AddProbe(SleepingProbe("Graphics", SectionGraphics, SectionOs, 10, true, [](MachineRecord& r) { r.Graphics.WDDMVersion = 0x0300; }), 1000); // Waits for the OS timeout
+
+    MachineRecord record; std::vector<ProbeOutcome> outcomes; unsigned launched = 0;
+    const Clock::time_point start = Clock::now();
+    scheduler.Run(record, outcomes, [&launched](const SystemProbe&) { ++launched; });
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    static const ProbeState expected[] = { ProbeSucceeded, ProbeSucceeded, ProbeTimedOut, ProbeTimedOut, ProbeFailed, ProbeSucceeded, ProbeSucceeded, ProbeSucceeded };
+    Expect(t, outcomes.size() == 8 && launched == 8, "8 outcomes and 8 launches, got " + std::to_string(outcomes.size()) + " / " + std::to_string(launched));
+    for (size_t i = 0; i < outcomes.size() && i < 8; ++i) {
+        Expect(t, outcomes[i].State == expected[i], std::string(outcomes[i].Name) + ": " + ProbeStateName(outcomes[i].State) + ", expected " + ProbeStateName(expected[i]));
+    }
+    Expect(t, record.TimedOutSections == (SectionDisk | SectionOs), "TimedOutSections " + Hex(record.TimedOutSections) + ", expected Disk|OS " + Hex(SectionDisk | SectionOs));
+    Expect(t, record.Cpu.NumberOfCores == 8 && record.Ram.TotalPhysicalBytes == (16ULL << 30) && record.Graphics.WDDMVersion == 0x0300, "results of finished probes are copied back");
+    Expect(t, record.Disk.FreeBytesAvailableToUser == 0 && record.Os.Caption == L"N/A", "timed-out sections keep their defaults");
+    Expect(t, record.Screen.Width == 1 && record.Security.TpmFound, "a failed probe's section is still copied back");
+    Expect(t, sawUefi->load(), "Security ran after Firmware and saw its result");
+    if (outcomes.size() == 8) {
+        Expect(t, outcomes[2].Milliseconds >= 245 && outcomes[2].Milliseconds < 500, "Disk gave up at its 250 ms deadline, took " + std::to_string(outcomes[2].Milliseconds) + " ms");
+        Expect(t, outcomes[3].Milliseconds >= 145 && outcomes[3].Milliseconds < 400, "OS gave up at its 150 ms deadline, took " + std::to_string(outcomes[3].Milliseconds) + " ms");
+    }
+    // Sum of all sleeps is 1920 ms; the longest path is the 250 ms Disk deadline (OS timeout + Graphics is ~160 ms)
+    Expect(t, ms >= 245 && ms < 600, "wall time " + std::to_string(ms) + " ms, expected about 250 ms");
+}
+
+// --- Probe Snapshot (snapshot.cpp) ---
+// A saved snapshot loads back field for field; a wrong magic or version, a malformed line or a file cut short anywhere
+// is rejected as a whole; stale, future-dated and other-host sections are not used, so only those get probed again.
+static void TestSnapshot(TestContext& t) {
+    const long long now = 1700000000, day = 24LL * 60 * 60;
+    MachineRecord probed;
+    probed.Cpu.Name = L"Intel(R) Core(TM) i5-8250U CPU @ 1.60GHz, \"quoted\""; probed.Cpu.MaxClockSpeed = 1800; probed.Cpu.NumberOfCores = 4; probed.Cpu.Is64BitCapable = true;
+    probed.Ram.TotalPhysicalBytes = 8ULL << 30; probed.Disk.FreeBytesAvailableToUser = 100ULL << 30; probed.Os.Caption = L"Microsoft Windows 10 Pro";
+    probed.Security.TpmFound = true; probed.Security.TpmEnabled = true; probed.Security.TpmSpecVersionMajor = 2;
+    probed.Security.SecureBoot = SecureBootOn; probed.Security.SecureBootEnabled = true; probed.Security.SecureBootSource = SourceApi;
+    ProbeSnapshot snapshot; snapshot.Host = L"PC-\u00C9T\u00C9";
+    StoreSnapshotSections(snapshot, SectionCpu | SectionRam, probed, now - 100);
+    StoreSnapshotSections(snapshot, SectionDisk, probed, now - 10);          // TTL 0: never reused
+    StoreSnapshotSections(snapshot, SectionOs, probed, now - 2 * day);       // Older than its 1-day TTL
+    StoreSnapshotSections(snapshot, SectionSecurity, probed, now + 1000);    // Clock went backwards
+
+    // --- Round Trip Through a File ---
+    const std::string path = TempPath("snapshot");
+    std::string error; ProbeSnapshot loaded;
+    Expect(t, !LoadSnapshotFile(path + ".missing", loaded, error) && error.empty(), "a missing file is not an error");
+    if (Expect(t, SaveSnapshotFile(path, snapshot, error), "save: " + error)) {
+        const bool ok = LoadSnapshotFile(path, loaded, error);
+        Expect(t, ok, "load: " + error);
+        Expect(t, loaded.Host == snapshot.Host && loaded.Sections == snapshot.Sections, "host and sections survive the round trip");
+        for (int i = 0; i < RecordSectionCount; ++i) Expect(t, loaded.ProbedAt[i] == snapshot.ProbedAt[i], std::string("probe time of ") + RecordSectionName(i));
+        Expect(t, loaded.Record.Cpu.Name == probed.Cpu.Name && loaded.Record.Cpu.MaxClockSpeed == 1800 && loaded.Record.Cpu.NumberOfCores == 4 && loaded.Record.Cpu.Is64BitCapable, "CPU fields");
+        Expect(t, loaded.Record.Ram.TotalPhysicalBytes == (8ULL << 30) && loaded.Record.Os.Caption == probed.Os.Caption, "RAM and OS fields");
+        Expect(t, loaded.Record.Security.SecureBoot == SecureBootOn && loaded.Record.Security.SecureBootSource == SourceApi && loaded.Record.Security.TpmSpecVersionMajor == 2, "security fields");
+        Expect(t, loaded.Record.Graphics.Name == L"N/A", "a section that was never stored keeps its defaults");
+    }
+    std::remove(path.c_str());
+
+    // --- Rejection ---
+    std::ostringstream written; WriteSnapshot(written, snapshot);
+    const std::string text = written.str();
+    auto Rejects = [&t](const std::string& content, const std::string& what) {
+        std::istringstream in(content); ProbeSnapshot out; std::string readError;
+        const bool ok = ReadSnapshot(in, out, readError);
+        Expect(t, !ok && !readError.empty(), what + " is rejected");
+    };
+    { std::istringstream in(text); ProbeSnapshot out; Expect(t, ReadSnapshot(in, out, error), "the written text reads back: " + error); }
+    Rejects("", "an empty file");
+    Rejects("WinReadyCheck snapshot v3" + text.substr(text.find('\n')), "an older version");
+    Rejects("WinReadyCheck snapshot v99" + text.substr(text.find('\n')), "a newer version");
+    Rejects("Not a snapshot\n" + text.substr(text.find('\n') + 1), "a wrong magic line");
+    std::string badField = text; badField.replace(badField.find("Cpu.NumberOfCores"), 17, "Cpu.NumberOfCorez"); Rejects(badField, "an unknown field");
+    std::string badValue = text; badValue.replace(badValue.find("Cpu.NumberOfCores,4"), 19, "Cpu.NumberOfCores,x"); Rejects(badValue, "a bad value");
+    std::string extra = text + "Ram.TotalPhysicalBytes,1\n"; Rejects(extra, "data after the end line");
+    size_t cuts = 0, accepted = 0;
+    for (size_t length = 1; length < text.size(); ++length) { // Every possible truncation point, inside values and at line breaks
+        std::istringstream in(text.substr(0, length)); ProbeSnapshot out; std::string readError;
+        ++cuts; if (ReadSnapshot(in, out, readError)) ++accepted;
+    }
+    std::istringstream trailingNewlineOnly(text.substr(0, text.size() - 1)); ProbeSnapshot out; // Only the final '\n' may go
+    Expect(t, ReadSnapshot(trailingNewlineOnly, out, error), "a file without its last line break still reads: " + error);
+    Expect(t, accepted == 1, std::to_string(accepted) + " of " + std::to_string(cuts) + " truncated files were accepted (only the one missing the final line break may be)");
+
+    // --- Which Sections Are Reused ---
+    const SnapshotPolicy policy = DefaultSnapshotPolicy();
+    const unsigned needed = SectionCpu | SectionRam | SectionDisk | SectionOs | SectionSecurity;
+    MachineRecord machine;
+    const unsigned cached = UseSnapshotSections(snapshot, snapshot.Host, policy, needed, now, machine);
+    Expect(t, cached == (SectionCpu | SectionRam), "cached sections " + Hex(cached) + ", expected Cpu|Ram " + Hex(SectionCpu | SectionRam));
+    Expect(t, machine.Cpu.NumberOfCores == 4 && machine.Ram.TotalPhysicalBytes == (8ULL << 30), "cached sections are copied into the record");
+    Expect(t, machine.Disk.FreeBytesAvailableToUser == 0 && machine.Os.Caption == L"N/A" && !machine.Security.TpmFound, "stale sections are left to be probed");
+    MachineRecord other;
+    Expect(t, UseSnapshotSections(snapshot, L"OTHER-PC", policy, needed, now, other) == 0 && other.Cpu.NumberOfCores == 0, "nothing is used from another host's snapshot");
+    Expect(t, UseSnapshotSections(snapshot, snapshot.Host, policy, SectionRam, now, other) == SectionRam, "only needed sections are used");
+    Expect(t, UseSnapshotSections(snapshot, snapshot.Host, policy, needed, now + 31 * day, other) == 0, "sections past their TTL are not used");
+
+    // Probing the rest and storing it makes every needed section fresh except the never-cached disk
+    StoreSnapshotSections(snapshot, needed & ~cached, probed, now);
+    Expect(t, FreshSnapshotSections(snapshot, policy, now) == (needed & ~SectionDisk), "after re-probing, everything but Disk is fresh");
+}
+
+// --- Supported-processor List (cpu_list.cpp) ---
+// Golden Win32_Processor.Name strings with the level MatchCpuList must return (tests/fixtures/cpu_list/golden.csv):
+// real names of every family, the exact models and exclusions the prefix patterns would otherwise get wrong, word
+// boundaries and normalization. Add a line there whenever a name is reported as misclassified.
+static void TestCpuList(TestContext& t) {
+    const std::string path = t.Fixtures + "/cpu_list/golden.csv";
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!Expect(t, (bool)file, "cannot open " + path)) return;
+    std::string line, normalized; std::vector<std::string> cells; size_t lineNumber = 0, names = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#' || line == "Level,Name") continue;
+        const std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+        if (!Expect(t, SplitCsvLine(line, cells) && cells.size() == 2, where + "expected Level,Name")) continue;
+        const UINT expected = (UINT)strtoul(cells[0].c_str(), NULL, 10), level = MatchCpuList(Utf8ToWide(cells[1]));
+        NormalizeCpuName(Utf8ToWide(cells[1]), normalized); ++names;
+        Expect(t, level == expected, where + "'" + cells[1] + "' (normalized '" + normalized + "') -> " + std::to_string(level) + ", expected " + std::to_string(expected));
+    }
+    Expect(t, names >= 100, "only " + std::to_string(names) + " names in " + path);
+}
+
+// --- Trace Export (trace.cpp) ---
+// Runs the scheduler on fake probes with tracing on, exports the Chrome trace and reads it back: the file must parse,
+// every span must have a start and a non-negative duration, spans on one thread must nest (begin/end balanced), each
+// probe's span must carry its name on a thread named after it and last about as long as the probe slept, and a
+// timed-out probe must show up as a "timeout" span at its deadline.
+static void TestTrace(TestContext& t) {
+    ProbeScheduler scheduler(1000);
+    scheduler.AddProbe(SleepingProbe("CPU", SectionCpu, 0, 30, true, [](MachineRecord& r) {
+        TRACE_SPAN("Win32_Processor", "wmi"); std::this_thread::sleep_for(std::chrono::milliseconds(10)); r.Cpu.NumberOfCores = 4;
+    }));
+    scheduler.AddProbe(SleepingProbe("RAM", SectionRam, 0, 60, true, [](MachineRecord&) {}));
+    scheduler.AddProbe(SleepingProbe("Firmware", SectionFirmware, 0, 20, true, [](MachineRecord&) {}));
+    scheduler.AddProbe(SleepingProbe("Security", SectionSecurity, SectionFirmware, 20, true, [](MachineRecord&) {}));
+    scheduler.AddProbe(SleepingProbe("Disk", SectionDisk, 0, 600, true, [](MachineRecord&) {}), 100);
+    MachineRecord record; std::vector<ProbeOutcome> outcomes;
+    TraceStart(); TRACE_THREAD_NAME("main");
+    scheduler.Run(record, outcomes);
+    TraceStop();
+
+    const std::string path = TempPath("trace.json"); std::string error, text, summary;
+    if (!Expect(t, SaveChromeTrace(path, error), "save: " + error)) return;
+    { std::ifstream file(path.c_str(), std::ios::binary); std::ostringstream content; content << file.rdbuf(); text = content.str(); }
+    std::remove(path.c_str());
+    JsonValue root;
+    if (!Expect(t, JsonReader(text).Read(root), "the exported trace is valid JSON")) return;
+    const JsonValue* events = root.Get("traceEvents");
+    if (!Expect(t, events && events->Type == JsonValue::Array && !events->Items.empty(), "the trace has a traceEvents array")) return;
+
+    struct Span { std::string Name, Category; double Start, Duration; };
+    std::map<int, std::vector<Span>> byThread; std::map<int, std::string> threadNames; std::map<std::string, Span> named; size_t timeoutCounters = 0;
+    for (const JsonValue& e : events->Items) {
+        const std::string phase = e.TextOr("ph", ""); const int tid = (int)e.NumberOr("tid", -1);
+        if (phase == "M") { const JsonValue* args = e.Get("args"); threadNames[tid] = args ? args->TextOr("name", "") : ""; continue; }
+        if (phase == "C") { if (e.TextOr("name", "") == "Probes timed out") { ++timeoutCounters; Expect(t, e.Get("args") && e.Get("args")->NumberOr("value", 0) == 1, "timeout counter value 1"); } continue; }
+        if (!Expect(t, phase == "X", "event phase '" + phase + "'")) continue;
+        Span span = { e.TextOr("name", ""), e.TextOr("cat", ""), e.NumberOr("ts", -1), e.NumberOr("dur", -1) };
+        Expect(t, !span.Name.empty() && tid > 0, "span has a name and a thread");
+        Expect(t, span.Start >= 0 && span.Duration >= 0 && std::isfinite(span.Start + span.Duration), "span '" + span.Name + "' has a start and a duration");
+        byThread[tid].push_back(span); named[span.Category + "/" + span.Name] = span;
+        if (span.Category == "probe") {
+            Expect(t, threadNames.count(tid) && threadNames[tid] == span.Name, "probe span '" + span.Name + "' is on the thread named after it");
+        }
+    }
+    // Spans on one thread are balanced: each one that starts inside another also ends inside it (1 us export rounding)
+    for (std::map<int, std::vector<Span>>::value_type& thread : byThread) {
+        std::vector<Span>& spans = thread.second; std::vector<const Span*> open;
+        std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.Start < b.Start || (a.Start == b.Start && a.Duration > b.Duration); });
+        for (const Span& span : spans) {
+            while (!open.empty() && open.back()->Start + open.back()->Duration <= span.Start + 0.001) open.pop_back();
+            if (!open.empty()) Expect(t, span.Start + span.Duration <= open.back()->Start + open.back()->Duration + 0.001, "span '" + span.Name + "' ends inside '" + open.back()->Name + "'");
+            open.push_back(&span);
+        }
+    }
+    static const struct { const char* Key; double MinMs, MaxMs; } expected[] = {
+        { "phase/Probe scheduler", 100, 400 }, { "probe/CPU", 40, 250 }, { "wmi/Win32_Processor", 10, 200 }, { "probe/RAM", 60, 250 },
+        { "probe/Firmware", 20, 200 }, { "probe/Security", 20, 200 }, { "timeout/Disk", 100, 300 },
+    };
+    for (const auto& e : expected) {
+        std::map<std::string, Span>::const_iterator span = named.find(e.Key);
+        if (!Expect(t, span != named.end(), std::string("a span ") + e.Key)) continue;
+        const double ms = span->second.Duration / 1000.0;
+        Expect(t, ms >= e.MinMs - 1 && ms <= e.MaxMs, std::string(e.Key) + " took " + std::to_string(ms) + " ms");
+    }
+    Expect(t, named.count("probe/Disk") == 0, "the abandoned Disk probe has no span of its own yet");
+    Expect(t, named.size() == sizeof(expected) / sizeof(expected[0]), std::to_string(named.size()) + " distinct spans, expected " + std::to_string(sizeof(expected) / sizeof(expected[0])));
+    if (named.count("probe/Security") && named.count("probe/Firmware")) {
+        Expect(t, named["probe/Security"].Start >= named["probe/Firmware"].Start + named["probe/Firmware"].Duration - 0.001, "Security starts after Firmware ends");
+    }
+    Expect(t, timeoutCounters == 1, "one timeout counter sample");
+    FormatTraceSummary(summary);
+    Expect(t, summary.find("Probe scheduler") != std::string::npos && summary.find("Win32_Processor") != std::string::npos, "the summary lists the spans");
+}
+
+// --- Inventory Fields (inventory.cpp, mapped_inventory.cpp) ---
+// Numeric columns must take every value their member can hold and reject the first one past either end (a value that
+// does not fit is a malformed row, never wrapped into a plausible number); the CSV reader must count such a row as
+// malformed and keep reading. JSON Lines rows must decode escapes and surrogate pairs, take dotted and nested keys,
+// keep the default for null, skip unknown keys and arrays under them, and report the rest with its line number. The
+// compact rows batch mode parses into must give the features, drive size and names of the full records.
+static std::string InventoryCsv(const std::vector<MachineRecord>& machines) { std::ostringstream out; WriteInventoryHeader(out); for (const MachineRecord& m : machines) WriteInventoryRecord(out, m); return out.str(); }
+static std::string InventoryJsonLines(const std::vector<MachineRecord>& machines) { // Every field as a string, in the nested {"Cpu":{"Name":..}} form
+    size_t count = 0; const RecordField* fields = GetRecordFields(count); std::string out, value;
+    for (const MachineRecord& m : machines) {
+        std::string section; out += '{';
+        for (size_t i = 0; i < count; ++i) {
+            const char* dot = strchr(fields[i].Name, '.'); const std::string group = dot ? std::string(fields[i].Name, dot) : std::string();
+            if (group != section) { if (!section.empty()) out += '}'; if (out.back() != '{') out += ','; if (!group.empty()) out += "\"" + group + "\":{"; section = group; }
+            else if (out.back() != '{') out += ',';
+            value.clear(); fields[i].Format(m, value);
+            out += '"'; out += dot ? dot + 1 : fields[i].Name; out += "\":\"";
+            for (char c : value) { if (c == '"' || c == '\\') out += '\\'; out += c; }
+            out += '"';
+        }
+        if (!section.empty()) out += '}';
+        out += "}\n";
+    }
+    return out;
+}
+
+static void TestInventoryFields(TestContext& t) {
+    struct Case { const char* Field; const char* Value; bool Ok; };
+    static const Case cases[] = {
+        { "Cpu.MaxClockSpeed", "4294967295", true }, { "Cpu.MaxClockSpeed", "4294967296", false }, { "Cpu.MaxClockSpeed", "-1", false },
+        { "Cpu.NumberOfCores", "99999999999", false }, { "Graphics.AdapterRAM", "4294967295", true }, { "Graphics.AdapterRAM", "8589934592", false },
+        { "Security.TpmSpecVersionMajor", "4294967296", false }, { "TimedOutSections", "4294967296", false },
+        { "Ram.TotalPhysicalBytes", "18446744073709551615", true }, { "Ram.TotalPhysicalBytes", "18446744073709551616", false },
+        { "Screen.Width", "2147483647", true }, { "Screen.Width", "2147483648", false }, { "Screen.Height", "-2147483648", true },
+        { "Screen.Height", "-2147483649", false }, { "Screen.Width", "4294968216", false }, { "Screen.Width", " +1920", true },
+    };
+    for (const Case& c : cases) {
+        const RecordField* field = FindRecordField(c.Field); MachineRecord record; std::string formatted;
+        if (!Expect(t, field != NULL, std::string("unknown field ") + c.Field)) continue;
+        const bool ok = field->Parse(record, c.Value);
+        if (ok) field->Format(record, formatted);
+        Expect(t, ok == c.Ok, std::string(c.Field) + " '" + c.Value + "' " + (ok ? "accepted as " + formatted : std::string("rejected")));
+    }
+
+    std::istringstream csv("MachineId,Screen.Width,Cpu.MaxClockSpeed\r\nfits,1920,3000\r\nwide,4294968216,3000\r\nfast,1920,4294967296\r\nlast,1024,1000\r\n");
+    InventoryReader reader(csv); MachineRecord record; std::vector<std::string> ids;
+    if (!Expect(t, reader.ReadHeader(), "inventory header")) return;
+    InventoryReader::Status status;
+    while ((status = reader.ReadRecord(record)) != InventoryReader::EndOfInput) { if (status == InventoryReader::RecordOk) ids.push_back(WideToUtf8(record.MachineId)); }
+    Expect(t, ids.size() == 2 && ids[0] == "fits" && ids[1] == "last" && reader.MalformedRows() == 2, std::to_string(ids.size()) + " rows read, " + std::to_string(reader.MalformedRows()) + " malformed; expected 2 and 2");
+    Expect(t, reader.LastError().find("Cpu.MaxClockSpeed") != std::string::npos, "last error names the field: " + reader.LastError());
+
+    // --- JSON Lines ---
+    auto ParseMapped = [](const std::string& text, std::vector<MachineRecord>& records, std::vector<std::string>& errors) {
+        MappedInventory inventory; std::string error; records.clear(); errors.clear();
+        if (!inventory.OpenMemory(text.data(), text.size(), error)) { errors.push_back(error); return; }
+        inventory.ParseRange(inventory.DataBegin(), inventory.Size(), inventory.DataLine(), records, errors);
+    };
+    struct JsonCase { const char* Line; const char* Field; const char* Value; const char* Error; }; // Value NULL: the field keeps its default
+    static const JsonCase jsonCases[] = {
+        { "{\"MachineId\":\"q\\\"b\\\\s\\/n\\nt\\t\"}", "MachineId", "q\"b\\s/n\nt\t", NULL },
+        { "{\"Cpu\":{\"Name\":\"Caf\\u00e9 \\u20AC \\uD83D\\uDE00\"}}", "Cpu.Name", "Caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80", NULL },
+        { "{\"MachineId\":\"\\uD83D x\"}", "MachineId", "\xEF\xBF\xBD x", NULL },          // Unpaired high surrogate
+        { "{\"MachineId\":\"\\uDE00\"}", "MachineId", "\xEF\xBF\xBD", NULL },               // Lone low surrogate
+        { "{\"MachineId\":\"\\uD83D\\u0041\"}", NULL, NULL, "bad surrogate pair" },
+        { "{\"MachineId\":\"\\u00G0\"}", NULL, NULL, "bad \\u escape" },
+        { "{\"MachineId\":\"\\q\"}", NULL, NULL, "bad escape" },
+        { "{\"MachineId\":\"open", NULL, NULL, "unterminated string" },
+        { "{\"Cpu.Name\":\"Dotted\"}", "Cpu.Name", "Dotted", NULL },
+        { "{\"Ram\":{\"TotalPhysicalBytes\":8589934592},\"Cpu\":{\"Is64BitCapable\":true}}", "Ram.TotalPhysicalBytes", "8589934592", NULL },
+        { "{\"Vendor\":{\"Extra\":{\"Deep\":[1,{\"x\":\"]\"},[]]}},\"Screen\":{\"Width\":1280}}", "Screen.Width", "1280", NULL }, // Unknown keys, nested arrays
+        { "{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":{\"a\":1}}}}}}}}}}", NULL, NULL, "nested too deeply" },
+        { "{\"Screen\":{\"Width\":null},\"Cpu\":{\"Name\":null}}", "Screen.Width", NULL, NULL },
+        { "{\"Cpu\":{\"Name\":null}}", "Cpu.Name", NULL, NULL },
+        { "{\"Cpu\":{\"Name\":[\"x\"]}}", NULL, NULL, "bad value (array) for Cpu.Name" },
+        { "{\"Tags\":[\"a\",\"b\"],\"MachineId\":\"after-array\"}", "MachineId", "after-array", NULL },
+        { "{\"Screen\":{\"Width\":\"wide\"}}", NULL, NULL, "bad value 'wide' for Screen.Width" },
+        { "{\"MachineId\":\"t\"} x", NULL, NULL, "text after the object" },
+        { "{\"MachineId\":\"t\"}{}", NULL, NULL, "text after the object" },
+        { " {\"MachineId\":\"spaced\"} \t\r", "MachineId", "spaced", NULL },
+        { "{\"MachineId\" \"x\"}", NULL, NULL, "expected ':'" },
+        { "{\"MachineId\":\"x\" \"y\"}", NULL, NULL, "expected ',' or '}'" },
+        { "{\"MachineId\":}", NULL, NULL, "expected a value" },
+        { "{\"MachineId\":\"x\",}", NULL, NULL, "expected a key" },
+    };
+    const MachineRecord defaults; std::vector<MachineRecord> records; std::vector<std::string> errors;
+    for (const JsonCase& c : jsonCases) {
+        ParseMapped(std::string(c.Line) + "\n", records, errors);
+        if (c.Error) {
+            Expect(t, records.empty() && errors.size() == 1 && errors[0].compare(0, 8, "Line 1: ") == 0 && errors[0].find(c.Error) != std::string::npos,
+                   std::string(c.Line) + ": expected '" + c.Error + "', got " + (errors.empty() ? std::string("no error") : errors[0]));
+            continue;
+        }
+        if (!Expect(t, records.size() == 1 && errors.empty(), std::string(c.Line) + ": " + (errors.empty() ? std::string("no record") : errors[0]))) continue;
+        const RecordField* field = FindRecordField(c.Field); std::string value, expected = c.Value ? c.Value : "";
+        if (!Expect(t, field != NULL, std::string("unknown field ") + c.Field)) continue;
+        field->Format(records[0], value); if (!c.Value) field->Format(defaults, expected);
+        Expect(t, value == expected, std::string(c.Line) + ": " + c.Field + " is '" + value + "', expected '" + expected + "'");
+    }
+    ParseMapped("{\"MachineId\":\"first\"}\n\n  \r\n{\"MachineId\":1 2}\r\n{\"MachineId\":\"last\"}", records, errors);
+    Expect(t, records.size() == 2 && errors.size() == 1 && errors[0].compare(0, 8, "Line 4: ") == 0 && WideToUtf8(records[1].MachineId) == "last",
+           std::to_string(records.size()) + " records around blank lines; error " + (errors.empty() ? std::string("none") : errors[0]));
+
+    // --- Compact Rows (batch mode) Against Full Records ---
+    std::vector<MachineRecord> machines; SyntheticFleet(t.Seed).Generate(300, machines);
+    machines[3].MachineId = L"PC-\u00C9T\u00C9,\"x\""; machines[4].Cpu.Name.clear(); machines[5].Graphics.Name = L"GPU \U0001F600";
+    const std::string texts[] = { InventoryCsv(machines), InventoryJsonLines(machines) };
+    for (const std::string& text : texts) {
+        MappedInventory inventory; std::string error; MappedInventory::ParsedRows rows; std::vector<std::string> rowErrors;
+        ParseMapped(text, records, errors);
+        if (!Expect(t, inventory.OpenMemory(text.data(), text.size(), error), "open: " + error)) continue;
+        inventory.ParseRange(inventory.DataBegin(), inventory.Size(), inventory.DataLine(), rows, rowErrors);
+        const char* format = text[0] == '{' ? "JSON Lines" : "CSV";
+        if (!Expect(t, rows.Size() == records.size() && records.size() == machines.size() && errors.empty() && rowErrors.empty(), std::string(format) + ": " + std::to_string(rows.Size()) + " compact rows, " + std::to_string(records.size()) + " records")) continue;
+        size_t features = 0, names = 0, disks = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (!SameFeatures(rows.Features[i], ExtractFeatures(records[i]))) ++features;
+            if (rows.DiskTotals[i] != records[i].Disk.TotalBytes) ++disks;
+            if (rows.Get(i, MappedInventory::ParsedRows::MachineId) != WideToUtf8(records[i].MachineId) || rows.Get(i, MappedInventory::ParsedRows::CpuName) != WideToUtf8(records[i].Cpu.Name)
+                || rows.Get(i, MappedInventory::ParsedRows::GpuName) != WideToUtf8(records[i].Graphics.Name)) ++names;
+        }
+        Expect(t, features == 0 && names == 0 && disks == 0, std::string(format) + ": " + std::to_string(features) + " rows with other features, " + std::to_string(names) + " with other names, " + std::to_string(disks) + " with another drive size");
+    }
+    const std::string sparse = "{\"MachineId\":\"full\",\"Cpu\":{\"Name\":\"X\",\"NumberOfCores\":8},\"Ram\":{\"TotalPhysicalBytes\":5}}\n{\"MachineId\":\"bare\"}\n";
+    MappedInventory inventory; std::string error; MappedInventory::ParsedRows rows;
+    if (Expect(t, inventory.OpenMemory(sparse.data(), sparse.size(), error), "open: " + error)) {
+        inventory.ParseRange(inventory.DataBegin(), inventory.Size(), inventory.DataLine(), rows, errors);
+        MachineRecord bare; bare.MachineId = L"bare"; FinishInventoryRecord(bare);
+        Expect(t, rows.Size() == 2 && SameFeatures(rows.Features[1], ExtractFeatures(bare)) && rows.Get(1, MappedInventory::ParsedRows::CpuName) == WideToUtf8(defaults.Cpu.Name),
+               "a row without keys gets the defaults, not the previous row's values");
+    }
+}
+
+// --- Binary Fleet File (fleet_file.cpp) ---
+// Synthetic records packed with FleetWriter read back field for field and give the same features as ExtractFeatures().
+// Open() must refuse the file cut short at any point, a wrong magic or version, string offsets that go backwards or
+// past the string data, and counts or offsets so large that the size computed from them would wrap around.
+static void TestFleetFile(TestContext& t) {
+    std::vector<MachineRecord> machines; SyntheticFleet(t.Seed).Generate(200, machines);
+    machines[7].MachineId = L"PC-\u00C9T\u00C9"; machines[8].Cpu.Name.clear();
+    const std::string path = TempPath("fleet.wrcf");
+    std::string error; FleetWriter writer;
+    bool written = writer.Open(path, error);
+    for (const MachineRecord& machine : machines) written = written && writer.Add(machine);
+    if (!Expect(t, written && writer.Finish(error), "write: " + error)) { std::remove(path.c_str()); return; }
+
+    // --- Round Trip ---
+    {
+        FleetFile fleet;
+        if (Expect(t, fleet.Open(path, error), "open: " + error) && Expect(t, fleet.Size() == machines.size(), std::to_string(fleet.Size()) + " records read back")) {
+            size_t records = 0, features = 0;
+            for (size_t i = 0; i < machines.size(); ++i) {
+                MachineRecord back; fleet.Materialize(i, back);
+                if (FormatRecord(back) != FormatRecord(machines[i])) ++records;
+                if (!SameFeatures(fleet.Features(i), ExtractFeatures(machines[i]))) ++features;
+            }
+            Expect(t, records == 0, std::to_string(records) + " records differ after the round trip");
+            Expect(t, features == 0, std::to_string(features) + " records give other features than ExtractFeatures()");
+            Expect(t, fleet.StringUtf8(fleet.Record(7).MachineId) == "PC-\xC3\x89T\xC3\x89" && fleet.StringUtf8(0xFFFFFFFFu).empty(), "strings are UTF-8; an unknown id reads as empty");
+        }
+    }
+
+    // --- Rejection ---
+    const std::string bytes = ReadWholeFile(path), damagedPath = path + ".damaged";
+    FleetFileHeader header; memcpy(&header, bytes.data(), sizeof(header));
+    auto Refuses = [&](const std::string& content, const char* reason, const std::string& what) {
+        FleetFile fleet; std::string openError;
+        const bool ok = WriteWholeFile(damagedPath, content) && fleet.Open(damagedPath, openError);
+        return Expect(t, !ok && openError.find(reason) != std::string::npos, what + ": " + (ok ? std::string("accepted") : openError));
+    };
+    auto WithHeader = [&](const std::function<void(FleetFileHeader&)>& change) { FleetFileHeader changed = header; change(changed); return std::string((const char*)&changed, sizeof(changed)) + bytes.substr(sizeof(changed)); };
+    auto WithOffset = [&](ULONGLONG index, UINT32 value) { std::string changed = bytes; memcpy(&changed[header.StringIndexOffset + index * sizeof(UINT32)], &value, sizeof(value)); return changed; };
+    size_t cuts = 0, accepted = 0;
+    for (size_t length = 0; length < bytes.size(); length += (length < 128 || length + 64 > bytes.size()) ? 1 : 61) { // Every cut in the header and at the end, a spread in between
+        FleetFile fleet; std::string openError; ++cuts;
+        if (WriteWholeFile(damagedPath, bytes.substr(0, length)) && fleet.Open(damagedPath, openError)) ++accepted;
+    }
+    Expect(t, accepted == 0, std::to_string(accepted) + " of " + std::to_string(cuts) + " truncated files were accepted");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.Magic[0] = 'X'; }), "Not a fleet file", "a wrong magic");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.Version = FLEET_FILE_VERSION + 1; }), "version", "a newer version");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.RecordSize = sizeof(FleetRecord) - 8; }), "version", "another record size");
+    Refuses(WithOffset(1, 0xFFFFFFF0u), "corrupt", "string offsets that go backwards");
+    Refuses(WithOffset(header.StringCount, (UINT32)header.StringDataSize + 1), "corrupt", "a last string offset past the string data");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.StringCount = ~0ULL; }), "string index is truncated", "StringCount 2^64-1 (StringCount + 1 wraps to 0)");
+    const ULONGLONG indexRoom = (bytes.size() - header.StringIndexOffset) / sizeof(UINT32); // One more string than there is room for
+    Refuses(WithHeader([&](FleetFileHeader& h) { h.StringCount = indexRoom; }), "string index is truncated", "a StringCount one past the end of the file");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.StringIndexOffset = ~0ULL - 3; }), "string index is truncated", "a string index offset near 2^64");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.RecordCount = ~0ULL; }), "record table is truncated", "RecordCount 2^64-1");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.RecordsOffset = ~0ULL - 7; }), "record table is truncated", "a record offset near 2^64");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.StringDataSize = ~0ULL; }), "string data is truncated", "StringDataSize 2^64-1");
+    Refuses(WithHeader([](FleetFileHeader& h) { h.StringDataOffset = ~0ULL; h.StringDataSize = 1; }), "string data is truncated", "a string data offset near 2^64");
+    std::remove(damagedPath.c_str()); std::remove(path.c_str());
+}
+
+// --- Report Renderers (report.cpp) ---
+// One fixed machine rendered in all four formats. Every JSON line must parse and carry the MachineId back unchanged
+// with '"', '\' and control characters escaped; HTML must escape '<', '&' and '"'; the ANSI text without its color
+// sequences must be the plain text, and the plain text must match report/plain.txt (regenerate it from the file the
+// suite writes on a mismatch when the wording is meant to change).
+static MachineRecord ReportMachine() {
+    MachineRecord m; m.MachineId = L"PC-0042";
+    m.Cpu.Name = L"Intel(R) Core(TM) i5-7500 CPU @ 3.40GHz"; m.Cpu.Architecture = L"x64"; m.Cpu.MaxClockSpeed = 3400;
+    m.Cpu.NumberOfCores = 4; m.Cpu.NumberOfLogicalProcessors = 4; m.Cpu.Is64BitCapable = true; m.Cpu.MinCpuGenerationLevel = CpuListNotListed;
+    m.Ram.TotalPhysicalBytes = 8ULL << 30; m.Disk.TotalBytes = 256ULL << 30; m.Disk.FreeBytesAvailableToUser = 40ULL << 30; m.Disk.DriveLetter = L'C';
+    m.Os.Caption = L"Microsoft Windows 10 Pro"; m.Os.Version = L"10.0.19045"; m.Os.BuildNumber = L"19045"; m.Os.OSArchitecture = L"64-bit";
+    m.Firmware.FirmwareType = FirmwareUefi; m.Firmware.Source = SourceApi;
+    m.Graphics.Name = L"Intel(R) HD Graphics 630"; m.Graphics.DirectXFeatureLevel = PackVersion(12, 1); m.Graphics.WDDMVersion = PackVersion(2, 7);
+    m.Screen.Width = 1920; m.Screen.Height = 1080;
+    m.Security.TpmFound = true; m.Security.TpmEnabled = true; m.Security.TpmSpecVersionMajor = 2; m.Security.TpmVersionString = L"2.0, 0, 1.38";
+    m.Security.SecureBootCapable = true; m.Security.SecureBoot = SecureBootOff; m.Security.SecureBootSource = SourceApi;
+    m.DirectX.InstalledVersion = L"DirectX 12";
+    return m;
+}
+
+static void TestReport(TestContext& t) {
+    const WindowsRequirements& target = BUILTIN_TARGETS[TargetWin11].Requirements;
+    MachineRecord machine = ReportMachine();
+    auto Render = [&](ReportFormat format, const MachineRecord& m) {
+        const MachineFeatures features = ExtractFeatures(m);
+        RequirementsReport report; BuildRequirementsReport(target, m, MakeEvaluationResult(EvaluateFeatures(target, features), features), report);
+        TargetSummaryReport summary; summary.MachineId = report.MachineId; summary.Targets = EvaluateAllBuiltinTargets(features);
+        std::unique_ptr<ReportRenderer> renderer = CreateReportRenderer(format); std::string out;
+        renderer->BeginDocument(out); renderer->Render(report, out); renderer->Render(summary, out); renderer->EndDocument(out);
+        return out;
+    };
+
+    // --- Plain Text Against the Golden File, ANSI Without Colors ---
+    const std::string plain = Render(ReportPlain, machine), goldenPath = t.Fixtures + "/report/plain.txt";
+    std::string golden = ReadWholeFile(goldenPath); golden.erase(std::remove(golden.begin(), golden.end(), '\r'), golden.end());
+    if (!Expect(t, !golden.empty() && plain == golden, "plain text differs from " + goldenPath + " (written to " + TempPath("report-plain.txt") + ")")) WriteWholeFile(TempPath("report-plain.txt"), plain);
+    std::string ansi = Render(ReportAnsi, machine), stripped;
+    for (size_t i = 0; i < ansi.size(); ++i) { if (ansi[i] == '\x1b') { i = ansi.find('m', i); if (i == std::string::npos) break; } else stripped += ansi[i]; }
+    Expect(t, ansi != plain && stripped == plain, "ANSI text is the plain text plus color sequences");
+
+    // --- JSON Lines ---
+    const std::string id = "PC \"quoted\" back\\slash\ttab\x01\x1f" "end";
+    machine.MachineId = Utf8ToWide(id);
+    const std::string json = Render(ReportJson, machine);
+    std::istringstream lines(json); std::string line; std::vector<JsonValue> objects;
+    while (std::getline(lines, line)) { JsonValue value; if (Expect(t, JsonReader(line).Read(value) && value.Type == JsonValue::Object, "JSON line parses: " + line.substr(0, 80))) objects.push_back(value); }
+    if (Expect(t, objects.size() == 2, std::to_string(objects.size()) + " JSON lines, expected a report and a summary")) {
+        Expect(t, objects[0].TextOr("machineId", "") == id && objects[1].TextOr("machineId", "") == id, "MachineId reads back unchanged from both lines");
+        Expect(t, objects[0].TextOr("target", "") == "Windows 11" && objects[0].TextOr("result", "") == "fail", "target and result: " + objects[0].TextOr("target", "?") + ", " + objects[0].TextOr("result", "?"));
+        const JsonValue* sections = objects[0].Get("sections"); size_t checks = 0, failed = 0;
+        if (sections) for (const JsonValue& section : sections->Items) { const JsonValue* list = section.Get("checks"); if (list) for (const JsonValue& check : list->Items) { ++checks; if (check.TextOr("status", "") == "fail") failed += (check.TextOr("check", "") == "CpuGeneration"); } }
+        Expect(t, checks == 12 && failed == 1, std::to_string(checks) + " checks in the report, CPU generation failed " + std::to_string(failed) + " time(s)");
+        Expect(t, objects[1].TextOr("highestSupported", "") == "Windows 10", "highest supported target: " + objects[1].TextOr("highestSupported", "?"));
+    }
+    Expect(t, json.find("PC \\\"quoted\\\" back\\\\slash\\ttab\\u0001\\u001fend") != std::string::npos, "quotes, backslashes and control characters are escaped");
+    size_t raw = 0; for (char ch : json) raw += ((unsigned char)ch < 0x20 && ch != '\n');
+    Expect(t, raw == 0, std::to_string(raw) + " raw control characters in the JSON output");
+
+    // --- HTML ---
+    machine.MachineId = L"<script>&\"x\"</script>";
+    const std::string html = Render(ReportHtml, machine);
+    Expect(t, html.find("&lt;script&gt;&amp;&quot;x&quot;&lt;/script&gt;") != std::string::npos && html.find("<script>") == std::string::npos, "'<', '&' and '\"' in the MachineId are escaped");
+    Expect(t, html.compare(0, 15, "<!DOCTYPE html>") == 0 && html.size() > 22 && html.compare(html.size() - 15, 15, "</body></html>\n") == 0, "the page wraps the reports");
+}
+
+// --- Incremental Batch Runs (batch.cpp, result_cache.cpp) ---
+// Runs a small inventory through RunBatch with a result cache, then a second export in which machines were added,
+// removed, fixed, broken, failed for other reasons or changed only in a value no check reads. The delta must classify
+// each one (New, Removed, NewlyPassing, NewlyFailing, ReasonsChanged; nothing for the rest), verdicts must equal an
+// uncached run, unchanged lines must be reused without parsing, and the same machines exported as JSON Lines must
+// produce no delta: the line hashes differ but the checked values do not.
+static void TestBatchCache(TestContext& t) {
+    MachineRecord passing = ReportMachine();
+    passing.Cpu.Name = L"Intel(R) Core(TM) i5-8250U CPU @ 1.60GHz"; passing.Cpu.MinCpuGenerationLevel = CpuListSupported;
+    passing.Security.SecureBoot = SecureBootOn; passing.Security.SecureBootEnabled = true; passing.Disk.FreeBytesAvailableToUser = 100ULL << 30;
+    auto Machine = [&](const wchar_t* id, const std::function<void(MachineRecord&)>& change) { MachineRecord m = passing; m.MachineId = id; change(m); return m; };
+    auto NoSecureBoot = [](MachineRecord& m) { m.Security.SecureBoot = SecureBootOff; m.Security.SecureBootEnabled = false; };
+    auto Unchanged = [](MachineRecord&) {};
+    const std::vector<MachineRecord> before = {
+        Machine(L"A-same", Unchanged), Machine(L"B-fixed", NoSecureBoot), Machine(L"C-same-fail", [](MachineRecord& m) { m.Cpu.Name = L"Intel(R) Core(TM) i5-7500 CPU @ 3.40GHz"; m.Cpu.MinCpuGenerationLevel = CpuListNotListed; }),
+        Machine(L"D-broken", Unchanged), Machine(L"E-other-reason", NoSecureBoot), Machine(L"F-removed", Unchanged), Machine(L"G-caption", Unchanged),
+    };
+    std::vector<MachineRecord> after = before;
+    after[1].Security.SecureBoot = SecureBootOn; after[1].Security.SecureBootEnabled = true;
+    after[3].Disk.FreeBytesAvailableToUser = 10ULL << 30;
+    after[4].Security.SecureBoot = SecureBootOn; after[4].Security.SecureBootEnabled = true; after[4].Ram.TotalPhysicalBytes = 2ULL << 30;
+    after.erase(after.begin() + 5);
+    after[5].Os.Caption = L"Microsoft Windows 10 Enterprise";
+    after.push_back(Machine(L"H-new", NoSecureBoot));
+
+    const std::string inventory = TempPath("batch.csv"), verdicts = TempPath("batch-verdicts.csv"), delta = TempPath("batch-delta.csv"), cachePath = TempPath("batch.wrcc");
+    const WindowsRequirements* target = &BUILTIN_TARGETS[TargetWin11].Requirements;
+    auto Run = [&](const std::string& content, bool cached, BatchStats& stats) {
+        BatchOptions options; options.InputPaths.push_back(inventory); options.OutputPath = verdicts; options.Threads = 2; options.ChunkSize = 3;
+        ResultCache cache; std::string error;
+        if (cached) { options.Cache = &cache; options.DeltaPath = delta; Expect(t, cache.Load(cachePath, error), "load cache: " + error); }
+        bool ok = WriteWholeFile(inventory, content) && RunBatch(options, target, stats, error);
+        if (ok && cached) ok = cache.Save(cachePath, error);
+        Expect(t, ok, "batch run: " + error);
+        return ReadWholeFile(verdicts);
+    };
+    auto Changes = [&]() { // "MachineId,Change" per delta line, after the header
+        std::istringstream lines(ReadWholeFile(delta)); std::string line, out; std::getline(lines, line);
+        while (std::getline(lines, line)) { const size_t second = line.find(',', line.find(',') + 1); out += line.substr(0, second) + ";"; }
+        return out;
+    };
+    std::remove(cachePath.c_str());
+    BatchStats stats, uncached;
+    Run(InventoryCsv(before), true, stats);
+    Expect(t, Changes() == "A-same,New;B-fixed,New;C-same-fail,New;D-broken,New;E-other-reason,New;F-removed,New;G-caption,New;", "first run: every machine is new: " + Changes());
+
+    const std::string second = Run(InventoryCsv(after), true, stats);
+    Expect(t, second == Run(InventoryCsv(after), false, uncached), "verdicts with the cache equal an uncached run");
+    Expect(t, Changes() == "B-fixed,NewlyPassing;D-broken,NewlyFailing;E-other-reason,ReasonsChanged;H-new,New;F-removed,Removed;", "delta: " + Changes());
+    Expect(t, stats.Machines == 7 && stats.Reused == 3 && stats.Unparsed == 2 && stats.Changes == 5,
+           "second run: " + std::to_string(stats.Reused) + " reused, " + std::to_string(stats.Unparsed) + " unparsed, " + std::to_string(stats.Changes) + " changes; expected 3, 2 (A and C; G's line changed) and 5");
+    const std::string deltaText = ReadWholeFile(delta);
+    Expect(t, deltaText.find("E-other-reason,ReasonsChanged,FAIL,FAIL,Ram,SecureBoot,,") != std::string::npos, "ReasonsChanged lists the new and the old failed checks");
+    Expect(t, deltaText.find("F-removed,Removed,,PASS,") != std::string::npos, "a removed machine keeps only its previous verdict");
+
+    Run(InventoryCsv(after), true, stats);
+    Expect(t, Changes().empty() && stats.Reused == 7 && stats.Unparsed == 7, "an identical export: no delta, nothing parsed (" + std::to_string(stats.Unparsed) + " of 7 unparsed)");
+    const std::string json = Run(InventoryJsonLines(after), true, stats);
+    Expect(t, json == second, "the same machines as JSON Lines give the same verdicts");
+    Expect(t, Changes().empty() && stats.Reused == 7 && stats.Unparsed == 0, "JSON Lines: no delta, every line parsed once (" + std::to_string(stats.Unparsed) + " unparsed)");
+    Run(InventoryJsonLines(after), true, stats);
+    Expect(t, Changes().empty() && stats.Unparsed == 7, "JSON Lines again: " + std::to_string(stats.Unparsed) + " of 7 lines reused without parsing");
+    for (const std::string& path : { inventory, verdicts, delta, cachePath }) std::remove(path.c_str());
+}
+
+// --- Streaming Sketches (sketch.cpp) ---
+// Each sketch is checked against exact counts of the same stream, alone and merged from four parts: HyperLogLog within its
+// 1.6% standard error, KLL quantiles within about 1.7% rank error with exact minimum and maximum, Space-Saving counts
+// never below the true count and at most Error() above it. A serialized sketch must read back and merge to the same
+// bytes as the original, and truncated or corrupt input must be rejected.
+static unsigned long long NextRandom(unsigned long long& state) {
+    state += 0x9E3779B97F4A7C15ULL; unsigned long long z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL; z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL; return z ^ (z >> 31);
+}
+
+template <typename Sketch> static std::string SerializedSketch(const Sketch& sketch) { std::string out; sketch.Serialize(out); return out; }
+
+template <typename Sketch> static bool ReadsBack(const std::string& bytes, Sketch& sketch) {
+    const char* p = bytes.data(); return sketch.Deserialize(p, bytes.data() + bytes.size()) && p == bytes.data() + bytes.size();
+}
+
+// Serialize -> Deserialize must give the same bytes, and merging the read-back parts the same bytes as merging the
+// originals. Every prefix of the bytes (strided for large sketches) must be rejected.
+template <typename Sketch> static void CheckSketchBytes(TestContext& t, const std::string& what, const std::vector<Sketch>& parts) {
+    Sketch merged, mergedCopies; size_t roundTrips = 0, truncations = 0;
+    for (const Sketch& part : parts) {
+        const std::string bytes = SerializedSketch(part); Sketch copy;
+        if (ReadsBack(bytes, copy) && SerializedSketch(copy) == bytes) ++roundTrips;
+        merged.Merge(part); mergedCopies.Merge(copy);
+        const size_t stride = bytes.size() > 4096 ? 7 : 1;
+        for (size_t length = 0; length < bytes.size(); length += (length + 64 < bytes.size() ? stride : 1)) {
+            Sketch cut; const char* p = bytes.data();
+            if (cut.Deserialize(p, bytes.data() + length)) ++truncations;
+        }
+    }
+    Expect(t, roundTrips == parts.size(), what + ": " + std::to_string(roundTrips) + " of " + std::to_string(parts.size()) + " parts read back to the same bytes");
+    Expect(t, SerializedSketch(merged) == SerializedSketch(mergedCopies), what + ": merging read-back parts gives the same bytes as merging the originals");
+    Expect(t, truncations == 0, what + ": " + std::to_string(truncations) + " truncated encodings accepted");
+}
+
+static void TestSketch(TestContext& t) {
+    unsigned long long state = t.Seed;
+
+    // --- HyperLogLog: 16 streams of 20,000 distinct names, each also added to one union sketch twice over ---
+    double squares = 0, worst = 0; std::vector<HyperLogLog> hlls(4); HyperLogLog all;
+    const size_t streams = 16, distinct = 20000;
+    for (size_t stream = 0; stream < streams; ++stream) {
+        HyperLogLog hll; char name[64];
+        for (size_t i = 0; i < distinct; ++i) {
+            const int length = snprintf(name, sizeof(name), "Model %llu-%zu", (unsigned long long)t.Seed, stream * distinct + i);
+            const ULONGLONG hash = SketchHash(name, (size_t)length);
+            hll.Add(hash); hll.Add(hash); hlls[stream % 4].Add(hash);
+        }
+        const double error = hll.Estimate() / (double)distinct - 1.0;
+        squares += error * error; worst = std::max(worst, std::fabs(error));
+    }
+    for (const HyperLogLog& part : hlls) all.Merge(part);
+    const double rms = std::sqrt(squares / (double)streams), unionError = all.Estimate() / (double)(streams * distinct) - 1.0;
+    Expect(t, rms <= 0.025, "HyperLogLog RMS error " + std::to_string(rms * 100) + "% over " + std::to_string(streams) + " streams (standard error 1.6%)");
+    Expect(t, worst <= 4 * 0.016, "HyperLogLog worst error " + std::to_string(worst * 100) + "% (over 4 standard errors)");
+    Expect(t, std::fabs(unionError) <= 4 * 0.016, "merged HyperLogLog error " + std::to_string(unionError * 100) + "% over the union");
+    HyperLogLog small; for (int i = 0; i < 100; ++i) small.Add(SketchHash((const char*)&i, sizeof(i)));
+    Expect(t, std::fabs(small.Estimate() - 100) <= 2, "HyperLogLog estimate of 100 names is " + std::to_string(small.Estimate()) + " (linear counting)");
+    CheckSketchBytes(t, "HyperLogLog", hlls);
+
+    // --- KLL: 200,000 RAM-like values (half on a few common sizes, so ties), in four parts ---
+    static const ULONGLONG common[] = { 2ULL << 30, 4ULL << 30, 8ULL << 30, 16ULL << 30, 32ULL << 30 };
+    std::vector<ULONGLONG> values; std::vector<KllSketch> klls(4); KllSketch whole;
+    for (size_t i = 0; i < 200000; ++i) {
+        const unsigned long long r = NextRandom(state);
+        const ULONGLONG value = (r & 1) ? common[(r >> 1) % 5] : (r >> 1) % (64ULL << 30);
+        values.push_back(value); whole.Add(value); klls[i * 4 / 200000].Add(value);
+    }
+    KllSketch mergedKll; for (const KllSketch& part : klls) mergedKll.Merge(part);
+    std::sort(values.begin(), values.end());
+    auto RankError = [&](const KllSketch& kll) { // Largest distance of a reported value's rank range from the requested rank
+        double largest = 0;
+        for (int percent = 1; percent < 100; ++percent) {
+            const ULONGLONG value = kll.Quantile(percent / 100.0); const double target = percent / 100.0 * (double)values.size();
+            const double below = (double)(std::lower_bound(values.begin(), values.end(), value) - values.begin());
+            const double upTo = (double)(std::upper_bound(values.begin(), values.end(), value) - values.begin());
+            const double distance = target < below ? below - target : (target > upTo ? target - upTo : 0);
+            largest = std::max(largest, distance / (double)values.size());
+        }
+        return largest;
+    };
+    for (const KllSketch* kll : { &whole, &mergedKll }) {
+        const std::string what = kll == &whole ? "KLL" : "merged KLL";
+        const double error = RankError(*kll);
+        Expect(t, error <= 0.017, what + " rank error " + std::to_string(error * 100) + "% over p1..p99 (about 1.7%)");
+        Expect(t, kll->Count() == values.size() && kll->Quantile(0) == values.front() && kll->Quantile(1) == values.back(), what + " count, minimum and maximum are exact");
+        Expect(t, kll->Retained() <= 3 * KllSketch::K, what + " retains " + std::to_string(kll->Retained()) + " values");
+    }
+    CheckSketchBytes(t, "KLL", klls);
+
+    // --- Space-Saving: 200,000 names drawn from 5,000 with a steep skew, 64 counters, in four parts ---
+    std::map<std::string, unsigned long long> exact; std::vector<SpaceSaving> tops(4, SpaceSaving(64)); SpaceSaving single(64);
+    for (size_t i = 0; i < 200000; ++i) {
+        const double u = (double)(NextRandom(state) >> 11) / 9007199254740992.0;
+        const std::string name = "Intel(R) Core(TM) i" + std::to_string((unsigned)(5000 * u * u * u));
+        ++exact[name]; single.Add(name.data(), name.size()); tops[i * 4 / 200000].Add(name.data(), name.size());
+    }
+    SpaceSaving mergedTop(64); for (const SpaceSaving& part : tops) mergedTop.Merge(part);
+    for (const SpaceSaving* top : { &single, &mergedTop }) {
+        const std::string what = top == &single ? "Space-Saving" : "merged Space-Saving";
+        std::vector<SpaceSaving::Entry> entries; top->Top(64, entries);
+        size_t outOfBounds = 0, missing = 0; const unsigned long long bound = top->Total() / top->Capacity();
+        for (const SpaceSaving::Entry& entry : entries) {
+            const unsigned long long truth = exact.count(entry.Item) ? exact[entry.Item] : 0;
+            if (truth > entry.Count || entry.Count - entry.Error > truth || entry.Error > bound) {
+                if (++outOfBounds <= 3) Expect(t, false, what + " '" + entry.Item + "': count " + std::to_string(entry.Count) + " error " + std::to_string(entry.Error) + ", true count " + std::to_string(truth));
+            }
+        }
+        for (const std::pair<const std::string, unsigned long long>& name : exact) {
+            if (name.second <= bound) continue;
+            bool found = false; for (const SpaceSaving::Entry& entry : entries) found = found || entry.Item == name.first;
+            if (!found) ++missing;
+        }
+        Expect(t, top->Total() == values.size() && outOfBounds == 0, what + ": " + std::to_string(outOfBounds) + " of " + std::to_string(entries.size()) + " counts outside [true, true + Error] or Error over Total/Capacity");
+        Expect(t, missing == 0, what + ": " + std::to_string(missing) + " names over Total/Capacity missing from the list");
+    }
+    CheckSketchBytes(t, "Space-Saving", tops);
+
+    // --- Fleet sketch: parts from a synthetic fleet, merged, then through the sketch file ---
+    std::vector<MachineRecord> records; SyntheticFleet fleet(t.Seed); fleet.Generate(2000, records);
+    std::vector<FleetSketch> fleets(4); const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const MachineFeatures features = ExtractFeatures(records[i]); const CheckMasks masks = EvaluateFeatures(win11, features);
+        const std::string cpu = WideToUtf8(records[i].Cpu.Name), gpu = WideToUtf8(records[i].Graphics.Name);
+        fleets[i % 4].Add(features, masks.Fail, masks.Warn, cpu.data(), cpu.size(), gpu.data(), gpu.size());
+    }
+    CheckSketchBytes(t, "fleet sketch", fleets);
+    FleetSketch fleetSketch; for (const FleetSketch& part : fleets) fleetSketch.Merge(part);
+    const std::string path = TempPath("sketch.wrcs"); std::string error, targetName; FleetSketch loaded;
+    const bool saved = SaveSketchFile(path, fleetSketch, "Windows 11", error) && LoadSketchFile(path, loaded, targetName, error);
+    Expect(t, saved && targetName == "Windows 11" && SerializedSketch(loaded) == SerializedSketch(fleetSketch) && loaded.Machines() == records.size(), "sketch file round trip: " + error);
+
+    // --- Corrupt input ---
+    const std::string file = ReadWholeFile(path);
+    auto Rejected = [&](const std::string& what, const std::string& bytes) {
+        WriteWholeFile(path, bytes); FleetSketch sketch; std::string name, message;
+        Expect(t, !LoadSketchFile(path, sketch, name, message) && !message.empty(), "sketch file with " + what + " is rejected");
+    };
+    Rejected("a wrong magic", "WRCSKTCX" + file.substr(8));
+    std::string version = file; version[8] = 2; Rejected("version 2", version);
+    Rejected("a trailing byte", file + '\0');
+    Rejected("a target name longer than the file", file.substr(0, 12) + std::string("\xFF\xFF\xFF\x7F", 4) + file.substr(16));
+    Rejected("no sketch after the header", file.substr(0, 16 + 10));
+    auto Corrupt = [&](const std::string& what, const std::string& bytes, auto& sketch) { Expect(t, !ReadsBack(bytes, sketch), what + " is rejected"); };
+    std::string registers = SerializedSketch(hlls[0]); registers[17] = (char)(64 - HyperLogLog::Precision + 2);
+    HyperLogLog hll; Corrupt("a HyperLogLog register past 64 - Precision + 1", registers, hll);
+    SpaceSaving top; std::string bytes;
+    PutVarint(bytes, 0); PutVarint(bytes, 0); PutVarint(bytes, 0); Corrupt("a Space-Saving capacity of 0", bytes, top);
+    bytes.clear(); PutVarint(bytes, 2); PutVarint(bytes, 3); PutVarint(bytes, 3); Corrupt("more Space-Saving entries than counters", bytes, top);
+    bytes.clear(); PutVarint(bytes, 4); PutVarint(bytes, 2); PutVarint(bytes, 2);
+    for (int i = 0; i < 2; ++i) { PutVarint(bytes, 1); bytes += 'A'; PutVarint(bytes, 1); PutVarint(bytes, 0); }
+    Corrupt("a name listed twice in a Space-Saving sketch", bytes, top);
+    bytes.clear(); PutVarint(bytes, 4); PutVarint(bytes, 1); PutVarint(bytes, 1); PutVarint(bytes, 129); bytes.append(129, 'A'); PutVarint(bytes, 1); PutVarint(bytes, 0);
+    Corrupt("a Space-Saving name over 128 bytes", bytes, top);
+    bytes.clear(); PutVarint(bytes, 4); PutVarint(bytes, 5); PutVarint(bytes, 1); PutVarint(bytes, 1); bytes += 'A'; PutVarint(bytes, 2); PutVarint(bytes, 3);
+    Corrupt("a Space-Saving error above its count", bytes, top);
+    KllSketch kll;
+    bytes.clear(); for (int i = 0; i < 4; ++i) PutVarint(bytes, 0); PutVarint(bytes, 65); Corrupt("a KLL sketch 65 levels high", bytes, kll);
+    bytes.clear(); PutVarint(bytes, 3); PutVarint(bytes, 1); PutVarint(bytes, 9); PutVarint(bytes, 0); PutVarint(bytes, 1); PutVarint(bytes, 2); PutVarint(bytes, 1); PutVarint(bytes, 9);
+    Corrupt("a KLL count that differs from the weight it retains", bytes, kll);
+    bytes.clear(); PutVarint(bytes, 2); PutVarint(bytes, 9); PutVarint(bytes, 1); PutVarint(bytes, 0); PutVarint(bytes, 1); PutVarint(bytes, 2); PutVarint(bytes, 1); PutVarint(bytes, 9);
+    Corrupt("a KLL minimum above its maximum", bytes, kll);
+    bytes.clear(); PutVarint(bytes, 2); PutVarint(bytes, 1); PutVarint(bytes, 9); PutVarint(bytes, 0); PutVarint(bytes, 1); PutVarint(bytes, 2); PutVarint(bytes, 1); PutVarint(bytes, 10);
+    Corrupt("a KLL value outside its minimum and maximum", bytes, kll);
+    bytes.clear(); for (int i = 0; i < 11; ++i) bytes += '\x80'; bytes += '\x01';
+    const char* p = bytes.data(); unsigned long long value = 0;
+    Expect(t, !GetVarint(p, bytes.data() + bytes.size(), value), "a varint over 10 bytes is rejected");
+    std::remove(path.c_str());
+}
+
+// --- Fleet Aggregate (aggregate.cpp) ---
+// The same machines split into parts and merged in any order (forward, backward, shuffled, pairwise) must serialize to
+// the bytes of one aggregate fed in input order, and so must batch runs at 1 to 8 threads with small chunks. The bytes
+// must read back unchanged; every truncation, a name listed twice and a machine count that disagrees with the failure
+// combinations must be rejected.
+static std::string SerializedAggregate(const FleetAggregate& aggregate) { std::string out; aggregate.Serialize(out); return out; }
+
+static void TestAggregate(TestContext& t) {
+    std::vector<MachineRecord> machines; SyntheticFleet(t.Seed).Generate(3000, machines);
+    const WindowsRequirements& target = BUILTIN_TARGETS[TargetWin11].Requirements;
+    struct Row { MachineFeatures Features; CheckMasks Masks; std::string Cpu, Gpu; };
+    std::vector<Row> rows;
+    for (const MachineRecord& machine : machines) {
+        Row row; row.Features = ExtractFeatures(machine); row.Masks = EvaluateFeatures(target, row.Features);
+        row.Cpu = WideToUtf8(machine.Cpu.Name); row.Gpu = WideToUtf8(machine.Graphics.Name); rows.push_back(row);
+    }
+    auto Add = [&](FleetAggregate& aggregate, size_t i) {
+        const Row& row = rows[i]; aggregate.Add(row.Features, row.Masks.Fail, row.Masks.Warn, row.Cpu.data(), row.Cpu.size(), row.Gpu.data(), row.Gpu.size());
+    };
+    FleetAggregate whole; for (size_t i = 0; i < rows.size(); ++i) Add(whole, i);
+    const std::string expected = SerializedAggregate(whole);
+
+    // --- Merge Order ---
+    unsigned long long state = t.Seed;
+    for (size_t partCount : { 1, 2, 3, 7, 16 }) {
+        std::vector<FleetAggregate> parts(partCount);
+        for (size_t i = 0; i < rows.size(); ++i) Add(parts[NextRandom(state) % partCount], i); // Names reach each part in a different order
+        std::vector<size_t> order(partCount); for (size_t i = 0; i < partCount; ++i) order[i] = i;
+        std::vector<std::string> orders;
+        FleetAggregate forward; for (size_t i : order) forward.Merge(parts[i]); orders.push_back(SerializedAggregate(forward));
+        FleetAggregate backward; for (size_t i = partCount; i-- > 0; ) backward.Merge(parts[i]); orders.push_back(SerializedAggregate(backward));
+        for (size_t i = partCount; i > 1; --i) std::swap(order[i - 1], order[NextRandom(state) % i]);
+        FleetAggregate shuffled; for (size_t i : order) shuffled.Merge(parts[i]); orders.push_back(SerializedAggregate(shuffled));
+        std::vector<FleetAggregate> level = parts; // Pairwise, as a tree
+        while (level.size() > 1) {
+            std::vector<FleetAggregate> next;
+            for (size_t i = 0; i < level.size(); i += 2) { next.push_back(level[i]); if (i + 1 < level.size()) next.back().Merge(level[i + 1]); }
+            level.swap(next);
+        }
+        orders.push_back(SerializedAggregate(level[0]));
+        size_t same = 0; for (const std::string& bytes : orders) same += (bytes == expected);
+        Expect(t, same == orders.size(), std::to_string(partCount) + " parts: " + std::to_string(same) + " of " + std::to_string(orders.size()) + " merge orders serialize to the single aggregate's bytes");
+    }
+
+    // --- Thread Count ---
+    const std::string inventory = TempPath("aggregate.csv"), verdicts = TempPath("aggregate-verdicts.csv");
+    if (Expect(t, WriteWholeFile(inventory, InventoryCsv(machines)), "write the inventory")) {
+        for (unsigned threads : { 1u, 2u, 3u, 8u }) {
+            BatchOptions options; options.InputPaths.push_back(inventory); options.OutputPath = verdicts; options.Threads = threads; options.ChunkSize = 37;
+            FleetAggregate aggregate; options.Aggregate = &aggregate; BatchStats stats; std::string error;
+            if (!Expect(t, RunBatch(options, &target, stats, error), "batch run: " + error)) continue;
+            Expect(t, SerializedAggregate(aggregate) == expected, std::to_string(threads) + " threads: the batch aggregate serializes to the single aggregate's bytes");
+        }
+    }
+    std::remove(inventory.c_str()); std::remove(verdicts.c_str());
+
+    // --- Round Trip and Rejection ---
+    FleetAggregate copy;
+    Expect(t, ReadsBack(expected, copy) && SerializedAggregate(copy) == expected, "the serialized aggregate reads back to the same bytes");
+    size_t truncations = 0;
+    for (size_t length = 0; length < expected.size(); ++length) { FleetAggregate cut; const char* p = expected.data(); if (cut.Deserialize(p, expected.data() + length)) ++truncations; }
+    Expect(t, truncations == 0, std::to_string(truncations) + " of " + std::to_string(expected.size()) + " truncations accepted");
+    FleetAggregate two; MachineFeatures features;
+    two.Add(features, 0, 0, "A", 1, "G", 1); two.Add(features, 0, 0, "B", 1, "G", 1);
+    const std::string twoBytes = SerializedAggregate(two);
+    std::string duplicate = twoBytes; const size_t b = duplicate.find("\x01" "B");
+    if (Expect(t, b != std::string::npos, "CPU name B in the encoding")) { duplicate[b + 1] = 'A'; Expect(t, !ReadsBack(duplicate, copy), "a CPU name listed twice is rejected"); }
+    std::string miscounted = twoBytes; miscounted[0] = 3; // Machines: 2 -> 3
+    Expect(t, ReadsBack(twoBytes, copy) && !ReadsBack(miscounted, copy), "a machine count that disagrees with the failure combinations is rejected");
+}
+
+// --- Sharded Batch Runs (shard.cpp) ---
+// Runs RunShardWorker for every shard k/N of a CSV and a JSON Lines export in this process and merges the partials with
+// MergeShardOutputs (RunShardedBatch's merge step, without starting processes). The merged verdicts, statistics and
+// aggregate must equal a single RunBatch, with MachineIds and without them (machines then go by line number, and some
+// rows have an empty id). A missing, cut short or corrupt partial must fail the merge rather than drop machines.
+static std::string WithoutMachineIds(const std::string& text, bool json) { // Drops the MachineId column / key from every line
+    std::istringstream lines(text); std::string line, out;
+    while (std::getline(lines, line)) {
+        if (json) { const size_t comma = line.find("\",\""); out += "{" + line.substr(comma + 2) + "\n"; }
+        else out += line.substr(line.find(',') + 1) + "\n";
+    }
+    return out;
+}
+
+static void TestShard(TestContext& t) {
+    std::vector<MachineRecord> machines; SyntheticFleet fleet(t.Seed); fleet.Generate(1500, machines);
+    for (size_t i = 0; i < machines.size(); i += 97) machines[i].MachineId.clear(); // Goes by line number even with the column
+    const std::vector<MachineRecord> csvMachines(machines.begin(), machines.begin() + 900), jsonMachines(machines.begin() + 900, machines.end());
+    const std::string csv = TempPath("shard.csv"), jsonl = TempPath("shard.jsonl"), single = TempPath("shard-single.csv"), merged = TempPath("shard-merged.csv");
+    const WindowsRequirements* target = &BUILTIN_TARGETS[TargetWin11].Requirements;
+    std::vector<std::string> prefixes;
+
+    auto Options = [&](const std::string& output, FleetAggregate* aggregate, FleetSketch* sketch) {
+        BatchOptions options; options.InputPaths = { csv, jsonl }; options.OutputPath = output; options.Threads = 2; options.ChunkSize = 64;
+        options.Aggregate = aggregate; options.Sketch = sketch; return options;
+    };
+    auto AggregateJson = [](const FleetAggregate& aggregate) { std::string out; FormatAggregateJson(aggregate, "Windows 11", 1 << 20, out); return out; };
+    // Every shard of N in this process, then the merge; false (with error) if a worker or the merge fails
+    auto Shards = [&](unsigned shards, BatchStats& stats, FleetAggregate& aggregate, FleetSketch& sketch, std::string& error) {
+        prefixes.clear();
+        for (unsigned k = 0; k < shards; ++k) {
+            prefixes.push_back(TempPath(("shard-part" + std::to_string(k)).c_str()));
+            FleetAggregate partAggregate; FleetSketch partSketch;
+            if (!RunShardWorker(Options("", &partAggregate, &partSketch), target, std::to_string(k) + "/" + std::to_string(shards), prefixes.back(), error)) return false;
+        }
+        stats = BatchStats(); aggregate = FleetAggregate(); sketch = FleetSketch();
+        return MergeShardOutputs(prefixes, Options(merged, &aggregate, &sketch), target, stats, error);
+    };
+    auto RemovePartials = [&] { for (const std::string& prefix : prefixes) { std::remove((prefix + ".verdicts").c_str()); std::remove((prefix + ".summary").c_str()); } };
+
+    for (int ids = 1; ids >= 0; --ids) {
+        const std::string kind = ids ? "with MachineIds" : "without MachineIds";
+        const std::string csvText = InventoryCsv(csvMachines), jsonText = InventoryJsonLines(jsonMachines);
+        WriteWholeFile(csv, ids ? csvText : WithoutMachineIds(csvText, false)); WriteWholeFile(jsonl, ids ? jsonText : WithoutMachineIds(jsonText, true));
+        BatchStats expected; FleetAggregate expectedAggregate; std::string error;
+        Expect(t, RunBatch(Options(single, &expectedAggregate, NULL), target, expected, error), kind + ": single-process batch: " + error);
+        const std::string expectedVerdicts = ReadWholeFile(single);
+        Expect(t, expected.Machines == machines.size() && expected.MalformedRows == 0, kind + ": " + std::to_string(expected.Machines) + " machines evaluated in one process");
+        for (unsigned shards : { 1u, 2u, 3u, 5u }) {
+            const std::string what = kind + ", " + std::to_string(shards) + " shards";
+            BatchStats stats; FleetAggregate aggregate; FleetSketch sketch; error.clear();
+            if (!Expect(t, Shards(shards, stats, aggregate, sketch, error), what + ": " + error)) { RemovePartials(); continue; }
+            Expect(t, ReadWholeFile(merged) == expectedVerdicts, what + ": merged verdicts equal the single-process run");
+            Expect(t, stats.Machines == expected.Machines && stats.Passed == expected.Passed && stats.Failed == expected.Failed && stats.WithWarnings == expected.WithWarnings,
+                   what + ": statistics (" + std::to_string(stats.Passed) + " passed, " + std::to_string(stats.Failed) + " failed)");
+            Expect(t, AggregateJson(aggregate) == AggregateJson(expectedAggregate), what + ": merged aggregate equals the single-process aggregate");
+            Expect(t, sketch.Machines() == expected.Machines && sketch.Verdicts(SketchFail) == expected.Failed, what + ": merged sketch counts every machine once");
+            RemovePartials();
+        }
+    }
+
+    // --- Partials that must fail the merge ---
+    BatchStats stats; FleetAggregate aggregate; FleetSketch sketch; std::string error;
+    Expect(t, Shards(3, stats, aggregate, sketch, error), "3 shards for the corruption cases: " + error);
+    auto Fails = [&](const std::string& what, const std::string& path, const std::string& content, const std::string& message) {
+        const std::string original = ReadWholeFile(path);
+        if (content.empty()) std::remove(path.c_str()); else WriteWholeFile(path, content);
+        BatchStats partial; FleetAggregate partialAggregate; FleetSketch partialSketch; std::string reason;
+        const bool merged = MergeShardOutputs(prefixes, Options(TempPath("shard-merged.csv"), &partialAggregate, &partialSketch), target, partial, reason);
+        Expect(t, !merged && reason.find(message) != std::string::npos, what + " fails the merge: " + (merged ? "merged" : reason));
+        WriteWholeFile(path, original);
+    };
+    const std::string summary = prefixes[1] + ".summary", verdicts = prefixes[1] + ".verdicts";
+    const std::string summaryText = ReadWholeFile(summary), verdictsText = ReadWholeFile(verdicts);
+    Fails("a missing summary", summary, "", "is missing");
+    Fails("a summary with a wrong magic", summary, "WRCSHARX" + summaryText.substr(8), "is corrupt");
+    std::string version = summaryText; version[8] = 2; Fails("a summary of version 2", summary, version, "unsupported version");
+    Fails("a summary cut short in its header", summary, summaryText.substr(0, 40), "is corrupt");
+    Fails("a summary cut short in its aggregate", summary, summaryText.substr(0, summaryText.size() / 3), "is corrupt");
+    Fails("a summary cut short in its sketch", summary, summaryText.substr(0, summaryText.size() - 1), "is corrupt");
+    Fails("a summary with a trailing byte", summary, summaryText + '\0', "is corrupt");
+    std::string aggregateBlob = summaryText; aggregateBlob[8 + 4 + 8 * 8 + 8 + 8] ^= 1; // Machine count of the aggregate; still a valid varint
+    Fails("a summary with a corrupt aggregate", summary, aggregateBlob, "is corrupt");
+    const std::string other = TempPath("shard-other"); FleetAggregate otherAggregate; FleetSketch otherSketch;
+    Expect(t, RunShardWorker(Options("", &otherAggregate, &otherSketch), target, "0/2", other, error), "shard 0/2 for a mismatched summary: " + error);
+    Fails("the summary of another shard count", summary, ReadWholeFile(other + ".summary"), "do not match");
+    for (const char* suffix : { ".verdicts", ".summary" }) std::remove((other + suffix).c_str());
+    Fails("missing verdicts", verdicts, "", "are missing");
+    Fails("verdicts cut short in a frame", verdicts, verdictsText.substr(0, verdictsText.size() - 5), "are cut short");
+    Fails("verdicts cut short in a frame header", verdicts, verdictsText.substr(0, 7), "are cut short");
+    Fails("verdicts out of order", verdicts, verdictsText + verdictsText, "out of order");
+    RemovePartials();
+    for (const std::string& path : { csv, jsonl, single, merged }) std::remove(path.c_str());
+}
+
+// --- Columnar Result Store (result_store.cpp) ---
+// Writes a store of synthetic machines (sorted by RAM, as a sorted export would be) plus random edge rows across many small
+// blocks and reads every column of every row back. Scan must visit exactly the rows a brute-force filter matches while
+// reading only the blocks whose statistics allow a match, and the statistics must be those of the rows. A file cut
+// short, a block index that overlaps or miscounts, and a damaged column must be rejected.
+static void TestResultStore(TestContext& t) {
+    struct Row { std::string Id, Cpu, Gpu; MachineFeatures Features; CheckMasks Masks; };
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    std::vector<MachineRecord> machines; SyntheticFleet fleet(t.Seed); fleet.Generate(1200, machines);
+    std::vector<Row> rows; unsigned long long state = t.Seed;
+    for (const MachineRecord& machine : machines) {
+        Row row; row.Id = WideToUtf8(machine.MachineId); row.Cpu = WideToUtf8(machine.Cpu.Name); row.Gpu = WideToUtf8(machine.Graphics.Name);
+        row.Features = ExtractFeatures(machine); rows.push_back(row);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.Features.RamBytes < b.Features.RamBytes; });
+    for (int i = 0; i < 100; ++i) { Row row; row.Id = i % 10 ? "EDGE-" + std::to_string(i) : std::string(); row.Cpu = "\xC3\xA9" "dge CPU"; row.Features = RandomFeatures(state); rows.push_back(row); }
+    for (Row& row : rows) row.Masks = EvaluateFeatures(win11, row.Features);
+
+    const std::string path = TempPath("results.wrcr"); const size_t blockRows = 64; std::string error;
+    ResultStoreWriter writer; bool written = writer.Open(path, win11, blockRows, error);
+    for (const Row& row : rows) written = written && writer.Add(row.Id, row.Features, row.Masks.Fail, row.Masks.Warn, row.Cpu, row.Gpu);
+    written = written && writer.Finish(error);
+    if (!Expect(t, written, "write result store: " + error)) return;
+
+    ResultStoreReader reader;
+    if (!Expect(t, reader.Open(path, error), "open result store: " + error)) return;
+    Expect(t, reader.Rows() == rows.size() && reader.BlockCount() == (rows.size() + blockRows - 1) / blockRows && reader.TargetName() == "Windows 11" && reader.Applicable() == ApplicableChecks(win11),
+           std::to_string(reader.Rows()) + " rows in " + std::to_string(reader.BlockCount()) + " blocks, target '" + reader.TargetName() + "'");
+
+    // --- Every column of every row, and each block's statistics ---
+    ResultBlock block; size_t differing = 0, statistics = 0, unreadable = 0;
+    for (size_t b = 0; b < reader.BlockCount(); ++b) {
+        if (!reader.ReadBlock(b, ResultColumnAll, block, error)) { ++unreadable; continue; }
+        const ResultBlockInfo& info = reader.Block(b);
+        ResultBlockInfo expected = {};
+        for (size_t i = 0; i < block.Rows; ++i) {
+            const Row& row = rows[block.FirstRow + i];
+            if (block.MachineIds[i] != row.Id || block.Checks.Fail[i] != row.Masks.Fail || block.Checks.Warn[i] != row.Masks.Warn || !SameFeatures(block.Features.Row(i), row.Features)
+                || reader.DictionaryString(block.CpuName[i]) != row.Cpu || reader.DictionaryString(block.GpuName[i]) != row.Gpu) {
+                if (++differing <= 3) Expect(t, false, "row " + std::to_string(block.FirstRow + i) + " ('" + row.Id + "') reads back differently");
+            }
+            expected.FailAny |= row.Masks.Fail; expected.WarnAny |= row.Masks.Warn; expected.Failed += row.Masks.Fail != 0;
+        }
+        FeatureColumns& f = block.Features;
+        auto Range = [&](int column, const auto& values) {
+            const auto bounds = std::minmax_element(values.begin(), values.end());
+            if (info.Min[column] != (ULONGLONG)*bounds.first || info.Max[column] != (ULONGLONG)*bounds.second) ++statistics;
+        };
+        Range(ResultCpuSpeedMHz, f.CpuSpeedMHz); Range(ResultCpuCores, f.CpuCores); Range(ResultCpuGenerationLevel, f.CpuGenerationLevel);
+        Range(ResultRamBytes, f.RamBytes); Range(ResultDiskFreeBytes, f.DiskFreeBytes); Range(ResultScreenWidth, f.ScreenWidth);
+        Range(ResultScreenHeight, f.ScreenHeight); Range(ResultDXLevel, f.DXLevel); Range(ResultWDDMLevel, f.WDDMLevel); Range(ResultTpmVersionMajor, f.TpmVersionMajor);
+        if (info.FailAny != expected.FailAny || info.WarnAny != expected.WarnAny || info.Failed != expected.Failed) ++statistics;
+    }
+    Expect(t, unreadable == 0, std::to_string(unreadable) + " blocks could not be read: " + error);
+    Expect(t, differing == 0, std::to_string(differing) + " of " + std::to_string(rows.size()) + " rows read back differently");
+    Expect(t, statistics == 0, std::to_string(statistics) + " block statistics differ from the block's rows");
+    ResultBlock partial;
+    Expect(t, reader.ReadBlock(3, ResultColumnMachineId, partial, error) && partial.MachineIds.size() == partial.Rows && partial.CpuName.empty()
+           && reader.ReadBlock(3, ResultColumnNames, partial, error) && reader.DictionaryString(partial.CpuName[0]) == rows[partial.FirstRow].Cpu,
+           "one column at a time from the same block: " + error);
+
+    // --- Scan against brute force ---
+    struct Query { const char* Name; unsigned short Failing; int Column; ULONGLONG Min, Max; };
+    const Query queries[] = {
+        { "everything", 0, -1, 0, ~0ULL }, { "failing TPM", 1u << CheckTpm, -1, 0, ~0ULL }, { "RAM up to 4 GB", 0, ResultRamBytes, 0, 4ULL << 30 },
+        { "failing RAM and Secure Boot, 2-8 GB", (unsigned short)((1u << CheckRam) | (1u << CheckSecureBoot)), ResultRamBytes, 2ULL << 30, 8ULL << 30 },
+        { "RAM over 1 TB", 0, ResultRamBytes, 1ULL << 40, ~0ULL }, { "top-bit disk", 0, ResultDiskFreeBytes, 0x8000000000000000ULL, ~0ULL },
+    };
+    for (const Query& query : queries) {
+        ResultFilter filter; filter.Failing = query.Failing; filter.Column = query.Column; filter.Min = query.Min; filter.Max = query.Max;
+        std::vector<size_t> expected, visited; size_t possible = 0, blocksRead = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& row = rows[i];
+            const ULONGLONG value = query.Column == ResultRamBytes ? row.Features.RamBytes : row.Features.DiskFreeBytes;
+            if ((row.Masks.Fail & query.Failing) == query.Failing && (query.Column < 0 || (value >= query.Min && value <= query.Max))) expected.push_back(i);
+        }
+        for (size_t b = 0; b < reader.BlockCount(); ++b) possible += filter.MayMatch(reader.Block(b));
+        const bool scanned = reader.Scan(filter, [&](const ResultBlock& found, size_t row) {
+            visited.push_back(found.FirstRow + row);
+            if (found.MachineIds[row] != rows[found.FirstRow + row].Id) visited.push_back((size_t)-1);
+        }, blocksRead, error);
+        Expect(t, scanned && visited == expected, std::string(query.Name) + ": scan visits " + std::to_string(visited.size()) + " rows, brute force matches " + std::to_string(expected.size()));
+        Expect(t, blocksRead == possible, std::string(query.Name) + ": " + std::to_string(blocksRead) + " blocks read, " + std::to_string(possible) + " may match");
+    }
+    ResultFilter lowRam; lowRam.Column = ResultRamBytes; lowRam.Max = 4ULL << 30; size_t blocksRead = 0;
+    reader.Scan(lowRam, [](const ResultBlock&, size_t) {}, blocksRead, error);
+    Expect(t, blocksRead * 2 < reader.BlockCount(), "RAM up to 4 GB over a RAM-sorted store reads " + std::to_string(blocksRead) + " of " + std::to_string(reader.BlockCount()) + " blocks");
+
+    // --- Damaged files ---
+    const std::string file = ReadWholeFile(path); ResultStoreHeader header; memcpy(&header, file.data(), sizeof(header));
+    auto Opens = [&](const std::string& bytes) { WriteWholeFile(path, bytes); ResultStoreReader damaged; std::string message; return damaged.Open(path, message); };
+    size_t accepted = 0;
+    for (size_t length = 0; length < file.size(); length += (length < 256 || length + 512 > file.size()) ? 1 : 97) accepted += Opens(file.substr(0, length));
+    Expect(t, accepted == 0, std::to_string(accepted) + " truncated copies of the store opened");
+    auto Rejected = [&](const std::string& what, const std::function<void(ResultStoreHeader&, std::vector<ResultBlockInfo>&)>& change) {
+        std::vector<ResultBlockInfo> index((size_t)header.BlockCount); memcpy(&index[0], file.data() + header.IndexOffset, index.size() * sizeof(ResultBlockInfo));
+        ResultStoreHeader damagedHeader = header; change(damagedHeader, index);
+        std::string bytes = file; memcpy(&bytes[0], &damagedHeader, sizeof(damagedHeader)); memcpy(&bytes[(size_t)header.IndexOffset], &index[0], index.size() * sizeof(ResultBlockInfo));
+        Expect(t, !Opens(bytes), "a store with " + what + " is rejected");
+    };
+    Rejected("a wrong magic", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { h.Magic[7] = 'X'; });
+    Rejected("version 2", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { h.Version = 2; });
+    Rejected("one block too many", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { ++h.BlockCount; });
+    Rejected("a block count near 2^64", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { h.BlockCount = ~0ULL / sizeof(ResultBlockInfo) + 2; });
+    Rejected("a dictionary past the end", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { h.DictionarySize = ~0ULL; });
+    Rejected("a row count off by one", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>&) { ++h.RowCount; });
+    Rejected("a block past the index", [](ResultStoreHeader&, std::vector<ResultBlockInfo>& index) { index[2].Size = ~0ULL - index[2].Offset + 1; });
+    Rejected("a block inside the previous one", [](ResultStoreHeader&, std::vector<ResultBlockInfo>& index) { index[2].Offset = index[1].Offset; });
+    Rejected("a block in the header", [](ResultStoreHeader&, std::vector<ResultBlockInfo>& index) { index[0].Offset = 8; });
+    Rejected("blocks out of row order", [](ResultStoreHeader&, std::vector<ResultBlockInfo>& index) { std::swap(index[1].FirstRow, index[2].FirstRow); });
+    Rejected("an empty block", [](ResultStoreHeader&, std::vector<ResultBlockInfo>& index) { index[1].Rows = 0; index[2].FirstRow = index[1].FirstRow; });
+    Rejected("a block of 2^32 - 1 rows", [](ResultStoreHeader& h, std::vector<ResultBlockInfo>& index) {
+        const UINT32 rows = 0xFFFFFFFFu; h.BlockRows = rows; h.RowCount += rows - index.back().Rows; index.back().Rows = rows;
+    });
+
+    auto ReadFails = [&](const std::string& what, size_t at, UINT32 value) { // Overwrites 4 bytes of block 1 and reads it
+        std::string bytes = file; memcpy(&bytes[(size_t)reader.Block(1).Offset + at], &value, sizeof(value)); WriteWholeFile(path, bytes);
+        ResultStoreReader damaged; ResultBlock read; std::string message;
+        Expect(t, damaged.Open(path, message) && !damaged.ReadBlock(1, ResultColumnAll, read, message) && message.find("corrupt") != std::string::npos, "a block with " + what + " fails to read: " + message);
+    };
+    UINT32 idLength = 0; memcpy(&idLength, file.data() + reader.Block(1).Offset, sizeof(idLength));
+    ReadFails("a MachineId column longer than the block", 0, 0x7FFFFFFF);
+    ReadFails("a MachineId column one byte short", 0, idLength - 1);
+    ReadFails("a Checks column of the wrong size", 4 + idLength, 7);
+    std::remove(path.c_str());
+}
+
+// --- Upgrade Planner (upgrade_plan.cpp) ---
+// PlanUpgrade's pruned search must find the same cheapest cost as trying every subset of every action on its own model of
+// what the actions do: every standard RAM total above the current one, freeing exactly the missing space (within the
+// cleanup limit) or any larger standard drive, enabling a TPM that is present, a TPM module, UEFI, Secure Boot, GPU, CPU
+// and display. Machines are random edge rows and synthetic fleet machines (with BIOS machines that need Secure Boot),
+// against the built-in targets and synthetic baselines, under the default and random costs. The plan's own steps must
+// remove every [FAIL] and add up to its cost.
+static void ApplyUpgradeModel(const UpgradeStep& step, ULONGLONG diskUsed, MachineFeatures& f) {
+    switch (step.Action) {
+        case UpgradeRam: f.RamBytes = step.Amount; f.Flags &= ~FeatureRamTimedOut; break;
+        case UpgradeDiskCleanup: f.DiskFreeBytes += step.Amount; f.Flags &= ~FeatureDiskTimedOut; break;
+        case UpgradeDiskReplace: f.DiskFreeBytes = step.Amount - diskUsed; f.Flags &= ~FeatureDiskTimedOut; break;
+        case UpgradeEnableTpm: f.Flags |= FeatureTpmReady; break;
+        case UpgradeTpmModule: f.TpmVersionMajor = std::max(f.TpmVersionMajor, 2u); f.Flags |= FeatureTpmReady; break;
+        case UpgradeUefi: f.Flags = (f.Flags | FeatureUefi) & ~FeatureFirmwareUncertain; break;
+        case UpgradeSecureBoot: f.Flags = (f.Flags | FeatureSecureBootEnabled) & ~FeatureSecureBootUncertain; break;
+        case UpgradeGpu: f.DXLevel = std::max(f.DXLevel, 12u); f.WDDMLevel = std::max(f.WDDMLevel, 3u); f.Flags |= FeatureDXKnown | FeatureWDDMKnown; break;
+        case UpgradeCpu: f.CpuSpeedMHz = std::max(f.CpuSpeedMHz, 3000u); f.CpuCores = std::max(f.CpuCores, 8u); f.CpuGenerationLevel = std::max(f.CpuGenerationLevel, (UINT)CpuListSupported);
+                         f.Flags = (f.Flags | FeatureIs64Bit) & ~FeatureCpuTimedOut; break;
+        case UpgradeDisplay: f.ScreenWidth = std::max(f.ScreenWidth, 1920u); f.ScreenHeight = std::max(f.ScreenHeight, 1080u); break;
+        default: break;
+    }
+}
+
+// Cheapest cost over every combination of at most one RAM step, at most one disk step and any subset of the other
+// actions; -1 if none removes every [FAIL]
+static double CheapestUpgradeByEnumeration(const WindowsRequirements& target, const MachineFeatures& machine, ULONGLONG diskTotal, const UpgradeCosts& c) {
+    const ULONGLONG GB = 1ULL << 30, used = diskTotal > machine.DiskFreeBytes ? diskTotal - machine.DiskFreeBytes : 0;
+    std::vector<UpgradeStep> ram(1, UpgradeStep{ UpgradeActionCount, 0, 0 }), disk(1, UpgradeStep{ UpgradeActionCount, 0, 0 }), others;
+    for (unsigned size : { 2u, 4u, 8u, 16u, 32u, 64u, 128u }) { if (size * GB > machine.RamBytes) ram.push_back(UpgradeStep{ UpgradeRam, size * GB, c.RamFixed + c.RamPerGB * (double)(size * GB - machine.RamBytes) / GB }); }
+    if (target.MinDiskFreeBytes > machine.DiskFreeBytes && (double)(target.MinDiskFreeBytes - machine.DiskFreeBytes) / GB <= c.DiskCleanupMaxGB) {
+        const ULONGLONG needed = target.MinDiskFreeBytes - machine.DiskFreeBytes; disk.push_back(UpgradeStep{ UpgradeDiskCleanup, needed, c.DiskCleanupPerGB * (double)needed / GB });
+    }
+    for (unsigned size : { 128u, 256u, 512u, 1024u, 2048u, 4096u }) { if (size * GB > used) disk.push_back(UpgradeStep{ UpgradeDiskReplace, size * GB, c.DiskReplaceFixed + c.DiskPerGB * size }); }
+    if (machine.TpmVersionMajor > 0) others.push_back(UpgradeStep{ UpgradeEnableTpm, 0, c.EnableTpm }); // Only a TPM that is there can be switched on
+    others.push_back(UpgradeStep{ UpgradeTpmModule, 0, c.TpmModule }); others.push_back(UpgradeStep{ UpgradeUefi, 0, c.SwitchToUefi });
+    others.push_back(UpgradeStep{ UpgradeSecureBoot, 0, c.EnableSecureBoot }); others.push_back(UpgradeStep{ UpgradeGpu, 0, c.ReplaceGpu });
+    others.push_back(UpgradeStep{ UpgradeCpu, 0, c.ReplaceCpu }); others.push_back(UpgradeStep{ UpgradeDisplay, 0, c.ReplaceDisplay });
+    double best = -1;
+    for (const UpgradeStep& r : ram) for (const UpgradeStep& d : disk) for (unsigned subset = 0; subset < (1u << others.size()); ++subset) {
+        MachineFeatures f = machine; double cost = r.Cost + d.Cost;
+        ApplyUpgradeModel(r, used, f); ApplyUpgradeModel(d, used, f);
+        for (size_t i = 0; i < others.size(); ++i) { if (subset & (1u << i)) { ApplyUpgradeModel(others[i], used, f); cost += others[i].Cost; } }
+        if ((best < 0 || cost < best) && !EvaluateFeatures(target, f).Fail) best = cost;
+    }
+    return best;
+}
+
+static void TestUpgradePlan(TestContext& t) {
+    unsigned long long state = t.Seed; const ULONGLONG GB = 1ULL << 30;
+    std::vector<WindowsRequirements> targets = { BUILTIN_TARGETS[TargetWin11].Requirements, BUILTIN_TARGETS[TargetWin10].Requirements };
+    SyntheticFleet fleet(t.Seed);
+    for (int i = 0; i < 3; ++i) { WindowsRequirements custom; fleet.NextProfile(custom); targets.push_back(custom); }
+    std::vector<MachineRecord> records; fleet.Generate(150, records);
+    std::vector<std::pair<MachineFeatures, ULONGLONG>> machines; // Features, drive size (0: unknown)
+    for (const MachineRecord& record : records) {
+        MachineFeatures f = ExtractFeatures(record);
+        if (machines.size() % 5 == 0) f.Flags &= ~(FeatureUefi | FeatureSecureBootEnabled); // BIOS: Secure Boot needs UEFI first
+        machines.push_back(std::make_pair(f, f.DiskFreeBytes + (NextRandom(state) % 600) * GB));
+    }
+    for (int i = 0; i < 150; ++i) { const MachineFeatures f = RandomFeatures(state); machines.push_back(std::make_pair(f, NextRandom(state) % 3 ? f.DiskFreeBytes + (NextRandom(state) % 3000) * GB : 0)); }
+
+    std::vector<UpgradeCosts> costSets(1);
+    for (int i = 0; i < 3; ++i) { // Random weights, one of them with free actions (ties)
+        UpgradeCosts c; double* const fields[] = { &c.RamFixed, &c.RamPerGB, &c.DiskCleanupPerGB, &c.DiskCleanupMaxGB, &c.DiskReplaceFixed, &c.DiskPerGB,
+                                                    &c.EnableTpm, &c.TpmModule, &c.SwitchToUefi, &c.EnableSecureBoot, &c.ReplaceGpu, &c.ReplaceCpu, &c.ReplaceDisplay };
+        for (double* field : fields) *field = (i == 2 && NextRandom(state) % 3 == 0) ? 0 : (double)(NextRandom(state) % 400) / 4;
+        costSets.push_back(c);
+    }
+    size_t compared = 0, costDiffers = 0, badSteps = 0, feasible = 0;
+    for (const WindowsRequirements& target : targets) for (const UpgradeCosts& costs : costSets) for (const std::pair<MachineFeatures, ULONGLONG>& machine : machines) {
+        UpgradePlan plan; const bool planned = PlanUpgrade(target, machine.first, machine.second, costs, plan);
+        const double expected = CheapestUpgradeByEnumeration(target, machine.first, machine.second, costs);
+        ++compared; feasible += planned;
+        if (planned != (expected >= 0) || (planned && std::fabs(plan.Cost - expected) > 1e-9 * std::max(1.0, expected))) {
+            if (++costDiffers <= 3) Expect(t, false, "'" + WideToUtf8(target.Name) + "', machine " + std::to_string(&machine - &machines[0]) + ": plan cost " + (planned ? std::to_string(plan.Cost) : "infeasible")
+                                            + ", enumeration " + (expected >= 0 ? std::to_string(expected) : "infeasible"));
+        }
+        if (!planned) { if (!plan.Fail) ++badSteps; continue; } // An infeasible plan names the checks no action fixes
+        MachineFeatures f = machine.first; double sum = 0; const ULONGLONG used = machine.second > f.DiskFreeBytes ? machine.second - f.DiskFreeBytes : 0;
+        for (int i = 0; i < plan.StepCount; ++i) { ApplyUpgradeModel(plan.Steps[i], used, f); sum += plan.Steps[i].Cost; }
+        if (EvaluateFeatures(target, f).Fail || std::fabs(sum - plan.Cost) > 1e-9 * std::max(1.0, sum)) ++badSteps;
+    }
+    Expect(t, costDiffers == 0, std::to_string(costDiffers) + " of " + std::to_string(compared) + " plans differ from the cheapest enumerated subset (" + std::to_string(feasible) + " feasible)");
+    Expect(t, badSteps == 0, std::to_string(badSteps) + " plans whose steps leave a [FAIL], do not add up to the plan cost, or are infeasible without naming a check");
+
+    // --- Cases the search has to get right on purpose ---
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements; const UpgradeCosts costs;
+    MachineFeatures bios = ExtractFeatures(ReportMachine()); bios.Flags &= ~(FeatureUefi | FeatureSecureBootEnabled); bios.CpuGenerationLevel = CpuListSupported; bios.DiskFreeBytes = 100 * GB;
+    UpgradePlan plan; std::string cell;
+    Expect(t, PlanUpgrade(win11, bios, 0, costs, plan) && (AppendUpgradePlanCell(cell, plan), cell == "Uefi;SecureBoot") && plan.Cost == costs.SwitchToUefi + costs.EnableSecureBoot,
+           "Secure Boot on BIOS switches to UEFI first: '" + cell + "'");
+    MachineFeatures disk = ExtractFeatures(ReportMachine()); disk.CpuGenerationLevel = CpuListSupported; disk.Flags |= FeatureSecureBootEnabled;
+    disk.DiskFreeBytes = win11.MinDiskFreeBytes - 10 * GB; cell.clear();
+    Expect(t, PlanUpgrade(win11, disk, 256 * GB, costs, plan) && (AppendUpgradePlanCell(cell, plan), cell == "DiskCleanup:10GB"), "10 GB short: cleanup beats a new drive: '" + cell + "'");
+    UpgradeCosts dearCleanup; dearCleanup.DiskCleanupPerGB = 10; cell.clear();
+    Expect(t, PlanUpgrade(win11, disk, 256 * GB, dearCleanup, plan) && (AppendUpgradePlanCell(cell, plan), cell == "DiskReplace:512GB"), "10 GB short at 10 per GB: a new drive is cheaper: '" + cell + "'");
+    disk.DiskFreeBytes = win11.MinDiskFreeBytes - 30 * GB; cell.clear();
+    Expect(t, PlanUpgrade(win11, disk, 256 * GB, costs, plan) && (AppendUpgradePlanCell(cell, plan), cell == "DiskReplace:512GB"), "30 GB short, over the cleanup limit: a new drive: '" + cell + "'");
+}
+
+// --- Steady-state Allocations (evaluate.cpp, columnar.cpp, profile_index.cpp, report.cpp, mapped_inventory.cpp) ---
+// Counts heap allocations with the replaced operator new at the top of this file. After one warm-up pass over a synthetic working
+// set, evaluation, the columnar kernel, profile matching, batch mode's compact parse of CSV and JSON Lines rows, and
+// building and rendering a report in each format must not
+// allocate at all over further passes: their buffers are reused from machine to machine (the bench only reports the
+// per-machine count; this is where a new per-machine allocation fails).
+static volatile unsigned long long allocationSink; // Keeps the measured results alive
+
+static void TestAllocations(TestContext& t) {
+    std::vector<MachineRecord> machines; SyntheticFleet fleet(t.Seed); fleet.Generate(500, machines);
+    machines.push_back(ReportMachine()); machines.push_back(MachineRecord()); // Plus the report machine and one with every field at its default
+    FeatureColumns columns; for (const MachineRecord& machine : machines) columns.Append(ExtractFeatures(machine));
+    ProfileSet profiles; WindowsRequirements profile;
+    for (int i = 0; i < 300; ++i) { fleet.NextProfile(profile); profiles.Add(profile, L"Baseline " + std::to_wstring(i + 1)); }
+    profiles.BuildIndex();
+    const WindowsRequirements& win11 = BUILTIN_TARGETS[TargetWin11].Requirements;
+    const size_t passes = 3;
+    auto Steady = [&](const std::string& what, const std::function<void(size_t)>& machine) {
+        for (size_t r = 0; r < machines.size(); ++r) machine(r); // Warm-up: buffers grow to the largest machine
+        const unsigned long long before = allocationCount;
+        for (size_t pass = 0; pass < passes; ++pass) { for (size_t r = machines.size(); r-- > 0; ) machine(r); } // Reverse order: not just a replay
+        const unsigned long long made = allocationCount - before;
+        Expect(t, made == 0, what + " made " + std::to_string(made) + " heap allocations over " + std::to_string(passes * machines.size()) + " machines after warm-up");
+    };
+
+    Steady("EvaluateRequirements", [&](size_t r) { allocationSink = allocationSink + EvaluateRequirements(win11, machines[r]).OverallPass; });
+    Steady("EvaluateAllBuiltinTargets", [&](size_t r) { allocationSink = allocationSink + (unsigned)EvaluateAllBuiltinTargets(ExtractFeatures(machines[r])).Satisfied; });
+    CheckMaskColumns masks;
+    Steady("EvaluateColumns", [&](size_t r) { if (r == 0) { EvaluateColumns(win11, columns, masks); allocationSink = allocationSink + masks.Fail[0]; } });
+    ProfileMatch match; const ProfileIndex& index = profiles.Index();
+    Steady("ProfileIndex::Match", [&](size_t r) { index.Match(columns.Row(r), match); allocationSink = allocationSink + index.SatisfiedCount(match); });
+    const std::string texts[] = { InventoryCsv(machines), InventoryJsonLines(machines) };
+    for (const std::string& text : texts) { // One line per machine, parsed the way batch mode does without full reports
+        MappedInventory inventory; std::string error; std::vector<size_t> starts; MappedInventory::ParsedRows rows; std::vector<std::string> errors;
+        if (!Expect(t, inventory.OpenMemory(text.data(), text.size(), error), "open: " + error)) continue;
+        for (size_t at = inventory.DataBegin(), lines = 0; at < inventory.Size(); at = inventory.NextRange(at, 1, lines)) starts.push_back(at);
+        starts.push_back(inventory.Size());
+        if (!Expect(t, starts.size() == machines.size() + 1, std::to_string(starts.size() - 1) + " inventory lines")) continue;
+        Steady(std::string("parsing ") + (text[0] == '{' ? "JSON Lines" : "CSV") + " rows into compact rows", [&](size_t r) {
+            rows.Clear(); inventory.ParseRange(starts[r], starts[r + 1], inventory.DataLine() + r, rows, errors); allocationSink = allocationSink + rows.Size();
+        });
+        Expect(t, errors.empty(), std::to_string(errors.size()) + " malformed rows");
+    }
+    static const ReportFormat formats[] = { ReportAnsi, ReportPlain, ReportJson, ReportHtml };
+    static const char* const formatNames[] = { "ANSI", "plain", "JSON", "HTML" };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+        std::unique_ptr<ReportRenderer> renderer = CreateReportRenderer(formats[f]);
+        RequirementsReport report; TargetSummaryReport summary; std::string text;
+        Steady(std::string("building and rendering ") + formatNames[f] + " reports", [&](size_t r) {
+            const MachineFeatures features = ExtractFeatures(machines[r]);
+            BuildRequirementsReport(win11, machines[r], MakeEvaluationResult(EvaluateFeatures(win11, features), features), report);
+            summary.MachineId = report.MachineId; summary.Targets = EvaluateAllBuiltinTargets(features);
+            text.clear(); renderer->Render(report, text); renderer->Render(summary, text);
+            allocationSink = allocationSink + text.size();
+        });
+    }
+}
+
+// --- Linux Probes (linux_probe.cpp) ---
+// Runs ProbeLinuxMachine with --root on each tree under linux/ (copied /proc, /sys and /etc files of one machine) and
+// compares the record with the tree's expected.csv: "Field,Value" lines in the inventory field names, plus "Sections"
+// (the probes that must succeed) and "SecureBootUncertain" (the evaluation flag). Disk is statvfs() of the tree itself,
+// so only its drive letter is compared.
+#ifndef _WIN32
+static void TestLinuxProbe(TestContext& t) {
+    static const char* const MACHINES[] = { "laptop-uefi", "desktop-amd-bios", "vm-short-secureboot", "arm64" };
+    for (const char* machine : MACHINES) {
+        const std::string root = t.Fixtures + "/linux/" + machine, path = root + "/expected.csv";
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!Expect(t, (bool)file, "cannot open " + path)) continue;
+        MachineRecord record; const unsigned probed = ProbeLinuxMachine(root, SectionAll, record);
+        std::string line, sections, actual; std::vector<std::string> cells; size_t lineNumber = 0;
+        for (int i = 0; i < RecordSectionCount; ++i) { if (probed & (1u << i)) { sections += sections.empty() ? "" : " "; sections += RecordSectionName(i); } }
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#' || line == "Field,Value") continue;
+            const std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+            if (!Expect(t, SplitCsvLine(line, cells) && cells.size() == 2, where + "expected Field,Value")) continue;
+            actual.clear();
+            if (cells[0] == "Sections") actual = sections;
+            else if (cells[0] == "SecureBootUncertain") actual = (ExtractFeatures(record).Flags & FeatureSecureBootUncertain) ? "1" : "0";
+            else if (const RecordField* field = FindRecordField(cells[0])) field->Format(record, actual);
+            else { Expect(t, false, where + "unknown field " + cells[0]); continue; }
+            Expect(t, actual == cells[1], where + cells[0] + " is '" + actual + "', expected '" + cells[1] + "'");
+        }
+    }
+}
+#endif
+
+// --- Readiness Agent (agent.cpp) ---
+// Starts the agent on mock probes (Graphics always fails, the TPM is only enabled from its second, slower probe on) behind
+// a Unix socket in the temp directory and speaks the line protocol to it: status, check, several requests in one write
+// answered in order, malformed requests (an {"error":...} line each, the connection stays open), "refresh Security" and
+// the state it publishes, and a line over 4096 bytes without a newline, which must drop that connection only. A second
+// client polls status during the refresh: every answer must parse and the generation must never go back.
+#if defined(__unix__) || defined(__APPLE__)
+static int AgentConnect(const std::string& path) { // Retries while the server thread is still binding
+    sockaddr_un address = {}; address.sun_family = AF_UNIX; path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) == 0) return fd;
+        if (fd >= 0) close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+static bool AgentSend(int fd, const std::string& text) {
+    for (size_t sent = 0; sent < text.size(); ) {
+        const ssize_t count = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+        sent += (size_t)count;
+    }
+    return true;
+}
+
+// Reads until count lines have arrived (1), the server closed the connection (0) or two seconds passed (-1)
+static int AgentReadLines(int fd, size_t count, std::vector<std::string>& lines) {
+    lines.clear(); std::string pending; char buffer[4096];
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (lines.size() < count) {
+        const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        pollfd p = { fd, POLLIN, 0 };
+        if (left <= 0 || poll(&p, 1, (int)left) <= 0) return -1;
+        const ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) return 0;
+        pending.append(buffer, (size_t)n);
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) { lines.push_back(pending.substr(0, newline)); pending.erase(0, newline + 1); }
+    }
+    return 1;
+}
+
+static void TestAgent(TestContext& t) {
+    std::atomic<unsigned> cpuRuns{0}, securityRuns{0};
+    AgentProbeSource probes = [&cpuRuns, &securityRuns](ProbeScheduler& scheduler, unsigned sections) {
+        auto Add = [&](const char* name, unsigned section, std::function<bool(MachineRecord&)> run) { if (sections & section) scheduler.AddProbe(std::make_shared<FunctionProbe>(name, section, 0, run)); };
+        Add("CPU", SectionCpu, [&cpuRuns](MachineRecord& r) {
+            ++cpuRuns; r.Cpu.Name = L"Intel(R) Core(TM) i5-8250U CPU @ 1.60GHz"; r.Cpu.MaxClockSpeed = 1600; r.Cpu.NumberOfCores = 4;
+            r.Cpu.NumberOfLogicalProcessors = 8; r.Cpu.Is64BitCapable = true; r.Cpu.MinCpuGenerationLevel = CpuListSupported; return true;
+        });
+        Add("RAM", SectionRam, [](MachineRecord& r) { r.Ram.TotalPhysicalBytes = 16ULL << 30; return true; });
+        Add("Disk", SectionDisk, [](MachineRecord& r) { r.Disk.FreeBytesAvailableToUser = 200ULL << 30; r.Disk.TotalBytes = 500ULL << 30; return true; });
+        Add("OS", SectionOs, [](MachineRecord& r) { r.Os.Caption = L"Test OS"; return true; });
+        Add("Firmware", SectionFirmware, [](MachineRecord& r) { r.Firmware.FirmwareType = FirmwareUefi; r.Firmware.Source = SourceApi; return true; });
+        Add("Screen", SectionScreen, [](MachineRecord& r) { r.Screen.Width = 1920; r.Screen.Height = 1080; return true; });
+        Add("DirectX", SectionDirectX, [](MachineRecord& r) { r.DirectX.InstalledVersion = L"12"; return true; });
+        Add("Security", SectionSecurity, [&securityRuns](MachineRecord& r) {
+            if (++securityRuns >= 2) std::this_thread::sleep_for(std::chrono::milliseconds(100)); // The refresh: long enough for the poller below
+            r.Security.TpmFound = true; r.Security.TpmEnabled = securityRuns >= 2; r.Security.TpmSpecVersionMajor = 2;
+            r.Security.SecureBootCapable = r.Security.SecureBootEnabled = true; r.Security.SecureBoot = SecureBootOn; r.Security.SecureBootSource = SourceApi; return true;
+        });
+        Add("Graphics", SectionGraphics, [](MachineRecord&) { return false; });
+    };
+    AgentOptions options = DefaultAgentOptions(); options.MachineId = L"test-host"; options.ProbeDeadlineMs = 2000;
+    for (unsigned& seconds : options.RefreshSeconds) seconds = 0; // Probe at startup and on "refresh" only
+    ReadinessAgent agent(options, probes);
+    agent.Start();
+    Expect(t, agent.Generation() == 1, "generation " + std::to_string(agent.Generation()) + " after Start, expected 1");
+
+    const std::string path = TempPath("agent.sock"); std::atomic<bool> stop(false); std::string serverError; bool served = false;
+    std::thread server([&]() { served = RunAgentSocketServer(agent, path, stop, serverError); });
+    const int client = AgentConnect(path);
+    std::vector<std::string> lines; std::vector<JsonValue> replies;
+    auto Ask = [&](int fd, const std::string& requests, size_t count) { // Parses the reply lines into replies
+        replies.assign(count, JsonValue());
+        if (!Expect(t, AgentSend(fd, requests) && AgentReadLines(fd, count, lines) == 1, "no reply to " + requests)) return false;
+        for (size_t i = 0; i < count; ++i) { if (!Expect(t, JsonReader(lines[i]).Read(replies[i]) && replies[i].Type == JsonValue::Object, "reply is not a JSON object: " + lines[i])) return false; }
+        return true;
+    };
+    auto ListHas = [](const JsonValue* list, const char* name) { if (list) { for (const JsonValue& item : list->Items) { if (item.Text == name) return true; } } return false; };
+    auto SectionStatus = [](const JsonValue& status, const char* name) -> const JsonValue* {
+        if (const JsonValue* sections = status.Get("sections")) { for (const JsonValue& s : sections->Items) { if (s.TextOr("section", "") == name) return &s; } }
+        return NULL;
+    };
+
+    if (Expect(t, client >= 0, "cannot connect to " + path) && Ask(client, "status\ncheck 11\nsummary\nbogus\ncheck 99\nrefresh Nope\nstatus now\n\n", 8)) {
+        const JsonValue& status = replies[0];
+        Expect(t, status.TextOr("machineId", "") == "test-host" && status.NumberOr("generation", 0) == 1, "status: " + lines[0]);
+        const JsonValue* sections = status.Get("sections");
+        Expect(t, sections && sections->Items.size() == (size_t)RecordSectionCount, "status lists every section");
+        const JsonValue* cpu = SectionStatus(status, "Cpu"); const JsonValue* graphics = SectionStatus(status, "Graphics");
+        Expect(t, cpu && cpu->TextOr("lastProbe", "") == "ok" && cpu->NumberOr("ageSeconds", -1) >= 0 && cpu->NumberOr("refreshSeconds", -1) == 0, "Cpu status");
+        Expect(t, graphics && graphics->TextOr("lastProbe", "") == "failed" && graphics->Get("ageSeconds") && graphics->Get("ageSeconds")->Type == JsonValue::Null, "Graphics status (never probed successfully)");
+        Expect(t, replies[1].TextOr("target", "") == "11" && replies[1].TextOr("result", "") == "WARN" && ListHas(replies[1].Get("warned"), "Tpm"), "check 11 before the refresh: " + lines[1]);
+        Expect(t, ListHas(replies[1].Get("warned"), "DirectX") && replies[1].NumberOr("ageSeconds", -1) >= 0, "check 11 warns about the unknown DirectX level");
+        Expect(t, replies[2].TextOr("machineId", "") == "test-host" && replies[2].Get("targets"), "summary: " + lines[2].substr(0, 80));
+        static const char* const errors[] = { "Unknown request: bogus", "Unknown target: 99", "Unknown section: Nope", "Unknown request: status now", "Unknown request: " };
+        for (size_t i = 0; i < 5; ++i) Expect(t, replies[3 + i].TextOr("error", "") == errors[i], "malformed request " + std::to_string(i) + " -> " + lines[3 + i]);
+    }
+
+    // --- refresh: answered at once with the current generation; the new state shows up in status and check ---
+    std::atomic<bool> polling(true); bool pollOk = true; double lastGeneration = 0; unsigned polls = 0;
+    std::thread poller([&]() {
+        const int fd = AgentConnect(path); std::vector<std::string> got; JsonValue value;
+        pollOk = fd >= 0;
+        while (pollOk && polling.load()) {
+            value = JsonValue();
+            pollOk = AgentSend(fd, "status\n") && AgentReadLines(fd, 1, got) == 1 && JsonReader(got[0]).Read(value) && value.NumberOr("generation", 0) >= lastGeneration;
+            lastGeneration = value.NumberOr("generation", 0); polls += pollOk;
+        }
+        if (fd >= 0) close(fd);
+    });
+    if (client >= 0 && Ask(client, "refresh Security\n", 1)) {
+        Expect(t, replies[0].Get("refreshQueued") && replies[0].NumberOr("generation", 0) == 1, "refresh: " + lines[0]);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+        while (agent.Generation() < 2 && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (Ask(client, "status\ncheck 11\n", 2)) {
+            Expect(t, replies[0].NumberOr("generation", 0) == 2, "generation after the refresh: " + lines[0]);
+            const JsonValue* cpu = SectionStatus(replies[0], "Cpu"); const JsonValue* security = SectionStatus(replies[0], "Security");
+            Expect(t, security && security->TextOr("lastProbe", "") == "ok" && cpu && cpu->TextOr("lastProbe", "") == "ok", "Security re-probed, Cpu kept");
+            Expect(t, !ListHas(replies[1].Get("warned"), "Tpm") && ListHas(replies[1].Get("warned"), "DirectX"), "check 11 after the refresh still warns about the TPM: " + lines[1]);
+        }
+        Expect(t, cpuRuns.load() == 1 && securityRuns.load() == 2, "refresh Security ran only the Security probe (CPU " + std::to_string(cpuRuns.load()) + ", Security " + std::to_string(securityRuns.load()) + ")");
+    }
+    polling = false; poller.join();
+    Expect(t, pollOk && lastGeneration == 2 && polls > 1, "status polled during the refresh went back or did not parse (last generation " + std::to_string(lastGeneration) + ", " + std::to_string(polls) + " polls)");
+
+    // --- An over-long line without a newline drops that connection; the others keep working ---
+    const int flooder = AgentConnect(path);
+    if (Expect(t, flooder >= 0, "second connection")) {
+        AgentSend(flooder, std::string(5000, 'x'));
+        Expect(t, AgentReadLines(flooder, 1, lines) == 0, "a 5000-byte line without a newline must close the connection without a reply");
+        close(flooder);
+    }
+    if (client >= 0) { Ask(client, "status\n", 1); close(client); }
+
+    stop = true; server.join(); agent.Stop();
+    Expect(t, served, "server: " + serverError);
+    struct stat leftover; Expect(t, lstat(path.c_str(), &leftover) != 0, "the socket file is removed on exit");
+}
+#endif
+
+// --- Suites ---
+struct TestSuite { const char* Name; void (*Run)(TestContext&); };
+static const TestSuite SUITES[] = {
+    { "columnar", &TestColumnar },
+    { "profile_index", &TestProfileIndex },
+    { "probes", &TestProbeScheduler },
+    { "snapshot", &TestSnapshot },
+    { "cpu_list", &TestCpuList },
+    { "trace", &TestTrace },
+    { "inventory", &TestInventoryFields },
+    { "fleet_file", &TestFleetFile },
+    { "report", &TestReport },
+    { "batch_cache", &TestBatchCache },
+    { "sketch", &TestSketch },
+    { "aggregate", &TestAggregate },
+    { "shard", &TestShard },
+    { "result_store", &TestResultStore },
+    { "upgrade_plan", &TestUpgradePlan },
+    { "allocations", &TestAllocations },
+#ifndef _WIN32
+    { "linux_probe", &TestLinuxProbe },
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    { "agent", &TestAgent },
+#endif
+};
+
+int main(int argc, char* argv[]) {
+    TestContext context; context.Fixtures = "tests/fixtures";
+    std::string only;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i]; bool hasValue = (i + 1 < argc);
+        if (arg == "--only" && hasValue) { only = "," + std::string(argv[++i]) + ","; }
+        else if (arg == "--fixtures" && hasValue) { context.Fixtures = argv[++i]; }
+        else if (arg == "--seed" && hasValue) { context.Seed = strtoull(argv[++i], NULL, 10); }
+        else {
+            fprintf(stderr, "Usage: WinReadyCheckTest [--only suite,...] [--fixtures <dir>] [--seed N]\nSuites:");
+            for (const TestSuite& suite : SUITES) fprintf(stderr, " %s", suite.Name);
+            fprintf(stderr, "\n"); return 1;
+        }
+    }
+    unsigned failedSuites = 0, ran = 0;
+    for (const TestSuite& suite : SUITES) {
+        if (!only.empty() && only.find("," + std::string(suite.Name) + ",") == std::string::npos) continue;
+        TestContext t = context; ++ran;
+        printf("%s\n", suite.Name); fflush(stdout);
+        suite.Run(t);
+        printf("  %s: %u checks, %u failed\n", t.Failures ? "FAIL" : "ok", t.Checks, t.Failures); fflush(stdout);
+        if (t.Failures) ++failedSuites;
+    }
+    if (ran == 0) { fprintf(stderr, "Error: no suite matches --only\n"); return 1; }
+    printf("%u of %u suites passed\n", ran - failedSuites, ran);
+    return failedSuites ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+#include "shard.h"
+
+#include <chrono>
+#include <cstdio>         // For remove
+#include <cstdlib>        // For strtoul
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "aggregate.h"
+#include "sketch.h"       // SketchHash, FleetSketch
+#include "trace.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <spawn.h>        // posix_spawn
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // getpid, readlink
+extern char** environ;
+#endif
+
+unsigned ShardOf(const char* machineId, size_t length, unsigned long long row, unsigned shards) {
+    if (shards <= 1) return 0;
+    return (unsigned)((length ? SketchHash(machineId, length) : row) % shards); // Rows round-robin: every worker reads the same lines
+}
+
+// --- Shard Summary File ---
+static const char SHARD_MAGIC[8] = { 'W', 'R', 'C', 'S', 'H', 'A', 'R', 'D' };
+static const UINT32 SHARD_VERSION = 1;
+
+static void PutBlob(std::string& out, const std::string& blob) { const ULONGLONG size = blob.size(); out.append((const char*)&size, sizeof(size)); out += blob; }
+
+bool SaveShardSummary(const std::string& path, const BatchStats& stats, const FleetAggregate* aggregate, const FleetSketch* sketch, std::string& error) {
+    std::string data(SHARD_MAGIC, sizeof(SHARD_MAGIC)), blob;
+    data.append((const char*)&SHARD_VERSION, sizeof(SHARD_VERSION));
+    const ULONGLONG counts[8] = { stats.Machines, stats.Passed, stats.Failed, stats.WithWarnings, stats.MalformedRows, stats.Unfixable, stats.Steals, 0 };
+    data.append((const char*)counts, sizeof(counts)); data.append((const char*)&stats.PlanCost, sizeof(stats.PlanCost));
+    if (aggregate) aggregate->Serialize(blob);
+    PutBlob(data, blob); blob.clear();
+    if (sketch) sketch->Serialize(blob);
+    PutBlob(data, blob);
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(data.data(), (std::streamsize)data.size())) { error = "Could not write shard summary '" + path + "'"; return false; }
+    return true;
+}
+
+// Adds a worker's summary to the totals; aggregate/sketch (may be NULL) receive its partials
+static bool MergeShardSummary(const std::string& path, BatchStats& stats, FleetAggregate* aggregate, FleetSketch* sketch, std::string& error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) { error = "Shard summary '" + path + "' is missing"; return false; }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ULONGLONG counts[8] = {}; double planCost = 0; UINT32 version = 0;
+    const char* p = data.data() + sizeof(SHARD_MAGIC) + sizeof(version) + sizeof(counts) + sizeof(planCost); const char* end = data.data() + data.size();
+    if (data.size() < (size_t)(p - data.data()) || memcmp(data.data(), SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0) { error = "Shard summary '" + path + "' is corrupt"; return false; }
+    memcpy(&version, data.data() + sizeof(SHARD_MAGIC), sizeof(version));
+    memcpy(counts, data.data() + sizeof(SHARD_MAGIC) + sizeof(version), sizeof(counts)); memcpy(&planCost, p - sizeof(planCost), sizeof(planCost));
+    if (version != SHARD_VERSION) { error = "Shard summary '" + path + "' has unsupported version " + std::to_string(version); return false; }
+    auto Blob = [&](const char*& begin, const char*& finish) {
+        ULONGLONG size = 0;
+        if ((size_t)(end - p) < sizeof(size)) return false;
+        memcpy(&size, p, sizeof(size)); p += sizeof(size);
+        if (size > (ULONGLONG)(end - p)) return false;
+        begin = p; finish = p + size; p = finish;
+        return true;
+    };
+    const char *aggregateBegin, *aggregateEnd, *sketchBegin, *sketchEnd;
+    bool ok = Blob(aggregateBegin, aggregateEnd) && Blob(sketchBegin, sketchEnd) && p == end;
+    // A partial must count the same machines as the summary: a damaged varint can still decode, just to another number
+    if (ok && aggregate) { FleetAggregate part; ok = part.Deserialize(aggregateBegin, aggregateEnd) && aggregateBegin == aggregateEnd && part.Machines() == counts[0]; if (ok) aggregate->Merge(part); }
+    if (ok && sketch) { FleetSketch part; ok = part.Deserialize(sketchBegin, sketchEnd) && sketchBegin == sketchEnd && part.Machines() == counts[0]; if (ok) sketch->Merge(part); }
+    if (!ok) { error = "Shard summary '" + path + "' is corrupt"; return false; }
+    stats.Machines += (size_t)counts[0]; stats.Passed += (size_t)counts[1]; stats.Failed += (size_t)counts[2]; stats.WithWarnings += (size_t)counts[3];
+    stats.MalformedRows += (size_t)counts[4]; stats.Unfixable += (size_t)counts[5]; stats.Steals += (size_t)counts[6]; stats.PlanCost += planCost;
+    return true;
+}
+
+// --- Worker ---
+bool RunShardWorker(BatchOptions options, const WindowsRequirements* target, const std::string& shard, const std::string& prefix, std::string& error) {
+    char* end = NULL; const unsigned long index = strtoul(shard.c_str(), &end, 10);
+    const unsigned long count = (end && *end == '/') ? strtoul(end + 1, &end, 10) : 0;
+    if (!end || *end || count == 0 || index >= count) { error = "Invalid shard '" + shard + "' (expected k/N with k < N)"; return false; }
+    options.ShardIndex = (unsigned)index; options.ShardCount = (unsigned)count; options.OutputPath = prefix + ".verdicts";
+    BatchStats stats;
+    if (!RunBatch(options, target, stats, error)) return false;
+    return SaveShardSummary(prefix + ".summary", stats, options.Aggregate, options.Sketch, error);
+}
+
+// --- Worker Processes ---
+#ifdef _WIN32
+typedef HANDLE WorkerProcess;
+
+// CommandLineToArgvW rules: quotes around arguments with spaces, backslashes doubled only before a quote
+static void AppendQuotedArgument(std::string& line, const std::string& arg) {
+    if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos) { line += arg; return; }
+    line += '"';
+    for (size_t i = 0;; ++i) {
+        size_t backslashes = 0;
+        while (i < arg.size() && arg[i] == '\\') { ++i; ++backslashes; }
+        if (i == arg.size()) { line.append(backslashes * 2, '\\'); break; }
+        line.append(arg[i] == '"' ? backslashes * 2 + 1 : backslashes, '\\'); line += arg[i];
+    }
+    line += '"';
+}
+
+static bool StartWorker(const std::string& executable, const std::vector<std::string>& args, WorkerProcess& process, std::string& error) {
+    std::string line; AppendQuotedArgument(line, executable);
+    for (const std::string& arg : args) { line += ' '; AppendQuotedArgument(line, arg); }
+    STARTUPINFOA startup; memset(&startup, 0, sizeof(startup)); startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info;
+    if (!CreateProcessA(executable.c_str(), &line[0], NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info)) { error = "Could not start '" + executable + "' (error " + std::to_string(GetLastError()) + ")"; return false; }
+    CloseHandle(info.hThread); process = info.hProcess;
+    return true;
+}
+
+static int WaitWorker(WorkerProcess process) {
+    DWORD code = (DWORD)-1;
+    WaitForSingleObject(process, INFINITE); GetExitCodeProcess(process, &code); CloseHandle(process);
+    return (int)code;
+}
+
+static unsigned long CurrentProcessId() { return (unsigned long)GetCurrentProcessId(); }
+
+std::string CurrentExecutablePath() {
+    char path[MAX_PATH]; const DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+    return (length && length < MAX_PATH) ? std::string(path, length) : std::string();
+}
+#else
+typedef pid_t WorkerProcess;
+
+static bool StartWorker(const std::string& executable, const std::vector<std::string>& args, WorkerProcess& process, std::string& error) {
+    std::vector<char*> argv; argv.push_back(const_cast<char*>(executable.c_str()));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(NULL);
+    const int result = posix_spawn(&process, executable.c_str(), NULL, NULL, argv.data(), environ);
+    if (result != 0) { error = "Could not start '" + executable + "' (" + strerror(result) + ")"; return false; }
+    return true;
+}
+
+static int WaitWorker(WorkerProcess process) {
+    int status = 0;
+    if (waitpid(process, &status, 0) != process) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1; // -1: killed by a signal
+}
+
+static unsigned long CurrentProcessId() { return (unsigned long)getpid(); }
+
+std::string CurrentExecutablePath() {
+    char path[4096]; const ssize_t length = readlink("/proc/self/exe", path, sizeof(path));
+    return (length > 0 && (size_t)length < sizeof(path)) ? std::string(path, (size_t)length) : std::string();
+}
+#endif
+
+// --- Coordinator ---
+namespace {
+struct ShardStream {                          // Read side of one worker's .verdicts file
+    std::ifstream File; ULONGLONG Ordinal = 0; UINT32 Length = 0; bool Done = false; size_t Frames = 0;
+    bool Next(std::string& error, const std::string& path) { // Reads the next frame header; Done at the end of the file
+        ULONGLONG previous = Ordinal; char header[sizeof(ULONGLONG) + sizeof(UINT32)];
+        if (!File.read(header, sizeof(header))) {
+            if (File.gcount() == 0 && File.eof()) { Done = true; return true; }
+            error = "Shard verdicts '" + path + "' are cut short"; return false;
+        }
+        memcpy(&Ordinal, header, sizeof(Ordinal)); memcpy(&Length, header + sizeof(Ordinal), sizeof(Length));
+        if (Frames++ && Ordinal <= previous) { error = "Shard verdicts '" + path + "' are out of order"; return false; }
+        return true;
+    }
+};
+}
+
+bool RunShardedBatch(const ShardRun& run, const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error) {
+    stats = BatchStats();
+    const auto startTime = std::chrono::steady_clock::now();
+    const unsigned shards = run.Processes ? run.Processes : 1;
+    if (options.Cache || options.Store) { error = "The result cache and result store need a single process"; return false; }
+    for (const std::string& path : options.InputPaths) { if (path == "-") { error = "Standard input cannot be split into shards"; return false; } }
+    const std::string executable = run.Executable.empty() ? CurrentExecutablePath() : run.Executable;
+    if (executable.empty()) { error = "Could not find this program's executable to start the workers"; return false; }
+
+    std::string workDir = run.WorkDir;
+    if (workDir.empty()) {
+        const size_t slash = (options.OutputPath == "-") ? std::string::npos : options.OutputPath.find_last_of("/\\");
+        workDir = slash == std::string::npos ? "." : options.OutputPath.substr(0, slash ? slash : 1);
+    }
+    std::vector<std::string> prefixes;
+    for (unsigned k = 0; k < shards; ++k) prefixes.push_back(workDir + "/wrc-" + std::to_string(CurrentProcessId()) + "-shard" + std::to_string(k));
+    auto RemovePartials = [&] { for (const std::string& prefix : prefixes) { remove((prefix + ".verdicts").c_str()); remove((prefix + ".summary").c_str()); } };
+
+    // --- Workers: all started at once, then waited for in order ---
+    {
+        TRACE_SPAN("Run shard workers", "shard");
+        std::vector<WorkerProcess> processes;
+        for (unsigned k = 0; k < shards && error.empty(); ++k) {
+            std::vector<std::string> args = run.WorkerArgs;
+            args.push_back("--shard"); args.push_back(std::to_string(k) + "/" + std::to_string(shards));
+            args.push_back("--partial"); args.push_back(prefixes[k]);
+            WorkerProcess process;
+            if (StartWorker(executable, args, process, error)) processes.push_back(process);
+        }
+        for (size_t k = 0; k < processes.size(); ++k) {
+            const int code = WaitWorker(processes[k]);
+            if (code != 0 && error.empty()) error = "Shard " + std::to_string(k) + " of " + std::to_string(shards) + " failed (exit code " + std::to_string(code) + ")";
+        }
+        if (!error.empty()) { RemovePartials(); return false; }
+    }
+    const bool ok = MergeShardOutputs(prefixes, options, target, stats, error);
+    RemovePartials();
+    stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return ok;
+}
+
+// --- Merge: summaries in shard order, verdicts by ordinal ---
+bool MergeShardOutputs(const std::vector<std::string>& prefixes, const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error) {
+    TRACE_SPAN("Merge shards", "shard");
+    const unsigned shards = (unsigned)prefixes.size();
+    std::unique_ptr<ShardStream[]> streams(new ShardStream[shards]);
+    size_t frames = 0;
+    for (unsigned k = 0; k < shards && error.empty(); ++k) {
+        if (!MergeShardSummary(prefixes[k] + ".summary", stats, options.Aggregate, options.Sketch, error)) break;
+        streams[k].File.open((prefixes[k] + ".verdicts").c_str(), std::ios::binary);
+        if (!streams[k].File) error = "Shard verdicts '" + prefixes[k] + ".verdicts' are missing";
+        else streams[k].Next(error, prefixes[k] + ".verdicts");
+    }
+    std::ofstream outputFile; std::ostream* output = &std::cout;
+    if (error.empty() && !options.OutputPath.empty() && options.OutputPath != "-") {
+        outputFile.open(options.OutputPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!outputFile) error = "Could not create output file '" + options.OutputPath + "'";
+        output = &outputFile;
+    }
+    if (!error.empty()) return false;
+
+    std::string begin, end, text;
+    BatchDocumentEdges(options, target, begin, end);
+    text = begin;
+    for (;;) {
+        unsigned best = shards;
+        for (unsigned k = 0; k < shards; ++k) { if (!streams[k].Done && (best == shards || streams[k].Ordinal < streams[best].Ordinal)) best = k; }
+        if (best == shards) break;
+        ShardStream& stream = streams[best];
+        const size_t size = text.size(); text.resize(size + stream.Length);
+        if (!stream.File.read(&text[size], stream.Length)) { error = "Shard verdicts '" + prefixes[best] + ".verdicts' are cut short"; break; }
+        ++frames;
+        if (!stream.Next(error, prefixes[best] + ".verdicts")) break;
+        if (text.size() >= (1 << 16)) { output->write(text.data(), (std::streamsize)text.size()); text.clear(); }
+    }
+    if (error.empty() && frames != stats.Machines) error = "Shard verdicts do not match the shard summaries (" + std::to_string(frames) + " of " + std::to_string(stats.Machines) + " machines)";
+    text += end;
+    output->write(text.data(), (std::streamsize)text.size()); output->flush();
+    for (unsigned k = 0; k < shards; ++k) streams[k].File.close();
+    if (error.empty() && !*output) error = "Failed writing verdicts";
+    return error.empty();
+}
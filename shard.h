@@ -0,0 +1,53 @@
+#ifndef SHARD_H_INCLUDED
+#define SHARD_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include "batch.h"
+
+class FleetAggregate;
+class FleetSketch;
+
+// --- Sharded Batch Runs (--batch ... --processes N) ---
+// A coordinator starts N worker processes of the same executable on the same inputs. Every worker reads every input but
+// only parses and evaluates the machines of its shard (see ShardOf; a CSV row of another shard is only split into
+// cells, a JSON Lines object is read whole), so a worker holds 1/N of the evaluation state (aggregate name
+// tables, report buffers). Workers write their partial results to files; the coordinator merges them into exactly the
+// output, statistics and aggregate a single process writes. Malformed rows are reported by the worker that owns them,
+// so their warnings are not in input order. Fleet sketches are merged shard by shard: they answer within the same
+// error bounds but are not byte-identical to a single-process sketch.
+// A hash of the UTF-8 MachineId, the same on every platform. A machine without one (no MachineId column, an empty cell,
+// a malformed JSON Lines object) goes by its row instead: the line number in an inventory file, the record index in a
+// fleet file. Hashing all of those as "" would hand every one of them to the same worker.
+unsigned ShardOf(const char* machineId, size_t length, unsigned long long row, unsigned shards);
+
+// Worker output, next to each other under a prefix chosen by the coordinator:
+//   <prefix>.verdicts  per machine, in input order: UINT64 ordinal (input index << 40 | line number, or record index
+//                      for a fleet file) | UINT32 length | that machine's output (verdict line or rendered report)
+//   <prefix>.summary   magic[8] "WRCSHARD" | UINT32 version | BatchStats | aggregate (optional) | sketch (optional)
+bool SaveShardSummary(const std::string& path, const BatchStats& stats, const FleetAggregate* aggregate, const FleetSketch* sketch, std::string& error);
+
+// Worker side: evaluates shard "k/N" of options' inputs and writes <prefix>.verdicts and <prefix>.summary.
+// options.Aggregate / options.Sketch (may be NULL) only select which partials are collected.
+bool RunShardWorker(BatchOptions options, const WindowsRequirements* target, const std::string& shard, const std::string& prefix, std::string& error);
+
+// Coordinator side: runs Processes workers as "<Executable> <WorkerArgs...> --shard k/N --partial <prefix>" (the
+// worker's entry point passes both to RunShardWorker), waits for all of them, then writes the merged output to
+// options.OutputPath and merges their aggregates and sketches into options.Aggregate / options.Sketch. Partial files go
+// to WorkDir (default: the output's directory) and are removed afterwards.
+struct ShardRun {
+    std::string Executable;                 // Empty: this process's own executable
+    std::vector<std::string> WorkerArgs;    // Arguments that make the executable run the same batch as a worker
+    unsigned Processes = 2;
+    std::string WorkDir;
+};
+bool RunShardedBatch(const ShardRun& run, const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error);
+
+// The coordinator's merge step on its own: reads the partials of shards 0..N-1 (prefixes in shard order), writes the merged
+// output to options.OutputPath and adds the partials to stats, options.Aggregate and options.Sketch. Leaves the partial
+// files in place. False if a partial is missing, corrupt, cut short or disagrees with its summary.
+bool MergeShardOutputs(const std::vector<std::string>& prefixes, const BatchOptions& options, const WindowsRequirements* target, BatchStats& stats, std::string& error);
+
+std::string CurrentExecutablePath();
+
+#endif // SHARD_H_INCLUDED
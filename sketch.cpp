@@ -0,0 +1,353 @@
+#include "sketch.h"
+
+#include <algorithm>
+#include <cmath>          // For log
+#include <cstdio>         // For snprintf
+#include <cstring>
+#include <fstream>
+#include "report.h"       // AppendJsonString
+#include "varint.h"
+
+// --- Hashing and Serialization Helpers ---
+static ULONGLONG Finalize(ULONGLONG hash) { // splitmix64 finalizer: FNV-1a alone leaves the high bits (the HLL index) weak
+    hash ^= hash >> 30; hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27; hash *= 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+ULONGLONG SketchHash(const char* text, size_t length) {
+    ULONGLONG hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; ++i) { hash ^= (unsigned char)text[i]; hash *= 0x100000001B3ULL; }
+    return Finalize(hash);
+}
+
+static bool GetSize(const char*& p, const char* end, size_t limit, size_t& value) { // Counts that size an allocation
+    unsigned long long v = 0;
+    if (!GetVarint(p, end, v) || v > limit) return false;
+    value = (size_t)v; return true;
+}
+
+// --- HyperLogLog ---
+void HyperLogLog::Add(ULONGLONG hash) {
+    const size_t index = (size_t)(hash >> (64 - Precision));
+    ULONGLONG rest = hash << Precision; unsigned char rank = 1;
+    while (!(rest & 0x8000000000000000ULL) && rank <= 64 - Precision) { rest <<= 1; ++rank; } // Leading zeros + 1
+    if (rank > registers[index]) registers[index] = rank;
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < RegisterCount; ++i) registers[i] = std::max(registers[i], other.registers[i]);
+}
+
+double HyperLogLog::Estimate() const {
+    const double m = (double)RegisterCount, alpha = 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0; size_t zeros = 0;
+    for (unsigned char r : registers) { sum += std::ldexp(1.0, -(int)r); if (!r) ++zeros; }
+    const double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros) return m * std::log(m / (double)zeros); // Small range: linear counting
+    return estimate;
+}
+
+void HyperLogLog::Serialize(std::string& out) const { out.append((const char*)registers.data(), registers.size()); }
+
+bool HyperLogLog::Deserialize(const char*& p, const char* end) {
+    if ((size_t)(end - p) < RegisterCount) return false;
+    memcpy(registers.data(), p, RegisterCount); p += RegisterCount;
+    for (unsigned char r : registers) { if (r > 64 - Precision + 1) return false; }
+    return true;
+}
+
+// --- Space-Saving ---
+static const size_t MAX_ITEM_BYTES = 128;
+
+void SpaceSaving::Add(const char* item, size_t length, unsigned long long weight) {
+    if (length > MAX_ITEM_BYTES) { length = MAX_ITEM_BYTES; while (length && ((unsigned char)item[length] & 0xC0) == 0x80) --length; } // Whole UTF-8 characters
+    total += weight;
+    key.assign(item, length);
+    std::unordered_map<std::string, size_t>::iterator it = index.find(key);
+    if (it != index.end()) { entries[it->second].Count += weight; return; }
+    if (entries.size() < capacity) { Entry entry; entry.Item = key; entry.Count = weight; index.emplace(key, entries.size()); entries.push_back(std::move(entry)); return; }
+    size_t victim = 0; // The smallest counter gives up its slot; the newcomer inherits its count as the error bound
+    for (size_t i = 1; i < entries.size(); ++i) { if (entries[i].Count < entries[victim].Count) victim = i; }
+    Entry& entry = entries[victim];
+    index.erase(entry.Item); index.emplace(key, victim);
+    entry.Item = key; entry.Error = entry.Count; entry.Count += weight;
+}
+
+unsigned long long SpaceSaving::MinCount() const {
+    if (entries.size() < capacity) return 0; // Not full: a missing name has not been seen at all
+    unsigned long long minimum = entries[0].Count;
+    for (const Entry& entry : entries) minimum = std::min(minimum, entry.Count);
+    return minimum;
+}
+
+void SpaceSaving::Merge(const SpaceSaving& other) {
+    if (!total && capacity == other.capacity) { *this = other; return; }
+    const unsigned long long missingHere = MinCount(), missingThere = other.MinCount();
+    std::vector<Entry> merged; merged.reserve(entries.size() + other.entries.size());
+    for (const Entry& entry : entries) {
+        std::unordered_map<std::string, size_t>::const_iterator it = other.index.find(entry.Item);
+        Entry sum = entry;
+        if (it != other.index.end()) { sum.Count += other.entries[it->second].Count; sum.Error += other.entries[it->second].Error; }
+        else { sum.Count += missingThere; sum.Error += missingThere; }
+        merged.push_back(std::move(sum));
+    }
+    for (const Entry& entry : other.entries) {
+        if (index.count(entry.Item)) continue;
+        Entry sum = entry; sum.Count += missingHere; sum.Error += missingHere;
+        merged.push_back(std::move(sum));
+    }
+    auto Before = [](const Entry& a, const Entry& b) { return a.Count != b.Count ? a.Count > b.Count : a.Item < b.Item; };
+    std::sort(merged.begin(), merged.end(), Before);
+    if (merged.size() > capacity) merged.resize(capacity);
+    entries.swap(merged); index.clear();
+    for (size_t i = 0; i < entries.size(); ++i) index.emplace(entries[i].Item, i);
+    total += other.total;
+}
+
+void SpaceSaving::Top(size_t k, std::vector<Entry>& out) const {
+    out = entries;
+    auto Before = [](const Entry& a, const Entry& b) { return a.Count != b.Count ? a.Count > b.Count : a.Item < b.Item; };
+    const size_t keep = std::min(k, out.size());
+    std::partial_sort(out.begin(), out.begin() + keep, out.end(), Before); out.resize(keep);
+}
+
+size_t SpaceSaving::MemoryBytes() const {
+    size_t bytes = entries.capacity() * sizeof(Entry);
+    for (const Entry& entry : entries) bytes += 2 * (entry.Item.capacity() + 1) + 4 * sizeof(void*); // Name in the entry and the index node
+    return bytes;
+}
+
+void SpaceSaving::Serialize(std::string& out) const {
+    PutVarint(out, capacity); PutVarint(out, total); PutVarint(out, entries.size());
+    for (const Entry& entry : entries) { PutVarint(out, entry.Item.size()); out += entry.Item; PutVarint(out, entry.Count); PutVarint(out, entry.Error); }
+}
+
+bool SpaceSaving::Deserialize(const char*& p, const char* end) {
+    size_t size = 0; entries.clear(); index.clear();
+    if (!GetSize(p, end, 1 << 16, capacity) || !capacity || !GetVarint(p, end, total) || !GetSize(p, end, capacity, size)) return false;
+    for (size_t i = 0; i < size; ++i) {
+        Entry entry; size_t length = 0;
+        if (!GetSize(p, end, MAX_ITEM_BYTES, length) || (size_t)(end - p) < length) return false;
+        entry.Item.assign(p, length); p += length;
+        if (!GetVarint(p, end, entry.Count) || !GetVarint(p, end, entry.Error) || entry.Error > entry.Count || !index.emplace(entry.Item, entries.size()).second) return false;
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// --- KLL Quantiles ---
+size_t KllSketch::LevelCapacity(size_t level) const { // K for the top level, 2/3 of that per level below, at least 2
+    const double capacity = std::ceil((double)K * std::pow(2.0 / 3.0, (double)(levels.size() - 1 - level)));
+    return capacity < 2 ? 2 : (size_t)capacity;
+}
+
+size_t KllSketch::Retained() const { size_t total = 0; for (const std::vector<ULONGLONG>& level : levels) total += level.size(); return total; }
+
+void KllSketch::Add(ULONGLONG value) {
+    if (levels.empty()) levels.resize(1);
+    if (!count || value < minimum) minimum = value;
+    if (!count || value > maximum) maximum = value;
+    ++count; levels[0].push_back(value);
+    if (levels[0].size() >= LevelCapacity(0)) Compress();
+}
+
+// Compacts the lowest full level: sorts it and promotes every second value (weight doubles), keeping one back when the
+// count is odd, until every level is within its capacity
+void KllSketch::Compress() {
+    for (size_t h = 0; h < levels.size(); ++h) {
+        if (levels[h].size() < LevelCapacity(h)) continue;
+        if (h + 1 == levels.size()) levels.emplace_back(); // Capacities of the lower levels grow with the height
+        std::vector<ULONGLONG>& level = levels[h]; std::vector<ULONGLONG>& above = levels[h + 1];
+        std::sort(level.begin(), level.end());
+        const size_t kept = level.size() % 2, offset = (size_t)(Finalize(++compactions) & 1); // Deterministic coin flip
+        for (size_t i = kept + offset; i < level.size(); i += 2) above.push_back(level[i]);
+        level.resize(kept);
+    }
+}
+
+void KllSketch::Merge(const KllSketch& other) {
+    if (!other.count) return;
+    if (!count) { *this = other; return; }
+    minimum = std::min(minimum, other.minimum); maximum = std::max(maximum, other.maximum); compactions += other.compactions;
+    if (levels.size() < other.levels.size()) levels.resize(other.levels.size());
+    for (size_t h = 0; h < other.levels.size(); ++h) levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+    count += other.count;
+    Compress();
+}
+
+ULONGLONG KllSketch::Quantile(double fraction) const {
+    if (!count) return 0;
+    if (fraction <= 0) return minimum;
+    if (fraction >= 1) return maximum;
+    thread_local std::vector<std::pair<ULONGLONG, ULONGLONG>> weighted; weighted.clear(); // (value, weight)
+    ULONGLONG totalWeight = 0;
+    for (size_t h = 0; h < levels.size(); ++h) { for (ULONGLONG value : levels[h]) { weighted.push_back(std::make_pair(value, (ULONGLONG)1 << h)); totalWeight += (ULONGLONG)1 << h; } }
+    std::sort(weighted.begin(), weighted.end());
+    const double target = fraction * (double)totalWeight; ULONGLONG cumulative = 0;
+    for (const std::pair<ULONGLONG, ULONGLONG>& entry : weighted) { cumulative += entry.second; if ((double)cumulative >= target) return entry.first; }
+    return maximum;
+}
+
+void KllSketch::Serialize(std::string& out) const {
+    PutVarint(out, count); PutVarint(out, minimum); PutVarint(out, maximum); PutVarint(out, compactions); PutVarint(out, levels.size());
+    for (const std::vector<ULONGLONG>& level : levels) { PutVarint(out, level.size()); for (ULONGLONG value : level) PutVarint(out, value); }
+}
+
+bool KllSketch::Deserialize(const char*& p, const char* end) {
+    size_t height = 0; levels.clear();
+    if (!GetVarint(p, end, count) || !GetVarint(p, end, minimum) || !GetVarint(p, end, maximum) || !GetVarint(p, end, compactions) || !GetSize(p, end, 64, height)) return false;
+    levels.resize(height); unsigned long long weight = 0;
+    for (size_t h = 0; h < height; ++h) {
+        size_t size = 0;
+        if (!GetSize(p, end, 4 * K, size)) return false;
+        levels[h].resize(size); weight += (unsigned long long)size << h;
+        for (ULONGLONG& value : levels[h]) { unsigned long long v = 0; if (!GetVarint(p, end, v) || v < minimum || v > maximum) return false; value = v; }
+    }
+    return weight == count && minimum <= maximum; // Compaction keeps the total weight, so anything else is corrupt
+}
+
+// --- Fleet Sketch ---
+void FleetSketch::Add(const MachineFeatures& features, unsigned fail, unsigned warn, const char* cpuName, size_t cpuLength, const char* gpuName, size_t gpuLength) {
+    const SketchVerdict verdict = fail ? SketchFail : (warn ? SketchWarn : SketchPass);
+    ++machines; ++verdicts[verdict];
+    cpuModels.Add(SketchHash(cpuName, cpuLength)); gpuModels.Add(SketchHash(gpuName, gpuLength));
+    if (fail) { failingCpus.Add(cpuName, cpuLength); failingGpus.Add(gpuName, gpuLength); }
+    ram[verdict].Add(features.RamBytes); diskFree[verdict].Add(features.DiskFreeBytes);
+}
+
+void FleetSketch::Merge(const FleetSketch& other) {
+    machines += other.machines;
+    for (int v = 0; v < SketchVerdictCount; ++v) { verdicts[v] += other.verdicts[v]; ram[v].Merge(other.ram[v]); diskFree[v].Merge(other.diskFree[v]); }
+    cpuModels.Merge(other.cpuModels); gpuModels.Merge(other.gpuModels);
+    failingCpus.Merge(other.failingCpus); failingGpus.Merge(other.failingGpus);
+}
+
+size_t FleetSketch::MemoryBytes() const { // Approximate: register arrays, retained values and name counters
+    size_t bytes = sizeof(*this) + 2 * HyperLogLog::RegisterCount + failingCpus.MemoryBytes() + failingGpus.MemoryBytes();
+    for (int v = 0; v < SketchVerdictCount; ++v) bytes += (ram[v].Retained() + diskFree[v].Retained()) * sizeof(ULONGLONG);
+    return bytes;
+}
+
+void FleetSketch::Serialize(std::string& out) const {
+    PutVarint(out, machines);
+    for (int v = 0; v < SketchVerdictCount; ++v) PutVarint(out, verdicts[v]);
+    cpuModels.Serialize(out); gpuModels.Serialize(out);
+    failingCpus.Serialize(out); failingGpus.Serialize(out);
+    for (int v = 0; v < SketchVerdictCount; ++v) { ram[v].Serialize(out); diskFree[v].Serialize(out); }
+}
+
+bool FleetSketch::Deserialize(const char*& p, const char* end) {
+    if (!GetVarint(p, end, machines)) return false;
+    for (int v = 0; v < SketchVerdictCount; ++v) { if (!GetVarint(p, end, verdicts[v])) return false; }
+    if (!cpuModels.Deserialize(p, end) || !gpuModels.Deserialize(p, end) || !failingCpus.Deserialize(p, end) || !failingGpus.Deserialize(p, end)) return false;
+    for (int v = 0; v < SketchVerdictCount; ++v) { if (!ram[v].Deserialize(p, end) || !diskFree[v].Deserialize(p, end)) return false; }
+    return true;
+}
+
+// --- Sketch File ---
+static const char SKETCH_MAGIC[8] = { 'W', 'R', 'C', 'S', 'K', 'T', 'C', 'H' };
+static const UINT32 SKETCH_VERSION = 1;
+
+bool SaveSketchFile(const std::string& path, const FleetSketch& sketch, const std::string& targetName, std::string& error) {
+    std::string data(SKETCH_MAGIC, sizeof(SKETCH_MAGIC));
+    const UINT32 header[2] = { SKETCH_VERSION, (UINT32)targetName.size() };
+    data.append((const char*)header, sizeof(header)); data += targetName;
+    sketch.Serialize(data);
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(data.data(), (std::streamsize)data.size())) { error = "Could not write sketch file '" + path + "'"; return false; }
+    return true;
+}
+
+bool LoadSketchFile(const std::string& path, FleetSketch& sketch, std::string& targetName, std::string& error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) { error = "Could not open sketch file '" + path + "'"; return false; }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    UINT32 header[2] = {};
+    if (data.size() < sizeof(SKETCH_MAGIC) + sizeof(header) || memcmp(data.data(), SKETCH_MAGIC, sizeof(SKETCH_MAGIC)) != 0) { error = "'" + path + "' is not a sketch file"; return false; }
+    memcpy(header, data.data() + sizeof(SKETCH_MAGIC), sizeof(header));
+    if (header[0] != SKETCH_VERSION) { error = "Sketch file '" + path + "' has unsupported version " + std::to_string(header[0]); return false; }
+    const char* p = data.data() + sizeof(SKETCH_MAGIC) + sizeof(header); const char* end = data.data() + data.size();
+    if ((size_t)(end - p) < header[1]) { error = "Sketch file '" + path + "' is truncated"; return false; }
+    targetName.assign(p, header[1]); p += header[1];
+    sketch = FleetSketch();
+    if (!sketch.Deserialize(p, end) || p != end) { error = "Sketch file '" + path + "' is corrupt"; return false; }
+    return true;
+}
+
+// --- Summary Output ---
+namespace {
+const double SUMMARY_QUANTILES[] = { 0.10, 0.25, 0.50, 0.75, 0.90 };
+const char* const VERDICT_NAMES[SketchVerdictCount] = { "PASS", "WARN", "FAIL" };
+
+std::string Gigabytes(ULONGLONG bytes) { char text[32]; snprintf(text, sizeof(text), "%.1f GB", (double)bytes / (1024.0 * 1024.0 * 1024.0)); return text; }
+}
+
+void FormatSketchText(const FleetSketch& s, const std::string& targetName, size_t topK, std::string& out) {
+    char line[256];
+    out += "=== Fleet Sketch: " + targetName + " ===\n";
+    snprintf(line, sizeof(line), "Machines: %llu (%llu pass, %llu pass with warnings, %llu fail)\n", s.Machines(), s.Verdicts(SketchPass), s.Verdicts(SketchWarn), s.Verdicts(SketchFail));
+    out += line;
+    snprintf(line, sizeof(line), "Distinct CPU models: ~%.0f, distinct GPU models: ~%.0f (HyperLogLog, standard error 1.6%%)\n", s.CpuModels().Estimate(), s.GpuModels().Estimate());
+    out += line;
+
+    std::vector<SpaceSaving::Entry> top;
+    auto AppendTop = [&](const char* title, const SpaceSaving& names) {
+        names.Top(topK, top);
+        snprintf(line, sizeof(line), "\n--- %s (failing machines; a count may be up to its error too high) ---\n", title); out += line;
+        for (const SpaceSaving::Entry& entry : top) {
+            snprintf(line, sizeof(line), "  %10llu  (error <= %llu)  ", entry.Count, entry.Error); out += line; out += entry.Item; out += '\n';
+        }
+    };
+    AppendTop("Top CPU Names", s.FailingCpus()); AppendTop("Top GPU Names", s.FailingGpus());
+
+    auto AppendQuantiles = [&](const char* title, const KllSketch* sketches) {
+        snprintf(line, sizeof(line), "\n--- %s by Verdict (KLL, rank error about 1.7%%) ---\n", title); out += line;
+        for (int v = 0; v < SketchVerdictCount; ++v) {
+            if (!sketches[v].Count()) continue;
+            snprintf(line, sizeof(line), "  %-4s", VERDICT_NAMES[v]); out += line;
+            for (double q : SUMMARY_QUANTILES) { snprintf(line, sizeof(line), "  p%.0f: %s", q * 100, Gigabytes(sketches[v].Quantile(q)).c_str()); out += line; }
+            out += '\n';
+        }
+    };
+    const KllSketch ram[SketchVerdictCount] = { s.Ram(SketchPass), s.Ram(SketchWarn), s.Ram(SketchFail) };
+    const KllSketch disk[SketchVerdictCount] = { s.DiskFree(SketchPass), s.DiskFree(SketchWarn), s.DiskFree(SketchFail) };
+    AppendQuantiles("RAM", ram); AppendQuantiles("Free Disk", disk);
+    snprintf(line, sizeof(line), "\nSketch memory: about %zu KB\n", s.MemoryBytes() / 1024); out += line;
+}
+
+void FormatSketchJson(const FleetSketch& s, const std::string& targetName, size_t topK, std::string& out) {
+    char number[64];
+    out += "{\"target\":"; AppendJsonString(out, targetName);
+    out += ",\"machines\":" + std::to_string(s.Machines()) + ",\"verdicts\":{";
+    for (int v = 0; v < SketchVerdictCount; ++v) { if (v) out += ','; out += '"'; out += VERDICT_NAMES[v]; out += "\":" + std::to_string(s.Verdicts((SketchVerdict)v)); }
+    snprintf(number, sizeof(number), "},\"distinctCpuModels\":%.0f,\"distinctGpuModels\":%.0f", s.CpuModels().Estimate(), s.GpuModels().Estimate()); out += number;
+
+    std::vector<SpaceSaving::Entry> top;
+    auto AppendTop = [&](const SpaceSaving& names) {
+        names.Top(topK, top); out += '[';
+        for (size_t i = 0; i < top.size(); ++i) {
+            if (i) out += ',';
+            out += "{\"name\":"; AppendJsonString(out, top[i].Item); out += ",\"machines\":" + std::to_string(top[i].Count) + ",\"error\":" + std::to_string(top[i].Error) + "}";
+        }
+        out += ']';
+    };
+    out += ",\"failingTopCpu\":"; AppendTop(s.FailingCpus()); out += ",\"failingTopGpu\":"; AppendTop(s.FailingGpus());
+
+    auto AppendQuantiles = [&](const char* field, bool useRam) {
+        out += ",\""; out += field; out += "\":{"; bool first = true;
+        for (int v = 0; v < SketchVerdictCount; ++v) {
+            const KllSketch& sketch = useRam ? s.Ram((SketchVerdict)v) : s.DiskFree((SketchVerdict)v);
+            if (!sketch.Count()) continue;
+            if (!first) out += ',';
+            out += '"'; out += VERDICT_NAMES[v]; out += "\":{"; first = false;
+            for (size_t i = 0; i < sizeof(SUMMARY_QUANTILES) / sizeof(SUMMARY_QUANTILES[0]); ++i) {
+                snprintf(number, sizeof(number), "%s\"p%.0f\":%llu", i ? "," : "", SUMMARY_QUANTILES[i] * 100, (unsigned long long)sketch.Quantile(SUMMARY_QUANTILES[i])); out += number;
+            }
+            out += '}';
+        }
+        out += '}';
+    };
+    AppendQuantiles("ramBytes", true); AppendQuantiles("diskFreeBytes", false);
+    out += "}\n";
+}
@@ -0,0 +1,118 @@
+#ifndef SKETCH_H_INCLUDED
+#define SKETCH_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "evaluate.h"
+
+// --- Streaming Sketches (fixed memory, mergeable, serializable) ---
+// Fleet statistics that do not keep one entry per machine or per distinct name, unlike FleetAggregate (aggregate.h):
+// each sketch has a fixed size, two sketches of the same kind merge into one that answers as if it had seen both
+// streams, and merging is deterministic, so merging per-chunk sketches in input order gives the same answer for any
+// thread count.
+
+ULONGLONG SketchHash(const char* text, size_t length); // 64-bit, platform independent (also for the on-disk format)
+
+// Distinct count. 2^12 one-byte registers (4 KB); standard error 1.04 / sqrt(4096) = 1.6%, i.e. within +-3.3% for 95%
+// of fleets, at any cardinality.
+class HyperLogLog {
+public:
+    static const int Precision = 12;
+    static const size_t RegisterCount = (size_t)1 << Precision;
+    HyperLogLog() : registers(RegisterCount, 0) {}
+    void Add(ULONGLONG hash);
+    void Merge(const HyperLogLog& other);
+    double Estimate() const;
+    void Serialize(std::string& out) const;
+    bool Deserialize(const char*& p, const char* end);
+private:
+    std::vector<unsigned char> registers;
+};
+
+// Heavy hitters (Space-Saving, Metwally et al.; merged as in Agarwal et al., "Mergeable Summaries"). Keeps Capacity
+// counters. A reported count is never below the true count and at most Error() above it, and Error() <= Total() /
+// Capacity, so every name that holds more than 1/Capacity of the stream is in the list. Names are kept up to 128 bytes.
+class SpaceSaving {
+public:
+    struct Entry { std::string Item; unsigned long long Count = 0; unsigned long long Error = 0; }; // True count in [Count - Error, Count]
+    explicit SpaceSaving(size_t capacity = 256) : capacity(capacity ? capacity : 1) {}
+    void Add(const char* item, size_t length, unsigned long long weight = 1);
+    void Merge(const SpaceSaving& other);
+    void Top(size_t k, std::vector<Entry>& out) const;         // By count, then name
+    unsigned long long Total() const { return total; }
+    size_t Capacity() const { return capacity; }
+    size_t MemoryBytes() const;                                 // Approximate heap use (entries and index)
+    void Serialize(std::string& out) const;
+    bool Deserialize(const char*& p, const char* end);
+private:
+    unsigned long long MinCount() const;                        // Count a name not in a full table may have had
+    size_t capacity; unsigned long long total = 0;
+    std::vector<Entry> entries; std::unordered_map<std::string, size_t> index;
+    std::string key;                                            // Reused lookup key
+};
+
+// Quantiles (KLL, Karnin/Lang/Liberty). Compactors of geometrically shrinking capacity, the largest K = 200; holds at most
+// about 3 * K values (under 5 KB) for any stream length. The rank of a reported quantile is within about 1.7% of the
+// stream length of the requested rank (99% confidence); the minimum and maximum are exact. The coin that picks the half a
+// compaction keeps is a hash of the compaction count, so the result depends only on the order of Add/Merge calls.
+class KllSketch {
+public:
+    static const unsigned K = 200;
+    void Add(ULONGLONG value);
+    void Merge(const KllSketch& other);
+    ULONGLONG Quantile(double fraction) const;                  // 0 = minimum, 1 = maximum; 0 if empty
+    unsigned long long Count() const { return count; }
+    size_t Retained() const;
+    void Serialize(std::string& out) const;
+    bool Deserialize(const char*& p, const char* end);
+private:
+    size_t LevelCapacity(size_t level) const;
+    void Compress();
+    std::vector<std::vector<ULONGLONG>> levels;                 // levels[h]: values of weight 2^h
+    unsigned long long count = 0; ULONGLONG minimum = 0, maximum = 0;
+    unsigned long long compactions = 0;                         // Seeds the coin of the next compaction
+};
+
+// --- Fleet Sketch (--batch ... --sketch <stats.wrcs>) ---
+// Distinct CPU and GPU models over all machines, the most common CPU and GPU names among failing machines, and RAM and
+// free disk quantiles per verdict. At most about 200 KB whatever the fleet size; sketch files of different runs or sites for
+// the same target merge with --sketch-report.
+enum SketchVerdict { SketchPass, SketchWarn, SketchFail, SketchVerdictCount };
+
+class FleetSketch {
+public:
+    void Add(const MachineFeatures& features, unsigned fail, unsigned warn, const char* cpuName, size_t cpuLength, const char* gpuName, size_t gpuLength);
+    void Merge(const FleetSketch& other);
+
+    unsigned long long Machines() const { return machines; }
+    unsigned long long Verdicts(SketchVerdict verdict) const { return verdicts[verdict]; }
+    const HyperLogLog& CpuModels() const { return cpuModels; }
+    const HyperLogLog& GpuModels() const { return gpuModels; }
+    const SpaceSaving& FailingCpus() const { return failingCpus; }
+    const SpaceSaving& FailingGpus() const { return failingGpus; }
+    const KllSketch& Ram(SketchVerdict verdict) const { return ram[verdict]; }
+    const KllSketch& DiskFree(SketchVerdict verdict) const { return diskFree[verdict]; }
+    size_t MemoryBytes() const;
+
+    void Serialize(std::string& out) const;
+    bool Deserialize(const char*& p, const char* end);
+private:
+    unsigned long long machines = 0; unsigned long long verdicts[SketchVerdictCount] = {};
+    HyperLogLog cpuModels, gpuModels;
+    SpaceSaving failingCpus, failingGpus;
+    KllSketch ram[SketchVerdictCount], diskFree[SketchVerdictCount];
+};
+
+// --- Sketch File (little-endian) ---
+//   magic[8] "WRCSKTCH" | UINT32 version | UINT32 target name length | target name (UTF-8) | FleetSketch
+bool SaveSketchFile(const std::string& path, const FleetSketch& sketch, const std::string& targetName, std::string& error);
+bool LoadSketchFile(const std::string& path, FleetSketch& sketch, std::string& targetName, std::string& error);
+
+// --- Summary Output ---
+// Text or JSON: machines per verdict, distinct models, top-K failing CPU/GPU names (with their error bound) and the
+// RAM / free disk quantiles (10/25/50/75/90%) per verdict.
+void FormatSketchText(const FleetSketch& sketch, const std::string& targetName, size_t topK, std::string& out);
+void FormatSketchJson(const FleetSketch& sketch, const std::string& targetName, size_t topK, std::string& out);
+
+#endif // SKETCH_H_INCLUDED
@@ -0,0 +1,136 @@
+#include "snapshot.h"
+
+#include <cstdio>         // For std::rename / std::remove
+#include <cstdlib>        // For strtoll / strtoull
+#include <fstream>
+#include <vector>
+#include "inventory.h"    // Record field table, CSV and UTF-8 helpers
+#include "probe.h"        // CopyRecordSections
+
+static const char* SNAPSHOT_MAGIC = "WinReadyCheck snapshot v5"; // Bump when the field table, the layout or the meaning of a cached field changes
+
+// --- Sections and Policy ---
+const char* RecordSectionName(int index) {
+    static const char* const names[RecordSectionCount] = { "Cpu", "Ram", "Disk", "Os", "Firmware", "Screen", "DirectX", "Security", "Graphics" };
+    return (index >= 0 && index < RecordSectionCount) ? names[index] : "Unknown";
+}
+
+static int FindRecordSection(const std::string& name) { // Index of "Cpu" etc.; -1 if unknown
+    for (int i = 0; i < RecordSectionCount; ++i) { if (name == RecordSectionName(i)) return i; }
+    return -1;
+}
+
+SnapshotPolicy DefaultSnapshotPolicy() {
+    const long long day = 24LL * 60 * 60;
+    SnapshotPolicy policy = {};
+    policy.TtlSeconds[0] = 30 * day;  // Cpu
+    policy.TtlSeconds[1] = 30 * day;  // Ram
+    policy.TtlSeconds[2] = 0;         // Disk: free space changes all the time
+    policy.TtlSeconds[3] = 1 * day;   // Os: feature updates change the build number
+    policy.TtlSeconds[4] = 30 * day;  // Firmware
+    policy.TtlSeconds[5] = 0;         // Screen: depends on the attached display
+    policy.TtlSeconds[6] = 7 * day;   // DirectX
+    policy.TtlSeconds[7] = 1 * day;   // Security: TPM readiness and Secure Boot can be toggled in setup
+    policy.TtlSeconds[8] = 7 * day;   // Graphics: driver updates change WDDM/feature levels
+    return policy;
+}
+
+unsigned FreshSnapshotSections(const ProbeSnapshot& snapshot, const SnapshotPolicy& policy, long long now) {
+    unsigned fresh = 0;
+    for (int i = 0; i < RecordSectionCount; ++i) {
+        const long long age = now - snapshot.ProbedAt[i];
+        if ((snapshot.Sections & (1u << i)) && age >= 0 && age < policy.TtlSeconds[i]) fresh |= 1u << i;
+    }
+    return fresh;
+}
+
+unsigned UseSnapshotSections(const ProbeSnapshot& snapshot, const std::wstring& host, const SnapshotPolicy& policy, unsigned needed, long long now, MachineRecord& record) {
+    if (snapshot.Host != host) return 0;
+    const unsigned sections = FreshSnapshotSections(snapshot, policy, now) & needed;
+    CopyRecordSections(sections, snapshot.Record, record);
+    return sections;
+}
+
+void StoreSnapshotSections(ProbeSnapshot& snapshot, unsigned sections, const MachineRecord& record, long long now) {
+    sections &= SectionAll;
+    CopyRecordSections(sections, record, snapshot.Record);
+    for (int i = 0; i < RecordSectionCount; ++i) { if (sections & (1u << i)) snapshot.ProbedAt[i] = now; }
+    snapshot.Sections |= sections;
+}
+
+// --- Reading ---
+bool ReadSnapshot(std::istream& in, ProbeSnapshot& snapshot, std::string& error) {
+    snapshot = ProbeSnapshot();
+    std::string line; std::vector<std::string> cells;
+    size_t lineNumber = 1;
+    if (std::getline(in, line) && !line.empty() && line.back() == '\r') line.pop_back();
+    if (line != SNAPSHOT_MAGIC) { error = "Unknown snapshot version"; return false; }
+    int section = -1; // Section the following field lines belong to
+    bool ended = false;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line == "\r") continue;
+        const std::string where = "Snapshot line " + std::to_string(lineNumber) + ": ";
+        if (ended) { error = where + "data after the end line"; return false; }
+        if (!SplitCsvLine(line, cells) || cells.size() != 2) { error = where + "expected 2 columns"; return false; }
+        if (cells[0] == "End") {
+            char* end = NULL; unsigned long long sections = strtoull(cells[1].c_str(), &end, 10);
+            if (cells[1].empty() || *end != '\0' || sections != snapshot.Sections) { error = where + "bad end line"; return false; }
+            ended = true; continue;
+        }
+        if (cells[0] == "Host") { snapshot.Host = Utf8ToWide(cells[1]); continue; }
+        if (!cells[0].empty() && cells[0][0] == '@') {
+            char* end = NULL; long long probedAt = strtoll(cells[1].c_str(), &end, 10);
+            section = FindRecordSection(cells[0].substr(1));
+            if (section < 0 || cells[1].empty() || *end != '\0') { error = where + "bad section line"; return false; }
+            snapshot.ProbedAt[section] = probedAt; snapshot.Sections |= 1u << section;
+            continue;
+        }
+        const RecordField* field = FindRecordField(cells[0]);
+        const size_t dot = cells[0].find('.');
+        if (!field || section < 0 || dot == std::string::npos || cells[0].compare(0, dot, RecordSectionName(section)) != 0) { error = where + "unexpected field '" + cells[0] + "'"; return false; }
+        if (!field->Parse(snapshot.Record, cells[1])) { error = where + "bad value for " + cells[0]; return false; }
+    }
+    if (!ended) { error = "Snapshot is truncated"; return false; }
+    return true;
+}
+
+bool LoadSnapshotFile(const std::string& path, ProbeSnapshot& snapshot, std::string& error) {
+    error.clear();
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) return false; // No snapshot yet is not an error
+    return ReadSnapshot(file, snapshot, error);
+}
+
+// --- Writing ---
+void WriteSnapshot(std::ostream& out, const ProbeSnapshot& snapshot) {
+    size_t fieldCount = 0; const RecordField* fields = GetRecordFields(fieldCount);
+    std::string line, value;
+    out << SNAPSHOT_MAGIC << '\n';
+    line = "Host,"; AppendCsvCell(line, WideToUtf8(snapshot.Host)); out << line << '\n';
+    for (int i = 0; i < RecordSectionCount; ++i) {
+        if (!(snapshot.Sections & (1u << i))) continue;
+        const std::string prefix = std::string(RecordSectionName(i)) + ".";
+        out << '@' << RecordSectionName(i) << ',' << snapshot.ProbedAt[i] << '\n';
+        for (size_t f = 0; f < fieldCount; ++f) {
+            if (std::string(fields[f].Name).compare(0, prefix.size(), prefix) != 0) continue;
+            line = fields[f].Name; line += ',';
+            value.clear(); fields[f].Format(snapshot.Record, value); AppendCsvCell(line, value);
+            out << line << '\n';
+        }
+    }
+    out << "End," << snapshot.Sections << '\n';
+}
+
+bool SaveSnapshotFile(const std::string& path, const ProbeSnapshot& snapshot, std::string& error) {
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) { error = "Cannot write " + temp; return false; }
+        WriteSnapshot(file, snapshot);
+        if (!file.flush()) { error = "Cannot write " + temp; return false; }
+    }
+    std::remove(path.c_str()); // rename() does not replace an existing file on Windows
+    if (std::rename(temp.c_str(), path.c_str()) != 0) { error = "Cannot replace " + path; std::remove(temp.c_str()); return false; }
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H_INCLUDED
+#define SNAPSHOT_H_INCLUDED
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include "sysinfo.h"
+
+// --- Probe Snapshot Cache ---
+// The last live detection results, saved per RecordSection with the time each section was probed. On the next run
+// sections still within their TTL are taken from the snapshot and only the rest are re-probed, so repeat runs (login
+// scripts, scheduled checks) skip most of the COM/WMI work. Sections whose probe failed or timed out are never stored.
+struct SnapshotPolicy {
+    long long TtlSeconds[RecordSectionCount];   // Indexed like RecordSection bits; 0 = always re-probe
+};
+SnapshotPolicy DefaultSnapshotPolicy();         // CPU/RAM/firmware 30 days ... disk free space and resolution never cached
+
+struct ProbeSnapshot {
+    std::wstring Host;                          // Computer the data belongs to; a snapshot from another host is ignored
+    MachineRecord Record;
+    long long ProbedAt[RecordSectionCount] = {};// Unix time per section
+    unsigned Sections = 0;                      // RecordSection bits present in the snapshot
+};
+
+// Sections that may be used as-is at time "now" (a timestamp in the future counts as stale)
+unsigned FreshSnapshotSections(const ProbeSnapshot& snapshot, const SnapshotPolicy& policy, long long now);
+// Copies the sections of needed that the snapshot has fresh data for into record and returns them; the caller probes
+// the rest. Nothing is used from a snapshot of another host.
+unsigned UseSnapshotSections(const ProbeSnapshot& snapshot, const std::wstring& host, const SnapshotPolicy& policy, unsigned needed, long long now, MachineRecord& record);
+// Records freshly probed sections of record in the snapshot
+void StoreSnapshotSections(ProbeSnapshot& snapshot, unsigned sections, const MachineRecord& record, long long now);
+const char* RecordSectionName(int index);        // "Cpu", "Ram", ... (also the field name prefix)
+
+// --- Snapshot File (versioned text; "@Section,probedAt" lines followed by that section's "Struct.Field,value" lines) ---
+// The last line is "End,<Sections>", so a file cut short (at a line break or inside a value) is rejected as a whole.
+bool ReadSnapshot(std::istream& in, ProbeSnapshot& snapshot, std::string& error); // False on an unknown version, any malformed line or truncation
+void WriteSnapshot(std::ostream& out, const ProbeSnapshot& snapshot);
+bool LoadSnapshotFile(const std::string& path, ProbeSnapshot& snapshot, std::string& error); // False with an empty error if there is no file
+bool SaveSnapshotFile(const std::string& path, const ProbeSnapshot& snapshot, std::string& error); // Writes a temp file, then renames it
+
+#endif // SNAPSHOT_H_INCLUDED
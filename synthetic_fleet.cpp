@@ -0,0 +1,149 @@
+#include "synthetic_fleet.h"
+
+#include <cstdio>         // For snprintf
+#include <cstring>        // For strlen
+#include "cpu_list.h"     // Generation level from the CPU name, as live detection does
+
+// --- CPU Pool (a few SKUs make up most of a real fleet; weights are relative) ---
+struct SyntheticCpu { const wchar_t* Name; UINT MHz; UINT Cores; UINT Threads; bool Is64Bit; unsigned Weight; };
+static const SyntheticCpu CPU_POOL[] = {
+    { L"Intel(R) Core(TM) i5-8250U CPU @ 1.60GHz", 1800, 4, 8, true, 120 },
+    { L"Intel(R) Core(TM) i5-8500 CPU @ 3.00GHz", 3000, 6, 6, true, 90 },
+    { L"11th Gen Intel(R) Core(TM) i5-1145G7 @ 2.60GHz", 2611, 4, 8, true, 110 },
+    { L"11th Gen Intel(R) Core(TM) i7-1165G7 @ 2.80GHz", 2803, 4, 8, true, 80 },
+    { L"12th Gen Intel(R) Core(TM) i5-1245U", 1600, 10, 12, true, 70 },
+    { L"13th Gen Intel(R) Core(TM) i7-1365U", 1800, 10, 12, true, 40 },
+    { L"Intel(R) Core(TM) Ultra 7 155H", 3800, 16, 22, true, 15 },
+    { L"Intel(R) Core(TM) i7-10510U CPU @ 1.80GHz", 2304, 4, 8, true, 60 },
+    { L"Intel(R) Core(TM) i7-7700 CPU @ 3.60GHz", 3600, 4, 8, true, 55 },
+    { L"Intel(R) Core(TM) i5-7300U CPU @ 2.60GHz", 2712, 2, 4, true, 50 },
+    { L"Intel(R) Core(TM) i5-6500 CPU @ 3.20GHz", 3192, 4, 4, true, 45 },
+    { L"Intel(R) Core(TM) i7-4790 CPU @ 3.60GHz", 3600, 4, 8, true, 30 },
+    { L"Intel(R) Core(TM) i5-3470 CPU @ 3.20GHz", 3201, 4, 4, true, 20 },
+    { L"Intel(R) Core(TM) i3-2120 CPU @ 3.30GHz", 3300, 2, 4, true, 10 },
+    { L"Intel(R) Core(TM)2 Duo CPU E8400 @ 3.00GHz", 3000, 2, 2, true, 6 },
+    { L"Intel(R) Pentium(R) 4 CPU 3.00GHz", 3000, 1, 2, false, 2 },
+    { L"Intel(R) Celeron(R) N4020 CPU @ 1.10GHz", 1101, 2, 2, true, 15 },
+    { L"Intel(R) Celeron(R) CPU N3350 @ 1.10GHz", 1101, 2, 2, true, 8 },
+    { L"Intel(R) Xeon(R) CPU E5-2680 v4 @ 2.40GHz", 2394, 14, 28, true, 10 },
+    { L"Intel(R) Xeon(R) Gold 6248 CPU @ 2.50GHz", 2494, 20, 40, true, 8 },
+    { L"AMD Ryzen 5 3600 6-Core Processor", 3600, 6, 12, true, 35 },
+    { L"AMD Ryzen 5 PRO 4650U with Radeon Graphics", 2100, 6, 12, true, 40 },
+    { L"AMD Ryzen 7 5800U with Radeon Graphics", 1901, 8, 16, true, 30 },
+    { L"AMD Ryzen 7 PRO 7840U w/ Radeon 780M Graphics", 3301, 8, 16, true, 12 },
+    { L"AMD Ryzen 5 2500U with Radeon Vega Mobile Gfx", 2000, 4, 8, true, 12 },
+    { L"AMD Ryzen 7 1700 Eight-Core Processor", 3000, 8, 16, true, 6 },
+    { L"AMD A10-9700 RADEON R7, 10 COMPUTE CORES 4C+6G", 3500, 4, 4, true, 5 },
+    { L"AMD EPYC 7763 64-Core Processor", 2450, 64, 128, true, 3 },
+    { L"Snapdragon (TM) 8cx @ 3.0 GHz", 2995, 8, 8, true, 4 },
+    { L"Common KVM processor", 2400, 2, 2, true, 10 },
+    { L"Intel(R) Xeon(R) CPU E5-2690 v4 @ 2.60GHz", 0, 0, 4, true, 4 },  // VM guest reporting no speed/cores
+};
+static const size_t CPU_POOL_COUNT = sizeof(CPU_POOL) / sizeof(CPU_POOL[0]);
+
+// --- Other Distributions (value tables with matching relative weights) ---
+static const unsigned RAM_GB[] = { 1, 2, 4, 8, 16, 32, 64 };
+static const unsigned RAM_WEIGHTS[] = { 1, 4, 15, 38, 30, 10, 2 };
+struct SyntheticScreen { int Width; int Height; };
+static const SyntheticScreen SCREENS[] = { { 1024, 768 }, { 1280, 800 }, { 1366, 768 }, { 1600, 900 }, { 1920, 1080 }, { 1920, 1200 }, { 2560, 1440 } };
+static const unsigned SCREEN_WEIGHTS[] = { 3, 4, 18, 8, 55, 4, 8 };
+static const WORD DX_LEVELS[] = { 0, 0x0A01, 0x0B00, 0x0B01, 0x0C00, 0x0C01, 0x0C02 };  // 0 = not detected
+static const unsigned DX_WEIGHTS[] = { 5, 3, 4, 10, 15, 55, 8 };
+static const WORD WDDM_VERSIONS[] = { 0, 0x0101, 0x0102, 0x0200, 0x0205, 0x0207, 0x0300 };
+static const unsigned WDDM_WEIGHTS[] = { 5, 3, 5, 5, 12, 50, 20 };
+enum { TpmNone, Tpm12, Tpm20Ready, Tpm20Disabled };
+static const unsigned TPM_WEIGHTS[] = { 15, 10, 70, 5 };
+static const wchar_t* const OS_CAPTIONS[] = { L"Microsoft Windows 10 Pro", L"Microsoft Windows 10 Enterprise", L"Microsoft Windows 11 Pro", L"Microsoft Windows 11 Enterprise", L"Microsoft Windows 7 Professional" };
+static const unsigned OS_WEIGHTS[] = { 35, 25, 20, 15, 5 };
+#define COUNT_OF(table) (sizeof(table) / sizeof(table[0]))
+
+SyntheticFleet::SyntheticFleet(unsigned long long seed) : state(seed) {
+    for (const SyntheticCpu& cpu : CPU_POOL) { cpuLevels.push_back(MatchCpuList(cpu.Name)); cpuWeights.push_back(cpu.Weight); }
+}
+
+unsigned long long SyntheticFleet::Random() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL; z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+size_t SyntheticFleet::Pick(const unsigned* weights, size_t count) {
+    unsigned total = 0; for (size_t i = 0; i < count; ++i) total += weights[i];
+    unsigned long long roll = Random() % total;
+    for (size_t i = 0; i < count; ++i) { if (roll < weights[i]) return i; roll -= weights[i]; }
+    return count - 1;
+}
+
+void SyntheticFleet::Next(MachineRecord& record) {
+    record = MachineRecord();
+    char id[32]; snprintf(id, sizeof(id), "SYN-%08llu", ++generated);
+    record.MachineId.assign(id, id + strlen(id));
+
+    // --- CPU ---
+    const size_t c = Pick(cpuWeights.data(), CPU_POOL_COUNT);
+    const SyntheticCpu& cpu = CPU_POOL[c];
+    record.Cpu.Name = cpu.Name; record.Cpu.MaxClockSpeed = cpu.MHz; record.Cpu.NumberOfCores = cpu.Cores; record.Cpu.NumberOfLogicalProcessors = cpu.Threads;
+    record.Cpu.Is64BitCapable = cpu.Is64Bit; record.Cpu.Architecture = cpu.Is64Bit ? L"x64 (64-bit)" : L"x86 (32-bit)";
+    record.Cpu.MinCpuGenerationLevel = cpuLevels[c];
+
+    // --- RAM / Disk (free space roughly log-uniform between 8 GB and 1 TB) ---
+    record.Ram.TotalPhysicalBytes = (ULONGLONG)RAM_GB[Pick(RAM_WEIGHTS, COUNT_OF(RAM_WEIGHTS))] * 1024 * 1024 * 1024;
+    const ULONGLONG totalGB = 128ULL << (Random() % 4);  // 128 GB .. 1 TB drives
+    ULONGLONG freeGB = 8ULL << (Random() % 7); freeGB += Random() % freeGB; if (freeGB > totalGB) freeGB = totalGB - 1;
+    record.Disk.TotalBytes = totalGB * 1024 * 1024 * 1024; record.Disk.FreeBytesAvailableToUser = freeGB * 1024 * 1024 * 1024; record.Disk.DriveLetter = L'C';
+
+    // --- OS ---
+    record.Os.Caption = OS_CAPTIONS[Pick(OS_WEIGHTS, COUNT_OF(OS_WEIGHTS))];
+    record.Os.OSArchitecture = cpu.Is64Bit ? L"64-bit" : L"32-bit";
+
+    // --- Firmware / Secure Boot (UEFI more likely on newer CPUs) ---
+    const bool uefi = (Random() % 100) < (cpuLevels[c] >= CpuListSupported ? 92u : 55u);
+    record.Firmware.FirmwareType = uefi ? FirmwareUefi : FirmwareBios; record.Firmware.Source = SourceApi;
+    if (uefi) {
+        const unsigned roll = (unsigned)(Random() % 100);
+        record.Security.SecureBootCapable = true; record.Security.SecureBootSource = SourceApi;
+        if (roll < 72) { record.Security.SecureBoot = SecureBootOn; record.Security.SecureBootEnabled = true; }
+        else if (roll < 95) { record.Security.SecureBoot = SecureBootOff; }
+        else { record.Security.SecureBoot = SecureBootNeedsAdmin; }
+    } else { record.Security.SecureBoot = SecureBootNotApplicable; }
+
+    // --- TPM ---
+    switch (Pick(TPM_WEIGHTS, COUNT_OF(TPM_WEIGHTS))) {
+        case Tpm12: record.Security.TpmFound = true; record.Security.TpmEnabled = true; record.Security.TpmSpecVersionMajor = 1; record.Security.TpmSpecVersionMinor = 2; record.Security.TpmVersionString = L"1.2"; break;
+        case Tpm20Ready: record.Security.TpmFound = true; record.Security.TpmEnabled = true; record.Security.TpmSpecVersionMajor = 2; record.Security.TpmVersionString = L"2.0"; break;
+        case Tpm20Disabled: record.Security.TpmFound = true; record.Security.TpmSpecVersionMajor = 2; record.Security.TpmVersionString = L"2.0"; break;
+        default: record.Security.TpmVersionString = L"Not Found"; break;
+    }
+
+    // --- Graphics / Display ---
+    record.Graphics.Name = L"Synthetic Display Adapter";
+    record.Graphics.DirectXFeatureLevel = DX_LEVELS[Pick(DX_WEIGHTS, COUNT_OF(DX_WEIGHTS))];
+    record.Graphics.WDDMVersion = WDDM_VERSIONS[Pick(WDDM_WEIGHTS, COUNT_OF(WDDM_WEIGHTS))];
+    const SyntheticScreen& screen = SCREENS[Pick(SCREEN_WEIGHTS, COUNT_OF(SCREEN_WEIGHTS))];
+    record.Screen.Width = screen.Width; record.Screen.Height = screen.Height;
+}
+
+void SyntheticFleet::Generate(size_t count, std::vector<MachineRecord>& records) {
+    records.resize(count);
+    for (MachineRecord& record : records) Next(record);
+}
+
+// --- Custom Baselines (department / image / VDI tier profiles) ---
+static const UINT PROFILE_MHZ[] = { 0, 1000, 1400, 1800, 2000, 2400 };
+static const UINT PROFILE_CORES[] = { 0, 1, 2, 4, 6, 8 };
+static const unsigned PROFILE_RAM_GB[] = { 0, 2, 4, 8, 16, 32 };
+static const unsigned PROFILE_DISK_GB[] = { 0, 16, 32, 64, 128, 256 };
+static const SyntheticScreen PROFILE_SCREENS[] = { { 0, 0 }, { 800, 600 }, { 1280, 720 }, { 1366, 768 }, { 1920, 1080 } };
+
+void SyntheticFleet::NextProfile(WindowsRequirements& profile) {
+    profile = WindowsRequirements(); profile.Name = L"Synthetic Baseline";
+    profile.MinCpuSpeedMHz = PROFILE_MHZ[Random() % COUNT_OF(PROFILE_MHZ)]; profile.MinCpuCores = PROFILE_CORES[Random() % COUNT_OF(PROFILE_CORES)];
+    profile.Require64Bit = (Random() % 100) < 70; profile.MinCpuGenerationLevel = (Random() % 100) < 40 ? CpuListSupported : 0;
+    profile.MinRamBytes = (ULONGLONG)PROFILE_RAM_GB[Random() % COUNT_OF(PROFILE_RAM_GB)] * 1024 * 1024 * 1024;
+    profile.MinDiskFreeBytes = (ULONGLONG)PROFILE_DISK_GB[Random() % COUNT_OF(PROFILE_DISK_GB)] * 1024 * 1024 * 1024;
+    profile.MinDirectXFeatureLevelMajor = 9 + (UINT)(Random() % 4); profile.MinWDDMVersionMajor = (UINT)(Random() % 3);
+    const SyntheticScreen& screen = PROFILE_SCREENS[Random() % COUNT_OF(PROFILE_SCREENS)];
+    profile.MinScreenWidth = (UINT)screen.Width; profile.MinScreenHeight = (UINT)screen.Height;
+    profile.RequireUEFI = (Random() % 100) < 50; profile.RequireSecureBoot = profile.RequireUEFI && (Random() % 100) < 60;
+    profile.RequireTpm = (Random() % 100) < 50; profile.MinTpmVersionMajor = profile.RequireTpm ? 1 + (UINT)(Random() % 2) : 0;
+}
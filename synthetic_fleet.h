@@ -0,0 +1,28 @@
+#ifndef SYNTHETIC_FLEET_H_INCLUDED
+#define SYNTHETIC_FLEET_H_INCLUDED
+
+#include <vector>
+#include "sysinfo.h"
+
+// --- Seeded Synthetic Machine Generator ---
+// Produces MachineRecords with fleet-like distributions (RAM sizes, core counts, TPM 2.0/1.2/none, UEFI/BIOS mix, a
+// small pool of real CPU names repeated with a skewed popularity) for benchmarks and batch-mode testing. The same seed
+// always yields the same sequence on every platform; nothing is read from the live system or from stdin.
+class SyntheticFleet {
+public:
+    explicit SyntheticFleet(unsigned long long seed = 1);
+    void Next(MachineRecord& record);             // Overwrites every field (MachineId "SYN-00000001", ...)
+    void Generate(size_t count, std::vector<MachineRecord>& records);
+    // Custom baseline with thresholds drawn from the round values real ones use (name is a shared literal)
+    void NextProfile(WindowsRequirements& profile);
+    unsigned long long Generated() const { return generated; }
+private:
+    unsigned long long Random();                  // splitmix64
+    size_t Pick(const unsigned* weights, size_t count); // Index drawn with probability weights[i] / sum
+    unsigned long long state;
+    unsigned long long generated = 0;
+    std::vector<UINT> cpuLevels;                  // MatchCpuList result per CPU pool entry, computed once
+    std::vector<unsigned> cpuWeights;
+};
+
+#endif // SYNTHETIC_FLEET_H_INCLUDED
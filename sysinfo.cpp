@@ -0,0 +1,105 @@
+#include "sysinfo.h"
+
+#include <cwchar>         // For wcstoul
+
+// --- Rendering (appends ASCII; the report path builds its text without temporaries) ---
+static const char* SourceSuffix(DetectionSource source) {
+    switch (source) {
+        case SourceApi: return " (API)"; case SourceWmi: return " (WMI)";
+        case SourceAssumed: return " (Assumed)"; case SourceSimulated: return " (Simulated)"; default: return "";
+    }
+}
+
+static void AppendDecimal(std::string& out, unsigned long value) { // Fixed buffer, no std::to_string temporary
+    char digits[20]; int count = 0;
+    do { digits[count++] = (char)('0' + value % 10); value /= 10; } while (value);
+    while (count) out += digits[--count];
+}
+
+void AppendFirmwareText(std::string& out, const FirmwareInfo& firmware) {
+    switch (firmware.FirmwareType) {
+        case FirmwareUefi: out += "UEFI"; break;
+        case FirmwareBios: out += firmware.Source == SourceAssumed ? "BIOS (Assumed)" : "BIOS"; break;
+        default: out += firmware.Source == SourceApi ? "Unknown (API)" : "Unknown";
+    }
+}
+
+void AppendSecureBootText(std::string& out, const SecurityInfo& security) {
+    const char* suffix = SourceSuffix(security.SecureBootSource);
+    switch (security.SecureBoot) {
+        case SecureBootOn: out += "Enabled"; out += suffix; break;
+        case SecureBootOff: out += "Disabled"; out += suffix; break;
+        case SecureBootNotFound: out += "Not Found"; out += suffix; break;
+        case SecureBootNotApplicable: out += "Not Applicable (BIOS)"; break;
+        case SecureBootNeedsAdmin: out += "Requires Admin"; out += suffix; break;
+        case SecureBootQueryFailed:
+            if (security.SecureBootSource == SourceApi) { out += "Error (API Code: "; AppendDecimal(out, security.SecureBootErrorCode); out += ')'; }
+            else { out += "Query Failed"; out += suffix; }
+            break;
+        case SecureBootApiUnavailable: out += "N/A (API Unavailable)"; break;
+        default: out += "N/A";
+    }
+}
+
+void AppendVersionText(std::string& out, WORD packed, char separator) {
+    if (packed == 0) { out += "N/A"; return; }
+    AppendDecimal(out, VersionMajor(packed)); out += separator; AppendDecimal(out, VersionMinor(packed));
+}
+
+std::wstring FirmwareText(const FirmwareInfo& firmware) { std::string text; AppendFirmwareText(text, firmware); return std::wstring(text.begin(), text.end()); }
+std::wstring SecureBootText(const SecurityInfo& security) { std::string text; AppendSecureBootText(text, security); return std::wstring(text.begin(), text.end()); }
+std::wstring VersionText(WORD packed, wchar_t separator) { std::string text; AppendVersionText(text, packed, (char)separator); return std::wstring(text.begin(), text.end()); }
+
+// --- Parsing (import only; never called while evaluating) ---
+static bool StartsWith(const std::wstring& text, const wchar_t* prefix) { return text.compare(0, wcslen(prefix), prefix) == 0; }
+
+static DetectionSource SourceFromSuffix(const std::wstring& text) {
+    if (text.find(L"(API") != std::wstring::npos) return SourceApi;
+    if (text.find(L"(WMI") != std::wstring::npos) return SourceWmi;
+    if (text.find(L"(Simulated") != std::wstring::npos) return SourceSimulated;
+    if (text.find(L"(Assumed") != std::wstring::npos) return SourceAssumed;
+    return SourceNone;
+}
+
+bool ParseFirmwareText(const std::wstring& text, FirmwareInfo& firmware) {
+    firmware.Source = SourceFromSuffix(text);
+    if (text == L"UEFI") firmware.FirmwareType = FirmwareUefi;
+    else if (StartsWith(text, L"BIOS")) firmware.FirmwareType = FirmwareBios;
+    else if (StartsWith(text, L"Unknown") || text.empty()) { firmware.FirmwareType = FirmwareUnknown; if (text.find(L'(') != std::wstring::npos) firmware.Source = SourceApi; } // "Unknown (Kernel32 Error)" etc.
+    else return false;
+    return true;
+}
+
+bool ParseSecureBootText(const std::wstring& text, SecurityInfo& security) {
+    security.SecureBootSource = SourceFromSuffix(text); security.SecureBootErrorCode = 0;
+    if (StartsWith(text, L"Enabled")) security.SecureBoot = SecureBootOn;
+    else if (StartsWith(text, L"Disabled")) security.SecureBoot = SecureBootOff;
+    else if (StartsWith(text, L"Not Found")) security.SecureBoot = SecureBootNotFound;
+    else if (StartsWith(text, L"Not Applicable")) { security.SecureBoot = SecureBootNotApplicable; security.SecureBootSource = SourceNone; }
+    else if (StartsWith(text, L"Requires Admin")) security.SecureBoot = SecureBootNeedsAdmin;
+    else if (StartsWith(text, L"Query Failed")) security.SecureBoot = SecureBootQueryFailed;
+    else if (StartsWith(text, L"Error")) {
+        security.SecureBoot = SecureBootQueryFailed;
+        const size_t code = text.find(L"Code: ");
+        if (code != std::wstring::npos) security.SecureBootErrorCode = (UINT32)wcstoul(text.c_str() + code + 6, NULL, 10);
+    }
+    else if (text == L"N/A (API Unavailable)") { security.SecureBoot = SecureBootApiUnavailable; security.SecureBootSource = SourceNone; }
+    else if (StartsWith(text, L"N/A") || text.empty()) { security.SecureBoot = SecureBootUnknown; security.SecureBootSource = SourceNone; } // Older exports: "N/A (ConnectServer ROOT\WMI failed)" ...
+    else return false;
+    return true;
+}
+
+bool ParseVersionText(const std::wstring& text, WORD& packed) {
+    if (text.empty() || text == L"N/A") { packed = 0; return true; }
+    wchar_t* end = NULL;
+    const unsigned long major = wcstoul(text.c_str(), &end, 10);
+    if (end == text.c_str() || major == 0 || major > 0xFF) return false;
+    unsigned long minor = 0;
+    if (*end == L'.' || *end == L'_') {  // "12_1" (feature level) or "2.0" (WDDM); a bare "12" means 12.0
+        const wchar_t* start = end + 1;
+        minor = wcstoul(start, &end, 10);
+        if (end == start || minor > 0xFF) return false;
+    }
+    if (*end != L'\0') return false;
+    packed = PackVersion((UINT)major, (UINT)minor); return true;
+}
@@ -0,0 +1,97 @@
+#ifndef SYSINFO_H_INCLUDED
+#define SYSINFO_H_INCLUDED
+
+#include <string>         // For std::wstring fields
+
+#ifdef _WIN32
+#include <windows.h>      // UINT, UINT32, ULONGLONG, WORD
+#else
+// Portable stand-ins for the Win32 integer types used by the info structs (batch/evaluation code builds without windows.h)
+typedef unsigned short WORD; typedef unsigned int UINT; typedef unsigned int UINT32; typedef unsigned long long ULONGLONG;
+#endif
+
+// --- Typed Detection State (text only exists at render/export time; see the *Text helpers below) ---
+enum DetectionSource : unsigned char { SourceNone, SourceApi, SourceWmi, SourceAssumed, SourceSimulated }; // Where a value came from
+enum FirmwareKind : unsigned char { FirmwareUnknown, FirmwareBios, FirmwareUefi };
+enum SecureBootState : unsigned char {
+    SecureBootUnknown,          // Not determined (firmware type unknown, nothing tried)
+    SecureBootOn, SecureBootOff,
+    SecureBootNotFound,         // Firmware variable / WMI instance not present
+    SecureBootNotApplicable,    // BIOS firmware
+    SecureBootNeedsAdmin,       // ERROR_PRIVILEGE_NOT_HELD reading the firmware variable
+    SecureBootQueryFailed,      // Error code in SecurityInfo::SecureBootErrorCode (0 for a WMI failure)
+    SecureBootApiUnavailable    // GetFirmwareEnvironmentVariableW missing and no WMI answer
+};
+
+// Packed major.minor version (DirectX feature level 12_1 -> 0x0C01, WDDM 2.0 -> 0x0200); 0 = not detected
+inline WORD PackVersion(UINT major, UINT minor) { return (WORD)(((major & 0xFF) << 8) | (minor & 0xFF)); }
+inline UINT VersionMajor(WORD packed) { return packed >> 8; }
+inline UINT VersionMinor(WORD packed) { return packed & 0xFF; }
+
+// --- Structures for Collected System Info ---
+struct CpuInfo {
+    std::wstring Name = L"N/A"; std::wstring Architecture = L"N/A"; UINT MaxClockSpeed = 0;
+    UINT NumberOfCores = 0; UINT NumberOfLogicalProcessors = 0; bool Is64BitCapable = false;
+    UINT MinCpuGenerationLevel = 0; // CpuListLevel from the supported-processor list (cpu_list.h); entered directly in Simulation Mode
+};
+struct RamInfo { ULONGLONG TotalPhysicalBytes = 0; };
+struct DiskInfo { ULONGLONG TotalBytes = 0; ULONGLONG FreeBytesAvailableToUser = 0; wchar_t DriveLetter = L'?'; };
+struct OsInfo { std::wstring Caption = L"N/A"; std::wstring Version = L"N/A"; std::wstring BuildNumber = L"N/A"; std::wstring OSArchitecture = L"N/A"; std::wstring ServicePackMajorVersion = L"N/A"; };
+struct FirmwareInfo { FirmwareKind FirmwareType = FirmwareUnknown; DetectionSource Source = SourceNone; };
+struct GraphicsInfo { std::wstring Name = L"N/A"; UINT32 AdapterRAM = 0; std::wstring DriverVersion = L"N/A"; std::wstring VideoProcessor = L"N/A"; WORD DirectXFeatureLevel = 0; WORD WDDMVersion = 0; };
+struct ScreenInfo { int Width = 0; int Height = 0; };
+struct SecurityInfo {
+    bool TpmEnabled = false; bool TpmFound = false; UINT32 TpmSpecVersionMajor = 0; UINT32 TpmSpecVersionMinor = 0; std::wstring TpmVersionString = L"N/A";
+    bool SecureBootEnabled = false; bool SecureBootCapable = false;
+    SecureBootState SecureBoot = SecureBootUnknown; DetectionSource SecureBootSource = SourceNone; UINT32 SecureBootErrorCode = 0;
+};
+struct DirectXInfo { std::wstring InstalledVersion = L"N/A"; };
+
+// --- Record Sections (one per detection probe; bitmask values) ---
+enum RecordSection {
+    SectionCpu = 1 << 0, SectionRam = 1 << 1, SectionDisk = 1 << 2, SectionOs = 1 << 3, SectionFirmware = 1 << 4,
+    SectionScreen = 1 << 5, SectionDirectX = 1 << 6, SectionSecurity = 1 << 7, SectionGraphics = 1 << 8,
+    SectionAll = (1 << 9) - 1
+};
+enum { RecordSectionCount = 9 };   // Section index i <-> bit (1 << i)
+
+// --- One Machine's Worth of Detection Data (live, simulated or read from an inventory export) ---
+// Only the values checks read are typed (firmware, Secure Boot, DirectX/WDDM levels). The 13 display strings (MachineId,
+// names, OS and driver versions, ...) stay std::wstrings, shown as probed and never parsed by a check, so the record is
+// over 500 bytes on 64-bit builds. The under-64-byte form is MachineFeatures (evaluate.h), extracted once per machine;
+// batch mode keeps only that and the names (MappedInventory::ParsedRows). Provenance (DetectionSource) is recorded for
+// firmware and Secure Boot only, the two values whose display text names where they came from.
+struct MachineRecord {
+    std::wstring MachineId = L"local";
+    CpuInfo Cpu; RamInfo Ram; DiskInfo Disk; OsInfo Os; FirmwareInfo Firmware;
+    GraphicsInfo Graphics; ScreenInfo Screen; SecurityInfo Security; DirectXInfo DirectX;
+    UINT TimedOutSections = 0;   // RecordSection bits whose probe missed its deadline (values are defaults, checks become [WARN])
+};
+
+
+// --- Display / Export Text for the Typed Fields (sysinfo.cpp) ---
+std::wstring FirmwareText(const FirmwareInfo& firmware);       // "UEFI", "BIOS", "BIOS (Assumed)", "Unknown"
+std::wstring SecureBootText(const SecurityInfo& security);     // "Enabled (API)", "Requires Admin (API)", "Error (API Code: 5)", ...
+std::wstring VersionText(WORD packed, wchar_t separator);      // "12_1" / "2.0"; "N/A" when not detected
+// The same text appended to a UTF-8 buffer (report building: no temporaries once out has grown)
+void AppendFirmwareText(std::string& out, const FirmwareInfo& firmware);
+void AppendSecureBootText(std::string& out, const SecurityInfo& security);
+void AppendVersionText(std::string& out, WORD packed, char separator);
+// Inverse of the above, for inventory/snapshot import (also accepts the free-form strings older exports contain)
+bool ParseFirmwareText(const std::wstring& text, FirmwareInfo& firmware);
+bool ParseSecureBootText(const std::wstring& text, SecurityInfo& security);
+bool ParseVersionText(const std::wstring& text, WORD& packed);
+
+
+// --- Requirements Structure ---
+struct WindowsRequirements {
+    const wchar_t* Name = L"";  // Literal-type member so built-in profiles can live in a constexpr table
+    UINT MinCpuSpeedMHz = 0; UINT MinCpuCores = 0; bool Require64Bit = false; UINT MinCpuGenerationLevel = 0;
+    ULONGLONG MinRamBytes = 0; ULONGLONG MinDiskFreeBytes = 0;
+    UINT MinDirectXFeatureLevelMajor = 0; UINT MinWDDMVersionMajor = 0;
+    UINT MinScreenWidth = 0; UINT MinScreenHeight = 0;
+    bool RequireUEFI = false; bool RequireSecureBoot = false; bool RequireTpm = false; UINT MinTpmVersionMajor = 0;
+    bool RequireInternetForSetup = false;
+};
+
+#endif // SYSINFO_H_INCLUDED
@@ -0,0 +1,168 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>         // For snprintf
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceEnabled(false);
+
+// --- Per-thread Event Buffers ---
+namespace {
+struct TraceEvent {
+    const char* Name; const char* Category;
+    unsigned long long StartNs; unsigned long long DurationNs; // Counters: StartNs = sample time, DurationNs unused
+    long long Value; char Phase;                                 // 'X' complete span, 'C' counter sample
+};
+
+// Owned jointly by the registry and the recording thread, so events from a probe thread that exits (or is abandoned
+// past its deadline) stay exportable. The mutex is only contended while exporting.
+struct TraceBuffer {
+    std::mutex Mutex;
+    std::vector<TraceEvent> Events;
+    unsigned Thread = 0; const char* ThreadName = nullptr;
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<TraceBuffer>> registry;
+unsigned long long traceOriginNs = 0;
+thread_local std::shared_ptr<TraceBuffer> localBuffer;
+
+TraceBuffer& LocalBuffer() {
+    if (!localBuffer) {
+        localBuffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        localBuffer->Thread = (unsigned)registry.size() + 1; registry.push_back(localBuffer);
+    }
+    return *localBuffer;
+}
+
+void Append(const TraceEvent& event) {
+    TraceBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.Mutex);
+    buffer.Events.push_back(event);
+}
+
+// Snapshot of every buffer taken under its lock, so export never races a late probe thread
+void CollectEvents(std::vector<std::pair<unsigned, TraceEvent>>& events, std::vector<std::pair<unsigned, const char*>>& threadNames) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::shared_ptr<TraceBuffer>& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+        for (const TraceEvent& event : buffer->Events) events.push_back(std::make_pair(buffer->Thread, event));
+        if (buffer->ThreadName) threadNames.push_back(std::make_pair(buffer->Thread, buffer->ThreadName));
+    }
+}
+
+void AppendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* p = text; *p; ++p) {
+        const unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') { out += '\\'; out += (char)c; }
+        else if (c < 0x20) { char escaped[8]; snprintf(escaped, sizeof(escaped), "\\u%04x", c); out += escaped; }
+        else out += (char)c;
+    }
+    out += '"';
+}
+}
+
+// --- Recording ---
+unsigned long long TraceNowNs() {
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() + 1;
+}
+
+void TraceStart() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::shared_ptr<TraceBuffer>& buffer : registry) { std::lock_guard<std::mutex> bufferLock(buffer->Mutex); buffer->Events.clear(); }
+        traceOriginNs = TraceNowNs();
+    }
+    traceEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceStop() { traceEnabled.store(false, std::memory_order_relaxed); }
+
+void TraceRecordSpan(const char* name, const char* category, unsigned long long startNs, unsigned long long endNs) {
+    TraceEvent event = { name, category, startNs, endNs > startNs ? endNs - startNs : 0, 0, 'X' };
+    Append(event);
+}
+
+void TraceRecordCounter(const char* name, long long value) {
+    TraceEvent event = { name, "counter", TraceNowNs(), 0, value, 'C' };
+    Append(event);
+}
+
+void TraceSetThreadName(const char* name) {
+    TraceBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.Mutex);
+    buffer.ThreadName = name;
+}
+
+// --- Chrome Trace Export ---
+void WriteChromeTrace(std::ostream& out) {
+    std::vector<std::pair<unsigned, TraceEvent>> events; std::vector<std::pair<unsigned, const char*>> threadNames;
+    CollectEvents(events, threadNames);
+    std::stable_sort(events.begin(), events.end(), [](const std::pair<unsigned, TraceEvent>& a, const std::pair<unsigned, TraceEvent>& b) { return a.second.StartNs < b.second.StartNs; });
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"; char number[96]; bool first = true;
+    for (const std::pair<unsigned, const char*>& thread : threadNames) {
+        if (!first) json += ",\n";
+        snprintf(number, sizeof(number), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", thread.first);
+        json += number; AppendJsonString(json, thread.second); json += "}}"; first = false;
+    }
+    for (const std::pair<unsigned, TraceEvent>& entry : events) {
+        const TraceEvent& e = entry.second;
+        if (!first) json += ",\n";
+        json += "{\"name\":"; AppendJsonString(json, e.Name); json += ",\"cat\":"; AppendJsonString(json, e.Category);
+        const double ts = (e.StartNs >= traceOriginNs ? e.StartNs - traceOriginNs : 0) / 1000.0; // Microseconds
+        if (e.Phase == 'X') snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", entry.first, ts, e.DurationNs / 1000.0);
+        else snprintf(number, sizeof(number), ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%lld}}", entry.first, ts, e.Value);
+        json += number; first = false;
+    }
+    json += "\n]}\n";
+    out << json;
+}
+
+bool SaveChromeTrace(const std::string& path, std::string& error) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) { error = "Could not create trace file '" + path + "'"; return false; }
+    WriteChromeTrace(out);
+    if (!out) { error = "Could not write trace file '" + path + "'"; return false; }
+    return true;
+}
+
+// --- Summary Table ---
+void FormatTraceSummary(std::string& out) {
+    std::vector<std::pair<unsigned, TraceEvent>> events; std::vector<std::pair<unsigned, const char*>> threadNames;
+    CollectEvents(events, threadNames);
+    struct SpanTotals { size_t Count = 0; unsigned long long TotalNs = 0; unsigned long long MaxNs = 0; };
+    struct CounterTotals { size_t Samples = 0; long long Last = 0; unsigned long long LastAt = 0; };
+    // Keyed by text, not pointer (the same literal may exist once per translation unit); spans also by category, so a
+    // probe's "timeout" span is not merged with the probe's own (late) span of the same name
+    std::map<std::pair<std::string, std::string>, SpanTotals> spans; std::map<std::string, CounterTotals> counters;
+    for (const std::pair<unsigned, TraceEvent>& entry : events) {
+        const TraceEvent& e = entry.second;
+        if (e.Phase == 'X') { SpanTotals& t = spans[std::make_pair(std::string(e.Category), std::string(e.Name))]; ++t.Count; t.TotalNs += e.DurationNs; t.MaxNs = std::max(t.MaxNs, e.DurationNs); }
+        else { CounterTotals& c = counters[e.Name]; ++c.Samples; if (e.StartNs >= c.LastAt) { c.Last = e.Value; c.LastAt = e.StartNs; } }
+    }
+    typedef std::pair<std::pair<std::string, std::string>, SpanTotals> SpanRow;
+    std::vector<SpanRow> rows(spans.begin(), spans.end());
+    std::stable_sort(rows.begin(), rows.end(), [](const SpanRow& a, const SpanRow& b) { return a.second.TotalNs > b.second.TotalNs; });
+
+    char line[256];
+    snprintf(line, sizeof(line), "%-40s %-10s %8s %12s %12s %12s\n", "Span", "Category", "Count", "Total ms", "Mean ms", "Max ms"); out += line;
+    for (const SpanRow& row : rows) {
+        const SpanTotals& t = row.second;
+        snprintf(line, sizeof(line), "%-40.40s %-10.10s %8zu %12.3f %12.3f %12.3f\n", row.first.second.c_str(), row.first.first.c_str(), t.Count, t.TotalNs / 1e6, t.TotalNs / 1e6 / (double)t.Count, t.MaxNs / 1e6);
+        out += line;
+    }
+    if (counters.empty()) return;
+    snprintf(line, sizeof(line), "%-40s %-10s %8s %12s\n", "Counter", "", "Samples", "Last"); out += line;
+    for (const std::pair<const std::string, CounterTotals>& counter : counters) {
+        snprintf(line, sizeof(line), "%-40.40s %-10s %8zu %12lld\n", counter.first.c_str(), "", counter.second.Samples, counter.second.Last);
+        out += line;
+    }
+}
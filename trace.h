@@ -0,0 +1,52 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+// --- Lightweight Tracing (--trace <file.json>) ---
+// Scoped spans and counters around probes, WMI calls, fallback branches and the evaluate/render phases. Recording is
+// off until TraceStart(); a disabled TRACE_SPAN costs one relaxed atomic load and a branch. Each thread appends to its
+// own buffer, so probe threads never contend with each other. Define WINREADYCHECK_NO_TRACE to compile the macros out.
+// Names and categories are stored as pointers: pass string literals (or strings that outlive the trace).
+extern std::atomic<bool> traceEnabled;
+inline bool TraceEnabled() { return traceEnabled.load(std::memory_order_relaxed); }
+
+void TraceStart();                  // Discards earlier events and starts recording
+void TraceStop();
+unsigned long long TraceNowNs();    // Steady clock; never 0
+void TraceRecordSpan(const char* name, const char* category, unsigned long long startNs, unsigned long long endNs);
+void TraceRecordCounter(const char* name, long long value);
+void TraceSetThreadName(const char* name); // Shown as the track name in trace viewers
+
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) : name(name), category(category), startNs(TraceEnabled() ? TraceNowNs() : 0) {}
+    ~TraceSpan() { if (startNs) TraceRecordSpan(name, category, startNs, TraceNowNs()); }
+    TraceSpan(const TraceSpan&) = delete; TraceSpan& operator=(const TraceSpan&) = delete;
+private:
+    const char* name; const char* category; unsigned long long startNs;
+};
+
+#ifndef WINREADYCHECK_NO_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name, category) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name, category)
+#define TRACE_COUNTER(name, value) do { if (TraceEnabled()) TraceRecordCounter(name, (long long)(value)); } while (0)
+#define TRACE_THREAD_NAME(name) do { if (TraceEnabled()) TraceSetThreadName(name); } while (0)
+#else
+#define TRACE_SPAN(name, category) do {} while (0)
+#define TRACE_COUNTER(name, value) do { (void)sizeof(value); } while (0) // Unevaluated; keeps counter-only locals "used"
+#define TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+// --- Export ---
+// Chrome trace-event JSON ({"traceEvents":[...]}), loadable in chrome://tracing, Perfetto or Speedscope. Spans still
+// open in abandoned probe threads are not included.
+void WriteChromeTrace(std::ostream& out);
+bool SaveChromeTrace(const std::string& path, std::string& error);
+// Plain-text table: one row per span name (count, total, mean, max ms; slowest total first), then the counters
+void FormatTraceSummary(std::string& out);
+
+#endif // TRACE_H_INCLUDED
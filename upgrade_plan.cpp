@@ -0,0 +1,268 @@
+#include "upgrade_plan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>         // For snprintf
+#include <cstdlib>        // For strtod
+#include <thread>
+#include "columnar.h"
+#include "cpu_list.h"     // CpuListSupported
+#include "profile_index.h" // SetProfileField
+
+// --- Replacement Parts (what a "replace" action puts into the machine) ---
+const UINT NEW_CPU_SPEED_MHZ = 3000; const UINT NEW_CPU_CORES = 8;   // A current mainstream part on the supported list
+const UINT NEW_GPU_DIRECTX = 12; const UINT NEW_GPU_WDDM = 3;
+const UINT NEW_DISPLAY_WIDTH = 1920; const UINT NEW_DISPLAY_HEIGHT = 1080;
+const UINT NEW_TPM_VERSION = 2;
+static const ULONGLONG GB = 1024ULL * 1024 * 1024;
+static const unsigned RAM_SIZES_GB[] = { 2, 4, 8, 16, 32, 64, 128 };          // Standard totals (DIMM pairs)
+static const unsigned DRIVE_SIZES_GB[] = { 128, 256, 512, 1024, 2048, 4096 };
+
+// --- Cost Table ---
+struct CostField { const char* Name; double UpgradeCosts::*Member; };
+static const CostField costFields[] = {
+    { "RamFixed", &UpgradeCosts::RamFixed }, { "RamPerGB", &UpgradeCosts::RamPerGB },
+    { "DiskCleanupPerGB", &UpgradeCosts::DiskCleanupPerGB }, { "DiskCleanupMaxGB", &UpgradeCosts::DiskCleanupMaxGB },
+    { "DiskReplaceFixed", &UpgradeCosts::DiskReplaceFixed }, { "DiskPerGB", &UpgradeCosts::DiskPerGB },
+    { "EnableTpm", &UpgradeCosts::EnableTpm }, { "TpmModule", &UpgradeCosts::TpmModule },
+    { "SwitchToUefi", &UpgradeCosts::SwitchToUefi }, { "EnableSecureBoot", &UpgradeCosts::EnableSecureBoot },
+    { "ReplaceGpu", &UpgradeCosts::ReplaceGpu }, { "ReplaceCpu", &UpgradeCosts::ReplaceCpu }, { "ReplaceDisplay", &UpgradeCosts::ReplaceDisplay },
+};
+
+bool SetUpgradeCost(UpgradeCosts& costs, const std::string& assignment, std::string& error) {
+    const size_t equals = assignment.find('=');
+    const std::string name = assignment.substr(0, equals), value = equals == std::string::npos ? std::string() : assignment.substr(equals + 1);
+    char* end = NULL; const double number = strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(number >= 0)) { error = "Bad cost '" + assignment + "' (expected Name=Value, Value >= 0)"; return false; }
+    for (const CostField& field : costFields) { if (name == field.Name) { costs.*field.Member = number; return true; } }
+    error = "Unknown cost '" + name + "'. Known costs:"; for (const CostField& field : costFields) { error += ' '; error += field.Name; }
+    return false;
+}
+
+// --- Action Groups (only groups behind a failing check are searched) ---
+enum UpgradeGroup { GroupRam, GroupDisk, GroupFirmware, GroupSecureBoot, GroupTpm, GroupCpu, GroupGpu, GroupDisplay, GroupCount };
+static const unsigned GROUP_CHECKS[GroupCount] = {
+    1u << CheckRam, 1u << CheckDisk, (1u << CheckFirmware) | (1u << CheckSecureBoot), 1u << CheckSecureBoot, 1u << CheckTpm,
+    (1u << CheckCpuSpeed) | (1u << CheckCpuCores) | (1u << CheckCpuArchitecture) | (1u << CheckCpuGeneration),
+    (1u << CheckDirectX) | (1u << CheckWddm), 1u << CheckDisplay
+};
+const int MAX_GROUP_OPTIONS = 2;
+
+static void ApplyStep(const UpgradeStep& step, ULONGLONG diskUsedBytes, MachineFeatures& f) {
+    switch (step.Action) {
+        case UpgradeRam: f.RamBytes = step.Amount; f.Flags &= ~FeatureRamTimedOut; break;
+        case UpgradeDiskCleanup: f.DiskFreeBytes += step.Amount; f.Flags &= ~FeatureDiskTimedOut; break;
+        case UpgradeDiskReplace: f.DiskFreeBytes = step.Amount - diskUsedBytes; f.Flags &= ~FeatureDiskTimedOut; break;
+        case UpgradeEnableTpm: f.Flags |= FeatureTpmReady; break;
+        case UpgradeTpmModule: f.TpmVersionMajor = std::max(f.TpmVersionMajor, NEW_TPM_VERSION); f.Flags |= FeatureTpmReady; break;
+        case UpgradeUefi: f.Flags = (f.Flags | FeatureUefi) & ~FeatureFirmwareUncertain; break;
+        case UpgradeSecureBoot: f.Flags = (f.Flags | FeatureSecureBootEnabled) & ~FeatureSecureBootUncertain; break;
+        case UpgradeGpu: f.DXLevel = std::max(f.DXLevel, NEW_GPU_DIRECTX); f.WDDMLevel = std::max(f.WDDMLevel, NEW_GPU_WDDM); f.Flags |= FeatureDXKnown | FeatureWDDMKnown; break;
+        case UpgradeCpu:
+            f.CpuSpeedMHz = std::max(f.CpuSpeedMHz, NEW_CPU_SPEED_MHZ); f.CpuCores = std::max(f.CpuCores, NEW_CPU_CORES);
+            f.CpuGenerationLevel = std::max(f.CpuGenerationLevel, (UINT)CpuListSupported); f.Flags = (f.Flags | FeatureIs64Bit) & ~FeatureCpuTimedOut; break;
+        case UpgradeDisplay: f.ScreenWidth = std::max(f.ScreenWidth, NEW_DISPLAY_WIDTH); f.ScreenHeight = std::max(f.ScreenHeight, NEW_DISPLAY_HEIGHT); break;
+        default: break;
+    }
+}
+
+// Cheapest sufficient options of one group, cheapest first where it is known (e.g. a cleanup before a new drive)
+static int GroupOptions(UpgradeGroup group, const WindowsRequirements& t, const MachineFeatures& f, ULONGLONG diskUsedBytes, const UpgradeCosts& c, UpgradeStep* options) {
+    int count = 0;
+    auto Add = [&](UpgradeAction action, ULONGLONG amount, double cost) { UpgradeStep step = { action, amount, cost }; options[count++] = step; };
+    switch (group) {
+        case GroupRam:
+            for (unsigned size : RAM_SIZES_GB) {
+                const ULONGLONG bytes = size * GB;
+                if (bytes >= t.MinRamBytes && bytes > f.RamBytes) { Add(UpgradeRam, bytes, c.RamFixed + c.RamPerGB * (double)(bytes - f.RamBytes) / GB); break; }
+            }
+            break;
+        case GroupDisk: {
+            if (t.MinDiskFreeBytes > f.DiskFreeBytes) {
+                const ULONGLONG needed = t.MinDiskFreeBytes - f.DiskFreeBytes;
+                if ((double)needed / GB <= c.DiskCleanupMaxGB) Add(UpgradeDiskCleanup, needed, c.DiskCleanupPerGB * (double)needed / GB);
+            }
+            for (unsigned size : DRIVE_SIZES_GB) {
+                const ULONGLONG bytes = size * GB;
+                if (bytes > diskUsedBytes && bytes - diskUsedBytes >= t.MinDiskFreeBytes) { Add(UpgradeDiskReplace, bytes, c.DiskReplaceFixed + c.DiskPerGB * size); break; }
+            }
+            break;
+        }
+        case GroupFirmware: if (!(f.Flags & FeatureUefi)) Add(UpgradeUefi, 0, c.SwitchToUefi); break;
+        case GroupSecureBoot: if (!(f.Flags & FeatureSecureBootEnabled) || (f.Flags & FeatureSecureBootUncertain)) Add(UpgradeSecureBoot, 0, c.EnableSecureBoot); break;
+        case GroupTpm:
+            if (f.TpmVersionMajor > 0 && f.TpmVersionMajor >= t.MinTpmVersionMajor && !(f.Flags & FeatureTpmReady)) Add(UpgradeEnableTpm, 0, c.EnableTpm);
+            Add(UpgradeTpmModule, 0, c.TpmModule);
+            break;
+        case GroupCpu: Add(UpgradeCpu, 0, c.ReplaceCpu); break;
+        case GroupGpu: Add(UpgradeGpu, 0, c.ReplaceGpu); break;
+        case GroupDisplay: Add(UpgradeDisplay, 0, c.ReplaceDisplay); break;
+        default: break;
+    }
+    return count;
+}
+
+// --- Search ---
+namespace {
+struct PlanSearch {
+    const WindowsRequirements* Target; ULONGLONG DiskUsed;
+    UpgradeGroup Active[GroupCount]; int ActiveCount = 0;         // Groups with at least one option, in search order
+    UpgradeStep Options[GroupCount][MAX_GROUP_OPTIONS]; int OptionCount[GroupCount];
+    UpgradeStep Chosen[GroupCount]; int ChosenCount = 0;
+    UpgradePlan* Best;
+
+    void Visit(int depth, const MachineFeatures& f, double cost) {
+        if (Best->Feasible && cost >= Best->Cost) return; // Costs are non-negative: this branch cannot get cheaper
+        if (depth == ActiveCount) {
+            if (EvaluateFeaturesInline(*Target, f).Fail) return;
+            Best->Feasible = true; Best->Cost = cost; Best->StepCount = ChosenCount;
+            for (int i = 0; i < ChosenCount; ++i) Best->Steps[i] = Chosen[i];
+            return;
+        }
+        const int group = Active[depth];
+        Visit(depth + 1, f, cost); // Leave this group as it is (e.g. UEFI alone may already fix Secure Boot's firmware side)
+        for (int o = 0; o < OptionCount[group]; ++o) {
+            MachineFeatures changed = f; ApplyStep(Options[group][o], DiskUsed, changed);
+            Chosen[ChosenCount++] = Options[group][o];
+            Visit(depth + 1, changed, cost + Options[group][o].Cost);
+            --ChosenCount;
+        }
+    }
+};
+}
+
+bool PlanUpgrade(const WindowsRequirements& target, const MachineFeatures& machine, ULONGLONG diskTotalBytes, const UpgradeCosts& costs, UpgradePlan& plan) {
+    plan = UpgradePlan();
+    plan.Fail = EvaluateFeaturesInline(target, machine).Fail;
+    if (!plan.Fail) { plan.Feasible = true; return true; }
+
+    PlanSearch search; search.Target = &target; search.Best = &plan;
+    search.DiskUsed = diskTotalBytes > machine.DiskFreeBytes ? diskTotalBytes - machine.DiskFreeBytes : 0;
+    // A fix can turn a [WARN] into a [FAIL] (Secure Boot only warns on BIOS, and fails once the firmware is UEFI), so the
+    // groups behind checks that fail once every option is applied join the search until no new check fails
+    unsigned short failing = plan.Fail, unfixable = 0;
+    for (;;) {
+        MachineFeatures strongest = machine; search.ActiveCount = 0; // Every option applied: whatever still fails cannot be fixed
+        for (int g = 0; g < GroupCount; ++g) {
+            search.OptionCount[g] = 0;
+            if (!(GROUP_CHECKS[g] & failing)) continue;
+            search.OptionCount[g] = GroupOptions((UpgradeGroup)g, target, machine, search.DiskUsed, costs, search.Options[g]);
+            if (!search.OptionCount[g]) continue;
+            search.Active[search.ActiveCount++] = (UpgradeGroup)g;
+            ApplyStep(search.Options[g][search.OptionCount[g] - 1], search.DiskUsed, strongest);
+        }
+        unfixable = EvaluateFeaturesInline(target, strongest).Fail;
+        if (!(unfixable & ~failing)) break;
+        failing |= unfixable;
+    }
+    if (unfixable) { plan.Fail = unfixable; return false; }
+    search.Visit(0, machine, 0.0);
+    return plan.Feasible;
+}
+
+// --- Formatting ---
+const char* UpgradeActionName(UpgradeAction action) {
+    static const char* const names[UpgradeActionCount] = { "Ram", "DiskCleanup", "DiskReplace", "EnableTpm", "TpmModule", "Uefi", "SecureBoot", "Gpu", "Cpu", "Display" };
+    return (action >= 0 && action < UpgradeActionCount) ? names[action] : "Unknown";
+}
+
+static ULONGLONG WholeGB(ULONGLONG bytes) { return (bytes + GB - 1) / GB; }
+
+std::string UpgradeStepText(const UpgradeStep& step) {
+    switch (step.Action) {
+        case UpgradeRam: return "Install RAM (" + std::to_string(WholeGB(step.Amount)) + " GB total)";
+        case UpgradeDiskCleanup: return "Free " + std::to_string(WholeGB(step.Amount)) + " GB on the system drive";
+        case UpgradeDiskReplace: return "Replace the system drive (" + std::to_string(WholeGB(step.Amount)) + " GB)";
+        case UpgradeEnableTpm: return "Enable the TPM in firmware setup";
+        case UpgradeTpmModule: return "Install a TPM " + std::to_string(NEW_TPM_VERSION) + ".0 module";
+        case UpgradeUefi: return "Switch the firmware to UEFI (convert the system disk with MBR2GPT)";
+        case UpgradeSecureBoot: return "Enable Secure Boot";
+        case UpgradeGpu: return "Replace the graphics adapter (DirectX " + std::to_string(NEW_GPU_DIRECTX) + ", WDDM " + std::to_string(NEW_GPU_WDDM) + ")";
+        case UpgradeCpu: return "Replace the CPU (supported model, " + std::to_string(NEW_CPU_CORES) + " cores)";
+        case UpgradeDisplay: return "Replace the display (" + std::to_string(NEW_DISPLAY_WIDTH) + "x" + std::to_string(NEW_DISPLAY_HEIGHT) + ")";
+        default: return "Unknown";
+    }
+}
+
+void AppendUpgradePlanCell(std::string& out, const UpgradePlan& plan) {
+    for (int i = 0; i < plan.StepCount; ++i) {
+        if (i) out += ';';
+        out += UpgradeActionName(plan.Steps[i].Action);
+        if (plan.Steps[i].Amount) { out += ':'; out += std::to_string(WholeGB(plan.Steps[i].Amount)); out += "GB"; }
+    }
+}
+
+// --- Grid Sweeps ---
+bool ParseSweepAxis(const std::string& spec, SweepAxis& axis, std::string& error) {
+    const size_t equals = spec.find('=');
+    if (equals == std::string::npos || equals == 0 || equals + 1 == spec.size()) { error = "Bad sweep '" + spec + "' (expected Field=Value:Value:...)"; return false; }
+    axis.Field = spec.substr(0, equals); axis.Values.clear();
+    for (size_t begin = equals + 1; begin <= spec.size();) {
+        size_t end = spec.find(':', begin); if (end == std::string::npos) end = spec.size();
+        axis.Values.push_back(spec.substr(begin, end - begin)); begin = end + 1;
+    }
+    WindowsRequirements probe; // Reject a typo now, not after the fleet has been loaded
+    for (const std::string& value : axis.Values) { if (!SetProfileField(probe, axis.Field, value, error)) { error = "Sweep: " + error; return false; } }
+    return true;
+}
+
+bool RunUpgradeSweep(const FeatureColumns& fleet, const std::vector<ULONGLONG>& diskTotals, const WindowsRequirements& base, const std::vector<SweepAxis>& axes,
+                     const UpgradeCosts& costs, unsigned threads, std::vector<SweepPoint>& points, std::string& error) {
+    // --- Grid points (odometer over the axes) ---
+    size_t pointCount = 1;
+    for (const SweepAxis& axis : axes) { pointCount *= axis.Values.size(); if (pointCount > 100000) { error = "Sweep grid has more than 100000 points"; return false; } }
+    points.assign(pointCount, SweepPoint());
+    for (size_t p = 0; p < pointCount; ++p) {
+        SweepPoint& point = points[p]; point.Target = base; point.ValueIndex.resize(axes.size());
+        for (size_t a = axes.size(), rest = p; a-- > 0; rest /= axes[a].Values.size()) {
+            point.ValueIndex[a] = rest % axes[a].Values.size();
+            if (!SetProfileField(point.Target, axes[a].Field, axes[a].Values[point.ValueIndex[a]], error)) { error = "Sweep: " + error; return false; }
+        }
+    }
+
+    // --- Chunks: every worker evaluates all grid points over one chunk at a time ---
+    // Costs are summed per chunk and combined in chunk order afterwards, so the totals do not depend on the thread count
+    const size_t chunkRows = 4096, rows = fleet.Size(), chunkCount = (rows + chunkRows - 1) / chunkRows;
+    std::vector<double> chunkCosts(chunkCount * pointCount, 0.0);
+    std::vector<std::vector<size_t>> counts(threads ? threads : 1, std::vector<size_t>(pointCount * 3, 0)); // Passing, Upgradable, Unfixable per point
+    std::atomic<size_t> nextChunk(0);
+    auto Worker = [&](unsigned id) {
+        FeatureColumns chunk; CheckMaskColumns masks; UpgradePlan plan; std::vector<size_t>& mine = counts[id];
+        for (size_t c = nextChunk++; c < chunkCount; c = nextChunk++) {
+            const size_t begin = c * chunkRows, end = std::min(rows, begin + chunkRows);
+            chunk.Clear(); chunk.Reserve(end - begin);
+            for (size_t r = begin; r < end; ++r) chunk.Append(fleet.Row(r));
+            for (size_t p = 0; p < pointCount; ++p) {
+                EvaluateColumns(points[p].Target, chunk, masks);
+                double cost = 0.0;
+                for (size_t r = 0; r < end - begin; ++r) {
+                    if (!masks.Fail[r]) { ++mine[p * 3]; continue; }
+                    if (PlanUpgrade(points[p].Target, chunk.Row(r), diskTotals.empty() ? 0 : diskTotals[begin + r], costs, plan)) { ++mine[p * 3 + 1]; cost += plan.Cost; }
+                    else ++mine[p * 3 + 2];
+                }
+                chunkCosts[c * pointCount + p] = cost;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < counts.size(); ++i) workers.emplace_back(Worker, i);
+    Worker(0);
+    for (std::thread& worker : workers) worker.join();
+
+    for (size_t p = 0; p < pointCount; ++p) {
+        for (const std::vector<size_t>& partial : counts) { points[p].Passing += partial[p * 3]; points[p].Upgradable += partial[p * 3 + 1]; points[p].Unfixable += partial[p * 3 + 2]; }
+        for (size_t c = 0; c < chunkCount; ++c) points[p].PlanCost += chunkCosts[c * pointCount + p];
+    }
+    return true;
+}
+
+void FormatSweepCsv(const std::vector<SweepAxis>& axes, const std::vector<SweepPoint>& points, std::string& out) {
+    for (const SweepAxis& axis : axes) { out += axis.Field; out += ','; }
+    out += "Passing,Upgradable,Unfixable,PlanCost,MeanCostPerUpgrade\n";
+    char number[64];
+    for (const SweepPoint& point : points) {
+        for (size_t a = 0; a < axes.size(); ++a) { out += axes[a].Values[point.ValueIndex[a]]; out += ','; }
+        out += std::to_string(point.Passing); out += ','; out += std::to_string(point.Upgradable); out += ','; out += std::to_string(point.Unfixable); out += ',';
+        snprintf(number, sizeof(number), "%.2f,%.2f\n", point.PlanCost, point.Upgradable ? point.PlanCost / point.Upgradable : 0.0); out += number;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef UPGRADE_PLAN_H_INCLUDED
+#define UPGRADE_PLAN_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include "evaluate.h"
+
+struct FeatureColumns;
+
+// --- Upgrade Planner ---
+// Finds the cheapest set of hardware/firmware changes after which a machine has no [FAIL] against a target. Every action
+// only touches the MachineFeatures values its checks read (RAM size, free disk, TPM/UEFI/Secure Boot flags, CPU and GPU
+// levels, resolution), so a candidate plan is checked with the same EvaluateFeaturesInline() the report uses. Only the
+// action groups behind a failing check (or one that fails once the others are fixed) are searched; each group offers its cheapest sufficient options (smallest
+// standard DIMM / drive size, enable vs. install a TPM, ...) and a depth-first search with cost pruning picks the
+// combination, which matters where actions interact (Secure Boot needs UEFI first).
+enum UpgradeAction {
+    UpgradeRam, UpgradeDiskCleanup, UpgradeDiskReplace, UpgradeEnableTpm, UpgradeTpmModule,
+    UpgradeUefi, UpgradeSecureBoot, UpgradeGpu, UpgradeCpu, UpgradeDisplay,
+    UpgradeActionCount
+};
+
+// Cost weights in any unit (currency, hours, ...); --cost Name=Value sets one, e.g. "RamPerGB=4"
+struct UpgradeCosts {
+    double RamFixed = 25; double RamPerGB = 4;                  // Install DIMMs up to a standard total size
+    double DiskCleanupPerGB = 1; double DiskCleanupMaxGB = 20;  // Freeing space on the current drive, up to a limit
+    double DiskReplaceFixed = 40; double DiskPerGB = 0.1;       // New drive of a standard size, system cloned onto it
+    double EnableTpm = 10; double TpmModule = 40;               // Firmware switch vs. discrete TPM 2.0 module
+    double SwitchToUefi = 20; double EnableSecureBoot = 5;      // MBR2GPT conversion + firmware setting
+    double ReplaceGpu = 180; double ReplaceCpu = 300; double ReplaceDisplay = 150;
+};
+bool SetUpgradeCost(UpgradeCosts& costs, const std::string& assignment, std::string& error); // "Name=Value"
+
+struct UpgradeStep {
+    UpgradeAction Action;
+    ULONGLONG Amount;   // RAM / drive size after the change, or bytes freed; 0 for the other actions
+    double Cost;
+};
+
+const int UPGRADE_MAX_STEPS = 8;
+struct UpgradePlan {
+    bool Feasible = false;          // Steps remove every [FAIL]
+    double Cost = 0;
+    UpgradeStep Steps[UPGRADE_MAX_STEPS]; int StepCount = 0; // Fixed array: planning a fleet does not allocate
+    unsigned short Fail = 0;        // Before the plan: failing checks; infeasible: the checks no action can fix
+};
+
+// diskTotalBytes sizes a replacement drive (used space moves with the system); 0 if unknown
+bool PlanUpgrade(const WindowsRequirements& target, const MachineFeatures& machine, ULONGLONG diskTotalBytes, const UpgradeCosts& costs, UpgradePlan& plan);
+const char* UpgradeActionName(UpgradeAction action);    // Stable key for CSV output, e.g. "TpmModule"
+std::string UpgradeStepText(const UpgradeStep& step);   // e.g. "Install RAM (8 GB total)"
+void AppendUpgradePlanCell(std::string& out, const UpgradePlan& plan); // "Ram:8GB;SecureBoot" (unquoted; no commas)
+
+// --- Grid Sweeps ("what would it cost to get everyone to ...") ---
+// Each axis varies one WindowsRequirements member (profile CSV column names, e.g. "MinRamBytes=4GB:8GB:16GB"); every
+// combination of axis values is one target. The fleet is cut into chunks and each worker evaluates every grid point
+// over its chunk with the column kernel, planning only the machines that fail, so the fleet is read once per chunk
+// instead of once per grid point.
+struct SweepAxis { std::string Field; std::vector<std::string> Values; };
+bool ParseSweepAxis(const std::string& spec, SweepAxis& axis, std::string& error);
+
+struct SweepPoint {
+    WindowsRequirements Target;
+    std::vector<size_t> ValueIndex;                 // Per axis
+    size_t Passing = 0; size_t Upgradable = 0; size_t Unfixable = 0;
+    double PlanCost = 0;                            // Sum over the upgradable machines
+};
+bool RunUpgradeSweep(const FeatureColumns& fleet, const std::vector<ULONGLONG>& diskTotals, const WindowsRequirements& base, const std::vector<SweepAxis>& axes,
+                     const UpgradeCosts& costs, unsigned threads, std::vector<SweepPoint>& points, std::string& error);
+void FormatSweepCsv(const std::vector<SweepAxis>& axes, const std::vector<SweepPoint>& points, std::string& out);
+
+#endif // UPGRADE_PLAN_H_INCLUDED
@@ -0,0 +1,24 @@
+#ifndef VARINT_H_INCLUDED
+#define VARINT_H_INCLUDED
+
+#include <string>
+
+// --- LEB128 Varints (7 bits per byte, low bits first; shared by the aggregate, sketch and result store formats) ---
+inline void PutVarint(std::string& out, unsigned long long value) {
+    while (value >= 0x80) { out += (char)(unsigned char)(value | 0x80); value >>= 7; }
+    out += (char)(unsigned char)value;
+}
+
+// Advances p past the varint. False if it runs past end or over 10 bytes; Byte is char or unsigned char
+template <typename Byte>
+inline bool GetVarint(const Byte*& p, const Byte* end, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const unsigned char byte = (unsigned char)*p++;
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+#endif // VARINT_H_INCLUDED
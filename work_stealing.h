@@ -0,0 +1,85 @@
+#ifndef WORK_STEALING_H_INCLUDED
+#define WORK_STEALING_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// --- Work-stealing Task Pool (one deque per worker) ---
+// A worker pushes and pops at the back of its own deque, so it keeps going with the work it just produced (the rest of
+// the file it is cutting into chunks). A worker whose deque runs dry steals from the front of another worker's deque,
+// where that worker's oldest task waits. Every deque has its own lock, so workers only meet when one of them steals;
+// tasks are meant to be coarse (a chunk of records), so a lock-free deque would not buy anything measurable.
+template <typename Task>
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t workers) : count(workers ? workers : 1), deques(new Deque[workers ? workers : 1]) {}
+    WorkStealingPool(const WorkStealingPool&) = delete; WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Adds a task to worker's deque: before the workers start, or from a worker while it runs a task (before Finished)
+    void Push(size_t worker, Task task) {
+        outstanding.fetch_add(1);
+        Deque& deque = deques[worker % count];
+        { std::lock_guard<std::mutex> lock(deque.Mutex); deque.Tasks.push_back(std::move(task)); }
+        queued.fetch_add(1);
+        std::lock_guard<std::mutex> lock(idleMutex); wake.notify_one();
+    }
+
+    // Next task for worker: the newest task of its own deque, else the oldest of another worker's (neighbours first).
+    // earliestFirst takes the smallest task (operator<) across all deques instead, for a consumer that needs results in
+    // order and has fallen behind. Waits while running tasks may still push more; false once all work is finished.
+    bool Next(size_t worker, Task& task, bool earliestFirst = false) {
+        for (;;) {
+            if (earliestFirst ? TakeEarliest(task) : (TakeOwn(worker % count, task) || Steal(worker % count, task))) return true;
+            std::unique_lock<std::mutex> lock(idleMutex);
+            wake.wait(lock, [&] { return queued.load() > 0 || outstanding.load() == 0; });
+            if (queued.load() == 0 && outstanding.load() == 0) return false;
+        }
+    }
+    // Marks a task returned by Next as done; tasks it pushed must already be in the pool
+    void Finished() { if (outstanding.fetch_sub(1) == 1) { std::lock_guard<std::mutex> lock(idleMutex); wake.notify_all(); } }
+    size_t Steals() const { return steals.load(); }
+
+private:
+    struct Deque { std::mutex Mutex; std::deque<Task> Tasks; };
+    bool TakeOwn(size_t worker, Task& task) {
+        Deque& deque = deques[worker];
+        std::lock_guard<std::mutex> lock(deque.Mutex);
+        if (deque.Tasks.empty()) return false;
+        task = std::move(deque.Tasks.back()); deque.Tasks.pop_back(); queued.fetch_sub(1);
+        return true;
+    }
+    bool Steal(size_t worker, Task& task) {
+        for (size_t k = 1; k < count; ++k) {
+            Deque& victim = deques[(worker + k) % count];
+            std::lock_guard<std::mutex> lock(victim.Mutex);
+            if (victim.Tasks.empty()) continue;
+            task = std::move(victim.Tasks.front()); victim.Tasks.pop_front(); queued.fetch_sub(1); steals.fetch_add(1);
+            return true;
+        }
+        return false;
+    }
+    bool TakeEarliest(Task& task) { // Locks every deque, always in index order (the other paths hold one lock at a time)
+        std::unique_ptr<std::unique_lock<std::mutex>[]> locks(new std::unique_lock<std::mutex>[count]);
+        for (size_t i = 0; i < count; ++i) locks[i] = std::unique_lock<std::mutex>(deques[i].Mutex);
+        Deque* best = NULL; typename std::deque<Task>::iterator bestTask;
+        for (size_t i = 0; i < count; ++i) {
+            for (typename std::deque<Task>::iterator it = deques[i].Tasks.begin(); it != deques[i].Tasks.end(); ++it) { if (!best || *it < *bestTask) { best = &deques[i]; bestTask = it; } }
+        }
+        if (!best) return false;
+        task = std::move(*bestTask); best->Tasks.erase(bestTask); queued.fetch_sub(1);
+        return true;
+    }
+
+    size_t count; std::unique_ptr<Deque[]> deques;
+    std::atomic<size_t> queued{0};        // Tasks sitting in a deque
+    std::atomic<size_t> outstanding{0};   // Queued plus handed out but not Finished
+    std::atomic<size_t> steals{0};
+    std::mutex idleMutex; std::condition_variable wake;
+};
+
+#endif // WORK_STEALING_H_INCLUDED